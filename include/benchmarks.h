@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+#include "cycle_counter.h"
+
+/**
+ * Boot-time micro benchmarks, compiled in with -D ENABLE_BENCHMARKS
+ * (see env:uno_bench). Results are logged in HAL::CycleCounter units:
+ * CPU cycles on target, nanoseconds on the host build.
+ */
+namespace Bench
+{
+    /// Average cost of one func() call over iterations, loop overhead removed
+    template <typename Func>
+    uint32_t measure(Func func, uint16_t iterations) {
+        const uint32_t start = HAL::CycleCounter::now();
+        for (uint16_t i = 0; i < iterations; ++i) {
+            func();
+        }
+        const uint32_t elapsed = HAL::CycleCounter::now() - start;
+
+        const uint32_t baseline_start = HAL::CycleCounter::now();
+        for (uint16_t i = 0; i < iterations; ++i) {
+            asm volatile("" ::: "memory");
+        }
+        const uint32_t baseline = HAL::CycleCounter::now() - baseline_start;
+
+        return elapsed > baseline ? (elapsed - baseline) / iterations : 0;
+    }
+
+    void runBenchmarks();
+} // namespace Bench
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * Per-step timing of the boot sequence.
+ *
+ * setup() marks the end of each step, loop() marks the first pass that has
+ * readings from both sensors, i.e. the first real fan decision. Times are
+ * micros() since reset, so the step durations add up to the time from
+ * power-on (after the bootloader) to fan control.
+ */
+class BootProfile {
+public:
+    enum Step : uint8_t {
+        STEP_SERIAL,        // Log port
+        STEP_GPIO,
+        STEP_SENSORS,       // Bus scan and resolution check
+        STEP_LCD,           // Controller init and CGRAM glyphs
+        STEP_SETTINGS,      // EEPROM settings, operation log, UI
+        STEP_LINKS,         // Shell, telemetry and Modbus wiring
+        STEP_FIRST_DECISION,
+        STEP_COUNT
+    };
+
+    /// Target from reset to the first fan decision
+    static constexpr uint32_t kBudgetMicros = 2000000UL;
+
+    /// Record the end of step, the first mark of each step wins
+    void mark(Step step) {
+        if (!marked(step)) {
+            end_us_[step] = micros();
+            marked_ |= static_cast<uint8_t>(1U << step);
+        }
+    }
+
+    bool marked(Step step) const { return marked_ & (1U << step); }
+
+    /// Duration of step, from the end of the previous marked step
+    uint32_t stepMicros(Step step) const;
+
+    /// End of step since reset, 0 while not reached
+    uint32_t endMicros(Step step) const { return end_us_[step]; }
+
+    bool withinBudget() const {
+        return marked(STEP_FIRST_DECISION) && end_us_[STEP_FIRST_DECISION] <= kBudgetMicros;
+    }
+
+    /// Short name of step (flash string)
+    static const __FlashStringHelper* name(Step step);
+
+private:
+    uint32_t end_us_[STEP_COUNT] = {};
+    uint8_t marked_ = 0;
+};
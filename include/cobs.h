@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Consistent Overhead Byte Stuffing.
+ *
+ * Removes every 0x00 from a payload at a cost of one byte per 254, so 0x00
+ * can delimit frames on a byte stream shared with plain log text.
+ */
+namespace Cobs
+{
+    /// Worst case encoded size of size payload bytes (without the delimiter)
+    constexpr size_t maxEncodedSize(size_t size) {
+        return size + size / 254U + 1U;
+    }
+
+    /**
+     * Encode size bytes of data into out.
+     * @return encoded length, 0 if out is too small
+     */
+    size_t encode(const uint8_t* data, size_t size, uint8_t* out, size_t out_size);
+
+    /**
+     * Decode a frame (delimiter stripped) into out; may decode in place.
+     * @return decoded length, 0 on a malformed frame or too small buffer
+     */
+    size_t decode(const uint8_t* data, size_t size, uint8_t* out, size_t out_size);
+} // namespace Cobs
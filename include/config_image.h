@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Portable image of all persisted settings, for bulk provisioning.
+ *
+ * Layout (little endian):
+ *   magic "PC", version u8, entry count u8,
+ *   count x { field u8, decimals u8, value i16 },
+ *   CRC-32 over everything before it.
+ *
+ * Entries carry the PersistenceField and the fixed-point scale of the
+ * settings registry, so an image does not depend on the PersistenceData
+ * layout of a platform. Import validates the whole image before touching
+ * the settings and then persists it in a single EEPROM commit: an image is
+ * applied completely or not at all.
+ */
+namespace ConfigImage
+{
+    constexpr uint8_t kMagic[2] = {'P', 'C'};
+    constexpr uint8_t kVersion = 1;
+    constexpr size_t kHeaderSize = 4;
+    constexpr size_t kEntrySize = 4;
+    constexpr size_t kCrcSize = 4;
+    constexpr size_t kMaxEntries = 6;     // Checked against the Number settings in settings_registry.cpp
+    constexpr size_t kMaxSize = kHeaderSize + kMaxEntries * kEntrySize + kCrcSize;
+
+    enum Result : uint8_t {
+        RESULT_OK            = 0,
+        RESULT_BAD_SIZE      = 1,
+        RESULT_BAD_CRC       = 2,
+        RESULT_BAD_HEADER    = 3,   // Wrong magic or unsupported version
+        RESULT_UNKNOWN_FIELD = 4,   // Field not in the registry, or listed twice
+        RESULT_BAD_VALUE     = 5    // Scale mismatch or value out of the setting's range
+    };
+
+    /**
+     * Write the persisted values of all settings into out.
+     * @return image size, 0 if out is too small
+     */
+    size_t exportImage(uint8_t* out, size_t size);
+
+    /// Validate an image and persist all of its values in one commit
+    Result importImage(const uint8_t* image, size_t size);
+} // namespace ConfigImage
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * View model between the control loop and UserInterface.
+ *
+ * Values are quantized to display resolution (0.1 C) when they are set, a
+ * field is only marked dirty when its displayed value changes. Frame
+ * counters record how many updateDisplay() calls actually had to render.
+ */
+class DisplayViewModel {
+public:
+    enum Field : uint8_t {
+        FIELD_NONE          = 0,
+        FIELD_EXTERNAL_TEMP = 1 << 0,
+        FIELD_INTERNAL_TEMP = 1 << 1,
+        FIELD_FAN_STATE     = 1 << 2,
+        FIELD_ALL           = FIELD_EXTERNAL_TEMP | FIELD_INTERNAL_TEMP | FIELD_FAN_STATE
+    };
+
+    struct FrameStats {
+        uint32_t rendered = 0;  // Frames that repainted at least one region
+        uint32_t skipped  = 0;  // Frames with nothing to repaint
+    };
+
+    static constexpr int16_t kNoReading = -32767 - 1;  // Sensor missing or NAN
+    static constexpr int16_t kTemperatureScale = 10;   // Display resolution 0.1 C
+
+    void setExternalTemperature(float temp);
+    void setInternalTemperature(float temp);
+    void setFanState(bool state);
+
+    /// Temperatures in tenths of degree, kNoReading if unavailable
+    int16_t externalTemperature() const { return external_temp_; }
+    int16_t internalTemperature() const { return internal_temp_; }
+    bool isFanOn() const { return is_fan_on_; }
+
+    /// Return the changed fields and clear them
+    uint8_t takeDirty();
+
+    void countFrame(bool rendered);
+    const FrameStats& frameStats() const { return frame_stats_; }
+
+    /// Quantize a temperature to display resolution
+    static int16_t quantize(float temp);
+
+private:
+    int16_t external_temp_ = kNoReading;
+    int16_t internal_temp_ = kNoReading;
+    bool is_fan_on_ = false;
+    uint8_t dirty_ = FIELD_ALL;
+    FrameStats frame_stats_;
+};
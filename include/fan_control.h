@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Fan on/off control law run by loop(), kept free of globals and of the
+ * persistence manager so host tests, benchmarks and the replay tools can
+ * drive it directly. decide() is the law itself; update() runs it for one
+ * controller per pass on the target, updateBatch() for many controllers in
+ * lockstep over structure-of-arrays lanes. Its loops are branch free over
+ * restrict pointers, so GCC vectorises them at -O3 (the replay tools and the
+ * native test build); at -O2 they stay scalar.
+ */
+namespace FanControl
+{
+    /// Thresholds from PersistenceManager, temperatures in C
+    struct Settings {
+        float min_external;             // Fan may run above this external temperature
+        float max_external;             // ...and below this one
+        float temperature_difference;   // Hysteresis around internal - external
+        unsigned long switch_time_ms;   // Minimum time between two changes of the fan
+    };
+
+    struct State {
+        bool fan_on = false;
+        unsigned long last_change_ms = 0;   // Time the fan last changed
+    };
+
+    /// Power-up state: fan off and free to change on the first pass
+    inline State initialState(unsigned long now_ms, const Settings& settings) {
+        State state;
+        state.last_change_ms = now_ms - settings.switch_time_ms;    // Wraps like millis()
+        return state;
+    }
+
+    /**
+     * The fan state the readings call for, ignoring the switch time.
+     * NAN readings fail every comparison, so the fan keeps its state.
+     */
+    inline bool decide(bool fan_on, float external_temp, float internal_temp,
+                       float min_external, float max_external, float temperature_difference) {
+        if (!fan_on) {
+            // Off -> On
+            return external_temp > min_external &&
+                   external_temp < max_external &&
+                   external_temp < internal_temp - temperature_difference;
+        }
+        // On -> Off
+        return !(external_temp <= min_external ||
+                 external_temp >= max_external ||
+                 external_temp > internal_temp + temperature_difference);
+    }
+
+    /**
+     * One control pass at now_ms with the latest filtered readings.
+     * @return the new fan state, also stored in state
+     */
+    inline bool update(State& state, const Settings& settings, unsigned long now_ms,
+                       float external_temp, float internal_temp) {
+        // 1) time-hysteresis: if we switched too recently, ignore.
+        if (now_ms - state.last_change_ms < settings.switch_time_ms) {
+            return state.fan_on;
+        }
+
+        // 2) temperature-hysteresis & range checks
+        const bool fan_on = decide(state.fan_on, external_temp, internal_temp, settings.min_external,
+                                   settings.max_external, settings.temperature_difference);
+        if (fan_on != state.fan_on) {
+            state.fan_on = fan_on;
+            state.last_change_ms = now_ms;
+        }
+        return state.fan_on;
+    }
+
+    /**
+     * Settings and state of count controllers, one array per field. Times
+     * are 32-bit and wrap like millis() on the target. The arrays must not
+     * overlap: updateBatch() reads and writes them through restrict pointers.
+     */
+    struct Lanes {
+        const float* min_external;
+        const float* max_external;
+        const float* temperature_difference;
+        const uint32_t* switch_time_ms;
+        uint8_t* fan_on;                // 0 or 1
+        uint32_t* last_change_ms;
+        size_t count;
+    };
+
+    namespace detail
+    {
+        /// 1 when the lane changes its fan on this pass; branch free, every
+        /// comparison is evaluated so the batch loops become SIMD selects
+        inline uint32_t laneChange(float ext, float in, uint32_t on, float min_external, float max_external,
+                                   float difference, uint32_t free) {
+            const uint32_t turn_on = static_cast<uint32_t>(ext > min_external) &
+                                     static_cast<uint32_t>(ext < max_external) &
+                                     static_cast<uint32_t>(ext < in - difference);
+            const uint32_t turn_off = static_cast<uint32_t>(ext <= min_external) |
+                                      static_cast<uint32_t>(ext >= max_external) |
+                                      static_cast<uint32_t>(ext > in + difference);
+            return free & ((on & turn_off) | (~on & turn_on));
+        }
+    } // namespace detail
+
+    /// One pass of every lane, lane i reading external[i] and internal[i]
+    inline void updateBatch(const Lanes& lanes, uint32_t now_ms, const float* __restrict external,
+                            const float* __restrict internal) {
+        const float* __restrict const min_external = lanes.min_external;
+        const float* __restrict const max_external = lanes.max_external;
+        const float* __restrict const difference = lanes.temperature_difference;
+        const uint32_t* __restrict const switch_time_ms = lanes.switch_time_ms;
+        uint8_t* __restrict const fan_on = lanes.fan_on;
+        uint32_t* __restrict const last_change_ms = lanes.last_change_ms;
+        const size_t count = lanes.count;
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t on = fan_on[i];
+            const uint32_t free = static_cast<uint32_t>(now_ms - last_change_ms[i] >= switch_time_ms[i]);
+            const uint32_t change = detail::laneChange(external[i], internal[i], on, min_external[i],
+                                                       max_external[i], difference[i], free);
+            fan_on[i] = static_cast<uint8_t>(on ^ change);
+            last_change_ms[i] += (now_ms - last_change_ms[i]) & (0U - change);
+        }
+    }
+
+    /// One pass of every lane on the same readings, e.g. settings candidates over one trace
+    inline void updateBatch(const Lanes& lanes, uint32_t now_ms, float external, float internal) {
+        const float* __restrict const min_external = lanes.min_external;
+        const float* __restrict const max_external = lanes.max_external;
+        const float* __restrict const difference = lanes.temperature_difference;
+        const uint32_t* __restrict const switch_time_ms = lanes.switch_time_ms;
+        uint8_t* __restrict const fan_on = lanes.fan_on;
+        uint32_t* __restrict const last_change_ms = lanes.last_change_ms;
+        const size_t count = lanes.count;
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t on = fan_on[i];
+            const uint32_t free = static_cast<uint32_t>(now_ms - last_change_ms[i] >= switch_time_ms[i]);
+            const uint32_t change = detail::laneChange(external, internal, on, min_external[i], max_external[i],
+                                                       difference[i], free);
+            fan_on[i] = static_cast<uint8_t>(on ^ change);
+            last_change_ms[i] += (now_ms - last_change_ms[i]) & (0U - change);
+        }
+    }
+} // namespace FanControl
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "project_pin_definition.h"
+
+namespace HAL
+{
+    /// Keypad keys, one bit each in GpioInterface::readKeypad()
+    enum KeypadKey : uint8_t {
+        KEY_NEXT   = 0x01,
+        KEY_PREV   = 0x02,
+        KEY_SELECT = 0x04,
+        KEY_UP     = 0x08,
+        KEY_DOWN   = 0x10
+    };
+    constexpr uint8_t kKeypadKeyCount = 5;
+
+    /**
+     * Compile-time GPIO HAL interface.
+     *
+     * Each platform library (platform/<target>) implements a backend class
+     * deriving from GpioInterface<Backend> and exports it as HAL::Gpio from
+     * its gpio_hal.h. The PlatformIO environment decides which platform
+     * library is linked, so GPIO:: never needs a platform #ifdef and every
+     * call resolves statically (no vtable, no function pointers).
+     *
+     * A backend has to provide:
+     *   static bool     init();
+     *   static void     writeRelay(bool state);
+     *   static void     writeBacklight(bool state);
+     *   static bool     readPinActive(uint16_t pin);   // true on active (low) level
+     *   static uint16_t readKeypadAnalog();
+     *   static constexpr uint16_t kAdcMax;            // full scale of readKeypadAnalog()
+     *   static void     initLcdBus();
+     *   static void     writeLcdNibble(bool rs, uint8_t nibble);  // set RS/D4-D7, pulse EN
+     * and may override readLcdBusy() when the LCD RW line is wired.
+     */
+    template <typename Backend>
+    class GpioInterface {
+    public:
+        static bool initGPIO() {
+            return Backend::init();
+        }
+
+        static void setRelay(bool state) {
+            Backend::writeRelay(state);
+        }
+
+        static void setBacklight(bool state) {
+            Backend::writeBacklight(state);
+        }
+
+        static bool isButtonPressed(uint16_t buttonPin) {
+            return Backend::readPinActive(buttonPin);
+        }
+
+        static bool isButtonHolded(uint16_t buttonPin) {
+            // TODO: Implement hold detection logic if needed
+            return Backend::readPinActive(buttonPin);
+        }
+
+#ifdef USE_ANALOG_KEYPAD
+        /// Keys down now as KeypadKey bits, a single ADC read
+        static uint8_t readKeypad() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            if (analogKeypadKey < scaleAdc(50)) {
+                return KEY_NEXT;
+            }
+            if (analogKeypadKey < scaleAdc(150)) {
+                return KEY_UP;
+            }
+            if (analogKeypadKey < scaleAdc(350)) {
+                return KEY_DOWN;
+            }
+            if (analogKeypadKey < scaleAdc(500)) {
+                return KEY_PREV;
+            }
+            if (analogKeypadKey < scaleAdc(750)) {
+                return KEY_SELECT;
+            }
+            return 0;
+        }
+
+        static bool isKeypadNextPressed() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            return analogKeypadKey < scaleAdc(50);
+        }
+
+        static bool isKeypadPrevPressed() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            return analogKeypadKey >= scaleAdc(350) && analogKeypadKey < scaleAdc(500);
+        }
+
+        static bool isKeypadSelectPressed() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            return analogKeypadKey >= scaleAdc(500) && analogKeypadKey < scaleAdc(750);
+        }
+
+        static bool isKeypadUpPressed() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            return analogKeypadKey >= scaleAdc(50) && analogKeypadKey < scaleAdc(150);
+        }
+
+        static bool isKeypadDownPressed() {
+            const auto analogKeypadKey = Backend::readKeypadAnalog();
+            return analogKeypadKey >= scaleAdc(150) && analogKeypadKey < scaleAdc(350);
+        }
+#else
+        /// Keys down now as KeypadKey bits
+        static uint8_t readKeypad() {
+            return static_cast<uint8_t>((isKeypadNextPressed() ? KEY_NEXT : 0) |
+                                        (isKeypadPrevPressed() ? KEY_PREV : 0) |
+                                        (isKeypadSelectPressed() ? KEY_SELECT : 0) |
+                                        (isKeypadUpPressed() ? KEY_UP : 0) |
+                                        (isKeypadDownPressed() ? KEY_DOWN : 0));
+        }
+
+        static bool isKeypadNextPressed() {
+            return Backend::readPinActive(NEXT_BUTTON_PIN);
+        }
+
+        static bool isKeypadPrevPressed() {
+            return Backend::readPinActive(BEFORE_BUTTON_PIN);
+        }
+
+        static bool isKeypadSelectPressed() {
+            return Backend::readPinActive(SELECT_BUTTON_PIN);
+        }
+
+        static bool isKeypadUpPressed() {
+            return Backend::readPinActive(INCREASE_BUTTON_PIN);
+        }
+
+        static bool isKeypadDownPressed() {
+            return Backend::readPinActive(DECREASE_BUTTON_PIN);
+        }
+#endif  // USE_ANALOG_KEYPAD
+
+        // HD44780 4-bit bus
+        static constexpr bool lcdHasBusyFlag() {
+            return LCD_RW_PIN != PIN_NOT_WIRED;
+        }
+
+        static void lcdInit() {
+            Backend::initLcdBus();
+        }
+
+        static void lcdWriteNibble(bool rs, uint8_t nibble) {
+            Backend::writeLcdNibble(rs, nibble);
+        }
+
+        static bool lcdReadBusy() {
+            return Backend::readLcdBusy();
+        }
+
+        /// Read the busy flag (D7) of the instruction register, needs RW wired
+        static bool readLcdBusy() {
+            // The controller drives D4-D7 while RW is high: release all of them first
+            static constexpr uint8_t kDataPins[] = {LCD_D4_PIN, LCD_D5_PIN, LCD_D6_PIN, LCD_D7_PIN};
+            for (const uint8_t pin : kDataPins) {
+                pinMode(pin, INPUT);
+            }
+            digitalWrite(LCD_RS_PIN, LOW);
+            digitalWrite(LCD_RW_PIN, HIGH);
+            digitalWrite(LCD_EN_PIN, HIGH);
+            delayMicroseconds(1);
+            const bool busy = digitalRead(LCD_D7_PIN) == HIGH;
+            digitalWrite(LCD_EN_PIN, LOW);
+            delayMicroseconds(1);
+            // Second pulse clocks out the low nibble (address counter), ignored
+            digitalWrite(LCD_EN_PIN, HIGH);
+            delayMicroseconds(1);
+            digitalWrite(LCD_EN_PIN, LOW);
+            digitalWrite(LCD_RW_PIN, LOW);
+            for (const uint8_t pin : kDataPins) {
+                pinMode(pin, OUTPUT);
+            }
+            return busy;
+        }
+
+    protected:
+        /// Keypad thresholds are specified for a 10-bit ADC; rescale them to the backend
+        static constexpr uint16_t scaleAdc(uint32_t value10bit) {
+            return static_cast<uint16_t>((value10bit * (static_cast<uint32_t>(Backend::kAdcMax) + 1U)) / 1024U);
+        }
+    };
+} // namespace HAL
@@ -11,6 +11,17 @@ namespace GPIO {
 
     bool isButtonPressed(uint16_t buttonPin);
 
+    /**
+     * Sample the keypad once and latch new presses until isKeypad*Pressed()
+     * takes them. A key counts as released after 20 ms without contact, so
+     * contact bounce is one press. Call it while waiting so presses shorter
+     * than a loop() pass are not lost.
+     * @return true while a latched press has not been taken
+     */
+    bool pollKeypad();
+
+    // Rising edges of the keys, polled now or latched since the last call
+
     bool isKeypadNextPressed();
 
     bool isKeypadPrevPressed();
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * HD44780 character LCD driver on a 4-bit, write-only bus.
+ *
+ * Replaces the LiquidCrystal library: nibbles go out through
+ * HAL::Gpio::lcdWriteNibble() (direct port writes on AVR). After begin()
+ * every command and data byte is put into a ring buffer and clocked out by
+ * HAL::LcdTxTimer, one byte per kTickMicros and only once the previous
+ * instruction has finished (datasheet execution times at 270 kHz, or the busy
+ * flag when LCD_RW_PIN is wired). Rendering is a memory-only operation; it
+ * only waits when the queue is full.
+ */
+class Hd44780 : public Print {
+public:
+    struct Stats {
+        uint32_t bytes = 0;             // Bytes sent to the controller since begin()
+        uint32_t bus_micros = 0;        // Controller execution time of those bytes, datasheet figures
+        uint32_t last_drain_micros = 0; // Last queue drain, first byte queued to the ring going empty
+        uint16_t last_drain_bytes = 0;  // Bytes clocked out by that drain
+        uint32_t frames = 0;            // endFrame() calls
+        uint32_t last_frame_micros = 0; // CPU time spent rendering the last frame
+        uint16_t last_frame_bytes = 0;  // Bytes queued by the last frame
+        uint16_t queue_full_waits = 0;  // Writes that had to wait for a free slot
+    };
+
+    // Datasheet execution times, fosc = 270 kHz
+    static constexpr uint16_t kCommandMicros = 37;
+    static constexpr uint16_t kDataMicros = 41;             // 37 us + 4 us address counter update
+    static constexpr uint16_t kClearHomeMicros = 1520;
+    static constexpr uint16_t kPowerOnMillis = 40;          // Vcc rise to 4.5 V
+    static constexpr uint16_t kTickMicros = 50;             // Transmit tick, covers a data byte and the margin
+    static constexpr uint16_t kReadyMarginMicros = 8;       // micros() steps of 4 us and tick entry jitter
+    static constexpr uint8_t kQueueSize = 64;               // Power of two, fits a full 16x2 repaint
+
+    void begin(uint8_t cols, uint8_t rows);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void createChar(uint8_t location, const uint8_t charmap[]);
+    void command(uint8_t value);
+
+    size_t write(uint8_t value) override;
+    using Print::write;
+
+    /// Bracket one screen update to record its render time and size
+    void beginFrame();
+    void endFrame();
+
+    /// Block until every queued byte has been executed by the controller
+    void flush();
+
+    /// Consistent copy, the transmit tick updates the counters
+    Stats stats() const;
+
+    /**
+     * Throughput of the last queue drain, timed with micros() from the first
+     * byte queued to the tick that finds the ring empty. Shows what the bus
+     * really does: one byte per kTickMicros at best, plus the long waits.
+     */
+    uint32_t bytesPerSecond() const;
+
+private:
+    enum OpFlags : uint8_t {
+        OP_DATA = 1 << 0,   // RS high
+        OP_LONG = 1 << 1,   // Clear display / return home
+    };
+
+    void send(uint8_t value, uint8_t flags);
+    void sendNow(uint8_t value, uint8_t flags);
+    void waitReady();
+    void serviceQueue();
+    static void onTxTick();
+    static uint16_t executionMicros(uint8_t flags);
+
+    static Hd44780* tx_owner_;      // Display served by the transmit tick
+
+    uint8_t rows_ = 2;
+    bool queued_ = false;           // Bytes go through the queue, set at the end of begin()
+    uint32_t ready_at_us_ = 0;      // Controller finishes the last instruction (synchronous mode)
+    uint32_t frame_start_us_ = 0;
+    uint16_t frame_queued_ = 0;     // Bytes queued since beginFrame()
+
+    // Single producer (send) / single consumer (transmit tick) ring
+    volatile uint8_t queue_values_[kQueueSize];
+    volatile uint8_t queue_flags_[kQueueSize];
+    volatile uint8_t head_ = 0;
+    volatile uint8_t tail_ = 0;
+    uint32_t tx_ready_at_us_ = 0;       // Controller finishes the last queued instruction, tick only
+    volatile bool draining_ = false;    // Set by send() on the first byte, cleared by the tick on empty
+    uint32_t drain_start_us_ = 0;
+    uint16_t drain_bytes_ = 0;          // Tick only
+    Stats stats_;
+};
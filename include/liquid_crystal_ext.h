@@ -1,58 +1,66 @@
 #pragma once
 
 #include <Arduino.h>   // For byte type
-#include <LiquidCrystal.h>   // Include the LiquidCrystal library for LCD control
+#include "hd44780.h"   // HD44780 driver, pins come from project_pin_definition.h
 #include "log.h"
 
-class PolishLCD : public LiquidCrystal {
+class PolishLCD : public Hd44780 {
 public:
-    // Inherit all LiquidCrystal constructors
-    using LiquidCrystal::LiquidCrystal;
-
     /// Call instead of begin(), to init LCD and load Polish CGRAM chars
     void beginPolish(uint8_t cols, uint8_t rows) {
-        LiquidCrystal::begin(cols, rows);
+        Hd44780::begin(cols, rows);
         loadPolishChars();
     }
 
     /// Print a UTF‑8 encoded C‑string, mapping Polish letters to custom slots
     virtual size_t print(const char *str) {
+        return printUtf8(str, [](const char *p) { return static_cast<uint8_t>(*p); });
+    }
+
+    /// Print a UTF‑8 encoded string stored in flash (F() / PROGMEM)
+    size_t print(const __FlashStringHelper *str) {
+        return printUtf8(reinterpret_cast<const char *>(str),
+                         [](const char *p) { return static_cast<uint8_t>(pgm_read_byte(p)); });
+    }
+
+private:
+    template <typename ReadByte>
+    size_t printUtf8(const char *str, ReadByte readByte) {
         size_t count = 0;
-        while (*str) {
-            uint8_t c = (uint8_t)*str;
+        while (uint8_t c = readByte(str)) {
             if (c == 0xC4) {
                 // two‑byte sequences starting with C4
                 str++;
-                switch ((uint8_t)*str) {
+                switch (readByte(str)) {
                     case 0x85: write(byte(0)); break; // ą
                     case 0x87: write(byte(1)); break; // ć
                     case 0x99: write(byte(2)); break; // ę
-                    case 0x84: write(byte(4)); break; // ń
                     default:
                         write('?');
-                        LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)*str);
+                        LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)readByte(str));
                         break;
                 }
             }
             else if (c == 0xC3) {
                 // ó = C3 B3
                 str++;
-                if ((uint8_t)*str == 0xB3) write(byte(5));
+                if (readByte(str) == 0xB3) write(byte(5));
                 else {
-                    LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)*str);
+                    LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)readByte(str));
                     write('?');
                 }
             }
             else if (c == 0xC5) {
                 // two‑byte sequences starting with C5
                 str++;
-                switch ((uint8_t)*str) {
+                switch (readByte(str)) {
                     case 0x9B: write(byte(6)); break; // ś
                     case 0xBC: write(byte(7)); break; // ż
                     case 0x82: write(byte(3)); break; // ł
+                    case 0x84: write(byte(4)); break; // ń
                     default:
                         write('?');
-                        LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)*str);
+                        LOG_INFO("Unknown Polish character: %02X %02X", (int)c, (int)readByte(str));
                         break;
                 }
             }
@@ -65,15 +73,6 @@ public:
         return count;
     }
 
-    inline size_t print(const float f) {
-        return LiquidCrystal::print(f);
-    }
-
-    inline size_t print(const size_t s) {
-        return LiquidCrystal::print(s);
-    }
-
-private:
     static constexpr const uint8_t _polishChars[8][8] = {
         // ą
         {0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b01110, 0b00001},
@@ -95,7 +94,7 @@ private:
 
     void loadPolishChars() {
         for (uint8_t i = 0; i < 8; i++) {
-            createChar(i, const_cast<uint8_t*>(_polishChars[i]));
+            createChar(i, _polishChars[i]);
         }
     }
 };
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Ids written to HAL::StageMarker: the stage loop() is in and the EEPROM
+ * commit in progress. Plain C++ without Arduino headers, the simavr bench
+ * (tools/simavr_bench) includes it to name its report entries.
+ */
+namespace LoopStage
+{
+    enum Stage : uint8_t {
+        STAGE_NONE,         // Reset until setup() starts
+        STAGE_SETUP,
+        STAGE_LINKS,        // Start of loop(): Modbus, serial RX, shell
+        STAGE_SENSORS,      // One DS18B20 conversion and read
+        STAGE_FAN_CONTROL,
+        STAGE_TELEMETRY,    // Snapshot publish and telemetry stream
+        STAGE_RECORDS,      // Trends, history and operation log
+        STAGE_UI_INPUT,     // Keypad polling and key handlers
+        STAGE_UI_RENDER,    // updateDisplay()
+        STAGE_DELAY,        // Loop statistics and the pacing delay()
+        STAGE_COUNT
+    };
+
+    enum Commit : uint8_t {
+        COMMIT_NONE,
+        COMMIT_SETTINGS,    // PersistenceManager data and CRC
+        COMMIT_COUNTERS,    // OperationLog counter slot
+        COMMIT_EVENTS,      // OperationLog pending events
+        COMMIT_COUNT
+    };
+} // namespace LoopStage
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * RAM figures of HAL::Memory::usage(), in bytes; 0 where the platform cannot
+ * tell. The stack figures come from the paint HAL::Memory applies at boot:
+ * bytes between the heap and the stack that still hold it were never used.
+ */
+struct MemoryUsage {
+    uint16_t total = 0;         // RAM of the MCU, the painted stack window on the host
+    uint16_t data = 0;          // Initialized statics
+    uint16_t bss = 0;           // Zeroed statics, function-local statics included
+    uint16_t heap = 0;          // malloc arena up to the break
+    uint16_t free = 0;          // Heap end to the stack pointer, now
+    uint16_t stack_peak = 0;    // Deepest stack since the paint
+    uint16_t unused = 0;        // Painted bytes never touched: the least free RAM so far
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include "modbus_rtu.h"
+
+class OperationLog;
+namespace Telemetry {
+    class SnapshotBuffer;
+}
+
+namespace Modbus
+{
+    enum RegisterType : uint8_t {
+        REGISTER_INPUT,
+        REGISTER_HOLDING
+    };
+
+    /**
+     * Register map of the controller. 32-bit values are two registers,
+     * high word first.
+     *
+     * Input registers (function 04), read only:
+     *   0      external temperature, 0.01 C (0x8000 = no reading)
+     *   1      internal temperature, 0.01 C (0x8000 = no reading)
+     *   2      fan on (0/1)
+     *   3      last loop duration, ms
+     *   4-5    uptime, s
+     *   6      boots
+     *   7-8    relay cycles
+     *   9-10   fan runtime, s
+     *
+     * Holding registers (functions 03/06/16), one per PersistenceField, in
+     * the fixed-point units of the settings registry:
+     *   0 minimal external temperature (0.1 C), 1 maximal external
+     *   temperature (0.1 C), 2 temperature difference hysteresis (0.1 C),
+     *   3 switch time hysteresis (s), 4 Modbus address
+     *
+     * Values outside a setting's range are rejected, not clamped. A write
+     * of several registers is validated first and persisted in one commit.
+     */
+    class RegisterMap {
+    public:
+        struct Context {
+            const Telemetry::SnapshotBuffer* snapshot = nullptr;
+            const OperationLog* operation_log = nullptr;
+        };
+
+        static constexpr uint16_t kInputRegisters = 11;
+
+        /// context is kept by reference, it may be filled in after construction
+        explicit RegisterMap(const Context& context) : context_(context) {}
+
+        /// Persisted slave address
+        uint8_t unitAddress() const;
+
+        /// Read count registers from start as big-endian words into out
+        Exception read(RegisterType type, uint16_t start, uint16_t count, uint8_t* out) const;
+
+        /// Write count big-endian words from values to holding registers from start
+        Exception write(uint16_t start, uint16_t count, const uint8_t* values);
+
+    private:
+        const Context& context_;
+    };
+} // namespace Modbus
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Modbus RTU slave on an RS-485 port (HAL::ModbusPort).
+ *
+ * The UART is buffered by the core's RX/TX interrupts; service() runs the
+ * frame state machine from the main loop and from yield(), i.e. also
+ * during every delay(), with bounded work per call and no waiting:
+ *
+ *   IDLE -> RECEIVING   bytes are appended as they are drained
+ *   RECEIVING -> reply  a t3.5 silence ends the frame, or earlier once a
+ *                       request of known length is complete with a good CRC
+ *   TRANSMITTING        the reply is handed to the UART as TX room allows
+ *   DRAINING            the driver enable is released after the last
+ *                       character has left the shift register
+ *
+ * Supported functions: 03 read holding, 04 read input, 06 write single and
+ * 16 write multiple registers. Address 0 is broadcast (writes, no reply).
+ */
+namespace Modbus
+{
+    enum FunctionCode : uint8_t {
+        FC_READ_HOLDING   = 0x03,
+        FC_READ_INPUT     = 0x04,
+        FC_WRITE_SINGLE   = 0x06,
+        FC_WRITE_MULTIPLE = 0x10,
+        FC_EXCEPTION      = 0x80
+    };
+
+    enum Exception : uint8_t {
+        EXCEPTION_NONE             = 0,
+        EXCEPTION_ILLEGAL_FUNCTION = 1,
+        EXCEPTION_ILLEGAL_ADDRESS  = 2,
+        EXCEPTION_ILLEGAL_VALUE    = 3,
+        EXCEPTION_DEVICE_FAILURE   = 4
+    };
+
+    constexpr uint8_t kBroadcastAddress = 0;
+
+    /// CRC-16/MODBUS, transmitted low byte first
+    uint16_t crc16(const uint8_t* data, size_t size);
+
+    class RegisterMap;
+
+    class RtuSlave {
+    public:
+        static constexpr uint8_t kFrameSize = 64;
+        // Registers per request: a read reply carries address, function, byte
+        // count and CRC; a write request adds start, count and byte count
+        static constexpr uint8_t kMaxReadRegisters = (kFrameSize - 5) / 2;
+        static constexpr uint8_t kMaxWriteRegisters = (kFrameSize - 9) / 2;
+
+        struct Stats {
+            uint16_t requests = 0;      // Frames for this unit with a good CRC
+            uint16_t exceptions = 0;
+            uint16_t crc_errors = 0;
+            uint16_t overruns = 0;      // Frames longer than kFrameSize, answered if their CRC is good
+        };
+
+        explicit RtuSlave(RegisterMap& map) : map_(map) {}
+
+        void begin(uint32_t baud);
+
+        /// Advance reception or transmission; cheap when the bus is idle
+        void service(uint32_t now_us);
+
+        /**
+         * Handle a complete request frame in place.
+         * @return length of the reply written to frame, 0 if there is none
+         */
+        size_t handleRequest(uint8_t* frame, size_t size);
+
+        const Stats& stats() const { return stats_; }
+
+    private:
+        enum State : uint8_t {
+            STATE_IDLE,
+            STATE_RECEIVING,
+            STATE_TRANSMITTING,
+            STATE_DRAINING
+        };
+
+        bool requestComplete() const;
+        void finishFrame(uint32_t now_us);
+        size_t rejectOversized(uint8_t* frame);
+        size_t reply(uint8_t* frame, size_t length, Exception exception);
+        void transmit(uint32_t now_us);
+        void reset();
+
+        RegisterMap& map_;
+        Stats stats_;
+        uint8_t frame_[kFrameSize];
+        uint8_t size_ = 0;
+        uint8_t tx_offset_ = 0;
+        bool overrun_ = false;
+        uint16_t overrun_crc_ = 0;      // Running CRC of an overrun frame, 0 once its own CRC is in
+        State state_ = STATE_IDLE;
+        uint32_t last_event_us_ = 0;    // Last received byte, or TX buffer empty while draining
+        uint16_t char_us_ = 0;          // One 11-bit character
+        uint16_t silence_us_ = 0;       // t3.5
+        int tx_idle_room_ = 0;          // availableForWrite() of an empty TX buffer
+    };
+} // namespace Modbus
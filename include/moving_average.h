@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * Moving average over the last Size samples, the filter behind
+ * TemperatureSensor::readTemperature(). Header-only and free of Arduino
+ * dependencies so the host replay tools filter exactly like the firmware.
+ */
+template <size_t Size>
+class MovingAverage {
+public:
+    static_assert(Size > 0, "MovingAverage needs at least one sample");
+
+    void add(float sample) {
+        // subtract oldest value from sum
+        if (count_ == Size) {
+            sum_ -= buffer_[index_];
+        } else {
+            count_++;
+        }
+
+        // store new sample
+        buffer_[index_] = sample;
+        sum_ += sample;
+
+        // advance index (wrapping around)
+        index_ = (index_ + 1) % Size;
+    }
+
+    /// Mean of the stored samples, only valid once count() > 0
+    float mean() const { return sum_ / static_cast<float>(count_); }
+
+    size_t count() const { return count_; }
+
+private:
+    float buffer_[Size] = { 0 };
+    size_t index_ = 0;
+    size_t count_ = 0;
+    float sum_ = 0.0f;
+};
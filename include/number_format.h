@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Allocation-free integer and fixed-point formatter.
+ *
+ * Replaces dtostrf()/snprintf()/Print::print(float) on the LCD and log
+ * paths: no floating point, no stdio, output goes to a caller-provided
+ * buffer and is always NUL-terminated.
+ */
+namespace NumberFormat
+{
+    struct Spec {
+        uint8_t width      = 0;     // Minimum field width, right aligned
+        uint8_t decimals   = 0;     // Value is scaled by 10^decimals
+        bool    force_sign = false; // Print '+' for positive values
+        char    pad        = ' ';   // Fill character for width (' ' or '0')
+    };
+
+    /**
+     * Format a fixed-point value, e.g. value 125 with 1 decimal -> "12.5".
+     * @return number of characters written (without NUL), 0 if the buffer is too small
+     */
+    size_t formatFixed(char* buffer, size_t buffer_size, int32_t value, const Spec& spec);
+
+    /// Round a float to spec.decimals and format it as fixed-point; NAN prints "nan"
+    size_t formatFloat(char* buffer, size_t buffer_size, float value, const Spec& spec);
+
+    /// Format an integer, spec.decimals is ignored
+    size_t formatInteger(char* buffer, size_t buffer_size, int32_t value, const Spec& spec = Spec{});
+
+    /**
+     * Parse "[+-]digits[.digits]" into a fixed-point value with the given
+     * decimals, e.g. "4.5" with 1 decimal -> 45. More fraction digits than
+     * decimals, other characters or more than 9 digits are rejected.
+     * @return true and value set on success
+     */
+    bool parseFixed(const char* text, uint8_t decimals, int32_t& value);
+} // namespace NumberFormat
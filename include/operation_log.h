@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Persisted operational counters and fan switching event log.
+ *
+ * Lives in the EEPROM above the settings block (kRegionStart..EEPROM_SIZE):
+ *   - kCounterSlots rotating copies of the counter record, each with a
+ *     sequence number and CRC; the newest valid one wins at boot, so every
+ *     flush goes to the next slot and wear is spread over all of them,
+ *   - a ring of kEventSlots fan on/off events.
+ *
+ * Counters are kept in RAM and flushed at most once per kCounterFlushMs (and
+ * at boot). Events are queued and written in batches, at most one batch per
+ * kEventFlushMs; events beyond the queue are counted as dropped instead of
+ * written. At one flush per hour each counter slot sees 3 writes a day,
+ * negligible against the 100k cycle EEPROM endurance.
+ */
+class OperationLog {
+public:
+    struct Counters {
+        uint16_t boots = 0;
+        uint32_t relay_cycles = 0;      // Fan off -> on transitions
+        uint32_t fan_on_seconds = 0;
+        uint32_t counter_writes = 0;    // Counter record flushes
+        uint32_t event_writes = 0;      // Event entries written
+        uint16_t dropped_events = 0;    // Rate limited, not persisted
+    };
+
+    struct Event {
+        uint16_t sequence = 0xFFFF;     // 0xFFFF marks an empty slot
+        uint16_t boot = 0;              // Counters::boots at the time of the event
+        uint16_t uptime_minutes = 0;    // Saturates after 45 days
+        int8_t external_half_degrees = -128;    // -128: no reading
+        uint8_t flags = 0;
+
+        static constexpr uint8_t FLAG_FAN_ON = 1 << 0;
+        bool fanOn() const { return flags & FLAG_FAN_ON; }
+    };
+
+    static constexpr uint16_t kRegionStart = 64;
+    static constexpr uint8_t kCounterSlots = 8;
+    static constexpr uint8_t kEventSlots = 32;
+    static constexpr uint8_t kPendingEvents = 4;
+    static constexpr uint32_t kCounterFlushMs = 60UL * 60UL * 1000UL;
+    static constexpr uint32_t kEventFlushMs = 10UL * 60UL * 1000UL;
+
+    // Ratings used for the wear estimate
+    static constexpr uint32_t kRelayRatedCycles = 100000UL;     // Electrical life at rated load
+    static constexpr uint32_t kEepromEndurance = 100000UL;      // Write cycles per cell
+
+    /// Load the newest counters and the event ring, count the boot
+    void begin(uint32_t now_ms);
+
+    /// Track fan transitions and runtime; call every loop, flushes when due
+    void update(uint32_t now_ms, bool fan_on, int16_t external_tenths);
+
+    /// Write pending counters and events now, e.g. before a reboot
+    void flush(uint32_t now_ms);
+
+    const Counters& counters() const { return counters_; }
+
+    /// Persisted and queued events, newest first
+    uint8_t eventCount() const { return stored_events_ + pending_count_; }
+    bool event(uint8_t age, Event& event) const;
+
+    /// Estimated share of rated life used, in permille
+    uint16_t relayWearPermille() const;
+    uint16_t eepromWearPermille() const;
+
+private:
+    struct CounterRecord;
+
+    void flushCounters(uint32_t now_ms);
+    void flushEvents(uint32_t now_ms);
+    void loadCounters();
+    void loadEvents();
+
+    Counters counters_;
+    uint16_t counter_sequence_ = 0;
+    uint8_t next_counter_slot_ = 0;
+    bool counters_dirty_ = false;
+    uint32_t last_counter_flush_ms_ = 0;
+
+    uint16_t event_sequence_ = 0;       // Sequence of the next event
+    uint8_t next_event_slot_ = 0;
+    uint8_t stored_events_ = 0;
+    Event pending_[kPendingEvents];
+    uint8_t pending_count_ = 0;
+    uint32_t last_event_flush_ms_ = 0;
+
+    bool started_ = false;
+    bool fan_on_ = false;
+    uint32_t last_update_ms_ = 0;
+    uint16_t fan_on_ms_ = 0;            // Runtime not yet added to fan_on_seconds
+};
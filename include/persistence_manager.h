@@ -10,12 +10,39 @@ constexpr float DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE = 4.0f; // Default minimal
 constexpr float DEFAULT_MAXIMAL_EXTERNAL_TEMPERATURE = 20.0f; // Default maximal external temperature
 constexpr float DEFAULT_TEMPERATURE_DIFFERENCE_HYSTERESIS = 1.0f; // Default temperature difference hysteresis
 constexpr size_t DEFAULT_SWITCH_TIME_HYSTERESIS = 5 * 60; // Default switch time hysteresis in seconds
+constexpr uint8_t DEFAULT_MODBUS_ADDRESS = 1; // Default Modbus RTU slave address
+
+// Record layouts, kept in has_data: 0 means no data. Layout 1 is the record
+// before modbus_address, whose has_data was a plain true
+constexpr uint8_t PERSISTENCE_LAYOUT_V1 = 1;
+constexpr uint8_t PERSISTENCE_LAYOUT_VERSION = 2;
+
 struct PersistenceData {
-    uint8_t has_data = 0; // Flag to indicate if data is present
+    uint8_t has_data = 0; // Layout version of the record, 0 when no data is present
     float minimal_external_temperature = DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE;
     float maximal_external_temperature = DEFAULT_MAXIMAL_EXTERNAL_TEMPERATURE;
     float temperature_difference_hysteresis = DEFAULT_TEMPERATURE_DIFFERENCE_HYSTERESIS;
     size_t switch_time_hysteresis = DEFAULT_SWITCH_TIME_HYSTERESIS;
+    uint8_t modbus_address = DEFAULT_MODBUS_ADDRESS;
+};
+
+// Layout 1 as stored by earlier firmware, its CRC follows at sizeof(PersistenceDataV1)
+struct PersistenceDataV1 {
+    uint8_t has_data;
+    float minimal_external_temperature;
+    float maximal_external_temperature;
+    float temperature_difference_hysteresis;
+    size_t switch_time_hysteresis;
+};
+
+// Identifies a single PersistenceData field, used by table driven accessors
+enum class PersistenceField : uint8_t {
+    MinimalExternalTemperature,
+    MaximalExternalTemperature,
+    TemperatureDifferenceHysteresis,
+    SwitchTimeHysteresis,
+    ModbusAddress,
+    None
 };
 
 class PersistenceManager {
@@ -28,17 +55,24 @@ public:
     float getTemperatureDifferenceHysteresis() const;
     size_t getSwitchTimeHysteresis() const;
     float getMaximalExternalTemperature() const;
+    uint8_t getModbusAddress() const;
 
     // Set data and save to EEPROM
     void setMinimalExternalTemperature(float value);
     void setMaximalExternalTemperature(float value);
     void setTemperatureDifferenceHysteresis(float value);
     void setSwitchTimeHysteresis(size_t value);
+    void setModbusAddress(uint8_t value);
 
     void resetToDefaults();
 
+    // Setters between these only change the RAM copy, commit saves once
+    void beginTransaction();
+    void commitTransaction();
+
 private:
     bool checkIsDataPresent();
+    bool migrateFromV1();
     void loadDefaults();
     void saveData();
     void loadData();
@@ -47,5 +81,7 @@ private:
     void updateCRC();
 
     PersistenceData data_; // Data structure to hold persistence data
+    bool in_transaction_ = false; // Defer saveData() until commitTransaction()
+    bool save_pending_ = false; // A setter ran during the transaction
 
 };
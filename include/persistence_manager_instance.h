@@ -27,6 +27,10 @@ inline size_t getSwitchTimeHysteresis() {
     return getPersistenceManagerInstance()->getSwitchTimeHysteresis();
 }
 
+inline uint8_t getModbusAddress() {
+    return getPersistenceManagerInstance()->getModbusAddress();
+}
+
 inline void setMinimalExternalTemperature(float value) {
     getPersistenceManagerInstance()->setMinimalExternalTemperature(value);
 }
@@ -43,6 +47,10 @@ inline void setSwitchTimeHysteresis(size_t value) {
     getPersistenceManagerInstance()->setSwitchTimeHysteresis(value);
 }
 
+inline void setModbusAddress(uint8_t value) {
+    getPersistenceManagerInstance()->setModbusAddress(value);
+}
+
 inline void resetSettings() {
     getPersistenceManagerInstance()->resetToDefaults();
 }
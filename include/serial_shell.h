@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+class UserInterface;
+class PolishLCD;
+class TemperatureHistory;
+class TemperatureTrends;
+class OperationLog;
+class BootProfile;
+namespace Modbus {
+    class RtuSlave;
+}
+namespace Telemetry {
+    class SnapshotBuffer;
+    class Link;
+}
+
+/**
+ * Line based diagnostics shell on the log serial port.
+ *
+ * feed() only queues received bytes (O(1), binary telemetry frames are
+ * skipped); service() runs from the main loop and does a bounded amount of
+ * work per call: it assembles at most one line from the RX ring, or runs one
+ * step of the current command. Multi-line commands print one line per step,
+ * so the serial TX buffer never fills and the control loop is never held up.
+ * Commands live in a flash table, the tokenizer splits the line in place.
+ */
+class SerialShell {
+public:
+    /// Runtime objects the commands report on
+    struct Context {
+        UserInterface* ui = nullptr;
+        PolishLCD* lcd = nullptr;
+        Telemetry::SnapshotBuffer* snapshot = nullptr;
+        Telemetry::Link* telemetry = nullptr;
+        TemperatureHistory* history = nullptr;
+        TemperatureTrends* trends = nullptr;
+        OperationLog* operation_log = nullptr;
+        const Modbus::RtuSlave* modbus = nullptr;
+        const BootProfile* boot = nullptr;
+    };
+
+    /// Command step: runs once per service() call while it returns true
+    using Handler = bool (*)(SerialShell& shell, uint8_t step);
+
+    struct Command {
+        const char* name;   // PROGMEM
+        const char* usage;  // PROGMEM
+        Handler     handler;
+    };
+
+    static constexpr uint8_t kRxSize = 64;      // Power of two
+    static constexpr uint8_t kLineSize = 40;
+    static constexpr uint8_t kMaxArgs = 4;
+    static constexpr uint8_t kStateSize = 2 * sizeof(void*) + 16;   // Per-command state kept between steps
+
+    /// context is kept by reference, it may be filled in after construction
+    SerialShell(Print& out, const Context& context) : out_(out), context_(context) {}
+
+    /// Queue one received byte, safe to call for every byte of the serial stream
+    void feed(uint8_t byte);
+
+    /// Advance line assembly or the running command by one bounded step
+    void service();
+
+    /// False while the RX ring is full, leave further bytes in the serial driver
+    bool canFeed() const { return ((rx_head_ + 1) & (kRxSize - 1)) != rx_tail_; }
+
+    bool isRunning() const { return handler_ != nullptr; }
+
+    // Accessors for command handlers
+    Print& out() { return out_; }
+    const Context& context() const { return context_; }
+    uint8_t argc() const { return argc_; }
+    const char* arg(uint8_t index) const { return index < argc_ ? argv_[index] : ""; }
+
+    /// Command state that survives between steps, trivially copyable types
+    /// only; zeroed when a command starts
+    template <typename T>
+    T& state() {
+        static_assert(sizeof(T) <= kStateSize, "Command state does not fit");
+        return *reinterpret_cast<T*>(state_);
+    }
+
+    /// Print a fixed-point value with the given number of decimals
+    void printFixed(int32_t value, uint8_t decimals);
+
+private:
+    void collectLine();
+    void execute();
+    uint8_t tokenize();
+
+    Print& out_;
+    const Context& context_;
+
+    // RX ring, written by feed(), read by service()
+    uint8_t rx_[kRxSize];
+    uint8_t rx_head_ = 0;
+    uint8_t rx_tail_ = 0;
+    bool rx_overflow_ = false;
+    bool in_frame_ = false;         // Between the 0x00 delimiters of a telemetry frame
+    bool frame_has_data_ = false;
+
+    char line_[kLineSize];
+    uint8_t line_size_ = 0;
+    bool line_invalid_ = false;     // Too long or not printable, dropped at the newline
+
+    char* argv_[kMaxArgs] = {};
+    uint8_t argc_ = 0;
+    Handler handler_ = nullptr;
+    uint8_t step_ = 0;
+    alignas(4) uint8_t state_[kStateSize];
+};
@@ -1,5 +0,0 @@
-#pragma once
-
-#include "setting.h"
-
-ISetting** createSettings(size_t& count);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include "settings_registry.h"
+
+/**
+ * Generic editor for the flash-resident settings registry.
+ *
+ * Only the setting being edited lives in SRAM: its index and the
+ * fixed-point value buffer. Descriptors are fetched from flash on demand.
+ */
+class SettingsEditor {
+public:
+    /// Select a setting and load its persisted value into the edit buffer
+    void select(size_t index);
+
+    void increase();
+    void decrease();
+
+    /// Persist the edit buffer (or run the action); returns false if nothing was saved
+    bool save();
+
+    /// Drop the edit buffer and reload the persisted value
+    void discard();
+
+    size_t index() const { return index_; }
+    int16_t value() const { return value_; }
+
+    /// Name of the selected setting (flash string, for logs)
+    const __FlashStringHelper* name() const;
+
+    /// UTF-8 screen text of the selected setting (flash string)
+    const __FlashStringHelper* screenText() const;
+
+    /// Format the edit buffer for the LCD
+    void getValueAsString(char* buffer, size_t buffer_size) const;
+
+private:
+    uint8_t index_ = 0;
+    int16_t value_ = 0;
+};
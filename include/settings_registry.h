@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include "persistence_manager.h"
+
+/**
+ * Flash-resident settings registry.
+ *
+ * Every user setting is one constexpr Descriptor in PROGMEM, names and
+ * screen texts included, so adding a setting costs flash only. Values are
+ * fixed-point integers scaled by 10^decimals (e.g. 4.5 C -> 45).
+ */
+namespace Settings
+{
+    enum class Type : uint8_t {
+        Number,         // Editable value stored in a PersistenceField
+        ResetAction     // Restores defaults when saved
+    };
+
+    struct Descriptor {
+        const char*      key;           // PROGMEM, short identifier for the serial shell
+        const char*      name;          // PROGMEM, used in logs
+        const char*      screen_text;   // PROGMEM, UTF-8 text shown on the LCD
+        Type             type;
+        PersistenceField field;
+        uint8_t          decimals;      // Fixed-point scale of value/step/min/max
+        int16_t          step;
+        int16_t          min;
+        int16_t          max;
+    };
+
+    /// Number of settings in the registry
+    size_t count();
+
+    /// Copy the descriptor at index from flash
+    void load(size_t index, Descriptor& descriptor);
+
+    /// Copy the Number descriptor stored in field, false if no setting uses it
+    bool find(PersistenceField field, Descriptor& descriptor);
+
+    /// Index of the setting with the given key, -1 if there is none
+    int8_t indexOf(const char* key);
+
+    /// Key of the setting at index (flash string)
+    const __FlashStringHelper* key(size_t index);
+
+    /// Name of the setting at index (flash string, for logs)
+    const __FlashStringHelper* name(size_t index);
+
+    /// UTF-8 screen text of the setting at index (flash string)
+    const __FlashStringHelper* screenText(size_t index);
+
+    /// Read the persisted value of a Number setting in descriptor units
+    int16_t readPersisted(const Descriptor& descriptor);
+
+    /// Persist a Number setting value given in descriptor units
+    void writePersisted(const Descriptor& descriptor, int16_t value);
+
+    /// Limit value to the descriptor range
+    int16_t clamp(const Descriptor& descriptor, int32_t value);
+} // namespace Settings
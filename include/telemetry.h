@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Arduino.h>
+#include "cobs.h"
+#include "config_image.h"
+
+/**
+ * Binary telemetry and control protocol on the log serial port.
+ *
+ * Frame on the wire: 0x00, COBS(type, sequence, body..., CRC-16 LE), 0x00.
+ * The CRC is CRC-16/CCITT-FALSE over type, sequence and body. The leading
+ * delimiter cuts off any log text printed before the frame, which the
+ * receiver then drops as a frame with a bad CRC. All integers are little
+ * endian. Requests from the host get a response with type | 0x80.
+ *
+ *   SAMPLE       0x01  dev->host  uptime_ms u32, external i16, internal i16
+ *                                 (0.01 C, -32768 = no reading), fan u8,
+ *                                 loop_ms u16
+ *   READ_FIELD   0x02  host->dev  field u8 -> FIELD_VALUE
+ *   WRITE_FIELD  0x03  host->dev  field u8, value i16 -> FIELD_VALUE
+ *   SET_STREAM   0x04  host->dev  period_ms u16 (0 = off) -> ACK
+ *   READ_CONFIG  0x05  host->dev  (empty) -> CONFIG
+ *   WRITE_CONFIG 0x06  host->dev  image -> CONFIG
+ *   FIELD_VALUE  0x82/0x83        field u8, value i16, decimals u8
+ *   ACK          0x84             period_ms u16
+ *   CONFIG       0x85/0x86        image of the persisted settings
+ *   NACK         0xFF             request type u8, error u8
+ *
+ * Fields are PersistenceField values; values are in the fixed-point units
+ * of the matching settings registry descriptor and are clamped to its range.
+ * Images are ConfigImage blobs; WRITE_CONFIG applies all values or none and
+ * answers with the image read back after the commit.
+ */
+namespace Telemetry
+{
+    enum MessageType : uint8_t {
+        MSG_SAMPLE      = 0x01,
+        MSG_READ_FIELD  = 0x02,
+        MSG_WRITE_FIELD = 0x03,
+        MSG_SET_STREAM  = 0x04,
+        MSG_READ_CONFIG = 0x05,
+        MSG_WRITE_CONFIG = 0x06,
+        MSG_RESPONSE    = 0x80,
+        MSG_NACK        = 0xFF
+    };
+
+    enum Error : uint8_t {
+        ERROR_UNKNOWN_TYPE  = 1,
+        ERROR_BAD_LENGTH    = 2,
+        ERROR_UNKNOWN_FIELD = 3,
+        // Rejected WRITE_CONFIG, ConfigImage::Result + 3
+        ERROR_IMAGE_SIZE    = 4,
+        ERROR_IMAGE_CRC     = 5,
+        ERROR_IMAGE_HEADER  = 6,
+        ERROR_IMAGE_FIELD   = 7,
+        ERROR_IMAGE_VALUE   = 8
+    };
+
+    constexpr int16_t kNoReading = -32767 - 1;
+    constexpr size_t kMaxBody = ConfigImage::kMaxSize;
+    constexpr size_t kMaxPayload = 2 + kMaxBody + 2;     // type, sequence, body, CRC
+    constexpr size_t kMaxFrame = Cobs::maxEncodedSize(kMaxPayload) + 2;   // with both delimiters
+
+    /// One control loop iteration, the SAMPLE message body
+    struct Sample {
+        uint32_t uptime_ms = 0;
+        int16_t external_centi = kNoReading;   // 0.01 C
+        int16_t internal_centi = kNoReading;
+        bool fan_on = false;
+        uint16_t loop_ms = 0;
+
+        static int16_t toCenti(float celsius);
+    };
+
+    /**
+     * Double-buffered Sample: the writer fills the back slot and flips, a
+     * reader copies the front slot and retries if a flip happened meanwhile.
+     * Readers never see a half-written sample, also from interrupt context.
+     */
+    class SnapshotBuffer {
+    public:
+        void publish(const Sample& sample);
+        Sample read() const;
+        uint16_t sequence() const { return sequence_; }
+
+    private:
+        Sample slots_[2];
+        volatile uint8_t front_ = 0;
+        volatile uint16_t sequence_ = 0;   // Published samples
+    };
+
+    /// CRC-16/CCITT-FALSE
+    uint16_t crc16(const uint8_t* data, size_t size);
+
+    /**
+     * Protocol endpoint: feed() it received bytes, it answers requests and
+     * streams SAMPLE frames from the snapshot at the requested period.
+     */
+    class Link {
+    public:
+        Link(Print& out, SnapshotBuffer& snapshot) : out_(out), snapshot_(snapshot) {}
+
+        /// Handle one received byte, a complete frame is processed right away
+        void feed(uint8_t byte);
+
+        /// Send a SAMPLE frame if streaming is on and the period has elapsed
+        void service(uint32_t now_ms);
+
+        uint16_t streamPeriod() const { return stream_period_ms_; }
+        uint16_t droppedFrames() const { return dropped_frames_; }
+
+    private:
+        void handleFrame(const uint8_t* payload, size_t size);
+        void handleRequest(uint8_t type, const uint8_t* body, size_t size);
+        void sendFieldValue(uint8_t type, uint8_t field);
+        void sendConfig(uint8_t type);
+        void sendNack(uint8_t type, Error error);
+        void send(uint8_t type, const uint8_t* body, size_t size);
+
+        Print& out_;
+        SnapshotBuffer& snapshot_;
+        uint8_t rx_[Cobs::maxEncodedSize(kMaxPayload)];
+        uint8_t rx_size_ = 0;
+        bool rx_overflow_ = false;
+        uint8_t tx_sequence_ = 0;
+        uint16_t stream_period_ms_ = 0;
+        uint32_t last_stream_ms_ = 0;
+        uint16_t dropped_frames_ = 0;      // Received frames with bad COBS, CRC or length
+    };
+} // namespace Telemetry
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * RAM-resident, delta-compressed history of the periodic control samples.
+ *
+ * The buffer is split into blocks. Each block starts with a key frame (both
+ * temperatures as 12-bit tenths of a degree and the fan state), followed by
+ * a bit stream of one code per sample:
+ *
+ *   0                        nothing changed (1 bit)
+ *   1 <ext> <int> <fan>      <fan> = 1 when the fan toggled
+ *
+ * where each temperature code is
+ *
+ *   0                        unchanged
+ *   10 s mm                  +-3..6 tenths
+ *   110 s mmmmm              +-7..38 tenths
+ *   111 vvvvvvvvvvvv         escape: absolute 12-bit value (sensor loss, jumps)
+ *
+ * Changes of up to 0.2 C are absorbed by a dead band so sensor noise costs
+ * nothing; the stored value stays within 0.2 C of the input, well inside the
+ * DS18B20's +-0.5 C. Unchanged minutes cost one bit. Capacity at one sample
+ * per minute, 12 C day/night swing outside, Gaussian noise on both inputs:
+ *
+ *   noise sigma    0-0.05 C   0.08 C   0.10 C   0.15 C
+ *   hours kept     ~27        ~22      ~18      ~10
+ *
+ * The sensors' moving average keeps a DS18B20 below 0.05 C, so a full day
+ * fits. When the buffer is full the oldest block is dropped; append() is
+ * O(1) and Reader decodes in a single pass.
+ */
+class TemperatureHistory {
+public:
+    static constexpr int16_t kNoReading = -32767 - 1;  // Same marker as DisplayViewModel
+    static constexpr uint8_t kBlockSize = 32;
+    static constexpr uint8_t kBlockCount = 12;
+
+    struct Sample {
+        int16_t external_tenths = kNoReading;
+        int16_t internal_tenths = kNoReading;
+        bool fan_on = false;
+    };
+
+    /// Streaming decoder, oldest sample first
+    class Reader {
+    public:
+        explicit Reader(const TemperatureHistory& history);
+
+        /// Skip count samples without decoding the blocks they fill completely
+        void skip(uint16_t count);
+
+        /// Decode the next sample, false at the end of the history or once stale()
+        bool next(Sample& sample);
+
+        /// A block was dropped (or the history cleared) since construction,
+        /// the ring position may hold newer data
+        bool stale() const;
+
+    private:
+        uint16_t readBits(uint8_t count);
+        int16_t readChannel(int16_t previous);
+        void enterBlock();
+
+        const TemperatureHistory* history_;
+        uint8_t block_ = 0;             // Index into the ring
+        uint8_t blocks_left_ = 0;
+        uint8_t samples_left_ = 0;      // In the current block
+        uint16_t bit_ = 0;              // Read position in the current block
+        bool at_key_frame_ = false;
+        uint8_t generation_;
+        Sample current_;
+    };
+
+    void append(const Sample& sample);
+    void clear();
+
+    /// Samples stored
+    uint16_t size() const { return size_; }
+
+    /// Samples appended since clear(), dropped ones included
+    uint32_t appended() const { return appended_; }
+
+    /// Bytes of the ring in use
+    uint16_t usedBytes() const;
+
+private:
+    friend class Reader;
+
+    static constexpr uint8_t kKeyFrameBits = 32;
+    static constexpr uint16_t kBlockBits = kBlockSize * 8U;
+
+    void startBlock(const Sample& sample);
+    void writeBits(uint16_t value, uint8_t count);
+    static uint8_t channelBits(int16_t delta, bool absolute);
+    void writeChannel(int16_t previous, int16_t value);
+    int16_t applyDeadBand(int16_t previous, int16_t value) const;
+
+    uint8_t data_[kBlockCount][kBlockSize];
+    uint8_t samples_[kBlockCount] = {};     // Samples in each block
+    uint16_t bits_[kBlockCount] = {};       // Used bits in each block, key frame included
+    uint8_t oldest_ = 0;
+    uint8_t newest_ = 0;
+    uint8_t blocks_ = 0;
+    uint16_t size_ = 0;
+    uint32_t appended_ = 0;
+    uint8_t generation_ = 0;                // Bumped when a block is dropped or on clear()
+    Sample last_;                           // Value the decoder will reconstruct for the newest sample
+};
@@ -3,30 +3,30 @@
 #include <Arduino.h>
 #include <OneWire.h>
 #include <DallasTemperature.h>
+#include "moving_average.h"
 
 namespace  Sensor
 {
     class TemperatureSensor
     {
     public:
+        static constexpr size_t kFilterSize = 10;  // moving‐average window
+
         TemperatureSensor(uint8_t pin);
-        void begin();
+        void begin();               // Sets the resolution and starts the first conversion
         bool isConnected() noexcept;
+        /**
+         * Filtered temperature without waiting for the bus. A finished conversion
+         * is read into the filter and the next one started, otherwise the mean
+         * so far is returned. Only the first reading waits for its conversion.
+         */
         float readTemperature() noexcept;
 
     private:
-        static constexpr size_t kFilterSize = 10;  // moving‐average window
-
         uint8_t _pin;
         OneWire _one_wire;
         DallasTemperature _sensor;
-
-        // moving‐average filter state
-        float _buffer[kFilterSize] = { 0 };
-        size_t _bufIndex     = 0;
-        size_t _bufCount     = 0;
-        float  _sum          = 0.0f;
-
-        void loadIntoFilter(float sample);
+        unsigned long _requested_at = 0;    // millis() when the running conversion started
+        MovingAverage<kFilterSize> _filter;
     };
 } // namespace  Sensor
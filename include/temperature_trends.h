@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Cascaded min/max/mean rollups of the control loop samples.
+ *
+ * Every loop sample goes into a one-minute accumulator. A closed minute is
+ * stored as a Bucket and merged into the 15-minute accumulator, fifteen of
+ * those close a quarter, twenty-four quarters close a six-hour bucket. Each
+ * level keeps a small ring of closed buckets, so trend queries read a few
+ * dozen bytes instead of scanning history. Accumulators keep exact sums,
+ * buckets are rounded to half degrees to fit a week into RAM.
+ */
+class TemperatureTrends {
+public:
+    enum Level : uint8_t {
+        LEVEL_MINUTE,
+        LEVEL_QUARTER,
+        LEVEL_SIX_HOURS,
+        LEVEL_COUNT
+    };
+
+    static constexpr int8_t kNoReading = -128;  // Half degrees, no valid sample in the bucket
+    static constexpr int16_t kNoReadingTenths = -32767 - 1;
+
+    /// Closed buckets kept per level
+#if defined(__AVR__)
+    static constexpr uint8_t kMinuteDepth = 4;
+    static constexpr uint8_t kQuarterDepth = 8;     // 2 h
+#else
+    static constexpr uint8_t kMinuteDepth = 15;
+    static constexpr uint8_t kQuarterDepth = 24;    // 6 h
+#endif
+    static constexpr uint8_t kSixHourDepth = 28;    // 7 days
+
+    /// Temperatures in half degrees C
+    struct Range {
+        int8_t min = kNoReading;
+        int8_t max = kNoReading;
+        int8_t mean = kNoReading;
+    };
+
+    struct Bucket {
+        Range external;
+        Range internal;
+        uint8_t fan_percent = 0;    // Share of samples with the fan on
+    };
+
+    /// Feed one loop sample, temperatures in tenths (kNoReadingTenths if missing)
+    void addSample(uint32_t now_ms, int16_t external_tenths, int16_t internal_tenths, bool fan_on);
+
+    /// Closed buckets available at level
+    uint8_t count(Level level) const { return counts_[level]; }
+
+    /// Closed bucket by age, 0 is the newest; false if there is none
+    bool bucket(Level level, uint8_t age, Bucket& bucket) const;
+
+    /// Length of one bucket at level
+    static uint16_t bucketMinutes(Level level);
+
+    /// Lowest external minimum over the newest buckets at level, false without readings
+    bool coldest(Level level, uint8_t buckets, int8_t& half_degrees, uint8_t& age) const;
+
+    /// Highest external maximum over the newest buckets at level, false without readings
+    bool warmest(Level level, uint8_t buckets, int8_t& half_degrees, uint8_t& age) const;
+
+    /// Fan running time over the newest buckets at level
+    uint16_t fanMinutes(Level level, uint8_t buckets) const;
+
+    /// Tenths of a degree to the half degrees used by Bucket
+    static int8_t toHalfDegrees(int16_t tenths);
+
+private:
+    struct ChannelAccumulator {
+        int16_t min = 0;
+        int16_t max = 0;
+        int32_t sum = 0;
+        uint32_t valid = 0;
+
+        void add(int16_t tenths);
+        void merge(const ChannelAccumulator& other);
+        Range toRange() const;
+    };
+
+    struct Accumulator {
+        ChannelAccumulator external;
+        ChannelAccumulator internal;
+        uint32_t samples = 0;
+        uint32_t fan_samples = 0;
+        uint8_t children = 0;       // Closed buckets of the level below merged in
+
+        void merge(const Accumulator& other);
+        Bucket toBucket() const;
+    };
+
+    void close(uint8_t level);
+
+    static constexpr uint8_t kDepth[LEVEL_COUNT] = {kMinuteDepth, kQuarterDepth, kSixHourDepth};
+    static constexpr uint8_t kOffset[LEVEL_COUNT] = {0, kMinuteDepth, kMinuteDepth + kQuarterDepth};
+    static constexpr uint8_t kChildren[LEVEL_COUNT] = {0, 15, 24};  // Buckets of the level below per bucket
+
+    Bucket buckets_[kMinuteDepth + kQuarterDepth + kSixHourDepth];
+    uint8_t heads_[LEVEL_COUNT] = {};   // Next write slot per level
+    uint8_t counts_[LEVEL_COUNT] = {};
+    Accumulator open_[LEVEL_COUNT];
+    uint32_t minute_start_ms_ = 0;
+    bool started_ = false;
+};
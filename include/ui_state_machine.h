@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <tinyfsm.hpp>
+
+class UserInterface;
+
+// Typed keypad events dispatched to the UI state machine
+struct KeySelectEvent : tinyfsm::Event {};
+struct KeyUpEvent     : tinyfsm::Event {};
+struct KeyDownEvent   : tinyfsm::Event {};
+struct KeyNextEvent   : tinyfsm::Event {};
+struct KeyPrevEvent   : tinyfsm::Event {};
+
+/**
+ * Base state of the MAIN_SCREEN / SETTINGS_MENU / EDIT_SETTING flow.
+ *
+ * Concrete states live in ui_state_machine.cpp. Every reaction declares the
+ * screen regions it invalidates (UserInterface::Region), the renderer then
+ * repaints only those regions on the next updateDisplay().
+ */
+struct UiState : tinyfsm::Fsm<UiState> {
+    // Unhandled events are ignored
+    void react(tinyfsm::Event const &) {}
+
+    virtual void react(KeySelectEvent const &) {}
+    virtual void react(KeyUpEvent const &) {}
+    virtual void react(KeyDownEvent const &) {}
+    virtual void react(KeyNextEvent const &) {}
+    virtual void react(KeyPrevEvent const &) {}
+
+    virtual void entry() {}
+    void exit() {}
+
+    /// Bind the machine to its UserInterface and enter the initial state
+    static void start(UserInterface* ui);
+
+protected:
+    static UserInterface* ui_;
+
+    /// Change state and invalidate the regions the new screen differs in
+    template <typename S>
+    void transitTo(uint8_t regions);
+
+    template <typename S, typename Action>
+    void transitTo(uint8_t regions, Action action);
+};
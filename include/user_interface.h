@@ -1,15 +1,25 @@
 #pragma once
 
-#include <LiquidCrystal.h>
-#include "liquid_crystal_ext.h" // Extended LiquidCrystal library for Polish characters
+#include "liquid_crystal_ext.h" // HD44780 driver with Polish characters
 #include <math.h> // For NAN
 #include "persistence_manager.h"
-#include "setting.h"
+#include "settings_editor.h"
+#include "display_view_model.h"
+#include "ui_state_machine.h"
 
 class UserInterface {
 public:
     enum State { MAIN_SCREEN, SETTINGS_MENU, EDIT_SETTING };
 
+    // Independently repainted parts of the 16x2 screen
+    enum Region : uint8_t {
+        REGION_NONE   = 0,
+        REGION_TOP    = 1 << 0,   // Row 0, columns 0-13
+        REGION_STATUS = 1 << 1,   // Row 0, columns 14-15 (fan indicator)
+        REGION_BOTTOM = 1 << 2,   // Row 1
+        REGION_ALL    = REGION_TOP | REGION_STATUS | REGION_BOTTOM
+    };
+
     explicit UserInterface(PolishLCD* lcd);
     void updateDisplay();
     void handleSelect();
@@ -18,35 +28,44 @@ public:
     void handleNext();
     void handlePrev();
 
-    void setFanState(bool state) { is_fan_on_ = state; }
-    void setExternalTemperature(float temp) { external_temp_ = temp; }
-    void setInternalTemperature(float temp) { internal_temp_ = temp; }
+    void setFanState(bool state);
+    void setExternalTemperature(float temp);
+    void setInternalTemperature(float temp);
+
+    /// Mark regions for repaint on the next updateDisplay()
+    void invalidate(uint8_t regions) { dirty_regions_ |= regions; }
+
+    /// Rendered vs skipped updateDisplay() calls
+    const DisplayViewModel::FrameStats& frameStats() const { return view_model_.frameStats(); }
 
 private:
+    friend class MainScreenState;
+    friend class SettingsMenuState;
+    friend class EditSettingState;
+
+    static constexpr uint8_t kScreenColumns = 16;
+    static constexpr uint8_t kStatusColumn = 14;
+    static constexpr uint8_t kValueColumn = 9;   // First column after "Wartość: "
 
     // LCD and persistence manager pointers
     PolishLCD* lcd_;
-    // Temperature readings
-    float external_temp_ = NAN; // Use NAN to indicate no reading
-    float internal_temp_ = NAN; // Use NAN to indicate no reading
-
-    // Fan state
-    bool is_fan_on_ = false;
+    // Temperature readings and fan state at display resolution
+    DisplayViewModel view_model_;
 
     // Current state and settings
     State current_state_;
-    ISetting** settings_array_; // Array of settings
+    uint8_t dirty_regions_ = REGION_ALL; // Regions waiting for repaint
+    SettingsEditor editor_; // Edit buffer for the selected setting
     size_t current_setting_ = 0; // Index of the current setting being edited
     size_t total_num_settings_ = 0; // Total number of settings
 
     // Helper methods
-    void showMainScreen();
-    void showSettingsMenu();
-    void showEditSetting();
-    void enterSettingsMenu();
-    void exitSettingsMenu();
+    void showMainScreen(uint8_t regions);
+    void showSettingsMenu(uint8_t regions);
+    void showEditSetting(uint8_t regions);
+    void padTo(size_t printed, uint8_t width);
+    size_t printTemperature(int16_t tenths);
     void enterEditSetting();
-    void exitEditSetting();
     void navigateSettings(int direction);
     void adjustSetting(int delta);
     void saveSetting();
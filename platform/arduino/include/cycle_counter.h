@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+namespace HAL
+{
+    /**
+     * Exact CPU cycle counter for benchmarks: Timer1 runs at F_CPU and its
+     * overflow interrupt extends it to 32 bits. Timer1 (PWM on pins 9/10) is
+     * borrowed between begin() and end().
+     */
+    class CycleCounter {
+    public:
+        static constexpr const char* kUnit = "cycles";
+
+        static void begin();
+        static void end();
+
+        static uint32_t now() {
+            const uint8_t sreg = SREG;
+            cli();
+            const uint16_t low = TCNT1;
+            uint16_t high = overflows_;
+            // Overflow pending but not serviced yet
+            if ((TIFR1 & _BV(TOV1)) && low < 0x8000U) {
+                ++high;
+            }
+            SREG = sreg;
+            return (static_cast<uint32_t>(high) << 16) | low;
+        }
+
+        static volatile uint16_t overflows_;
+    };
+} // namespace HAL
@@ -1,27 +1,105 @@
 #pragma once
 
 #include <stdint.h>
+#include <Arduino.h>  // Include Arduino library for pin manipulation
+#include <avr/io.h>
+
+#include "gpio_hal_interface.h"
+#include "project_pin_definition.h"
 
 namespace HAL
 {
-    bool initGPIO();
+    /**
+     * Compile-time mapping of an Uno (ATmega328P) digital pin to its port.
+     * Pins 0-7 are PORTD, 8-13 PORTB and 14-19 (A0-A5) PORTC, so a write to
+     * a constexpr pin becomes a single sbi/cbi instead of digitalWrite().
+     */
+    template <uint8_t kPin>
+    struct AvrPin {
+        static_assert(kPin < 20, "Pin is not available on ATmega328P");
+        static constexpr uint8_t kMask = static_cast<uint8_t>(1U << (kPin < 8 ? kPin : (kPin < 14 ? kPin - 8 : kPin - 14)));
+
+        static void write(bool state) {
+            if (kPin < 8) {
+                state ? (PORTD |= kMask) : (PORTD &= static_cast<uint8_t>(~kMask));
+            } else if (kPin < 14) {
+                state ? (PORTB |= kMask) : (PORTB &= static_cast<uint8_t>(~kMask));
+            } else {
+                state ? (PORTC |= kMask) : (PORTC &= static_cast<uint8_t>(~kMask));
+            }
+        }
+    };
+
+    class AvrGpio : public GpioInterface<AvrGpio> {
+    public:
+        static constexpr uint16_t kAdcMax = 1023U;  // 10-bit ADC
 
-    void setRelay(bool state);
+        static bool init() {
+            // Initialize GPIO pins here
+            pinMode(KEYPAD_ANALOG_BUTTON_PIN, INPUT);
+            pinMode(RELAY_PIN, OUTPUT);
+            pinMode(LCD_BACKLIGHT_PIN, OUTPUT);
 
-    void setBacklight(bool state);
+            // Set digital button pins as inputs
+            pinMode(BEFORE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(SELECT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(NEXT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(INCREASE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(DECREASE_BUTTON_PIN, INPUT_PULLUP);
 
-    bool isButtonPressed(uint16_t buttonPin);
+            return true;  // Return true if initialization is successful
+        }
 
-    bool isButtonHolded(uint16_t buttonPin);
+        static void writeRelay(bool state) {
+            AvrPin<RELAY_PIN>::write(state);
+        }
 
-    bool isKeypadNextPressed();
+        static void writeBacklight(bool state) {
+            AvrPin<LCD_BACKLIGHT_PIN>::write(state);
+        }
 
-    bool isKeypadPrevPressed();
+        static bool readPinActive(uint16_t pin) {
+            // Assuming active low logic for buttons
+            return digitalRead(pin) == LOW;
+        }
 
-    bool isKeypadSelectPressed();
+        static uint16_t readKeypadAnalog() {
+            return static_cast<uint16_t>(analogRead(KEYPAD_ANALOG_BUTTON_PIN));
+        }
 
-    bool isKeypadUpPressed();
+        static void initLcdBus() {
+            pinMode(LCD_RS_PIN, OUTPUT);
+            pinMode(LCD_EN_PIN, OUTPUT);
+            pinMode(LCD_D4_PIN, OUTPUT);
+            pinMode(LCD_D5_PIN, OUTPUT);
+            pinMode(LCD_D6_PIN, OUTPUT);
+            pinMode(LCD_D7_PIN, OUTPUT);
+            if (LCD_RW_PIN != PIN_NOT_WIRED) {
+                pinMode(LCD_RW_PIN, OUTPUT);
+                digitalWrite(LCD_RW_PIN, LOW);
+            }
+            AvrPin<LCD_EN_PIN>::write(false);
+        }
 
-    bool isKeypadDownPressed();
+        static void writeLcdNibble(bool rs, uint8_t nibble) {
+            AvrPin<LCD_RS_PIN>::write(rs);
+            if (LCD_D4_PIN == 4 && LCD_D5_PIN == 5 && LCD_D6_PIN == 6 && LCD_D7_PIN == 7) {
+                // Keypad shield wiring: D4-D7 are PD4-PD7. Ones written to PIND toggle
+                // just those outputs, so PD0-PD3 (UART, the DS18B20 buses) are never
+                // written back, whatever the code this tick interrupted was doing
+                PIND = static_cast<uint8_t>((PORTD ^ static_cast<uint8_t>(nibble << 4)) & 0xF0U);
+            } else {
+                AvrPin<LCD_D4_PIN>::write(nibble & 0x01U);
+                AvrPin<LCD_D5_PIN>::write(nibble & 0x02U);
+                AvrPin<LCD_D6_PIN>::write(nibble & 0x04U);
+                AvrPin<LCD_D7_PIN>::write(nibble & 0x08U);
+            }
+            // Enable pulse width >= 450 ns (datasheet PW_EH), 8 cycles at 16 MHz
+            AvrPin<LCD_EN_PIN>::write(true);
+            __builtin_avr_delay_cycles(8);
+            AvrPin<LCD_EN_PIN>::write(false);
+        }
+    };
 
+    using Gpio = AvrGpio;
 } // namespace HAL
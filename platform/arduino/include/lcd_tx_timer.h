@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+namespace HAL
+{
+    /**
+     * Periodic tick clocking the LCD transmit queue: Timer2 in CTC mode,
+     * 2 us resolution. The compare interrupt is only enabled while the queue
+     * has work, so an idle display costs no CPU. Timer2 is taken from tone().
+     */
+    class LcdTxTimer {
+    public:
+        using Callback = void (*)();
+
+        static void begin(uint16_t period_us, Callback callback);
+
+        static void start() {
+            const uint8_t sreg = SREG;
+            cli();
+            // Already running: keep the phase, a restart would postpone the next tick
+            if (!(TIMSK2 & _BV(OCIE2A))) {
+                TCNT2 = 0;
+                TIFR2 = _BV(OCF2A);
+                TIMSK2 |= _BV(OCIE2A);
+            }
+            SREG = sreg;
+        }
+
+        /// Called from the tick callback once the queue is drained
+        static void stop() {
+            TIMSK2 &= static_cast<uint8_t>(~_BV(OCIE2A));
+        }
+
+        static Callback callback_;
+    };
+} // namespace HAL
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include "memory_usage.h"
+
+namespace HAL
+{
+    /**
+     * RAM use of the ATmega328P (2 KB). From the heap start to the top of RAM
+     * is painted with kPaint in .init3, before .data/.bss are set up and the
+     * constructors run, so the high-water mark covers the whole run. The
+     * heap is not painted again when it grows; the scan starts at its end.
+     */
+    class Memory {
+    public:
+        static constexpr uint8_t kPaint = 0xC5;
+
+        /// Nothing left to do, the paint is applied at reset
+        static void paintStack() {
+        }
+
+        /// Painted bytes above the heap the stack never reached, the least free RAM so far
+        static uint16_t unusedStackBytes();
+
+        static MemoryUsage usage();
+    };
+} // namespace HAL
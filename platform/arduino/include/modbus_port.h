@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "gpio_hal.h"
+#include "project_pin_definition.h"
+
+namespace HAL
+{
+    /**
+     * UART and RS-485 driver enable of the Modbus RTU slave.
+     *
+     * The ATmega328P has a single USART, so Modbus takes over Serial: a
+     * Modbus build must not log to it and does not run the shell or the
+     * telemetry link. RX and TX are buffered by the core's USART interrupts.
+     */
+    class ModbusPort {
+    public:
+        static constexpr bool kSharesLogPort = true;
+
+        static void begin(uint32_t baud) {
+            pinMode(MODBUS_DE_PIN, OUTPUT);
+            setTransmit(false);
+            Serial.begin(baud);
+        }
+
+        static int available() { return Serial.available(); }
+        static int read() { return Serial.read(); }
+        static int availableForWrite() { return Serial.availableForWrite(); }
+        static size_t write(const uint8_t* data, size_t size) { return Serial.write(data, size); }
+
+        static void setTransmit(bool enabled) {
+            AvrPin<MODBUS_DE_PIN>::write(enabled);
+        }
+    };
+} // namespace HAL
@@ -1,6 +1,8 @@
 #pragma once
 #include <Arduino.h>
 
+constexpr auto PIN_NOT_WIRED        = 0xFFU; // Marks an optional signal that is not connected
+
 // DS18B20
 constexpr auto EXTERNAL_DS18B20_PIN = 2U;   // Pin for external DS18B20 sensor
 constexpr auto INTERNAL_DS18B20_PIN = 3U;   // Pin for internal DS18B20 sensor
@@ -13,6 +15,7 @@ constexpr auto LCD_D5_PIN           = 5U;   // Data pin D5 for LCD
 constexpr auto LCD_D6_PIN           = 6U;   // Data pin D6 for LCD
 constexpr auto LCD_D7_PIN           = 7U;   // Data pin D7 for LCD
 constexpr auto LCD_BACKLIGHT_PIN    = 10U;  // Backlight pin for LCD
+constexpr auto LCD_RW_PIN           = PIN_NOT_WIRED;    // RW tied to GND on the keypad shield
 
 // Analog button
 constexpr auto KEYPAD_ANALOG_BUTTON_PIN    = A0;   // Analog pin for button input
@@ -26,3 +29,6 @@ constexpr auto NEXT_BUTTON_PIN      = A5;   // Next button pin
 
 // Relay control
 constexpr auto RELAY_PIN            = 12U;  // Pin for relay control
+
+// Modbus RTU (RS-485 transceiver driver enable, high while transmitting)
+constexpr auto MODBUS_DE_PIN        = 11U;  // RS-485 DE/RE pin
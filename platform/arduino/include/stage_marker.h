@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "loop_stages.h"
+
+namespace HAL
+{
+    /**
+     * Stage markers for the cycle-accurate simavr bench: with
+     * -D ENABLE_STAGE_MARKERS (env:uno_simavr) the current loop stage goes to
+     * GPIOR0 and the EEPROM commit in progress to GPIOR1, one OUT instruction
+     * each. Otherwise the calls compile to nothing.
+     */
+    class StageMarker {
+    public:
+        static void stage(LoopStage::Stage id) {
+#ifdef ENABLE_STAGE_MARKERS
+            GPIOR0 = id;
+#else
+            (void) id;
+#endif
+        }
+
+        /// Start of a commit, COMMIT_NONE ends it
+        static void commit(LoopStage::Commit id) {
+#ifdef ENABLE_STAGE_MARKERS
+            GPIOR1 = id;
+#else
+            (void) id;
+#endif
+        }
+    };
+} // namespace HAL
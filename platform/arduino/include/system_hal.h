@@ -0,0 +1,16 @@
+#pragma once
+
+#include <avr/wdt.h>
+
+namespace HAL
+{
+    class System {
+    public:
+        /// Restart the MCU through a watchdog reset, disabled again in .init3 (system_hal.cpp)
+        [[noreturn]] static void reboot() {
+            wdt_enable(WDTO_15MS);
+            for (;;) {
+            }
+        }
+    };
+} // namespace HAL
@@ -0,0 +1,37 @@
+#include "cycle_counter.h"
+
+namespace {
+    uint8_t saved_tccr1a = 0;
+    uint8_t saved_tccr1b = 0;
+    uint8_t saved_timsk1 = 0;
+} // namespace
+
+volatile uint16_t HAL::CycleCounter::overflows_ = 0;
+
+ISR(TIMER1_OVF_vect) {
+    ++HAL::CycleCounter::overflows_;
+}
+
+void HAL::CycleCounter::begin() {
+    const uint8_t sreg = SREG;
+    cli();
+    saved_tccr1a = TCCR1A;
+    saved_tccr1b = TCCR1B;
+    saved_timsk1 = TIMSK1;
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);     // Normal mode, no prescaler
+    TCNT1 = 0;
+    overflows_ = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+    SREG = sreg;
+}
+
+void HAL::CycleCounter::end() {
+    const uint8_t sreg = SREG;
+    cli();
+    TIMSK1 = saved_timsk1;
+    TCCR1A = saved_tccr1a;
+    TCCR1B = saved_tccr1b;
+    SREG = sreg;
+}
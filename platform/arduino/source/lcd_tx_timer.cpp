@@ -0,0 +1,20 @@
+#include "lcd_tx_timer.h"
+
+HAL::LcdTxTimer::Callback HAL::LcdTxTimer::callback_ = nullptr;
+
+ISR(TIMER2_COMPA_vect) {
+    HAL::LcdTxTimer::callback_();
+}
+
+void HAL::LcdTxTimer::begin(uint16_t period_us, Callback callback) {
+    const uint8_t sreg = SREG;
+    cli();
+    callback_ = callback;
+    TIMSK2 = 0;
+    TCCR2A = _BV(WGM21);                // CTC, TOP = OCR2A
+    TCCR2B = _BV(CS21) | _BV(CS20);     // clk/32: 2 us per count at 16 MHz
+    const uint16_t counts = period_us / 2U;
+    OCR2A = static_cast<uint8_t>(counts > 256U ? 255U : (counts > 0U ? counts - 1U : 0U));
+    TCNT2 = 0;
+    SREG = sreg;
+}
@@ -0,0 +1,52 @@
+#include "memory_hal.h"
+
+#include <avr/io.h>
+
+// Linker script and avr-libc malloc symbols
+extern "C" {
+    extern char __data_start;
+    extern char __data_end;
+    extern char __bss_start;
+    extern char __bss_end;
+    extern char __heap_start;
+    extern char* __brkval;  // Heap end, null until the first malloc
+}
+
+namespace {
+    const char* heapEnd() {
+        return __brkval != nullptr ? __brkval : &__heap_start;
+    }
+} // namespace
+
+// Runs between setting the stack pointer (.init2) and the .data/.bss init
+// (.init4): nothing is on the stack yet, the loop lives in registers.
+extern "C" void paintRamAtReset() __attribute__((naked, used, section(".init3")));
+void paintRamAtReset() {
+    for (char* p = &__heap_start; p <= reinterpret_cast<char*>(RAMEND); ++p) {
+        *p = static_cast<char>(HAL::Memory::kPaint);
+    }
+}
+
+uint16_t HAL::Memory::unusedStackBytes() {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(heapEnd());
+    const uint8_t* const stack = reinterpret_cast<const uint8_t*>(SP);
+    uint16_t count = 0;
+    while (p < stack && *p == kPaint) {
+        ++p;
+        ++count;
+    }
+    return count;
+}
+
+MemoryUsage HAL::Memory::usage() {
+    const uint16_t heap_end = reinterpret_cast<uint16_t>(heapEnd());
+    MemoryUsage usage;
+    usage.total = RAMEND - RAMSTART + 1;
+    usage.data = static_cast<uint16_t>(&__data_end - &__data_start);
+    usage.bss = static_cast<uint16_t>(&__bss_end - &__bss_start);
+    usage.heap = static_cast<uint16_t>(heap_end - reinterpret_cast<uint16_t>(&__heap_start));
+    usage.free = static_cast<uint16_t>(SP - heap_end);
+    usage.unused = unusedStackBytes();
+    usage.stack_peak = static_cast<uint16_t>(RAMEND + 1 - (heap_end + usage.unused));
+    return usage;
+}
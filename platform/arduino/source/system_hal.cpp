@@ -0,0 +1,12 @@
+#include "system_hal.h"
+
+#include <avr/io.h>
+
+// A watchdog reset leaves the watchdog running with its 15 ms timeout, and
+// WDRF in MCUSR keeps it enabled. Not every bootloader clears them, so turn
+// it off before the .data/.bss init and the constructors can overrun it.
+extern "C" void disableWatchdogAtReset() __attribute__((naked, used, section(".init3")));
+void disableWatchdogAtReset() {
+    MCUSR = 0;
+    wdt_disable();
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Minimal Arduino core stand-in for the host (native) simulator build.
+// Only the subset of the API used by this project is provided; timing runs
+// on the simulator's virtual clock (see sim_io.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+constexpr uint8_t A0 = 14;
+constexpr uint8_t A1 = 15;
+constexpr uint8_t A2 = 16;
+constexpr uint8_t A3 = 17;
+constexpr uint8_t A4 = 18;
+constexpr uint8_t A5 = 19;
+
+// Flash helpers are no-ops on the host, data lives in ordinary memory
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(addr)  (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr)  (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+#define pgm_read_ptr(addr)   (*reinterpret_cast<const void * const *>(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+    size_t write(const char *str) {
+        return str ? write(reinterpret_cast<const uint8_t *>(str), strlen(str)) : 0;
+    }
+
+    size_t print(const __FlashStringHelper *str) { return write(reinterpret_cast<const char *>(str)); }
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(int value, int base = DEC) { return print(static_cast<long>(value), base); }
+    size_t print(unsigned int value, int base = DEC) { return print(static_cast<unsigned long>(value), base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println() { return write("\r\n"); }
+    virtual void flush() {}
+    template <typename T>
+    size_t println(const T &value) {
+        const size_t n = print(value);
+        return n + println();
+    }
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { baud_ = baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+
+    int available();
+    int read();
+    int peek();
+    int availableForWrite() { return 64; }
+    void flush();
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    unsigned long baud() const { return baud_; }
+
+private:
+    unsigned long baud_ = 0;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,56 @@
+#pragma once
+
+// ArduinoLog stand-in for the host simulator build. Supports the format
+// specifiers used in this project: %s %S %c %d %i %l %u %x %X %b %t %T %F %f %p %%
+// (flags and width digits are accepted and ignored, as is the z modifier).
+
+#include <stdarg.h>
+#include "Arduino.h"
+
+#define LOG_LEVEL_SILENT  0
+#define LOG_LEVEL_FATAL   1
+#define LOG_LEVEL_ERROR   2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_INFO    4
+#define LOG_LEVEL_NOTICE  4
+#define LOG_LEVEL_TRACE   5
+#define LOG_LEVEL_VERBOSE 6
+
+class Logging {
+public:
+    void begin(int level, Print *output, bool show_level = true) {
+        level_ = level;
+        output_ = output;
+        show_level_ = show_level;
+    }
+    void setLevel(int level) { level_ = level; }
+    int getLevel() const { return level_; }
+
+#define LOGGING_LEVEL_METHODS(NAME, LEVEL)                                                        \
+    template <typename T> void NAME(T msg, ...) {                                                 \
+        va_list args; va_start(args, msg); printLevel(LEVEL, false, toChars(msg), args); va_end(args); \
+    }                                                                                             \
+    template <typename T> void NAME##ln(T msg, ...) {                                             \
+        va_list args; va_start(args, msg); printLevel(LEVEL, true, toChars(msg), args); va_end(args);  \
+    }
+    LOGGING_LEVEL_METHODS(fatal, LOG_LEVEL_FATAL)
+    LOGGING_LEVEL_METHODS(error, LOG_LEVEL_ERROR)
+    LOGGING_LEVEL_METHODS(warning, LOG_LEVEL_WARNING)
+    LOGGING_LEVEL_METHODS(notice, LOG_LEVEL_NOTICE)
+    LOGGING_LEVEL_METHODS(info, LOG_LEVEL_INFO)
+    LOGGING_LEVEL_METHODS(trace, LOG_LEVEL_TRACE)
+    LOGGING_LEVEL_METHODS(verbose, LOG_LEVEL_VERBOSE)
+#undef LOGGING_LEVEL_METHODS
+
+private:
+    static const char *toChars(const char *msg) { return msg; }
+    static const char *toChars(const __FlashStringHelper *msg) { return reinterpret_cast<const char *>(msg); }
+
+    void printLevel(int level, bool newline, const char *format, va_list args);
+
+    int level_ = LOG_LEVEL_SILENT;
+    Print *output_ = nullptr;
+    bool show_level_ = true;
+};
+
+extern Logging Log;
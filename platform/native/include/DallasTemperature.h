@@ -0,0 +1,36 @@
+#pragma once
+
+// DallasTemperature stand-in for the host simulator build. One DS18B20 per bus,
+// the reading comes from Sim::setSensorTemperature() and a blocking conversion
+// advances the virtual clock by the datasheet conversion time. Without waiting
+// the reading is available at once, callers keep the datasheet time themselves.
+
+#include <stdint.h>
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+public:
+    explicit DallasTemperature(OneWire *one_wire) : one_wire_(one_wire) {}
+
+    void begin() {}
+    uint8_t getDeviceCount();
+    bool getAddress(uint8_t *address, uint8_t index);
+
+    void setResolution(uint8_t resolution);
+    uint8_t getResolution() const;
+    void setWaitForConversion(bool wait) { wait_for_conversion_ = wait; }
+
+    void requestTemperatures();
+    float getTempCByIndex(uint8_t index);
+
+    /// Conversion time for the configured resolution [ms]
+    uint16_t millisToWaitForConversion() const { return static_cast<uint16_t>(750U >> (12U - getResolution())); }
+
+private:
+    OneWire *one_wire_;
+    bool wait_for_conversion_ = true;
+};
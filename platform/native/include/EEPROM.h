@@ -0,0 +1,51 @@
+#pragma once
+
+// EEPROM stand-in for the host simulator build, same interface as the AVR core library.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class EEPROMClass {
+public:
+    static constexpr size_t kSize = 1024;   // ATmega328P
+
+    EEPROMClass() { memset(data_, 0xFF, sizeof(data_)); }
+
+    uint8_t read(int idx) const { return data_[wrap(idx)]; }
+    void write(int idx, uint8_t val) { data_[wrap(idx)] = val; ++writes_; }
+    void update(int idx, uint8_t val) {
+        if (read(idx) != val) {
+            write(idx, val);
+        }
+    }
+    uint16_t length() const { return kSize; }
+
+    template <typename T>
+    T &get(int idx, T &t) const {
+        memcpy(&t, &data_[wrap(idx)], sizeof(T));
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int idx, const T &t) {
+        const auto *bytes = reinterpret_cast<const uint8_t *>(&t);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            update(static_cast<int>(i) + idx, bytes[i]);
+        }
+        return t;
+    }
+
+    // Simulator helpers
+    uint8_t *data() { return data_; }
+    uint32_t byteWrites() const { return writes_; }
+    void erase() { memset(data_, 0xFF, sizeof(data_)); }
+
+private:
+    static size_t wrap(int idx) { return static_cast<size_t>(idx) % kSize; }
+
+    uint8_t data_[kSize];
+    uint32_t writes_ = 0;
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,15 @@
+#pragma once
+
+// OneWire stand-in for the host simulator build. The bus only carries its pin,
+// DallasTemperature.h resolves the simulated sensor from it.
+
+#include <stdint.h>
+
+class OneWire {
+public:
+    explicit OneWire(uint8_t pin) : pin_(pin) {}
+    uint8_t pin() const { return pin_; }
+
+private:
+    uint8_t pin_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+
+namespace HAL
+{
+    /// Benchmark clock of the host build, wall-clock nanoseconds
+    class CycleCounter {
+    public:
+        static constexpr const char* kUnit = "ns";
+
+        static void begin() {
+        }
+
+        static void end() {
+        }
+
+        static uint32_t now() {
+            const auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+} // namespace HAL
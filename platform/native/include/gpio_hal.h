@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>  // Host Arduino stand-in, pins live in the simulator (sim_io.h)
+#include "sim_io.h"
+
+#include "gpio_hal_interface.h"
+#include "project_pin_definition.h"
+
+namespace HAL
+{
+    class HostGpio : public GpioInterface<HostGpio> {
+    public:
+        static constexpr uint16_t kAdcMax = 1023U;  // Simulates the Uno 10-bit ADC
+
+        static bool init() {
+            pinMode(KEYPAD_ANALOG_BUTTON_PIN, INPUT);
+            pinMode(RELAY_PIN, OUTPUT);
+            pinMode(LCD_BACKLIGHT_PIN, OUTPUT);
+
+            pinMode(BEFORE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(SELECT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(NEXT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(INCREASE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(DECREASE_BUTTON_PIN, INPUT_PULLUP);
+
+            return true;
+        }
+
+        static void writeRelay(bool state) {
+            digitalWrite(RELAY_PIN, state ? HIGH : LOW);
+        }
+
+        static void writeBacklight(bool state) {
+            digitalWrite(LCD_BACKLIGHT_PIN, state ? HIGH : LOW);
+        }
+
+        static bool readPinActive(uint16_t pin) {
+            return digitalRead(static_cast<uint8_t>(pin)) == LOW;
+        }
+
+        static uint16_t readKeypadAnalog() {
+            return static_cast<uint16_t>(analogRead(KEYPAD_ANALOG_BUTTON_PIN));
+        }
+
+        static void initLcdBus() {
+        }
+
+        static void writeLcdNibble(bool rs, uint8_t nibble) {
+            // Simulated HD44780 latches the nibble on the falling edge of EN
+            Sim::lcdWriteNibble(rs, nibble);
+        }
+    };
+
+    using Gpio = HostGpio;
+} // namespace HAL
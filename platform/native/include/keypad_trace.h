@@ -0,0 +1,232 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "sim_io.h"
+
+/**
+ * Press-to-pixel latency of the analog keypad on the host simulator.
+ *
+ * A KeypadTrace replays timed ADC readings on the keypad pin, the firmware
+ * polls them through HAL::Gpio and GPIO:: like on the board, and an
+ * LcdActivity records when the controller executes each byte. A press is
+ * served by the first burst of LCD bytes that starts after it and before the
+ * next press; its latency runs from the key going down to the last byte of
+ * that burst. Presses without a burst are dropped, so every press of a trace
+ * must change the screen (e.g. Up/Down in the settings menu).
+ *
+ *   Sim::KeypadTrace trace(samples);
+ *   Sim::LatencyReport report = Sim::runKeypadTrace(trace, KEYPAD_ANALOG_BUTTON_PIN, loop);
+ */
+namespace Sim
+{
+    /// ADC reading of the keypad from at_ms on, until the next sample
+    struct KeypadSample {
+        uint32_t at_ms;
+        uint16_t adc;
+    };
+
+    // Readings of the keypad shield, inside the bands of HAL::Gpio (10-bit scale)
+    enum KeypadLevel : uint16_t {
+        KEYPAD_NEXT = 0,
+        KEYPAD_UP = 99,
+        KEYPAD_DOWN = 256,
+        KEYPAD_PREV = 409,
+        KEYPAD_SELECT = 639,
+        KEYPAD_RELEASED = kFloatingAnalog,
+    };
+    constexpr uint16_t kKeypadBandsEnd = 750;   // Readings from here on are no key
+
+    class KeypadTrace : public AnalogModel {
+    public:
+        explicit KeypadTrace(std::vector<KeypadSample> samples) : samples_(std::move(samples)) {}
+
+        /// Virtual time of the trace's 0 ms
+        void start(uint64_t now_us) {
+            start_us_ = now_us;
+            next_ = 0;
+        }
+
+        int valueAt(uint64_t now_us) override {
+            const uint64_t at_ms = now_us > start_us_ ? (now_us - start_us_) / 1000U : 0;
+            if (next_ > 0 && samples_[next_ - 1].at_ms > at_ms) {
+                next_ = 0;  // Clock went back, e.g. a simulated reboot
+            }
+            while (next_ < samples_.size() && samples_[next_].at_ms <= at_ms) {
+                ++next_;
+            }
+            return next_ == 0 ? static_cast<int>(KEYPAD_RELEASED) : samples_[next_ - 1].adc;
+        }
+
+        uint64_t endMicros() const {
+            return start_us_ + (samples_.empty() ? 0 : samples_.back().at_ms * 1000ULL);
+        }
+
+        /// Virtual times at which a key goes down
+        std::vector<uint64_t> pressTimes() const {
+            std::vector<uint64_t> presses;
+            bool down = false;
+            for (const KeypadSample& sample : samples_) {
+                const bool pressed = sample.adc < kKeypadBandsEnd;
+                if (pressed && !down) {
+                    presses.push_back(start_us_ + sample.at_ms * 1000ULL);
+                }
+                down = pressed;
+            }
+            return presses;
+        }
+
+        const std::vector<KeypadSample>& samples() const { return samples_; }
+
+    private:
+        std::vector<KeypadSample> samples_;
+        uint64_t start_us_ = 0;
+        size_t next_ = 0;
+    };
+
+    /**
+     * "ms,adc" lines with increasing ms; a header line and '#' comments are
+     * skipped. False when the file cannot be read or has no samples.
+     */
+    inline bool loadKeypadTrace(const char* path, std::vector<KeypadSample>& samples) {
+        FILE* file = fopen(path, "r");
+        if (file == nullptr) {
+            return false;
+        }
+        samples.clear();
+        char line[128];
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            unsigned long at_ms = 0;
+            unsigned int adc = 0;
+            if (line[0] != '#' && sscanf(line, "%lu,%u", &at_ms, &adc) == 2) {
+                samples.push_back(KeypadSample{static_cast<uint32_t>(at_ms), static_cast<uint16_t>(adc)});
+            }
+        }
+        fclose(file);
+        return !samples.empty();
+    }
+
+    /**
+     * Presses cycling through keys, hold and release times uniform in the
+     * given ranges, clean edges. The trace ends with tail_ms released so the
+     * last press can be served.
+     */
+    inline std::vector<KeypadSample> syntheticKeypadTrace(size_t presses, const uint16_t* keys, size_t key_count,
+                                                          uint32_t min_hold_ms, uint32_t max_hold_ms,
+                                                          uint32_t min_gap_ms, uint32_t max_gap_ms,
+                                                          uint32_t seed, uint32_t tail_ms = 3000) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<uint32_t> hold(min_hold_ms, max_hold_ms);
+        std::uniform_int_distribution<uint32_t> gap(min_gap_ms, max_gap_ms);
+        std::vector<KeypadSample> samples;
+        uint32_t at_ms = 0;
+        samples.push_back(KeypadSample{at_ms, KEYPAD_RELEASED});
+        for (size_t i = 0; i < presses; ++i) {
+            at_ms += gap(rng);
+            const uint16_t key = keys[i % key_count];
+            samples.push_back(KeypadSample{at_ms, key});
+            at_ms += hold(rng);
+            samples.push_back(KeypadSample{at_ms, KEYPAD_RELEASED});
+        }
+        samples.push_back(KeypadSample{at_ms + tail_ms, KEYPAD_RELEASED});
+        return samples;
+    }
+
+    /// Virtual time of every byte the LCD controller executes
+    class LcdActivity : public LcdObserver {
+    public:
+        void onLcdByte(uint64_t now_us, bool, uint8_t) override { byte_us_.push_back(now_us); }
+        const std::vector<uint64_t>& byteTimes() const { return byte_us_; }
+        void clear() { byte_us_.clear(); }
+
+    private:
+        std::vector<uint64_t> byte_us_;
+    };
+
+    struct LatencyReport {
+        size_t presses = 0;
+        size_t dropped = 0;
+        double p50_ms = 0.0;    // Nearest rank over all presses, a dropped press is INFINITY
+        double p99_ms = 0.0;
+        double max_ms = 0.0;    // Slowest served press
+        std::vector<double> served_ms;  // Sorted
+
+        /// Share of all presses, dropped ones included, shown within ms
+        double servedWithin(double ms) const {
+            if (presses == 0) {
+                return 0.0;
+            }
+            const size_t served = std::upper_bound(served_ms.begin(), served_ms.end(), ms) - served_ms.begin();
+            return static_cast<double>(served) / static_cast<double>(presses);
+        }
+    };
+
+    /**
+     * Match presses to LCD bursts. A burst ends at the first pause of
+     * burst_gap_us between bytes; a frame is clocked out every 50 us with at
+     * most a clear display (1.52 ms) in between.
+     */
+    inline LatencyReport measureKeypadLatency(const std::vector<uint64_t>& presses,
+                                              const std::vector<uint64_t>& lcd_bytes,
+                                              uint64_t burst_gap_us = 5000) {
+        LatencyReport report;
+        report.presses = presses.size();
+        std::vector<double>& latencies_ms = report.served_ms;
+        size_t byte = 0;
+        for (size_t i = 0; i < presses.size(); ++i) {
+            const uint64_t next_press = i + 1 < presses.size() ? presses[i + 1] : UINT64_MAX;
+            while (byte < lcd_bytes.size() && lcd_bytes[byte] < presses[i]) {
+                ++byte;
+            }
+            if (byte == lcd_bytes.size() || lcd_bytes[byte] >= next_press) {
+                ++report.dropped;
+                continue;
+            }
+            while (byte + 1 < lcd_bytes.size() && lcd_bytes[byte + 1] - lcd_bytes[byte] < burst_gap_us) {
+                ++byte;
+            }
+            latencies_ms.push_back(static_cast<double>(lcd_bytes[byte] - presses[i]) * 1e-3);
+            ++byte;
+        }
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        if (!presses.empty()) {
+            // Dropped presses rank after every served one
+            const auto rank = [&](double fraction) {
+                const size_t index = static_cast<size_t>(ceil(fraction * static_cast<double>(presses.size())));
+                const size_t position = index > 0 ? index - 1 : 0;
+                return position < latencies_ms.size() ? latencies_ms[position] : INFINITY;
+            };
+            report.p50_ms = rank(0.50);
+            report.p99_ms = rank(0.99);
+        }
+        if (!latencies_ms.empty()) {
+            report.max_ms = latencies_ms.back();
+        }
+        return report;
+    }
+
+    /**
+     * Run pass() (the firmware's loop()) over the whole trace with the trace
+     * on pin, starting now. The caller brings the firmware to the screen the
+     * trace expects first.
+     */
+    inline LatencyReport runKeypadTrace(KeypadTrace& trace, uint8_t pin, void (*pass)()) {
+        LcdActivity activity;
+        trace.start(nowMicros());
+        attachAnalogModel(pin, &trace);
+        attachLcdObserver(&activity);
+        while (nowMicros() < trace.endMicros()) {
+            pass();
+        }
+        attachLcdObserver(nullptr);
+        attachAnalogModel(pin, nullptr);
+        return measureKeypadLatency(trace.pressTimes(), activity.byteTimes());
+    }
+} // namespace Sim
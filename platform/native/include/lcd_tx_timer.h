@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include "sim_io.h"
+
+namespace HAL
+{
+    /// LCD transmit tick of the host build, runs on the simulator's virtual clock
+    class LcdTxTimer {
+    public:
+        using Callback = void (*)();
+
+        static void begin(uint16_t period_us, Callback callback) {
+            Sim::attachTimer(period_us, callback);
+        }
+
+        static void start() {
+            Sim::setTimerEnabled(true);
+        }
+
+        static void stop() {
+            Sim::setTimerEnabled(false);
+        }
+    };
+} // namespace HAL
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "memory_usage.h"
+
+namespace HAL
+{
+    /**
+     * Stack high-water mark of the host build. paintStack() paints a window
+     * of kWindowBytes below its caller's frame and the scan measures how deep
+     * later calls reached into it. Host frames are larger than AVR ones, so
+     * the figures compare changes rather than predict the board; statics and
+     * heap are not measured on the host and read 0.
+     */
+    class Memory {
+    public:
+        static constexpr uint8_t kPaint = 0xC5;
+        static constexpr size_t kWindowBytes = 16 * 1024;
+
+        /// Call first thing in setup(); tests may call it again to start over
+        static void paintStack();
+
+        /// Painted bytes the stack never reached, 0 before paintStack()
+        static uint16_t unusedStackBytes();
+
+        static MemoryUsage usage();
+    };
+} // namespace HAL
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "project_pin_definition.h"
+#include "sim_io.h"
+
+namespace HAL
+{
+    /// Modbus RTU port on the simulator's second UART (a pty when opened)
+    class ModbusPort {
+    public:
+        static constexpr bool kSharesLogPort = false;
+
+        /// The simulated UART moves whole bytes, the baud rate only sets the frame timing
+        static void begin(uint32_t) {
+            pinMode(MODBUS_DE_PIN, OUTPUT);
+            setTransmit(false);
+        }
+
+        static int available() { return static_cast<int>(Sim::uartAvailable()); }
+        static int read() { return Sim::uartRead(); }
+        static int availableForWrite() { return static_cast<int>(Sim::kUartTxBuffer); }
+        static size_t write(const uint8_t* data, size_t size) { return Sim::uartWrite(data, size); }
+
+        static void setTransmit(bool enabled) {
+            digitalWrite(MODBUS_DE_PIN, enabled ? HIGH : LOW);
+        }
+    };
+} // namespace HAL
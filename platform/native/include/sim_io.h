@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Host simulator control surface.
+ *
+ * The Arduino stand-in (Arduino.h, EEPROM.h, DallasTemperature.h, ...) reads
+ * and writes this state; tests and host tools use it to drive inputs and
+ * observe outputs while the unmodified firmware runs on top.
+ */
+namespace Sim
+{
+    constexpr uint8_t kNumPins = 32;
+    constexpr int kFloatingAnalog = 1023;   // analog keypad with no key pressed
+
+    // Virtual clock
+    uint64_t nowMicros();
+    void advanceMicros(uint64_t us);
+    void setRealTime(bool enabled);         // sleep alongside delay() when enabled
+
+    // Periodic timer interrupt: the callback runs each time the virtual clock crosses a period boundary
+    using TimerCallback = void (*)();
+    void attachTimer(uint32_t period_us, TimerCallback callback);
+    void setTimerEnabled(bool enabled);
+    bool isTimerEnabled();
+    // The next tick runs us late, like an interrupt behind a cli() section; the
+    // ones after keep their schedule and a tick passed meanwhile is lost
+    void holdOffTimerTick(uint32_t us);
+
+    // GPIO
+    void driveDigital(uint8_t pin, bool level);
+    void releaseDigital(uint8_t pin);
+    void setAnalog(uint8_t pin, int value);
+    // Analog input from a model read at the virtual time of each analogRead(),
+    // e.g. a KeypadTrace (keypad_trace.h) replaying recorded key presses
+    class AnalogModel {
+    public:
+        virtual ~AnalogModel() = default;
+        virtual int valueAt(uint64_t now_us) = 0;
+    };
+    void attachAnalogModel(uint8_t pin, AnalogModel *model);   // nullptr detaches; kept over reset()
+    uint8_t pinModeOf(uint8_t pin);
+    bool outputLevel(uint8_t pin);
+
+    // DS18B20 sensors, addressed by their OneWire pin
+    void setSensorTemperature(uint8_t pin, float celsius);
+    void setSensorConnected(uint8_t pin, bool connected);
+    float sensorTemperature(uint8_t pin);
+    bool isSensorConnected(uint8_t pin);
+    uint8_t sensorResolution(uint8_t pin);  // kept in the sensor's EEPROM, survives reset()
+    void setSensorResolution(uint8_t pin, uint8_t resolution);
+
+    // Closed loop: a model computes the reading of a sensor at the virtual time
+    // of each read, e.g. a PlantSensor (sim_plant.h) in place of a fixed value
+    class SensorModel {
+    public:
+        virtual ~SensorModel() = default;
+        virtual float temperatureAt(uint64_t now_us) = 0;
+    };
+    void attachSensorModel(uint8_t pin, SensorModel *model);   // nullptr detaches; kept over reset()
+
+    // Serial
+    void injectSerial(const uint8_t *data, size_t size);
+    void setSerialEcho(bool enabled);       // copy TX to stdout (default on)
+
+    // Second UART (Modbus port): fed from a pty master or injectUart(), TX goes
+    // to the pty or is collected for takeUartOutput()
+    constexpr size_t kUartTxBuffer = 64;
+    bool openUartPty(const char *link_path); // symlink link_path to the pty slave side
+    void injectUart(const uint8_t *data, size_t size);
+    size_t uartAvailable();
+    int uartRead();
+    size_t uartWrite(const uint8_t *data, size_t size);
+    size_t takeUartOutput(uint8_t *out, size_t size);
+
+    // HD44780 on the LCD pins (4-bit bus, write only)
+    struct LcdStats {
+        uint32_t commands = 0;          // Instructions executed
+        uint32_t data_bytes = 0;        // DDRAM and CGRAM writes
+        uint32_t nibbles = 0;           // Enable strobes
+        uint64_t bus_micros = 0;        // Datasheet execution time of the above, fosc = 270 kHz
+        uint32_t busy_violations = 0;   // Bytes started before the previous instruction had finished
+    };
+    // Sees every byte the controller executes, when it executes it
+    class LcdObserver {
+    public:
+        virtual ~LcdObserver() = default;
+        virtual void onLcdByte(uint64_t now_us, bool rs, uint8_t value) = 0;
+    };
+    struct LcdStatus {
+        bool display_on;
+        bool cursor_on;
+        bool blink;
+        bool four_bit;
+        bool two_lines;
+        bool cgram;                     // Address counter points into CGRAM
+        uint8_t address;                // Address counter, the cursor position when in DDRAM
+        uint8_t shift;                  // Display shift, characters to the left
+    };
+    void lcdWriteNibble(bool rs, uint8_t nibble);
+    const char *lcdRow(uint8_t row);        // 16 visible character codes, not NUL-terminated
+    // Visible 16x2 screen as UTF-8, rows separated by '\n'. CGRAM characters are
+    // matched against the registered glyphs, unknown ones render as U+FFFD.
+    size_t lcdRender(char *out, size_t size);
+    bool lcdRegisterGlyph(const uint8_t rows[8], const char *utf8);    // kept over reset()
+    void lcdClearGlyphs();
+    LcdStatus lcdStatus();
+    const uint8_t *lcdCgram();              // 64 bytes, 8 rows per character
+    void attachLcdObserver(LcdObserver *observer);  // nullptr detaches; kept over reset()
+    LcdStats lcdStats();
+    void lcdResetStats();
+    void lcdReset();
+
+    // Firmware reboot request, sim_main() resets the simulator and calls setup() again
+    void requestReboot();
+    bool takeRebootRequest();
+
+    // Restore power-on state (pins, sensors, LCD, timer, clock); EEPROM and sensor models are kept like on hardware
+    void reset();
+} // namespace Sim
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+#include "sim_io.h"
+#include "thermal_plant.h"
+
+namespace Sim
+{
+    /**
+     * A ThermalPlant behind a simulated DS18B20, usually the internal one.
+     * On each read the plant catches up with the virtual clock, taking the
+     * outside temperature from the external sensor and the fan state from
+     * the relay pin as they are at that moment; the firmware reads a sensor
+     * about once a second, well inside the plant time constants.
+     *
+     *   Sim::ThermalPlant plant(parameters, 12.0f);
+     *   Sim::PlantSensor room(plant, EXTERNAL_DS18B20_PIN, RELAY_PIN);
+     *   Sim::attachSensorModel(INTERNAL_DS18B20_PIN, &room);
+     */
+    class PlantSensor : public SensorModel {
+    public:
+        PlantSensor(ThermalPlant &plant, uint8_t external_pin, uint8_t fan_pin)
+            : plant_(plant), external_pin_(external_pin), fan_pin_(fan_pin), last_us_(nowMicros()) {}
+
+        float temperatureAt(uint64_t now_us) override {
+            // The clock restarts at a simulated reboot, the room does not
+            if (now_us > last_us_) {
+                plant_.advance(static_cast<double>(now_us - last_us_) * 1e-6, sensorTemperature(external_pin_),
+                               outputLevel(fan_pin_));
+            }
+            last_us_ = now_us;
+            return plant_.sensorTemperature();
+        }
+
+    private:
+        ThermalPlant &plant_;
+        uint8_t external_pin_;
+        uint8_t fan_pin_;
+        uint64_t last_us_;
+    };
+} // namespace Sim
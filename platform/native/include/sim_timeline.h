@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Timeline of the host simulator in virtual time, exported as Chrome
+ * trace-event JSON for Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * timelineStart() allocates a ring of events once; recording only copies an
+ * event into it and overwrites the oldest when full. While stopped every
+ * record call is one load and branch on the inline flag. Sources:
+ *
+ *   TRACK_LOOP     loop() stages from HAL::StageMarker, control decisions are
+ *                  the "fan control" slices
+ *   TRACK_SENSORS  DS18B20 conversions (requestTemperatures)
+ *   TRACK_EEPROM   commits from HAL::StageMarker, with the bytes written
+ *   TRACK_LCD      frames as seen on the bus, from the first byte to the end
+ *                  of execution of the last one before a pause
+ *   TRACK_INPUT    analog input changes, e.g. keypad presses
+ *   TRACK_GPIO     digital output changes, e.g. the relay
+ *
+ * Names are not copied: pass string literals or other static storage.
+ * Time keeps running over Sim::reset(), a reboot shows as a "reset" instant.
+ */
+namespace Sim
+{
+    enum TimelineTrack : uint8_t {
+        TRACK_LOOP,
+        TRACK_SENSORS,
+        TRACK_EEPROM,
+        TRACK_LCD,
+        TRACK_INPUT,
+        TRACK_GPIO,
+        TRACK_COUNT
+    };
+
+    namespace detail
+    {
+        extern bool timeline_enabled;
+        void timelineRecord(char phase, TimelineTrack track, const char *name, int32_t value);
+        void timelineOnReset();     // Sim::reset(), before the clock restarts
+        void lcdTimelineFlush();    // sim_lcd.cpp: records the frame still open
+    } // namespace detail
+
+    inline bool timelineEnabled() {
+        return detail::timeline_enabled;
+    }
+
+    inline void timelineBegin(TimelineTrack track, const char *name, int32_t value = 0) {
+        if (detail::timeline_enabled) {
+            detail::timelineRecord('B', track, name, value);
+        }
+    }
+
+    /// Ends the innermost open slice of the track, ignored when none is open
+    inline void timelineEnd(TimelineTrack track, const char *name, int32_t value = 0) {
+        if (detail::timeline_enabled) {
+            detail::timelineRecord('E', track, name, value);
+        }
+    }
+
+    inline void timelineInstant(TimelineTrack track, const char *name, int32_t value = 0) {
+        if (detail::timeline_enabled) {
+            detail::timelineRecord('i', track, name, value);
+        }
+    }
+
+    /// Slice with a known start and end, e.g. one running on in hardware, in Sim::nowMicros() time
+    void timelineComplete(TimelineTrack track, const char *name, uint64_t start_us, uint64_t end_us, int32_t value);
+
+    bool timelineStart(size_t capacity);    // Drops earlier events; false when capacity is 0 or allocation fails
+    void timelineStop();                    // Keeps the events for export
+    size_t timelineSize();                  // Events held, at most the capacity
+    uint64_t timelineOverwritten();         // Oldest events lost to a full ring
+    bool timelineWriteJson(FILE *out);
+    bool timelineWriteJson(const char *path);
+} // namespace Sim
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <EEPROM.h>
+#include "loop_stages.h"
+#include "sim_timeline.h"
+
+namespace HAL
+{
+    /**
+     * Stage markers feed the simulator timeline (sim_timeline.h): each loop
+     * stage is a slice on the loop track, each commit one on the EEPROM track
+     * with the bytes it wrote. One branch while the timeline is stopped.
+     */
+    class StageMarker {
+    public:
+        static void stage(LoopStage::Stage id) {
+            if (!Sim::timelineEnabled()) {
+                return;
+            }
+            static constexpr const char *kNames[LoopStage::STAGE_COUNT] = {
+                "none", "setup", "links", "sensors", "fan control", "telemetry",
+                "records", "UI input", "UI render", "delay",
+            };
+            Sim::timelineEnd(Sim::TRACK_LOOP, "");
+            if (id != LoopStage::STAGE_NONE && id < LoopStage::STAGE_COUNT) {
+                Sim::timelineBegin(Sim::TRACK_LOOP, kNames[id]);
+            }
+        }
+
+        /// Start of a commit, COMMIT_NONE ends it
+        static void commit(LoopStage::Commit id) {
+            if (!Sim::timelineEnabled()) {
+                return;
+            }
+            static constexpr const char *kNames[LoopStage::COMMIT_COUNT] = {
+                "none", "settings commit", "counters commit", "events commit",
+            };
+            if (id == LoopStage::COMMIT_NONE) {
+                Sim::timelineEnd(Sim::TRACK_EEPROM, "", static_cast<int32_t>(EEPROM.byteWrites() - writes_at_begin_));
+            } else if (id < LoopStage::COMMIT_COUNT) {
+                writes_at_begin_ = EEPROM.byteWrites();
+                Sim::timelineBegin(Sim::TRACK_EEPROM, kNames[id]);
+            }
+        }
+
+    private:
+        static inline uint32_t writes_at_begin_ = 0;
+    };
+} // namespace HAL
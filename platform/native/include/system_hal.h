@@ -0,0 +1,14 @@
+#pragma once
+
+#include "sim_io.h"
+
+namespace HAL
+{
+    class System {
+    public:
+        /// The simulator restarts setup() once the current loop() pass returns
+        static void reboot() {
+            Sim::requestReboot();
+        }
+    };
+} // namespace HAL
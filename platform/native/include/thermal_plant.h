@@ -0,0 +1,95 @@
+#pragma once
+
+#include <math.h>
+
+/**
+ * Lumped-capacitance model of the storage room for closed-loop runs on the
+ * host. Two nodes: the potato pile and the room air, which also carries the
+ * heat capacity of the building. Heat flows per step:
+ *
+ *   respiration -> pile     m * r(T_pile), r doubling every 10 C (Q10)
+ *   pile <-> air            UA, much larger while the fan pushes air through the pile
+ *   air <-> outside         wall and roof UA
+ *   outside air -> air      fan airflow * rho * cp while the fan runs
+ *
+ * integrated with explicit Euler at a fixed step. Free of the simulator so
+ * the replay tools run it directly; Sim::attachSensorModel() puts it behind
+ * a DS18B20 pin of the simulator.
+ */
+namespace Sim
+{
+    struct PlantParameters {
+        float pile_mass_kg = 100000.0f;             // 100 t of potatoes
+        float pile_specific_heat = 3600.0f;         // J/(kg K)
+        float room_air_m3 = 400.0f;                 // Free air volume
+        float room_heat_capacity = 5.0e6f;          // Walls, floor and crates in contact with the air, J/K
+        float wall_ua = 150.0f;                     // W/K
+        float pile_air_ua = 2000.0f;                // W/K, still air
+        float pile_air_ua_fan = 15000.0f;           // W/K, fan running
+        float fan_airflow_m3_s = 3.0f;
+        float respiration_w_per_t = 8.0f;           // At kRespirationReferenceC
+        float respiration_q10 = 2.0f;
+        float step_s = 10.0f;
+        bool sensor_in_pile = true;                 // Else the internal sensor hangs in the room air
+    };
+
+    class ThermalPlant {
+    public:
+        static constexpr float kAirVolumetricHeat = 1206.0f;   // rho * cp of air, J/(m3 K)
+        static constexpr float kRespirationReferenceC = 5.0f;
+
+        explicit ThermalPlant(const PlantParameters& parameters, float initial_c = 10.0f)
+            : parameters_(parameters),
+              pile_capacity_(parameters.pile_mass_kg * parameters.pile_specific_heat),
+              air_capacity_(parameters.room_air_m3 * kAirVolumetricHeat + parameters.room_heat_capacity),
+              fan_conductance_(parameters.fan_airflow_m3_s * kAirVolumetricHeat),
+              pile_c_(initial_c), air_c_(initial_c) {}
+
+        /// One fixed step with the outside temperature and fan state held over it
+        void step(float external_c, bool fan_on) {
+            const float dt = parameters_.step_s;
+            const float respiration = parameters_.pile_mass_kg * 0.001f * parameters_.respiration_w_per_t *
+                powf(parameters_.respiration_q10, (pile_c_ - kRespirationReferenceC) * 0.1f);
+            const float to_air = (fan_on ? parameters_.pile_air_ua_fan : parameters_.pile_air_ua) * (pile_c_ - air_c_);
+            const float from_outside = (parameters_.wall_ua + (fan_on ? fan_conductance_ : 0.0f)) * (external_c - air_c_);
+            pile_c_ += dt * (respiration - to_air) / pile_capacity_;
+            air_c_ += dt * (to_air + from_outside) / air_capacity_;
+            elapsed_s_ += dt;
+        }
+
+        /// Whole steps over seconds, the remainder is carried to the next call
+        void advance(double seconds, float external_c, bool fan_on) {
+            pending_s_ += seconds;
+            while (pending_s_ >= parameters_.step_s) {
+                step(external_c, fan_on);
+                pending_s_ -= parameters_.step_s;
+            }
+        }
+
+        /**
+         * Largest stable Euler step for these parameters, the air node with
+         * the fan running is the stiff one. step_s should stay well below.
+         */
+        float maxStableStep() const {
+            const float air = air_capacity_ / (parameters_.pile_air_ua_fan + parameters_.wall_ua + fan_conductance_);
+            const float pile = pile_capacity_ / parameters_.pile_air_ua_fan;
+            return 2.0f * (air < pile ? air : pile);
+        }
+
+        float pileTemperature() const { return pile_c_; }
+        float airTemperature() const { return air_c_; }
+        float sensorTemperature() const { return parameters_.sensor_in_pile ? pile_c_ : air_c_; }
+        double elapsedSeconds() const { return elapsed_s_; }
+        const PlantParameters& parameters() const { return parameters_; }
+
+    private:
+        PlantParameters parameters_;
+        float pile_capacity_;
+        float air_capacity_;
+        float fan_conductance_;
+        float pile_c_;
+        float air_c_;
+        double pending_s_ = 0.0;
+        double elapsed_s_ = 0.0;
+    };
+} // namespace Sim
@@ -0,0 +1,50 @@
+#include "memory_hal.h"
+
+namespace {
+    // Lowest and one past the highest address of the painted window, kept as
+    // integers: the frame that painted it is gone, later frames reuse it
+    uintptr_t g_window_low = 0;
+    uintptr_t g_window_high = 0;
+
+    // A frame of its own, so the paint lies below the caller of paintStack()
+    __attribute__((noinline)) void paintWindow() {
+        volatile uint8_t window[HAL::Memory::kWindowBytes];
+        for (size_t i = 0; i < sizeof(window); ++i) {
+            window[i] = HAL::Memory::kPaint;
+        }
+        g_window_low = reinterpret_cast<uintptr_t>(window);
+        g_window_high = g_window_low + sizeof(window);
+    }
+} // namespace
+
+void HAL::Memory::paintStack() {
+    paintWindow();
+}
+
+uint16_t HAL::Memory::unusedStackBytes() {
+    uint16_t count = 0;
+    for (uintptr_t address = g_window_low; address < g_window_high; ++address) {
+        if (*reinterpret_cast<const volatile uint8_t*>(address) != kPaint) {
+            break;
+        }
+        ++count;
+    }
+    return count;
+}
+
+MemoryUsage HAL::Memory::usage() {
+    MemoryUsage usage;
+    if (g_window_low == 0) {
+        return usage;
+    }
+    const auto stack = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    usage.total = static_cast<uint16_t>(kWindowBytes);
+    if (stack >= g_window_high) {
+        usage.free = usage.total;
+    } else if (stack > g_window_low) {
+        usage.free = static_cast<uint16_t>(stack - g_window_low);
+    }
+    usage.unused = unusedStackBytes();
+    usage.stack_peak = static_cast<uint16_t>(kWindowBytes - usage.unused);
+    return usage;
+}
@@ -0,0 +1,336 @@
+#include "Arduino.h"
+#include "sim_io.h"
+#include "sim_timeline.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <deque>
+#include <thread>
+
+namespace {
+    struct PinState {
+        uint8_t mode = INPUT;
+        bool output = false;
+        bool driven = false;
+        bool drive_level = false;
+        int analog = Sim::kFloatingAnalog;
+        int last_read = Sim::kFloatingAnalog;   // Last analogRead(), changes go on the timeline
+    };
+
+    struct SensorState {
+        float temperature = 20.0f;
+        bool connected = true;
+        uint8_t resolution = 12;
+        Sim::SensorModel *model = nullptr;
+    };
+
+    struct TimerState {
+        uint32_t period_us = 0;
+        Sim::TimerCallback callback = nullptr;
+        bool enabled = false;
+        uint64_t next_us = 0;
+        uint32_t hold_off_us = 0;   // Delay of the next tick only
+    };
+
+    uint64_t g_now_us = 0;
+    bool g_real_time = false;
+    TimerState g_timer;
+    PinState g_pins[Sim::kNumPins];
+    SensorState g_sensors[Sim::kNumPins];
+    Sim::AnalogModel *g_analog_models[Sim::kNumPins] = {};
+    std::deque<uint8_t> g_serial_rx;
+    bool g_serial_echo = true;
+    bool g_reboot_requested = false;
+
+    PinState &pin(uint8_t index) {
+        return g_pins[index % Sim::kNumPins];
+    }
+
+    // Timeline names of the pins, "pin 9" and "analog 14"
+    struct PinNames {
+        char digital[Sim::kNumPins][8];
+        char analog[Sim::kNumPins][12];
+        PinNames() {
+            for (uint8_t i = 0; i < Sim::kNumPins; ++i) {
+                snprintf(digital[i], sizeof(digital[i]), "pin %u", static_cast<unsigned>(i));
+                snprintf(analog[i], sizeof(analog[i]), "analog %u", static_cast<unsigned>(i));
+            }
+        }
+    };
+    const PinNames g_pin_names;
+} // namespace
+
+namespace Sim
+{
+    uint64_t nowMicros() {
+        return g_now_us;
+    }
+
+    void advanceMicros(uint64_t us) {
+        const uint64_t target = g_now_us + us;
+        // The callback may disable the timer or advance the clock itself
+        while (g_timer.enabled && g_timer.next_us + g_timer.hold_off_us <= target) {
+            g_now_us = g_timer.next_us + g_timer.hold_off_us;
+            g_timer.hold_off_us = 0;
+            // Compare matches while held off set the flag only once
+            do {
+                g_timer.next_us += g_timer.period_us;
+            } while (g_timer.next_us <= g_now_us);
+            g_timer.callback();
+        }
+        if (target > g_now_us) {
+            g_now_us = target;
+        }
+        if (g_real_time) {
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+    }
+
+    void setRealTime(bool enabled) {
+        g_real_time = enabled;
+    }
+
+    void attachTimer(uint32_t period_us, TimerCallback callback) {
+        g_timer = TimerState{};
+        g_timer.period_us = period_us > 0 ? period_us : 1;
+        g_timer.callback = callback;
+    }
+
+    void setTimerEnabled(bool enabled) {
+        if (enabled && !g_timer.enabled) {
+            g_timer.next_us = g_now_us + g_timer.period_us;
+        }
+        g_timer.enabled = enabled && g_timer.callback != nullptr;
+    }
+
+    bool isTimerEnabled() {
+        return g_timer.enabled;
+    }
+
+    void holdOffTimerTick(uint32_t us) {
+        g_timer.hold_off_us = us;
+    }
+
+    void driveDigital(uint8_t index, bool level) {
+        pin(index).driven = true;
+        pin(index).drive_level = level;
+    }
+
+    void releaseDigital(uint8_t index) {
+        pin(index).driven = false;
+    }
+
+    void attachAnalogModel(uint8_t index, AnalogModel *model) {
+        g_analog_models[index % kNumPins] = model;
+    }
+
+    void setAnalog(uint8_t index, int value) {
+        pin(index).analog = value;
+    }
+
+    uint8_t pinModeOf(uint8_t index) {
+        return pin(index).mode;
+    }
+
+    bool outputLevel(uint8_t index) {
+        return pin(index).output;
+    }
+
+    void setSensorTemperature(uint8_t index, float celsius) {
+        g_sensors[index % kNumPins].temperature = celsius;
+    }
+
+    void setSensorConnected(uint8_t index, bool connected) {
+        g_sensors[index % kNumPins].connected = connected;
+    }
+
+    float sensorTemperature(uint8_t index) {
+        SensorState &sensor = g_sensors[index % kNumPins];
+        return sensor.model != nullptr ? sensor.model->temperatureAt(g_now_us) : sensor.temperature;
+    }
+
+    void attachSensorModel(uint8_t index, SensorModel *model) {
+        g_sensors[index % kNumPins].model = model;
+    }
+
+    bool isSensorConnected(uint8_t index) {
+        return g_sensors[index % kNumPins].connected;
+    }
+
+    // DS18B20 configuration lives in the sensor's own EEPROM and survives reset()
+    uint8_t sensorResolution(uint8_t index) {
+        return g_sensors[index % kNumPins].resolution;
+    }
+
+    void setSensorResolution(uint8_t index, uint8_t resolution) {
+        g_sensors[index % kNumPins].resolution = resolution;
+    }
+
+    void injectSerial(const uint8_t *data, size_t size) {
+        g_serial_rx.insert(g_serial_rx.end(), data, data + size);
+    }
+
+    void setSerialEcho(bool enabled) {
+        g_serial_echo = enabled;
+    }
+
+    void requestReboot() {
+        g_reboot_requested = true;
+    }
+
+    bool takeRebootRequest() {
+        const bool requested = g_reboot_requested;
+        g_reboot_requested = false;
+        return requested;
+    }
+
+    void reset() {
+        detail::timelineOnReset();
+        g_now_us = 0;
+        g_timer.enabled = false;
+        for (auto &state : g_pins) {
+            state = PinState{};
+        }
+        for (auto &sensor : g_sensors) {
+            const auto resolution = sensor.resolution;
+            auto *const model = sensor.model;
+            sensor = SensorState{};
+            sensor.resolution = resolution;
+            sensor.model = model;
+        }
+        g_serial_rx.clear();
+        lcdReset();
+    }
+} // namespace Sim
+
+// --- Arduino core API ---
+
+unsigned long millis() {
+    return static_cast<unsigned long>(g_now_us / 1000U);
+}
+
+unsigned long micros() {
+    return static_cast<unsigned long>(g_now_us);
+}
+
+void delay(unsigned long ms) {
+    // Like the Arduino cores, let yield() run while waiting
+    for (; ms > 0; --ms) {
+        yield();
+        Sim::advanceMicros(1000U);
+    }
+}
+
+void delayMicroseconds(unsigned int us) {
+    Sim::advanceMicros(us);
+}
+
+// Weak like in the Arduino cores, the firmware may provide its own
+__attribute__((weak)) void yield() {
+}
+
+void pinMode(uint8_t index, uint8_t mode) {
+    pin(index).mode = mode;
+}
+
+void digitalWrite(uint8_t index, uint8_t val) {
+    PinState &state = pin(index);
+    const bool level = val != LOW;
+    if (Sim::timelineEnabled() && state.mode == OUTPUT && level != state.output) {
+        Sim::timelineInstant(Sim::TRACK_GPIO, g_pin_names.digital[index % Sim::kNumPins], level);
+    }
+    state.output = level;
+}
+
+int digitalRead(uint8_t index) {
+    const auto &state = pin(index);
+    if (state.mode == OUTPUT) {
+        return state.output ? HIGH : LOW;
+    }
+    if (state.driven) {
+        return state.drive_level ? HIGH : LOW;
+    }
+    return state.mode == INPUT_PULLUP ? HIGH : LOW;
+}
+
+int analogRead(uint8_t index) {
+    index %= Sim::kNumPins;
+    Sim::AnalogModel *const model = g_analog_models[index];
+    PinState &state = pin(index);
+    const int value = model != nullptr ? model->valueAt(g_now_us) : state.analog;
+    if (value != state.last_read) {
+        state.last_read = value;
+        Sim::timelineInstant(Sim::TRACK_INPUT, g_pin_names.analog[index], value);
+    }
+    return value;
+}
+
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout) {
+    sprintf(sout, "%*.*f", width, prec, val);
+    return sout;
+}
+
+// --- Print ---
+
+size_t Print::print(long value, int base) {
+    if (base == DEC) {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "%ld", value);
+        return write(buffer);
+    }
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    char buffer[8 * sizeof(long) + 1];
+    char *str = &buffer[sizeof(buffer) - 1];
+    *str = '\0';
+    if (base < 2) {
+        base = DEC;
+    }
+    do {
+        const auto digit = static_cast<char>(value % static_cast<unsigned long>(base));
+        value /= static_cast<unsigned long>(base);
+        *--str = static_cast<char>(digit < 10 ? digit + '0' : digit + 'A' - 10);
+    } while (value);
+    return write(str);
+}
+
+size_t Print::print(double value, int digits) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+// --- Serial ---
+
+HardwareSerial Serial;
+
+int HardwareSerial::available() {
+    return static_cast<int>(g_serial_rx.size());
+}
+
+int HardwareSerial::read() {
+    if (g_serial_rx.empty()) {
+        return -1;
+    }
+    const auto value = g_serial_rx.front();
+    g_serial_rx.pop_front();
+    return value;
+}
+
+int HardwareSerial::peek() {
+    return g_serial_rx.empty() ? -1 : g_serial_rx.front();
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    if (g_serial_echo) {
+        putchar(c);
+    }
+    return 1;
+}
@@ -0,0 +1,328 @@
+#include "sim_io.h"
+#include "sim_timeline.h"
+
+#include <string.h>
+
+namespace {
+    // Datasheet execution times at fosc = 270 kHz, the same the driver waits for
+    constexpr uint16_t kCommandMicros = 37;
+    constexpr uint16_t kDataMicros = 41;
+    constexpr uint16_t kClearHomeMicros = 1520;
+    constexpr uint64_t kPowerOnMicros = 40000;  // Vcc rise to 4.5 V, counted from Sim::reset()
+    constexpr uint8_t kLineLength = 40;         // DDRAM characters per line in two-line mode
+    constexpr uint8_t kMaxGlyphs = 16;
+    constexpr uint64_t kFrameGapMicros = 5000;  // Bus pause that ends a frame on the timeline
+    constexpr char kUnknownGlyph[] = "\xEF\xBF\xBD";   // U+FFFD
+
+    // HD44780 controller state reachable over a write-only 4-bit bus
+    struct LcdState {
+        bool four_bit = false;      // Powers up in 8-bit mode
+        bool two_lines = false;
+        bool high_pending = false;  // High nibble latched, waiting for the low one
+        uint8_t high = 0;
+        bool increment = true;
+        bool entry_shift = false;   // Entry mode S: the display follows the address counter
+        bool display_on = false;
+        bool cursor_on = false;
+        bool blink = false;
+        uint8_t shift = 0;          // Display shift, in characters to the left
+        bool cgram = false;         // Data goes to CGRAM after a set-CGRAM-address
+        uint8_t address = 0;        // DDRAM or CGRAM address counter
+        uint64_t busy_until_us = kPowerOnMicros;
+        char ddram[0x80];
+        uint8_t cgram_data[64];
+        Sim::LcdStats stats;
+    };
+
+    struct Glyph {
+        uint8_t rows[8];
+        char utf8[5];
+    };
+
+    LcdState powerOnState() {
+        LcdState state;
+        memset(state.ddram, ' ', sizeof(state.ddram));
+        memset(state.cgram_data, 0, sizeof(state.cgram_data));
+        return state;
+    }
+
+    LcdState g_lcd = powerOnState();
+    char g_visible[2][16];
+
+    // Kept over lcdReset(), like a label on the display
+    Glyph g_glyphs[kMaxGlyphs];
+    uint8_t g_glyph_count = 0;
+    Sim::LcdObserver *g_observer = nullptr;
+
+    // Frame being clocked out, recorded on the timeline once it ends
+    struct Burst {
+        bool open = false;
+        uint64_t start_us = 0;
+        uint64_t end_us = 0;    // Execution end of the last byte
+        int32_t bytes = 0;
+    };
+    Burst g_burst;
+
+    void traceByte(uint64_t now, uint16_t micros) {
+        if (g_burst.open && now > g_burst.end_us + kFrameGapMicros) {
+            Sim::detail::lcdTimelineFlush();
+        }
+        if (!g_burst.open) {
+            g_burst.open = true;
+            g_burst.start_us = now;
+            g_burst.bytes = 0;
+        }
+        g_burst.end_us = now + micros;
+        ++g_burst.bytes;
+    }
+
+    void clearDdram() {
+        memset(g_lcd.ddram, ' ', sizeof(g_lcd.ddram));
+    }
+
+    // Two-line mode: line 1 is 0x00-0x27, line 2 is 0x40-0x67; one line: 0x00-0x4F
+    uint8_t stepAddress(uint8_t address, bool increment) {
+        if (!g_lcd.two_lines) {
+            if (increment) {
+                return address >= 0x4F ? 0x00 : static_cast<uint8_t>(address + 1);
+            }
+            return address == 0x00 ? 0x4F : static_cast<uint8_t>(address - 1);
+        }
+        if (increment) {
+            ++address;
+            if (address == 0x28) return 0x40;
+            if (address == 0x68) return 0x00;
+            return address;
+        }
+        if (address == 0x00) return 0x67;
+        if (address == 0x40) return 0x27;
+        return static_cast<uint8_t>(address - 1);
+    }
+
+    void shiftDisplay(bool left) {
+        g_lcd.shift = static_cast<uint8_t>((g_lcd.shift + (left ? 1 : kLineLength - 1)) % kLineLength);
+    }
+
+    uint16_t executeInstruction(uint8_t value) {
+        ++g_lcd.stats.commands;
+        if (value & 0x80) {
+            g_lcd.cgram = false;
+            g_lcd.address = value & 0x7F;
+        } else if (value & 0x40) {
+            g_lcd.cgram = true;
+            g_lcd.address = value & 0x3F;
+        } else if (value & 0x20) {
+            g_lcd.four_bit = (value & 0x10) == 0;
+            g_lcd.two_lines = (value & 0x08) != 0;
+        } else if (value & 0x10) {
+            // Cursor or display shift, leaves DDRAM alone
+            const bool right = (value & 0x04) != 0;
+            if (value & 0x08) {
+                shiftDisplay(!right);
+            } else {
+                g_lcd.address = stepAddress(g_lcd.address, right);
+            }
+        } else if (value & 0x08) {
+            g_lcd.display_on = (value & 0x04) != 0;
+            g_lcd.cursor_on = (value & 0x02) != 0;
+            g_lcd.blink = (value & 0x01) != 0;
+        } else if (value & 0x04) {
+            g_lcd.increment = (value & 0x02) != 0;
+            g_lcd.entry_shift = (value & 0x01) != 0;
+        } else if (value & 0x02) {
+            g_lcd.cgram = false;
+            g_lcd.address = 0;
+            g_lcd.shift = 0;
+            return kClearHomeMicros;
+        } else if (value == 0x01) {
+            clearDdram();
+            g_lcd.cgram = false;
+            g_lcd.address = 0;
+            g_lcd.shift = 0;
+            g_lcd.increment = true;
+            return kClearHomeMicros;
+        }
+        return kCommandMicros;
+    }
+
+    uint16_t writeData(uint8_t value) {
+        ++g_lcd.stats.data_bytes;
+        if (g_lcd.cgram) {
+            g_lcd.cgram_data[g_lcd.address & 0x3F] = value;
+            g_lcd.address = static_cast<uint8_t>((g_lcd.address + (g_lcd.increment ? 1 : -1)) & 0x3F);
+        } else {
+            g_lcd.ddram[g_lcd.address & 0x7F] = static_cast<char>(value);
+            g_lcd.address = stepAddress(g_lcd.address, g_lcd.increment);
+            if (g_lcd.entry_shift) {
+                shiftDisplay(g_lcd.increment);
+            }
+        }
+        return kDataMicros;
+    }
+
+    // DDRAM code shown at a visible position, blank while the display is off
+    uint8_t visibleCode(uint8_t row, uint8_t col) {
+        if (!g_lcd.display_on) {
+            return ' ';
+        }
+        if (!g_lcd.two_lines) {
+            return row ? ' ' : static_cast<uint8_t>(g_lcd.ddram[(g_lcd.shift + col) % 80]);
+        }
+        const uint8_t base = row ? 0x40 : 0x00;
+        return static_cast<uint8_t>(g_lcd.ddram[base + (g_lcd.shift + col) % kLineLength]);
+    }
+
+    // UTF-8 for a character code: ROM A00 for the fixed codes, registered glyphs for CGRAM
+    const char *codeText(uint8_t code, char (&ascii)[2]) {
+        if (code < 0x10) {
+            const uint8_t *rows = &g_lcd.cgram_data[(code & 0x07) * 8];
+            for (uint8_t i = 0; i < g_glyph_count; ++i) {
+                bool match = true;
+                for (uint8_t r = 0; r < 8 && match; ++r) {
+                    match = (rows[r] & 0x1F) == (g_glyphs[i].rows[r] & 0x1F);
+                }
+                if (match) {
+                    return g_glyphs[i].utf8;
+                }
+            }
+            return kUnknownGlyph;
+        }
+        switch (code) {
+            case 0x5C: return "\xC2\xA5";       // Yen sign in ROM A00
+            case 0x7E: return "\xE2\x86\x92";   // Right arrow
+            case 0x7F: return "\xE2\x86\x90";   // Left arrow
+            default: break;
+        }
+        if (code < 0x20 || code > 0x7F) {
+            return kUnknownGlyph;
+        }
+        ascii[0] = static_cast<char>(code);
+        ascii[1] = '\0';
+        return ascii;
+    }
+} // namespace
+
+namespace Sim
+{
+    void lcdWriteNibble(bool rs, uint8_t nibble) {
+        nibble &= 0x0F;
+        const uint64_t now = nowMicros();
+        ++g_lcd.stats.nibbles;
+        // A byte starts with the first nibble, the controller must be done with the last one
+        const bool starts_byte = !g_lcd.four_bit || !g_lcd.high_pending;
+        if (starts_byte && now < g_lcd.busy_until_us) {
+            ++g_lcd.stats.busy_violations;
+        }
+        uint8_t value;
+        if (!g_lcd.four_bit) {
+            // 8-bit mode: D0-D3 are not connected and read as 0
+            value = static_cast<uint8_t>(nibble << 4);
+        } else if (!g_lcd.high_pending) {
+            g_lcd.high = nibble;
+            g_lcd.high_pending = true;
+            return;
+        } else {
+            value = static_cast<uint8_t>((g_lcd.high << 4) | nibble);
+            g_lcd.high_pending = false;
+        }
+        const uint16_t micros = rs ? writeData(value) : executeInstruction(value);
+        g_lcd.stats.bus_micros += micros;
+        g_lcd.busy_until_us = now + micros;
+        if (timelineEnabled()) {
+            traceByte(now, micros);
+        }
+        if (g_observer != nullptr) {
+            g_observer->onLcdByte(now, rs, value);
+        }
+    }
+
+    const char *lcdRow(uint8_t row) {
+        row = row ? 1 : 0;
+        for (uint8_t col = 0; col < 16; ++col) {
+            g_visible[row][col] = static_cast<char>(visibleCode(row, col));
+        }
+        return g_visible[row];
+    }
+
+    size_t lcdRender(char *out, size_t size) {
+        if (size == 0) {
+            return 0;
+        }
+        size_t length = 0;
+        char ascii[2];
+        for (uint8_t row = 0; row < 2; ++row) {
+            for (uint8_t col = 0; col < 16; ++col) {
+                const char *text = codeText(visibleCode(row, col), ascii);
+                const size_t text_length = strlen(text);
+                if (length + text_length + 1 > size) {
+                    out[length] = '\0';
+                    return length;
+                }
+                memcpy(out + length, text, text_length);
+                length += text_length;
+            }
+            if (row == 0 && length + 2 <= size) {
+                out[length++] = '\n';
+            }
+        }
+        out[length] = '\0';
+        return length;
+    }
+
+    bool lcdRegisterGlyph(const uint8_t rows[8], const char *utf8) {
+        if (g_glyph_count == kMaxGlyphs || strlen(utf8) >= sizeof(Glyph::utf8)) {
+            return false;
+        }
+        Glyph &glyph = g_glyphs[g_glyph_count++];
+        memcpy(glyph.rows, rows, sizeof(glyph.rows));
+        strcpy(glyph.utf8, utf8);
+        return true;
+    }
+
+    void lcdClearGlyphs() {
+        g_glyph_count = 0;
+    }
+
+    LcdStatus lcdStatus() {
+        LcdStatus status;
+        status.display_on = g_lcd.display_on;
+        status.cursor_on = g_lcd.cursor_on;
+        status.blink = g_lcd.blink;
+        status.four_bit = g_lcd.four_bit;
+        status.two_lines = g_lcd.two_lines;
+        status.address = g_lcd.address;
+        status.cgram = g_lcd.cgram;
+        status.shift = g_lcd.shift;
+        return status;
+    }
+
+    const uint8_t *lcdCgram() {
+        return g_lcd.cgram_data;
+    }
+
+    void attachLcdObserver(LcdObserver *observer) {
+        g_observer = observer;
+    }
+
+    LcdStats lcdStats() {
+        return g_lcd.stats;
+    }
+
+    void lcdResetStats() {
+        g_lcd.stats = LcdStats{};
+    }
+
+    namespace detail
+    {
+        void lcdTimelineFlush() {
+            if (g_burst.open) {
+                timelineComplete(TRACK_LCD, "LCD frame", g_burst.start_us, g_burst.end_us, g_burst.bytes);
+                g_burst.open = false;
+            }
+        }
+    } // namespace detail
+
+    void lcdReset() {
+        g_lcd = powerOnState();
+    }
+} // namespace Sim
@@ -0,0 +1,118 @@
+#include "ArduinoLog.h"
+#include "DallasTemperature.h"
+#include "EEPROM.h"
+#include "sim_io.h"
+#include "sim_timeline.h"
+
+EEPROMClass EEPROM;
+Logging Log;
+
+// --- DallasTemperature ---
+
+uint8_t DallasTemperature::getDeviceCount() {
+    return Sim::isSensorConnected(one_wire_->pin()) ? 1 : 0;
+}
+
+bool DallasTemperature::getAddress(uint8_t *address, uint8_t index) {
+    if (index >= getDeviceCount()) {
+        return false;
+    }
+    // DS18B20 family code followed by a per-pin serial number
+    const uint8_t rom[8] = {0x28, one_wire_->pin(), 0, 0, 0, 0, 0, 0};
+    memcpy(address, rom, sizeof(rom));
+    return true;
+}
+
+void DallasTemperature::setResolution(uint8_t resolution) {
+    if (resolution < 9) {
+        resolution = 9;
+    } else if (resolution > 12) {
+        resolution = 12;
+    }
+    Sim::setSensorResolution(one_wire_->pin(), resolution);
+    // Writing the scratchpad is followed by a copy to the sensor EEPROM (10 ms)
+    delay(10);
+}
+
+uint8_t DallasTemperature::getResolution() const {
+    return Sim::sensorResolution(one_wire_->pin());
+}
+
+void DallasTemperature::requestTemperatures() {
+    if (wait_for_conversion_) {
+        Sim::timelineBegin(Sim::TRACK_SENSORS, "DS18B20 conversion", one_wire_->pin());
+        delay(millisToWaitForConversion());
+        Sim::timelineEnd(Sim::TRACK_SENSORS, "DS18B20 conversion");
+    } else {
+        // The sensor converts on its own while the caller goes on
+        const uint64_t now_us = Sim::nowMicros();
+        Sim::timelineComplete(Sim::TRACK_SENSORS, "DS18B20 conversion", now_us,
+                              now_us + 1000ULL * millisToWaitForConversion(), one_wire_->pin());
+    }
+}
+
+float DallasTemperature::getTempCByIndex(uint8_t index) {
+    if (index >= getDeviceCount()) {
+        return DEVICE_DISCONNECTED_C;
+    }
+    // Quantize to the configured resolution like the sensor does
+    const float step = 0.0625f * static_cast<float>(1U << (12U - getResolution()));
+    return step * floorf(Sim::sensorTemperature(one_wire_->pin()) / step + 0.5f);
+}
+
+// --- Logging ---
+
+namespace {
+    const char *levelName(int level) {
+        switch (level) {
+            case LOG_LEVEL_FATAL: return "F: ";
+            case LOG_LEVEL_ERROR: return "E: ";
+            case LOG_LEVEL_WARNING: return "W: ";
+            case LOG_LEVEL_NOTICE: return "N: ";
+            case LOG_LEVEL_TRACE: return "T: ";
+            case LOG_LEVEL_VERBOSE: return "V: ";
+            default: return "";
+        }
+    }
+} // namespace
+
+void Logging::printLevel(int level, bool newline, const char *format, va_list args) {
+    if (output_ == nullptr || level > level_) {
+        return;
+    }
+    if (show_level_) {
+        output_->print(levelName(level));
+    }
+    for (const char *c = format; *c; ++c) {
+        if (*c != '%') {
+            output_->print(*c);
+            continue;
+        }
+        // skip flags, width and the z modifier
+        do {
+            ++c;
+        } while (*c && (strchr("-+ #0123456789.z", *c) != nullptr));
+        switch (*c) {
+            case '\0': --c; break;
+            case 's':
+            case 'S': output_->print(va_arg(args, const char *)); break;
+            case 'c': output_->print(static_cast<char>(va_arg(args, int))); break;
+            case 'd':
+            case 'i': output_->print(va_arg(args, int)); break;
+            case 'l': output_->print(va_arg(args, long)); break;
+            case 'u': output_->print(va_arg(args, unsigned long)); break;
+            case 'x': output_->print(va_arg(args, unsigned int), HEX); break;
+            case 'X': output_->print("0x"); output_->print(va_arg(args, unsigned int), HEX); break;
+            case 'b': output_->print(va_arg(args, unsigned int), BIN); break;
+            case 't': output_->print(va_arg(args, int) ? 'T' : 'F'); break;
+            case 'T': output_->print(va_arg(args, int) ? "true" : "false"); break;
+            case 'f':
+            case 'F': output_->print(va_arg(args, double)); break;
+            case 'p': output_->print(reinterpret_cast<unsigned long>(va_arg(args, void *)), HEX); break;
+            default: output_->print(*c); break;
+        }
+    }
+    if (newline) {
+        output_->println();
+    }
+}
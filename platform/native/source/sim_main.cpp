@@ -0,0 +1,70 @@
+// Entry point of the host simulator firmware image. Kept in its own
+// translation unit so unit tests and host tools can provide their own main().
+#ifndef PIO_UNIT_TESTING
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Arduino.h"
+#include "sim_io.h"
+#include "sim_timeline.h"
+
+void setup();
+void loop();
+
+namespace {
+    constexpr size_t kDefaultTraceEvents = 1U << 18;
+    volatile sig_atomic_t g_stop = 0;
+
+    void requestStop(int) {
+        g_stop = 1;
+    }
+} // namespace
+
+int main() {
+    // POTATO_SIM_LOOPS limits the number of loop() passes, POTATO_SIM_REALTIME
+    // paces the virtual clock against the wall clock
+    const char *loops_env = getenv("POTATO_SIM_LOOPS");
+    const long loops = loops_env ? atol(loops_env) : -1;
+    Sim::setRealTime(getenv("POTATO_SIM_REALTIME") != nullptr);
+    // POTATO_SIM_MODBUS_PTY=path links path to a pty on the Modbus UART
+    const char *modbus_pty = getenv("POTATO_SIM_MODBUS_PTY");
+    if (modbus_pty != nullptr) {
+        Sim::openUartPty(modbus_pty);
+    }
+
+    // POTATO_SIM_TRACE=path records a timeline and writes it as Chrome
+    // trace-event JSON on exit or Ctrl-C, POTATO_SIM_TRACE_EVENTS sizes the ring
+    const char *trace_path = getenv("POTATO_SIM_TRACE");
+    if (trace_path != nullptr) {
+        const char *events_env = getenv("POTATO_SIM_TRACE_EVENTS");
+        const long events = events_env ? atol(events_env) : 0;
+        if (!Sim::timelineStart(events > 0 ? static_cast<size_t>(events) : kDefaultTraceEvents)) {
+            fprintf(stderr, "cannot allocate the timeline\n");
+            return 1;
+        }
+        signal(SIGINT, requestStop);
+        signal(SIGTERM, requestStop);
+    }
+
+    setup();
+    for (long i = 0; (loops < 0 || i < loops) && !g_stop; ++i) {
+        loop();
+        if (Sim::takeRebootRequest()) {
+            Sim::reset();
+            setup();
+        }
+    }
+    if (trace_path != nullptr) {
+        Sim::timelineStop();
+        if (!Sim::timelineWriteJson(trace_path)) {
+            fprintf(stderr, "cannot write %s\n", trace_path);
+            return 1;
+        }
+        fprintf(stderr, "timeline: %zu events in %s, %llu overwritten\n", Sim::timelineSize(), trace_path,
+                static_cast<unsigned long long>(Sim::timelineOverwritten()));
+    }
+    return 0;
+}
+
+#endif  // PIO_UNIT_TESTING
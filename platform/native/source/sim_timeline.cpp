@@ -0,0 +1,196 @@
+#include "sim_timeline.h"
+#include "sim_io.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace {
+    struct Event {
+        uint64_t ts_us;
+        uint32_t dur_us;
+        int32_t value;
+        const char *name;
+        char phase;             // 'B', 'E', 'i' or 'X' as in the trace-event format
+        uint8_t track;
+    };
+
+    const char *const kTrackNames[Sim::TRACK_COUNT] = {
+        "loop", "sensors", "eeprom", "lcd", "input", "gpio",
+    };
+
+    Event *g_ring = nullptr;
+    size_t g_capacity = 0;
+    size_t g_head = 0;          // Next slot to write
+    size_t g_size = 0;
+    uint64_t g_overwritten = 0;
+    uint64_t g_offset_us = 0;   // Virtual time before the last Sim::reset() while recording
+    uint16_t g_depth[Sim::TRACK_COUNT] = {};
+
+    uint64_t now() {
+        return g_offset_us + Sim::nowMicros();
+    }
+
+    void push(const Event &event) {
+        g_ring[g_head] = event;
+        g_head = (g_head + 1) % g_capacity;
+        if (g_size < g_capacity) {
+            ++g_size;
+        } else {
+            ++g_overwritten;
+        }
+    }
+
+    void writeName(FILE *out, const char *name) {
+        fputc('"', out);
+        for (const char *c = name; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                fputc('\\', out);
+            }
+            fputc(*c, out);
+        }
+        fputc('"', out);
+    }
+
+    void writeEvent(FILE *out, const Event &event) {
+        fputs(",\n{\"name\":", out);
+        writeName(out, event.name);
+        fprintf(out, ",\"ph\":\"%c\",\"ts\":%llu,\"pid\":1,\"tid\":%u", event.phase,
+                static_cast<unsigned long long>(event.ts_us), static_cast<unsigned>(event.track));
+        if (event.phase == 'X') {
+            fprintf(out, ",\"dur\":%lu", static_cast<unsigned long>(event.dur_us));
+        } else if (event.phase == 'i') {
+            fputs(",\"s\":\"t\"", out);
+        }
+        if (event.phase != 'E' || event.value != 0) {
+            fprintf(out, ",\"args\":{\"value\":%ld}", static_cast<long>(event.value));
+        }
+        fputc('}', out);
+    }
+} // namespace
+
+namespace Sim
+{
+    namespace detail
+    {
+        bool timeline_enabled = false;
+
+        void timelineRecord(char phase, TimelineTrack track, const char *name, int32_t value) {
+            if (phase == 'E') {
+                if (g_depth[track] == 0) {
+                    return;
+                }
+                --g_depth[track];
+            } else if (phase == 'B') {
+                ++g_depth[track];
+            }
+            push(Event{now(), 0, value, name, phase, track});
+        }
+
+        void timelineOnReset() {
+            if (!timeline_enabled) {
+                return;
+            }
+            lcdTimelineFlush();
+            // Slices open at the reset end there, the firmware starts over
+            for (uint8_t track = 0; track < TRACK_COUNT; ++track) {
+                while (g_depth[track] > 0) {
+                    timelineRecord('E', static_cast<TimelineTrack>(track), "", 0);
+                }
+            }
+            timelineRecord('i', TRACK_LOOP, "reset", 0);
+            g_offset_us += nowMicros();
+        }
+    } // namespace detail
+
+    void timelineComplete(TimelineTrack track, const char *name, uint64_t start_us, uint64_t end_us, int32_t value) {
+        if (!detail::timeline_enabled) {
+            return;
+        }
+        const uint32_t dur_us = end_us > start_us ? static_cast<uint32_t>(end_us - start_us) : 0;
+        push(Event{g_offset_us + start_us, dur_us, value, name, 'X', track});
+    }
+
+    bool timelineStart(size_t capacity) {
+        timelineStop();
+        delete[] g_ring;
+        g_ring = capacity > 0 ? new (std::nothrow) Event[capacity] : nullptr;
+        g_capacity = g_ring != nullptr ? capacity : 0;
+        g_head = g_size = 0;
+        g_overwritten = 0;
+        g_offset_us = 0;
+        std::fill(g_depth, g_depth + TRACK_COUNT, 0);
+        detail::timeline_enabled = g_ring != nullptr;
+        return detail::timeline_enabled;
+    }
+
+    void timelineStop() {
+        if (detail::timeline_enabled) {
+            detail::lcdTimelineFlush();
+        }
+        detail::timeline_enabled = false;
+    }
+
+    size_t timelineSize() {
+        return g_size;
+    }
+
+    uint64_t timelineOverwritten() {
+        return g_overwritten;
+    }
+
+    bool timelineWriteJson(FILE *out) {
+        if (detail::timeline_enabled) {
+            detail::lcdTimelineFlush();
+        }
+        // Oldest first; an end whose begin was overwritten is dropped
+        std::vector<Event> events;
+        events.reserve(g_size + TRACK_COUNT);
+        uint16_t depth[TRACK_COUNT] = {};
+        for (size_t i = 0; i < g_size; ++i) {
+            const Event &event = g_ring[(g_head + g_capacity - g_size + i) % g_capacity];
+            if (event.phase == 'B') {
+                ++depth[event.track];
+            } else if (event.phase == 'E') {
+                if (depth[event.track] == 0) {
+                    continue;
+                }
+                --depth[event.track];
+            }
+            events.push_back(event);
+        }
+        // Slices still open end at the export
+        const uint64_t end_us = events.empty() ? 0 : std::max(now(), events.back().ts_us);
+        for (uint8_t track = 0; track < TRACK_COUNT; ++track) {
+            for (; depth[track] > 0; --depth[track]) {
+                events.push_back(Event{end_us, 0, 0, "", 'E', track});
+            }
+        }
+        // Frames are recorded when they end, the viewers want time order
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event &a, const Event &b) { return a.ts_us < b.ts_us; });
+
+        fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+        fputs("\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"firmware (host simulator)\"}}", out);
+        for (uint8_t track = 0; track < TRACK_COUNT; ++track) {
+            fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    static_cast<unsigned>(track), kTrackNames[track]);
+            fprintf(out, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}",
+                    static_cast<unsigned>(track), static_cast<unsigned>(track));
+        }
+        for (const Event &event : events) {
+            writeEvent(out, event);
+        }
+        fputs("\n]}\n", out);
+        return ferror(out) == 0;
+    }
+
+    bool timelineWriteJson(const char *path) {
+        FILE *out = fopen(path, "w");
+        if (out == nullptr) {
+            return false;
+        }
+        const bool written = timelineWriteJson(out);
+        return fclose(out) == 0 && written;
+    }
+} // namespace Sim
@@ -0,0 +1,85 @@
+// Second simulated UART, used as the Modbus RTU port. With a pty attached a
+// Modbus master (or any serial tool) on the host talks to the firmware.
+#include "sim_io.h"
+
+#include <deque>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace {
+    std::deque<uint8_t> g_uart_rx;
+    std::deque<uint8_t> g_uart_tx;
+    int g_pty_fd = -1;
+
+    void pollPty() {
+        if (g_pty_fd < 0) {
+            return;
+        }
+        uint8_t buffer[64];
+        ssize_t received;
+        while ((received = ::read(g_pty_fd, buffer, sizeof(buffer))) > 0) {
+            g_uart_rx.insert(g_uart_rx.end(), buffer, buffer + received);
+        }
+    }
+} // namespace
+
+namespace Sim
+{
+    bool openUartPty(const char *link_path) {
+        const int fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+            perror("sim: pty");
+            return false;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        const char *slave = ptsname(fd);
+        if (link_path != nullptr && *link_path != '\0') {
+            unlink(link_path);
+            if (symlink(slave, link_path) != 0) {
+                perror("sim: pty link");
+            }
+        }
+        fprintf(stderr, "sim: Modbus UART on %s\n", slave);
+        g_pty_fd = fd;
+        return true;
+    }
+
+    void injectUart(const uint8_t *data, size_t size) {
+        g_uart_rx.insert(g_uart_rx.end(), data, data + size);
+    }
+
+    size_t uartAvailable() {
+        pollPty();
+        return g_uart_rx.size();
+    }
+
+    int uartRead() {
+        pollPty();
+        if (g_uart_rx.empty()) {
+            return -1;
+        }
+        const auto value = g_uart_rx.front();
+        g_uart_rx.pop_front();
+        return value;
+    }
+
+    size_t uartWrite(const uint8_t *data, size_t size) {
+        if (g_pty_fd >= 0) {
+            const ssize_t written = ::write(g_pty_fd, data, size);
+            return written > 0 ? static_cast<size_t>(written) : 0;
+        }
+        g_uart_tx.insert(g_uart_tx.end(), data, data + size);
+        return size;
+    }
+
+    size_t takeUartOutput(uint8_t *out, size_t size) {
+        size_t taken = 0;
+        while (taken < size && !g_uart_tx.empty()) {
+            out[taken++] = g_uart_tx.front();
+            g_uart_tx.pop_front();
+        }
+        return taken;
+    }
+} // namespace Sim
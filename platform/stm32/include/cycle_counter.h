@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>  // CMSIS core registers
+
+namespace HAL
+{
+    /// Exact CPU cycle counter for benchmarks, Cortex-M3 DWT CYCCNT
+    class CycleCounter {
+    public:
+        static constexpr const char* kUnit = "cycles";
+
+        static void begin() {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CYCCNT = 0;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        }
+
+        static void end() {
+        }
+
+        static uint32_t now() {
+            return DWT->CYCCNT;
+        }
+    };
+} // namespace HAL
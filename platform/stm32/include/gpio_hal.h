@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>  // Include Arduino library for pin manipulation
+
+#include "gpio_hal_interface.h"
+#include "project_pin_definition.h"
+
+namespace HAL
+{
+    class Stm32Gpio : public GpioInterface<Stm32Gpio> {
+    public:
+        static constexpr uint16_t kAdcMax = 1023U;  // STM32duino defaults analogRead() to 10 bits
+
+        static bool init() {
+            // Initialize GPIO pins here
+            pinMode(KEYPAD_ANALOG_BUTTON_PIN, INPUT_ANALOG);
+            pinMode(RELAY_PIN, OUTPUT);
+            pinMode(LCD_BACKLIGHT_PIN, OUTPUT);
+
+            // Set digital button pins as inputs
+            pinMode(BEFORE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(SELECT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(NEXT_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(INCREASE_BUTTON_PIN, INPUT_PULLUP);
+            pinMode(DECREASE_BUTTON_PIN, INPUT_PULLUP);
+
+            return true;  // Return true if initialization is successful
+        }
+
+        static void writeRelay(bool state) {
+            // digitalWriteFast() resolves the port at compile time for constant pins
+            digitalWriteFast(digitalPinToPinName(RELAY_PIN), state ? HIGH : LOW);
+        }
+
+        static void writeBacklight(bool state) {
+            digitalWriteFast(digitalPinToPinName(LCD_BACKLIGHT_PIN), state ? HIGH : LOW);
+        }
+
+        static bool readPinActive(uint16_t pin) {
+            // Assuming active low logic for buttons
+            return digitalRead(pin) == LOW;
+        }
+
+        static uint16_t readKeypadAnalog() {
+            return static_cast<uint16_t>(analogRead(KEYPAD_ANALOG_BUTTON_PIN));
+        }
+
+        static void initLcdBus() {
+            pinMode(LCD_RS_PIN, OUTPUT);
+            pinMode(LCD_EN_PIN, OUTPUT);
+            pinMode(LCD_D4_PIN, OUTPUT);
+            pinMode(LCD_D5_PIN, OUTPUT);
+            pinMode(LCD_D6_PIN, OUTPUT);
+            pinMode(LCD_D7_PIN, OUTPUT);
+            if (LCD_RW_PIN != PIN_NOT_WIRED) {
+                pinMode(LCD_RW_PIN, OUTPUT);
+                digitalWrite(LCD_RW_PIN, LOW);
+            }
+            digitalWriteFast(digitalPinToPinName(LCD_EN_PIN), LOW);
+        }
+
+        static void writeLcdNibble(bool rs, uint8_t nibble) {
+            digitalWriteFast(digitalPinToPinName(LCD_RS_PIN), rs ? HIGH : LOW);
+            digitalWriteFast(digitalPinToPinName(LCD_D4_PIN), (nibble & 0x01U) ? HIGH : LOW);
+            digitalWriteFast(digitalPinToPinName(LCD_D5_PIN), (nibble & 0x02U) ? HIGH : LOW);
+            digitalWriteFast(digitalPinToPinName(LCD_D6_PIN), (nibble & 0x04U) ? HIGH : LOW);
+            digitalWriteFast(digitalPinToPinName(LCD_D7_PIN), (nibble & 0x08U) ? HIGH : LOW);
+            // Enable pulse width >= 450 ns (datasheet PW_EH)
+            digitalWriteFast(digitalPinToPinName(LCD_EN_PIN), HIGH);
+            delayMicroseconds(1);
+            digitalWriteFast(digitalPinToPinName(LCD_EN_PIN), LOW);
+        }
+    };
+
+    using Gpio = Stm32Gpio;
+} // namespace HAL
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace HAL
+{
+    /// Periodic tick clocking the LCD transmit queue, TIM3 update interrupt
+    class LcdTxTimer {
+    public:
+        using Callback = void (*)();
+
+        static void begin(uint16_t period_us, Callback callback);
+        static void start();
+        static void stop();
+    };
+} // namespace HAL
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include "memory_usage.h"
+
+namespace HAL
+{
+    /**
+     * RAM use of the STM32F103 (20 KB). The C runtime runs before any user
+     * code, so setup() paints from the heap end to just below its own stack
+     * frame; the high-water mark covers everything from setup() on.
+     */
+    class Memory {
+    public:
+        static constexpr uint8_t kPaint = 0xC5;
+
+        /// Call first thing in setup()
+        static void paintStack();
+
+        /// Painted bytes above the heap the stack never reached, the least free RAM so far
+        static uint16_t unusedStackBytes();
+
+        static MemoryUsage usage();
+    };
+} // namespace HAL
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "project_pin_definition.h"
+
+namespace HAL
+{
+    /**
+     * UART and RS-485 driver enable of the Modbus RTU slave.
+     *
+     * USART1 (PA9 TX, PA10 RX) is free while the log port is the USB CDC
+     * Serial. RX and TX are buffered by the core's USART interrupts.
+     */
+    class ModbusPort {
+    public:
+        static constexpr bool kSharesLogPort = false;
+
+        static void begin(uint32_t baud) {
+            pinMode(MODBUS_DE_PIN, OUTPUT);
+            setTransmit(false);
+            Serial1.begin(baud);
+        }
+
+        static int available() { return Serial1.available(); }
+        static int read() { return Serial1.read(); }
+        static int availableForWrite() { return Serial1.availableForWrite(); }
+        static size_t write(const uint8_t* data, size_t size) { return Serial1.write(data, size); }
+
+        static void setTransmit(bool enabled) {
+            digitalWriteFast(digitalPinToPinName(MODBUS_DE_PIN), enabled ? HIGH : LOW);
+        }
+    };
+} // namespace HAL
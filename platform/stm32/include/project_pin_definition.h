@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+
+constexpr auto PIN_NOT_WIRED        = 0xFFU; // Marks an optional signal that is not connected
+
+// Blue Pill (STM32F103C8) wiring
+
+// DS18B20
+constexpr auto EXTERNAL_DS18B20_PIN = PB13; // Pin for external DS18B20 sensor
+constexpr auto INTERNAL_DS18B20_PIN = PB14; // Pin for internal DS18B20 sensor
+
+// LCD Display
+constexpr auto LCD_RS_PIN           = PB10; // Register Select pin for LCD
+constexpr auto LCD_EN_PIN           = PB11; // Enable pin for LCD
+constexpr auto LCD_D4_PIN           = PB5;  // Data pin D4 for LCD
+constexpr auto LCD_D5_PIN           = PB6;  // Data pin D5 for LCD
+constexpr auto LCD_D6_PIN           = PB7;  // Data pin D6 for LCD
+constexpr auto LCD_D7_PIN           = PB8;  // Data pin D7 for LCD
+constexpr auto LCD_BACKLIGHT_PIN    = PB9;  // Backlight pin for LCD
+constexpr auto LCD_RW_PIN           = PIN_NOT_WIRED;    // RW tied to GND, no busy flag
+
+// Analog button
+constexpr auto KEYPAD_ANALOG_BUTTON_PIN    = PA0;  // Analog pin for button input
+
+// Digital pins
+constexpr auto SELECT_BUTTON_PIN    = PA1;  // Select button pin
+constexpr auto DECREASE_BUTTON_PIN  = PA2;  // Decrease button pin
+constexpr auto INCREASE_BUTTON_PIN  = PA3;  // Increase button pin
+constexpr auto BEFORE_BUTTON_PIN    = PA4;  // Before button pin
+constexpr auto NEXT_BUTTON_PIN      = PA5;  // Next button pin
+
+// Relay control
+constexpr auto RELAY_PIN            = PB15; // Pin for relay control
+
+// Modbus RTU (RS-485 transceiver driver enable, high while transmitting)
+constexpr auto MODBUS_DE_PIN        = PA8;  // RS-485 DE/RE pin
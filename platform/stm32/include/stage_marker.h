@@ -0,0 +1,16 @@
+#pragma once
+
+#include "loop_stages.h"
+
+namespace HAL
+{
+    /// Stage markers feed the simavr bench of the AVR build only
+    class StageMarker {
+    public:
+        static void stage(LoopStage::Stage) {
+        }
+
+        static void commit(LoopStage::Commit) {
+        }
+    };
+} // namespace HAL
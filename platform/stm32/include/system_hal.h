@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>  // CMSIS core functions
+
+namespace HAL
+{
+    class System {
+    public:
+        /// Restart the MCU through the Cortex-M system reset request
+        [[noreturn]] static void reboot() {
+            NVIC_SystemReset();
+            for (;;) {
+            }
+        }
+    };
+} // namespace HAL
@@ -0,0 +1,33 @@
+#include "lcd_tx_timer.h"
+
+#include <Arduino.h>
+#include <HardwareTimer.h>
+
+namespace {
+    HardwareTimer *tx_timer = nullptr;
+    volatile bool running = false;
+} // namespace
+
+void HAL::LcdTxTimer::begin(uint16_t period_us, Callback callback) {
+    if (tx_timer == nullptr) {
+        tx_timer = new HardwareTimer(TIM3);     // Allocated once at boot
+    }
+    tx_timer->pause();
+    tx_timer->setOverflow(period_us, MICROSEC_FORMAT);
+    tx_timer->attachInterrupt(callback);
+    running = false;
+}
+
+void HAL::LcdTxTimer::start() {
+    if (!running && tx_timer != nullptr) {
+        running = true;
+        tx_timer->resume();
+    }
+}
+
+void HAL::LcdTxTimer::stop() {
+    if (running && tx_timer != nullptr) {
+        running = false;
+        tx_timer->pause();
+    }
+}
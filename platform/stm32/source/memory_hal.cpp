@@ -0,0 +1,56 @@
+#include "memory_hal.h"
+
+#include <Arduino.h>    // CMSIS core functions
+#include <unistd.h>     // sbrk()
+
+// Linker script symbols
+extern "C" {
+    extern char _sdata;
+    extern char _edata;
+    extern char _sbss;
+    extern char _ebss;
+    extern char _estack;
+}
+
+namespace {
+    constexpr uint16_t kPaintMargin = 64;   // Left alone below the stack pointer: paintStack() and interrupts
+
+    char* heapEnd() {
+        return static_cast<char*>(sbrk(0));
+    }
+
+    char* stackPointer() {
+        return reinterpret_cast<char*>(__get_MSP());
+    }
+} // namespace
+
+void HAL::Memory::paintStack() {
+    char* const limit = stackPointer() - kPaintMargin;
+    for (char* p = heapEnd(); p < limit; ++p) {
+        *p = static_cast<char>(kPaint);
+    }
+}
+
+uint16_t HAL::Memory::unusedStackBytes() {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(heapEnd());
+    const uint8_t* const stack = reinterpret_cast<const uint8_t*>(stackPointer());
+    uint16_t count = 0;
+    while (p < stack && *p == kPaint) {
+        ++p;
+        ++count;
+    }
+    return count;
+}
+
+MemoryUsage HAL::Memory::usage() {
+    const char* const heap_end = heapEnd();
+    MemoryUsage usage;
+    usage.total = static_cast<uint16_t>(&_estack - &_sdata);
+    usage.data = static_cast<uint16_t>(&_edata - &_sdata);
+    usage.bss = static_cast<uint16_t>(&_ebss - &_sbss);
+    usage.heap = static_cast<uint16_t>(heap_end - &_ebss);
+    usage.free = static_cast<uint16_t>(stackPointer() - heap_end);
+    usage.unused = unusedStackBytes();
+    usage.stack_peak = static_cast<uint16_t>(&_estack - (heap_end + usage.unused));
+    return usage;
+}
@@ -0,0 +1,50 @@
+#ifdef ENABLE_BENCHMARKS
+
+// Formatter benchmarks: NumberFormat against dtostrf()/snprintf().
+// Flash cost comes from the linker map written by env:uno_bench, e.g.
+//   avr-nm -C --size-sort -S .pio/build/uno_bench/firmware.elf | grep -E "NumberFormat|dtostrf|dtoa|vfprintf"
+
+#include "benchmarks.h"
+#include "log.h"
+#include "number_format.h"
+
+#include <stdio.h>
+
+namespace {
+    constexpr uint16_t kIterations = 200;
+
+    // volatile input keeps the compiler from folding the formatted value
+    volatile int32_t g_tenths = -125;
+    volatile float g_value = -12.5f;
+    char g_buffer[16];
+
+    void report(const __FlashStringHelper* name, uint32_t cost) {
+        LOG_NOTICE("Bench %S: %l %s/op (%s)", name, static_cast<long>(cost), HAL::CycleCounter::kUnit, g_buffer);
+    }
+} // namespace
+
+void Bench::runBenchmarks() {
+    HAL::CycleCounter::begin();
+
+    NumberFormat::Spec fixed_spec;
+    fixed_spec.decimals = 1;
+    report(F("formatFixed"), measure([&] {
+        NumberFormat::formatFixed(g_buffer, sizeof(g_buffer), g_tenths, fixed_spec);
+    }, kIterations));
+    report(F("formatFloat"), measure([&] {
+        NumberFormat::formatFloat(g_buffer, sizeof(g_buffer), g_value, fixed_spec);
+    }, kIterations));
+    report(F("dtostrf"), measure([] {
+        dtostrf(g_value, 2, 1, g_buffer);
+    }, kIterations));
+    report(F("formatInteger"), measure([] {
+        NumberFormat::formatInteger(g_buffer, sizeof(g_buffer), g_tenths);
+    }, kIterations));
+    report(F("snprintf %d"), measure([] {
+        snprintf(g_buffer, sizeof(g_buffer), "%d", static_cast<int>(g_tenths));
+    }, kIterations));
+
+    HAL::CycleCounter::end();
+}
+
+#endif  // ENABLE_BENCHMARKS
@@ -0,0 +1,35 @@
+#include "boot_profile.h"
+
+namespace {
+    const char kSerialName[] PROGMEM = "serial";
+    const char kGpioName[] PROGMEM = "gpio";
+    const char kSensorsName[] PROGMEM = "sensors";
+    const char kLcdName[] PROGMEM = "lcd";
+    const char kSettingsName[] PROGMEM = "settings";
+    const char kLinksName[] PROGMEM = "links";
+    const char kFirstDecisionName[] PROGMEM = "first decision";
+
+    const char* const kNames[BootProfile::STEP_COUNT] PROGMEM = {
+        kSerialName, kGpioName, kSensorsName, kLcdName, kSettingsName, kLinksName, kFirstDecisionName
+    };
+} // namespace
+
+uint32_t BootProfile::stepMicros(Step step) const {
+    if (!marked(step)) {
+        return 0;
+    }
+    uint32_t start_us = 0;
+    for (uint8_t previous = step; previous > 0; --previous) {
+        if (marked(static_cast<Step>(previous - 1))) {
+            start_us = end_us_[previous - 1];
+            break;
+        }
+    }
+    return end_us_[step] - start_us;
+}
+
+const __FlashStringHelper* BootProfile::name(Step step) {
+    const char* text;
+    memcpy_P(&text, &kNames[step < STEP_COUNT ? step : STEP_COUNT - 1], sizeof(text));
+    return reinterpret_cast<const __FlashStringHelper*>(text);
+}
@@ -0,0 +1,57 @@
+#include "cobs.h"
+
+namespace Cobs
+{
+    size_t encode(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) {
+        if (out == nullptr || out_size < maxEncodedSize(size)) {
+            return 0;
+        }
+        size_t code_index = 0;      // Where the length code of the current block goes
+        size_t write_index = 1;
+        uint8_t code = 1;
+        for (size_t i = 0; i < size; ++i) {
+            if (data[i] == 0) {
+                out[code_index] = code;
+                code_index = write_index++;
+                code = 1;
+                continue;
+            }
+            out[write_index++] = data[i];
+            if (++code == 0xFF) {
+                out[code_index] = code;
+                code_index = write_index++;
+                code = 1;
+            }
+        }
+        out[code_index] = code;
+        return write_index;
+    }
+
+    size_t decode(const uint8_t* data, size_t size, uint8_t* out, size_t out_size) {
+        if (out == nullptr) {
+            return 0;
+        }
+        size_t read_index = 0;
+        size_t write_index = 0;
+        while (read_index < size) {
+            const uint8_t code = data[read_index++];
+            if (code == 0 || read_index + code - 1U > size) {
+                return 0;
+            }
+            for (uint8_t i = 1; i < code; ++i) {
+                if (write_index >= out_size) {
+                    return 0;
+                }
+                out[write_index++] = data[read_index++];
+            }
+            // Every block but a full one or the last stands for a zero
+            if (code != 0xFF && read_index < size) {
+                if (write_index >= out_size) {
+                    return 0;
+                }
+                out[write_index++] = 0;
+            }
+        }
+        return write_index;
+    }
+} // namespace Cobs
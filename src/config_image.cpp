@@ -0,0 +1,98 @@
+#include "config_image.h"
+#include "settings_registry.h"
+#include "persistence_manager_instance.h"
+#include "log.h"
+
+#include <CRC32.h>
+
+namespace {
+    uint32_t imageCrc(const uint8_t* data, size_t size) {
+        CRC32 crc;
+        crc.add(data, static_cast<uint16_t>(size));
+        return crc.calc();
+    }
+
+    uint32_t getU32(const uint8_t* in) {
+        return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+               (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+    }
+} // namespace
+
+namespace ConfigImage
+{
+    size_t exportImage(uint8_t* out, size_t size) {
+        if (size < kHeaderSize + kCrcSize) {
+            return 0;
+        }
+        out[0] = kMagic[0];
+        out[1] = kMagic[1];
+        out[2] = kVersion;
+        uint8_t count = 0;
+        size_t offset = kHeaderSize;
+        Settings::Descriptor descriptor;
+        for (size_t i = 0; i < Settings::count(); ++i) {
+            Settings::load(i, descriptor);
+            if (descriptor.type != Settings::Type::Number) {
+                continue;
+            }
+            if (count == kMaxEntries || offset + kEntrySize + kCrcSize > size) {
+                return 0;
+            }
+            const auto value = static_cast<uint16_t>(Settings::readPersisted(descriptor));
+            out[offset] = static_cast<uint8_t>(descriptor.field);
+            out[offset + 1] = descriptor.decimals;
+            out[offset + 2] = static_cast<uint8_t>(value);
+            out[offset + 3] = static_cast<uint8_t>(value >> 8);
+            offset += kEntrySize;
+            ++count;
+        }
+        out[3] = count;
+        const uint32_t crc = imageCrc(out, offset);
+        for (uint8_t i = 0; i < kCrcSize; ++i) {
+            out[offset++] = static_cast<uint8_t>(crc >> (8 * i));
+        }
+        return offset;
+    }
+
+    Result importImage(const uint8_t* image, size_t size) {
+        if (size < kHeaderSize + kCrcSize || size > kMaxSize ||
+            size != kHeaderSize + image[3] * kEntrySize + kCrcSize) {
+            return RESULT_BAD_SIZE;
+        }
+        if (imageCrc(image, size - kCrcSize) != getU32(image + size - kCrcSize)) {
+            return RESULT_BAD_CRC;
+        }
+        if (image[0] != kMagic[0] || image[1] != kMagic[1] || image[2] != kVersion) {
+            return RESULT_BAD_HEADER;
+        }
+
+        // Validate every entry before the first write
+        const uint8_t count = image[3];
+        Settings::Descriptor descriptors[kMaxEntries];
+        int16_t values[kMaxEntries];
+        for (uint8_t i = 0; i < count; ++i) {
+            const uint8_t* entry = image + kHeaderSize + i * kEntrySize;
+            if (!Settings::find(static_cast<PersistenceField>(entry[0]), descriptors[i])) {
+                return RESULT_UNKNOWN_FIELD;
+            }
+            for (uint8_t j = 0; j < i; ++j) {
+                if (descriptors[j].field == descriptors[i].field) {
+                    return RESULT_UNKNOWN_FIELD;
+                }
+            }
+            values[i] = static_cast<int16_t>(entry[2] | (entry[3] << 8));
+            if (entry[1] != descriptors[i].decimals || Settings::clamp(descriptors[i], values[i]) != values[i]) {
+                return RESULT_BAD_VALUE;
+            }
+        }
+
+        PersistenceManager* persistence = getPersistenceManagerInstance();
+        persistence->beginTransaction();
+        for (uint8_t i = 0; i < count; ++i) {
+            Settings::writePersisted(descriptors[i], values[i]);
+        }
+        persistence->commitTransaction();
+        LOG_INFO("Configuration image with %d settings applied", count);
+        return RESULT_OK;
+    }
+} // namespace ConfigImage
@@ -0,0 +1,55 @@
+#include "display_view_model.h"
+
+#include <math.h>
+
+void DisplayViewModel::setExternalTemperature(float temp) {
+    const int16_t quantized = quantize(temp);
+    if (quantized != external_temp_) {
+        external_temp_ = quantized;
+        dirty_ |= FIELD_EXTERNAL_TEMP;
+    }
+}
+
+void DisplayViewModel::setInternalTemperature(float temp) {
+    const int16_t quantized = quantize(temp);
+    if (quantized != internal_temp_) {
+        internal_temp_ = quantized;
+        dirty_ |= FIELD_INTERNAL_TEMP;
+    }
+}
+
+void DisplayViewModel::setFanState(bool state) {
+    if (state != is_fan_on_) {
+        is_fan_on_ = state;
+        dirty_ |= FIELD_FAN_STATE;
+    }
+}
+
+uint8_t DisplayViewModel::takeDirty() {
+    const uint8_t dirty = dirty_;
+    dirty_ = FIELD_NONE;
+    return dirty;
+}
+
+void DisplayViewModel::countFrame(bool rendered) {
+    if (rendered) {
+        ++frame_stats_.rendered;
+    } else {
+        ++frame_stats_.skipped;
+    }
+}
+
+int16_t DisplayViewModel::quantize(float temp) {
+    if (isnan(temp)) {
+        return kNoReading;
+    }
+    const float scaled = temp * static_cast<float>(kTemperatureScale);
+    // Clamp out-of-range values instead of overflowing, kNoReading stays reserved
+    if (scaled >= 32767.0f) {
+        return 32767;
+    }
+    if (scaled <= -32767.0f) {
+        return -32767;
+    }
+    return static_cast<int16_t>(lroundf(scaled));
+}
@@ -12,23 +12,23 @@ namespace GPIO {
         // Initialize GPIO pins here
         // For example, set pin modes, initialize relays, etc.
         LOG_INFO("GPIO initialization started");
-        const auto result = HAL::initGPIO();
+        const auto result = HAL::Gpio::initGPIO();
         LOG_INFO("GPIO initialization completed %s", result ? "success" : "failure");
         return result;  // Return true if initialization is successful
     }
 
     void setRelay(bool state) {
         LOG_INFO("Setting relay to %s", state ? "ON" : "OFF");
-        HAL::setRelay(state);
+        HAL::Gpio::setRelay(state);
     }
 
     void setBacklight(bool state) {
         LOG_INFO("Setting backlight to %s", state ? "ON" : "OFF");
-        HAL::setBacklight(state);
+        HAL::Gpio::setBacklight(state);
     }
 
     bool isButtonActive(uint16_t buttonPin) {
-        const auto result = HAL::isButtonPressed(buttonPin);
+        const auto result = HAL::Gpio::isButtonPressed(buttonPin);
         LOG_DEBUG("Checking if button on pin %d is pressed: %s", buttonPin, result ? "YES" : "NO");
         return result;
     }
@@ -55,13 +55,13 @@ namespace GPIO {
                 exit(1);
             }
             trackedPins[trackedCount]    = buttonPin;
-            lastStates[trackedCount]     = HAL::isButtonPressed(buttonPin);
+            lastStates[trackedCount]     = HAL::Gpio::isButtonPressed(buttonPin);
             lastTimestamps[trackedCount] = millis();
             ++trackedCount;
         }
 
         // read current state
-        bool    currentState = HAL::isButtonPressed(buttonPin);
+        bool    currentState = HAL::Gpio::isButtonPressed(buttonPin);
         bool    risingEdge   = currentState && !lastStates[index];
         uint32_t now         = millis();
 
@@ -86,69 +86,66 @@ namespace GPIO {
         return debouncedPress;
     }
 
+    namespace {
+        constexpr uint16_t KEYPAD_RELEASE_MS = 20;  // Longer than the contact bounce of the keys
+
+        uint8_t keypadDown = 0;         // Keys pressed and not released since
+        uint8_t keypadReleasing = 0;    // Down keys reading released, since keypadReleasedAt
+        uint8_t keypadPending = 0;      // Presses not taken yet
+        uint16_t keypadReleasedAt[HAL::kKeypadKeyCount] = {};
+
+        bool takeKeypadPress(uint8_t key, const char* name) {
+            pollKeypad();
+            const bool pressed = (keypadPending & key) != 0;
+            keypadPending &= static_cast<uint8_t>(~key);
+            LOG_VERBOSE("Keypad %s: %s (press: %s)", name, (keypadDown & key) ? "HIGH" : "LOW",
+                        pressed ? "YES" : "NO");
+            return pressed;
+        }
+    } // namespace
+
+    bool pollKeypad() {
+        const uint8_t keys = HAL::Gpio::readKeypad();
+        const auto now = static_cast<uint16_t>(millis());
+        for (uint8_t i = 0; i < HAL::kKeypadKeyCount; ++i) {
+            const auto key = static_cast<uint8_t>(1U << i);
+            if (keys & key) {
+                if (!(keypadDown & key)) {
+                    keypadDown |= key;
+                    keypadPending |= key;
+                }
+                keypadReleasing &= static_cast<uint8_t>(~key);
+            } else if (!(keypadDown & key)) {
+                continue;
+            } else if (!(keypadReleasing & key)) {
+                keypadReleasing |= key;
+                keypadReleasedAt[i] = now;
+            } else if (static_cast<uint16_t>(now - keypadReleasedAt[i]) >= KEYPAD_RELEASE_MS) {
+                keypadDown &= static_cast<uint8_t>(~key);
+                keypadReleasing &= static_cast<uint8_t>(~key);
+            }
+        }
+        return keypadPending != 0;
+    }
+
     // For specific keypad buttons
     bool isKeypadNextPressed() {
-        static bool lastState = false;
-        const bool currentState = HAL::isKeypadNextPressed();
-        const bool risingEdge = currentState && !lastState;
-        lastState = currentState;
-
-        LOG_VERBOSE("Keypad Next: %s (rising edge: %s)",
-                currentState ? "HIGH" : "LOW",
-                risingEdge ? "YES" : "NO");
-
-        return risingEdge;
+        return takeKeypadPress(HAL::KEY_NEXT, "Next");
     }
 
     bool isKeypadPrevPressed() {
-        static bool lastState = false;
-        const bool currentState = HAL::isKeypadPrevPressed();
-        const bool risingEdge = currentState && !lastState;
-        lastState = currentState;
-
-        LOG_VERBOSE("Keypad Prev: %s (rising edge: %s)",
-                currentState ? "HIGH" : "LOW",
-                risingEdge ? "YES" : "NO");
-
-        return risingEdge;
+        return takeKeypadPress(HAL::KEY_PREV, "Prev");
     }
 
     bool isKeypadSelectPressed() {
-        static bool lastState = false;
-        const bool currentState = HAL::isKeypadSelectPressed();
-        const bool risingEdge = currentState && !lastState;
-        lastState = currentState;
-
-        LOG_VERBOSE("Keypad Select: %s (rising edge: %s)",
-                currentState ? "HIGH" : "LOW",
-                risingEdge ? "YES" : "NO");
-
-        return risingEdge;
+        return takeKeypadPress(HAL::KEY_SELECT, "Select");
     }
 
     bool isKeypadUpPressed() {
-        static bool lastState = false;
-        const bool currentState = HAL::isKeypadUpPressed();
-        const bool risingEdge = currentState && !lastState;
-        lastState = currentState;
-
-        LOG_VERBOSE("Keypad Up: %s (rising edge: %s)",
-                currentState ? "HIGH" : "LOW",
-                risingEdge ? "YES" : "NO");
-
-        return risingEdge;
+        return takeKeypadPress(HAL::KEY_UP, "Up");
     }
 
     bool isKeypadDownPressed() {
-        static bool lastState = false;
-        const bool currentState = HAL::isKeypadDownPressed();
-        const bool risingEdge = currentState && !lastState;
-        lastState = currentState;
-
-        LOG_VERBOSE("Keypad Down: %s (rising edge: %s)",
-                currentState ? "HIGH" : "LOW",
-                risingEdge ? "YES" : "NO");
-
-        return risingEdge;
+        return takeKeypadPress(HAL::KEY_DOWN, "Down");
     }
 }  // namespace GPIO
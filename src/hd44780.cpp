@@ -0,0 +1,240 @@
+#include "hd44780.h"
+#include "gpio_hal.h"
+#include "lcd_tx_timer.h"
+
+namespace {
+    // Instructions
+    constexpr uint8_t kClearDisplay   = 0x01;
+    constexpr uint8_t kReturnHome     = 0x02;
+    constexpr uint8_t kEntryModeSet   = 0x04;
+    constexpr uint8_t kDisplayControl = 0x08;
+    constexpr uint8_t kFunctionSet    = 0x20;
+    constexpr uint8_t kSetCgramAddr   = 0x40;
+    constexpr uint8_t kSetDdramAddr   = 0x80;
+
+    // Flags
+    constexpr uint8_t kEntryIncrement = 0x02;
+    constexpr uint8_t kDisplayOn      = 0x04;
+    constexpr uint8_t kTwoLines       = 0x08;
+
+    constexpr uint8_t kRowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+    constexpr uint16_t kInitMicros = 4100;   // Wait after the first 8-bit function set
+    constexpr uint8_t kQueueMask = Hd44780::kQueueSize - 1;
+    static_assert((Hd44780::kQueueSize & kQueueMask) == 0, "Queue size must be a power of two");
+    static_assert(Hd44780::kTickMicros >= Hd44780::kDataMicros + Hd44780::kReadyMarginMicros,
+                  "Tick must cover one byte");
+    constexpr uint32_t kMaxExactBytes = 0xFFFFFFFFUL / 1000000UL;   // Bytes * 1e6 still fits 32 bits
+} // namespace
+
+Hd44780* Hd44780::tx_owner_ = nullptr;
+
+void Hd44780::begin(uint8_t cols, uint8_t rows) {
+    (void) cols;    // Addressing only depends on the number of rows
+    rows_ = rows;
+    flush();
+    queued_ = false;
+    stats_ = Stats{};
+    HAL::Gpio::lcdInit();
+
+    // Skip the power-on wait if the MCU has been running long enough already
+    const uint32_t now_ms = millis();
+    if (now_ms < kPowerOnMillis) {
+        delay(kPowerOnMillis - now_ms);
+    }
+
+    // Initialization by instruction (datasheet figure 24): three 8-bit
+    // function sets, then switch to 4-bit. Busy flag is not readable yet.
+    HAL::Gpio::lcdWriteNibble(false, 0x03);
+    delayMicroseconds(kInitMicros);
+    HAL::Gpio::lcdWriteNibble(false, 0x03);
+    delayMicroseconds(kClearHomeMicros / 10);
+    HAL::Gpio::lcdWriteNibble(false, 0x03);
+    delayMicroseconds(kCommandMicros);
+    HAL::Gpio::lcdWriteNibble(false, 0x02);
+    delayMicroseconds(kCommandMicros);
+    ready_at_us_ = micros();
+
+    command(kFunctionSet | (rows > 1 ? kTwoLines : 0));
+    command(kDisplayControl | kDisplayOn);
+    clear();
+    command(kEntryModeSet | kEntryIncrement);
+
+    // Initialized, from now on bytes are clocked out by the transmit tick
+    waitReady();
+    tx_owner_ = this;
+    head_ = tail_ = 0;
+    tx_ready_at_us_ = micros();
+    draining_ = false;
+    drain_bytes_ = 0;
+    HAL::LcdTxTimer::begin(kTickMicros, onTxTick);
+    queued_ = true;
+}
+
+void Hd44780::clear() {
+    send(kClearDisplay, OP_LONG);
+}
+
+void Hd44780::home() {
+    send(kReturnHome, OP_LONG);
+}
+
+void Hd44780::setCursor(uint8_t col, uint8_t row) {
+    const uint8_t max_rows = sizeof(kRowOffsets) / sizeof(kRowOffsets[0]);
+    if (row >= max_rows) {
+        row = max_rows - 1;
+    }
+    if (row >= rows_) {
+        row = rows_ - 1;
+    }
+    command(kSetDdramAddr | static_cast<uint8_t>(col + kRowOffsets[row]));
+}
+
+void Hd44780::createChar(uint8_t location, const uint8_t charmap[]) {
+    location &= 0x07;   // 8 CGRAM slots
+    command(kSetCgramAddr | static_cast<uint8_t>(location << 3));
+    for (uint8_t i = 0; i < 8; i++) {
+        write(charmap[i]);
+    }
+}
+
+void Hd44780::command(uint8_t value) {
+    send(value, 0);
+}
+
+size_t Hd44780::write(uint8_t value) {
+    send(value, OP_DATA);
+    return 1;
+}
+
+void Hd44780::beginFrame() {
+    frame_start_us_ = micros();
+    frame_queued_ = 0;
+}
+
+void Hd44780::endFrame() {
+    stats_.last_frame_micros = micros() - frame_start_us_;
+    stats_.last_frame_bytes = frame_queued_;
+    ++stats_.frames;
+}
+
+void Hd44780::flush() {
+    // Until the tick has found the ring empty and the last instruction executed
+    while (queued_ && draining_) {
+        delayMicroseconds(kTickMicros);
+    }
+}
+
+Hd44780::Stats Hd44780::stats() const {
+    noInterrupts();
+    const Stats copy = stats_;
+    interrupts();
+    return copy;
+}
+
+uint32_t Hd44780::bytesPerSecond() const {
+    const Stats current = stats();
+    uint32_t bytes = current.last_drain_bytes;
+    uint32_t elapsed = current.last_drain_micros;
+    // Keep to 32-bit arithmetic, the ratio survives the scaling
+    while (bytes > kMaxExactBytes) {
+        bytes >>= 1;
+        elapsed >>= 1;
+    }
+    if (elapsed == 0) {
+        return 0;
+    }
+    return bytes * 1000000UL / elapsed;
+}
+
+uint16_t Hd44780::executionMicros(uint8_t flags) {
+    if (flags & OP_LONG) {
+        return kClearHomeMicros;
+    }
+    return (flags & OP_DATA) ? kDataMicros : kCommandMicros;
+}
+
+void Hd44780::send(uint8_t value, uint8_t flags) {
+    ++frame_queued_;
+    if (!queued_) {
+        sendNow(value, flags);
+        return;
+    }
+    const uint8_t next = (head_ + 1) & kQueueMask;
+    if (next == tail_) {
+        ++stats_.queue_full_waits;
+        while (next == tail_) {
+            delayMicroseconds(kTickMicros);
+        }
+    }
+    // Tick held off: it clears draining_ once it finds the ring empty
+    noInterrupts();
+    if (!draining_) {
+        drain_start_us_ = micros();
+        draining_ = true;
+    }
+    queue_values_[head_] = value;
+    queue_flags_[head_] = flags;
+    head_ = next;
+    interrupts();
+    HAL::LcdTxTimer::start();
+}
+
+void Hd44780::sendNow(uint8_t value, uint8_t flags) {
+    const bool rs = flags & OP_DATA;
+    waitReady();
+    HAL::Gpio::lcdWriteNibble(rs, value >> 4);
+    HAL::Gpio::lcdWriteNibble(rs, value & 0x0F);
+    ready_at_us_ = micros() + executionMicros(flags);
+    ++stats_.bytes;
+    stats_.bus_micros += executionMicros(flags);
+}
+
+void Hd44780::onTxTick() {
+    tx_owner_->serviceQueue();
+}
+
+void Hd44780::serviceQueue() {
+    // Checked on the clock rather than by counting ticks: a tick held off by
+    // a section with interrupts disabled is followed closely by the next one
+    if (HAL::Gpio::lcdHasBusyFlag()) {
+        if (HAL::Gpio::lcdReadBusy()) {
+            return;
+        }
+    } else if (static_cast<int32_t>(micros() - tx_ready_at_us_) < 0) {
+        return;
+    }
+    const uint8_t tail = tail_;
+    if (tail == head_) {
+        HAL::LcdTxTimer::stop();
+        stats_.last_drain_micros = micros() - drain_start_us_;
+        stats_.last_drain_bytes = drain_bytes_;
+        drain_bytes_ = 0;
+        draining_ = false;
+        return;
+    }
+    const uint8_t value = queue_values_[tail];
+    const uint8_t flags = queue_flags_[tail];
+    const bool rs = flags & OP_DATA;
+    HAL::Gpio::lcdWriteNibble(rs, value >> 4);
+    HAL::Gpio::lcdWriteNibble(rs, value & 0x0F);
+    tail_ = (tail + 1) & kQueueMask;
+
+    const uint16_t exec_micros = executionMicros(flags);
+    tx_ready_at_us_ = micros() + exec_micros + kReadyMarginMicros;
+    ++stats_.bytes;
+    ++drain_bytes_;
+    stats_.bus_micros += exec_micros;
+}
+
+void Hd44780::waitReady() {
+    if (HAL::Gpio::lcdHasBusyFlag()) {
+        // Bounded poll, fall back to the datasheet time if the flag never clears
+        while (HAL::Gpio::lcdReadBusy() && static_cast<int32_t>(micros() - ready_at_us_) < kClearHomeMicros) {
+        }
+        return;
+    }
+    const int32_t remaining = static_cast<int32_t>(ready_at_us_ - micros());
+    if (remaining > 0) {
+        delayMicroseconds(static_cast<unsigned int>(remaining));
+    }
+}
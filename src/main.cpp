@@ -1,7 +1,6 @@
 #include <math.h> // For NAN
 #include <Arduino.h>    // Essential Arduino header
-#include <LiquidCrystal.h>
-#include "liquid_crystal_ext.h" // Extended LiquidCrystal library for Polish characters
+#include "liquid_crystal_ext.h" // HD44780 driver with Polish characters
 #include "log.h"       // Logging library
 #include "project_pin_definition.h" // Pin definitions for the project
 #include "pin_duplication_check.h" // Pin duplication check
@@ -10,6 +9,22 @@
 #include "persistence_manager.h"
 #include "persistence_manager_instance.h" // Singleton instance of PersistenceManager
 #include "user_interface.h" // User interface controller
+#include "number_format.h" // Allocation-free number formatting
+#include "benchmarks.h" // Optional boot-time benchmarks
+#include "telemetry.h" // Binary telemetry and control protocol
+#include "serial_shell.h" // Diagnostics command shell
+#include "temperature_history.h" // Compressed per-minute history
+#include "temperature_trends.h" // Minute, quarter and six-hour rollups
+#include "operation_log.h" // Persisted wear counters and fan event log
+#include "boot_profile.h" // Per-step boot timing
+#include "fan_control.h" // Fan on/off control law
+#include "stage_marker.h" // Loop stage markers for the simavr bench
+#include "memory_hal.h" // Stack paint and RAM use
+#ifdef ENABLE_MODBUS
+#include "modbus_rtu.h" // Modbus RTU slave on the RS-485 port
+#include "modbus_register_map.h"
+#include "modbus_port.h"
+#endif
 
 // DS18B20 sensors and temp readings
 Sensor::TemperatureSensor external_sensor(EXTERNAL_DS18B20_PIN); // Initialize temperature sensor on external sensor pin
@@ -18,56 +33,177 @@ float external_temp = NAN; // Variable to hold external temperature
 float internal_temp = NAN; // Variable to hold internal temperature
 
 // LCD with Polish characters support
-PolishLCD lcd(LCD_RS_PIN, LCD_EN_PIN, LCD_D4_PIN, LCD_D5_PIN, LCD_D6_PIN, LCD_D7_PIN);  // RS, EN, D4, D5, D6, D7
+PolishLCD lcd;  // Pins from project_pin_definition.h
 // Function to get the singleton instance of UserInterface
 UserInterface& getUIInstance() {
     static UserInterface instance(&lcd); // Create a singleton instance of UserInterface
     return instance;
 }
 
+// Binary telemetry on the log serial port
+Telemetry::SnapshotBuffer telemetry_snapshot;
+Telemetry::Link telemetry(Serial, telemetry_snapshot);
+// Text command shell on the same port, context filled in setup()
+SerialShell::Context shell_context;
+SerialShell shell(Serial, shell_context);
+
+#ifdef ENABLE_MODBUS
+#ifdef ENABLE_LOGGING
+static_assert(!HAL::ModbusPort::kSharesLogPort, "Modbus uses the log UART on this board, build without ENABLE_LOGGING");
+#endif
+// Shell and telemetry run only while the log port is not the Modbus port
+constexpr bool LOG_PORT_AVAILABLE = !HAL::ModbusPort::kSharesLogPort;
+constexpr uint32_t MODBUS_BAUD = 19200;
+Modbus::RegisterMap::Context modbus_context;
+Modbus::RegisterMap modbus_map(modbus_context);
+Modbus::RtuSlave modbus(modbus_map);
+#else
+constexpr bool LOG_PORT_AVAILABLE = true;
+#endif
+
+// Wait after each pass, and how often the keypad is sampled during any delay()
+constexpr unsigned long LOOP_PERIOD_MS = 200;
+constexpr unsigned long KEYPAD_POLL_MS = 10;
+unsigned long last_keypad_poll = 0;
+
+// Called by delay() of the cores, also while the first DS18B20 conversion is
+// waited for: keeps Modbus responsive and latches short keypad presses
+void yield() {
+#ifdef ENABLE_MODBUS
+    modbus.service(micros());
+#endif
+    if (millis() - last_keypad_poll >= KEYPAD_POLL_MS) {
+        last_keypad_poll = millis();
+        GPIO::pollKeypad();
+    }
+}
+
+// Per-minute temperature and fan history
+constexpr unsigned long HISTORY_PERIOD_MS = 60UL * 1000UL;
+TemperatureHistory history;
+unsigned long last_history_time = 0;
+// Rollups fed with every loop sample
+TemperatureTrends trends;
+// Relay cycles, fan runtime and switching events kept across reboots
+OperationLog operation_log;
+
 // Variable to hold last loop time
 auto last_main_loop_time = 0UL; // Variable to track the last loop time
+uint16_t last_loop_duration = 0; // Duration of the previous loop in ms
+
+// Fan state and time of the last fan change
+FanControl::State fan_control;
 
-// variable to save fan stats
-bool fan_active = false;
-unsigned long last_fan_change_time = 0;
+// Control law thresholds as currently stored
+FanControl::Settings fanSettings() {
+    const auto* const persi_manager = getPersistenceManagerInstance();
+    FanControl::Settings settings;
+    settings.min_external = persi_manager->getMinimalExternalTemperature();
+    settings.max_external = persi_manager->getMaximalExternalTemperature();
+    settings.temperature_difference = persi_manager->getTemperatureDifferenceHysteresis();
+    settings.switch_time_ms = persi_manager->getSwitchTimeHysteresis() * 1000UL;  // Stored in seconds
+    return settings;
+}
 
 // temperature sensor selector
 size_t selected_temp_sens = 0;
+// Sensors read since boot, bit 0 external, bit 1 internal
+uint8_t sensors_read = 0;
+
+BootProfile boot_profile;
+
+// Stack high water checked once per history period: warn while the least free
+// RAM is under the reserve, a stack/heap collision only shows as random resets
+constexpr uint16_t STACK_RESERVE_BYTES = 128;
+uint16_t stack_unused_warned = 0xFFFF;
 
 void setup() {
-    // Initialize Serial for logging
-    Serial.begin(115200);
-    while (!Serial);  // Wait for Serial to be ready
-    initLog();        // Initialize the logging system
+    HAL::Memory::paintStack();
+    HAL::StageMarker::stage(LoopStage::STAGE_SETUP);
+    // Initialize Serial for logging. No wait for a USB host: a headless unit
+    // must reach fan control without one, early log lines are simply lost
+    if (LOG_PORT_AVAILABLE) {
+        Serial.begin(115200);
+        initLog();        // Initialize the logging system
+    }
+    boot_profile.mark(BootProfile::STEP_SERIAL);
+#ifdef ENABLE_BENCHMARKS
+    Bench::runBenchmarks();
+#endif
 
     //initialize GPIO pins
     if (!GPIO::initGPIO()) {
         LOG_FATAL("Failed to initialize GPIO pins!");
     }
+    boot_profile.mark(BootProfile::STEP_GPIO);
     // Initialize the temperature sensor
     external_sensor.begin();
     internal_sensor.begin();
+    boot_profile.mark(BootProfile::STEP_SENSORS);
 
-    // Initialize the LCD
-    lcd.beginPolish(16, 2); // Initialize LCD with Polish characters support
-    lcd.begin(16, 2);                   // Set dimensions (16x2)
+    // Initialize the LCD (16x2) and load the Polish glyphs
+    lcd.beginPolish(16, 2);
     lcd.setCursor(0,0);
     lcd.print("Aktywacja!");        // Test message
+    boot_profile.mark(BootProfile::STEP_LCD);
 
     // Initialize the persistence manager
     (void) getPersistenceManagerInstance();
+    operation_log.begin(millis());
     // Initialize the user interface controller
     (void) getUIInstance();            // Initialize the UI controller
+    boot_profile.mark(BootProfile::STEP_SETTINGS);
 
-    // update last fan change state time
-    last_fan_change_time = millis();
+    // Let the shell report on the runtime objects
+    shell_context.ui = &getUIInstance();
+    shell_context.lcd = &lcd;
+    shell_context.snapshot = &telemetry_snapshot;
+    shell_context.telemetry = &telemetry;
+    shell_context.history = &history;
+    shell_context.trends = &trends;
+    shell_context.operation_log = &operation_log;
+    shell_context.boot = &boot_profile;
 
-    LOG_INFO("Setup completed");
+#ifdef ENABLE_MODBUS
+    modbus_context.snapshot = &telemetry_snapshot;
+    modbus_context.operation_log = &operation_log;
+    modbus.begin(MODBUS_BAUD);
+    shell_context.modbus = &modbus;
+#endif
+    boot_profile.mark(BootProfile::STEP_LINKS);
+
+    // Fan off after reset, the first decision is not held back by the switch time
+    fan_control = FanControl::initialState(millis(), fanSettings());
+    GPIO::setRelay(false);
+
+    LOG_INFO("Setup completed in %l us: serial %l, gpio %l, sensors %l, lcd %l, settings %l, links %l",
+             static_cast<long>(boot_profile.endMicros(BootProfile::STEP_LINKS)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_SERIAL)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_GPIO)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_SENSORS)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_LCD)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_SETTINGS)),
+             static_cast<long>(boot_profile.stepMicros(BootProfile::STEP_LINKS)));
+    const MemoryUsage memory = HAL::Memory::usage();
+    LOG_INFO("RAM %d B: static %d, free %d, stack peak %d", static_cast<int>(memory.total),
+             static_cast<int>(memory.data + memory.bss), static_cast<int>(memory.free),
+             static_cast<int>(memory.stack_peak));
 }
 
 void loop() {
+    HAL::StageMarker::stage(LoopStage::STAGE_LINKS);
     last_main_loop_time = millis(); // Update the last main loop time
+#ifdef ENABLE_MODBUS
+    modbus.service(micros());
+#endif
+    // Serial RX: telemetry frames and shell lines share the port
+    while (LOG_PORT_AVAILABLE && Serial.available() > 0 && shell.canFeed()) {
+        const auto byte = static_cast<uint8_t>(Serial.read());
+        telemetry.feed(byte);
+        shell.feed(byte);
+    }
+    shell.service();
+    HAL::StageMarker::stage(LoopStage::STAGE_SENSORS);
     switch(selected_temp_sens++) {
     case 0:
         if (external_sensor.isConnected()) {
@@ -75,6 +211,7 @@ void loop() {
         } else {
             external_temp = NAN; // Set to NAN if sensor is not connected
         }
+        sensors_read |= 0x01;
         break;
     case 1:
         if (internal_sensor.isConnected()) {
@@ -82,47 +219,75 @@ void loop() {
         } else {
             internal_temp = NAN; // Set to NAN if sensor is not connected
         }
+        sensors_read |= 0x02;
         selected_temp_sens = 0;
         break;
     default: break;
     }
 
     // Control fan
-    do {
-        const auto* const persi_manager = getPersistenceManagerInstance();
-        const auto min_ext_temp = persi_manager->getMinimalExternalTemperature();
-        const auto max_ext_temp = persi_manager->getMaximalExternalTemperature();
-        const auto switch_time = persi_manager->getSwitchTimeHysteresis();
-        const auto temp_diff = persi_manager->getTemperatureDifferenceHysteresis();
-
-        // 1) time‐hysteresis: if we switched too recently, ignore.
-        if (last_main_loop_time - last_fan_change_time < switch_time) {
-            break;
-        }
+    HAL::StageMarker::stage(LoopStage::STAGE_FAN_CONTROL);
+    const bool fan_was_active = fan_control.fan_on;
+    const bool fan_active = FanControl::update(fan_control, fanSettings(), last_main_loop_time,
+                                               external_temp, internal_temp);
+    if (fan_active != fan_was_active) {
+        GPIO::setRelay(fan_active);
+    }
 
-        // 2) temperature‐hysteresis & range checks
-        if (!fan_active) {
-            // Off → On
-            if (external_temp > min_ext_temp &&
-                external_temp < max_ext_temp &&
-                external_temp < internal_temp - temp_diff) {
-                fan_active      = true;
-            }
+    // First pass with both readings: the boot is complete once the fan is decided
+    if (sensors_read == 0x03 && !boot_profile.marked(BootProfile::STEP_FIRST_DECISION)) {
+        boot_profile.mark(BootProfile::STEP_FIRST_DECISION);
+        if (boot_profile.withinBudget()) {
+            LOG_INFO("First fan decision %l us after reset",
+                     static_cast<long>(boot_profile.endMicros(BootProfile::STEP_FIRST_DECISION)));
+        } else {
+            LOG_WARNING("First fan decision %l us after reset, over the %l us budget",
+                        static_cast<long>(boot_profile.endMicros(BootProfile::STEP_FIRST_DECISION)),
+                        static_cast<long>(BootProfile::kBudgetMicros));
         }
-        else {
-            // On → Off
-            if (external_temp <= min_ext_temp ||
-                external_temp >= max_ext_temp ||
-                external_temp > internal_temp + temp_diff) {
-                fan_active      = false;
-            }
+    }
+
+    // Publish the loop state and stream it if requested
+    HAL::StageMarker::stage(LoopStage::STAGE_TELEMETRY);
+    Telemetry::Sample sample;
+    sample.uptime_ms = last_main_loop_time;
+    sample.external_centi = Telemetry::Sample::toCenti(external_temp);
+    sample.internal_centi = Telemetry::Sample::toCenti(internal_temp);
+    sample.fan_on = fan_active;
+    sample.loop_ms = last_loop_duration;
+    telemetry_snapshot.publish(sample);
+    telemetry.service(last_main_loop_time);
+
+    // Trends take every sample, the history one per period, both at display resolution
+    HAL::StageMarker::stage(LoopStage::STAGE_RECORDS);
+    const int16_t external_tenths = DisplayViewModel::quantize(external_temp);
+    const int16_t internal_tenths = DisplayViewModel::quantize(internal_temp);
+    trends.addSample(last_main_loop_time, external_tenths, internal_tenths, fan_active);
+    if (last_main_loop_time - last_history_time >= HISTORY_PERIOD_MS) {
+        last_history_time = last_main_loop_time;
+        TemperatureHistory::Sample history_sample;
+        history_sample.external_tenths = external_tenths;
+        history_sample.internal_tenths = internal_tenths;
+        history_sample.fan_on = fan_active;
+        history.append(history_sample);
+        const uint16_t stack_unused = HAL::Memory::unusedStackBytes();
+        if (stack_unused < STACK_RESERVE_BYTES && stack_unused < stack_unused_warned) {
+            stack_unused_warned = stack_unused;
+            LOG_WARNING("Stack came within %d B of the heap", static_cast<int>(stack_unused));
         }
-        last_fan_change_time = last_main_loop_time;
-    } while (0);
+    }
+    operation_log.update(last_main_loop_time, fan_active, external_tenths);
 
-    LOG_DEBUG("Ext temp: %F, Int temp: %F, Fan: %d", external_temp, internal_temp, fan_active);
+    char ext_temp_text[8];
+    char int_temp_text[8];
+    NumberFormat::Spec temp_spec;
+    temp_spec.decimals = 2;
+    NumberFormat::formatFloat(ext_temp_text, sizeof(ext_temp_text), external_temp, temp_spec);
+    NumberFormat::formatFloat(int_temp_text, sizeof(int_temp_text), internal_temp, temp_spec);
+    LOG_DEBUG("Ext temp: %s, Int temp: %s, Fan: %d", ext_temp_text, int_temp_text, fan_active);
 
     // Get the singleton instance of UserInterface
+    HAL::StageMarker::stage(LoopStage::STAGE_UI_INPUT);
     UserInterface& userInterface = getUIInstance();
 
     // Update the user interface with the latest temperature readings
@@ -146,9 +311,21 @@ void loop() {
     if (GPIO::isKeypadPrevPressed()) {
         userInterface.handlePrev();    // Handle previous button press
     }
+    HAL::StageMarker::stage(LoopStage::STAGE_UI_RENDER);
     userInterface.updateDisplay();  // Update the display based on the current state
+    HAL::StageMarker::stage(LoopStage::STAGE_DELAY);
 
     const auto current_time = millis();
-    LOG_DEBUG("Main loop duration %l ms", current_time - last_main_loop_time);
-    delay(200);  // Delay to prevent excessive CPU usage
+    last_loop_duration = static_cast<uint16_t>(current_time - last_main_loop_time);
+    const auto& frame_stats = userInterface.frameStats();
+    LOG_DEBUG("Main loop duration %l ms, frames rendered %l, skipped %l", current_time - last_main_loop_time,
+              static_cast<long>(frame_stats.rendered), static_cast<long>(frame_stats.skipped));
+    const auto lcd_stats = lcd.stats();
+    LOG_DEBUG("LCD last frame %d B queued in %l us, queue full %d", static_cast<int>(lcd_stats.last_frame_bytes),
+              static_cast<long>(lcd_stats.last_frame_micros), static_cast<int>(lcd_stats.queue_full_waits));
+    // Pace the loop; yield() samples the keypad meanwhile and a latched
+    // press starts the next pass right away to show it
+    while (millis() - current_time < LOOP_PERIOD_MS && !GPIO::pollKeypad()) {
+        delay(1);
+    }
 }
@@ -0,0 +1,102 @@
+#include "modbus_register_map.h"
+#include "operation_log.h"
+#include "persistence_manager_instance.h"
+#include "settings_registry.h"
+#include "telemetry.h"
+
+namespace {
+    void putU16(uint8_t* out, uint16_t value) {
+        out[0] = static_cast<uint8_t>(value >> 8);
+        out[1] = static_cast<uint8_t>(value);
+    }
+
+    uint16_t highWord(uint32_t value) {
+        return static_cast<uint16_t>(value >> 16);
+    }
+
+    uint16_t lowWord(uint32_t value) {
+        return static_cast<uint16_t>(value);
+    }
+
+    uint16_t inputRegister(uint16_t address, const Telemetry::Sample& sample, const OperationLog::Counters& counters) {
+        const uint32_t uptime_s = sample.uptime_ms / 1000UL;
+        switch (address) {
+            case 0: return static_cast<uint16_t>(sample.external_centi);
+            case 1: return static_cast<uint16_t>(sample.internal_centi);
+            case 2: return sample.fan_on ? 1 : 0;
+            case 3: return sample.loop_ms;
+            case 4: return highWord(uptime_s);
+            case 5: return lowWord(uptime_s);
+            case 6: return counters.boots;
+            case 7: return highWord(counters.relay_cycles);
+            case 8: return lowWord(counters.relay_cycles);
+            case 9: return highWord(counters.fan_on_seconds);
+            default: return lowWord(counters.fan_on_seconds);
+        }
+    }
+} // namespace
+
+namespace Modbus
+{
+    uint8_t RegisterMap::unitAddress() const {
+        return getModbusAddress();
+    }
+
+    Exception RegisterMap::read(RegisterType type, uint16_t start, uint16_t count, uint8_t* out) const {
+        if (type == REGISTER_INPUT) {
+            if (start >= kInputRegisters || count > kInputRegisters - start) {
+                return EXCEPTION_ILLEGAL_ADDRESS;
+            }
+            if (context_.snapshot == nullptr) {
+                return EXCEPTION_DEVICE_FAILURE;
+            }
+            const Telemetry::Sample sample = context_.snapshot->read();
+            const OperationLog::Counters counters =
+                context_.operation_log != nullptr ? context_.operation_log->counters() : OperationLog::Counters{};
+            for (uint16_t i = 0; i < count; ++i) {
+                putU16(out + 2 * i, inputRegister(start + i, sample, counters));
+            }
+            return EXCEPTION_NONE;
+        }
+
+        Settings::Descriptor descriptor;
+        for (uint16_t i = 0; i < count; ++i) {
+            const uint16_t address = start + i;
+            if (address >= static_cast<uint16_t>(PersistenceField::None) ||
+                !Settings::find(static_cast<PersistenceField>(address), descriptor)) {
+                return EXCEPTION_ILLEGAL_ADDRESS;
+            }
+            putU16(out + 2 * i, static_cast<uint16_t>(Settings::readPersisted(descriptor)));
+        }
+        return EXCEPTION_NONE;
+    }
+
+    Exception RegisterMap::write(uint16_t start, uint16_t count, const uint8_t* values) {
+        // Validate every register before the first write
+        Settings::Descriptor descriptor;
+        for (uint16_t i = 0; i < count; ++i) {
+            const uint16_t address = start + i;
+            if (address >= static_cast<uint16_t>(PersistenceField::None) ||
+                !Settings::find(static_cast<PersistenceField>(address), descriptor)) {
+                return EXCEPTION_ILLEGAL_ADDRESS;
+            }
+            const auto value = static_cast<int16_t>((values[2 * i] << 8) | values[2 * i + 1]);
+            if (Settings::clamp(descriptor, value) != value) {
+                return EXCEPTION_ILLEGAL_VALUE;
+            }
+        }
+
+        PersistenceManager* persistence = getPersistenceManagerInstance();
+        persistence->beginTransaction();
+        for (uint16_t i = 0; i < count; ++i) {
+            Settings::find(static_cast<PersistenceField>(start + i), descriptor);
+            const auto value = static_cast<int16_t>((values[2 * i] << 8) | values[2 * i + 1]);
+            // Skip the EEPROM write when nothing changes
+            if (Settings::readPersisted(descriptor) != value) {
+                Settings::writePersisted(descriptor, value);
+            }
+        }
+        persistence->commitTransaction();
+        return EXCEPTION_NONE;
+    }
+} // namespace Modbus
@@ -0,0 +1,244 @@
+#include "modbus_rtu.h"
+#include "modbus_register_map.h"
+#include "modbus_port.h"
+
+#include <CRC16.h>
+
+namespace {
+    constexpr uint32_t kFixedTimingBaud = 19200;    // Above it t3.5 is fixed (Modbus over serial line, 2.5.1.1)
+    constexpr uint16_t kFixedSilenceMicros = 1750;
+    constexpr uint8_t kFixedLengthRequest = 8;     // Address, function, two words, CRC
+    constexpr uint8_t kWriteMultipleHeader = 7;    // Address, function, start, count, byte count
+
+    uint16_t getU16(const uint8_t* in) {
+        return static_cast<uint16_t>((in[0] << 8) | in[1]);
+    }
+
+    /// One byte of CRC-16/MODBUS, for frames that do not fit the buffer
+    uint16_t crc16Update(uint16_t crc, uint8_t byte) {
+        crc ^= byte;
+        for (uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001U) : static_cast<uint16_t>(crc >> 1);
+        }
+        return crc;
+    }
+} // namespace
+
+namespace Modbus
+{
+    uint16_t crc16(const uint8_t* data, size_t size) {
+        CRC16 crc(0x8005, 0xFFFF, 0x0000, true, true);
+        crc.add(data, static_cast<uint16_t>(size));
+        return crc.calc();
+    }
+
+    void RtuSlave::begin(uint32_t baud) {
+        char_us_ = static_cast<uint16_t>(11000000UL / baud);
+        silence_us_ = baud > kFixedTimingBaud ? kFixedSilenceMicros : static_cast<uint16_t>(char_us_ * 7U / 2U);
+        HAL::ModbusPort::begin(baud);
+        tx_idle_room_ = HAL::ModbusPort::availableForWrite();
+        reset();
+    }
+
+    void RtuSlave::reset() {
+        size_ = 0;
+        tx_offset_ = 0;
+        overrun_ = false;
+        state_ = STATE_IDLE;
+    }
+
+    void RtuSlave::service(uint32_t now_us) {
+        switch (state_) {
+            case STATE_IDLE:
+            case STATE_RECEIVING:
+                // Bounded by the core's RX buffer
+                while (HAL::ModbusPort::available() > 0) {
+                    const auto byte = static_cast<uint8_t>(HAL::ModbusPort::read());
+                    if (size_ < kFrameSize) {
+                        frame_[size_++] = byte;
+                    } else {
+                        // Keep the header and check the CRC on the fly, the request may still get an answer
+                        if (!overrun_) {
+                            overrun_ = true;
+                            overrun_crc_ = 0xFFFF;
+                            for (uint8_t i = 0; i < kFrameSize; ++i) {
+                                overrun_crc_ = crc16Update(overrun_crc_, frame_[i]);
+                            }
+                        }
+                        overrun_crc_ = crc16Update(overrun_crc_, byte);
+                    }
+                    last_event_us_ = now_us;
+                    state_ = STATE_RECEIVING;
+                    if (!overrun_ && requestComplete()) {
+                        finishFrame(now_us);
+                        return;
+                    }
+                }
+                if (state_ == STATE_RECEIVING && now_us - last_event_us_ >= silence_us_) {
+                    finishFrame(now_us);
+                }
+                return;
+            case STATE_TRANSMITTING:
+                transmit(now_us);
+                return;
+            case STATE_DRAINING:
+                // The TX buffer is empty, wait out the character in UDR and the shift register
+                if (HAL::ModbusPort::availableForWrite() < tx_idle_room_) {
+                    last_event_us_ = now_us;
+                } else if (now_us - last_event_us_ >= 2U * char_us_) {
+                    HAL::ModbusPort::setTransmit(false);
+                    reset();
+                }
+                return;
+        }
+    }
+
+    bool RtuSlave::requestComplete() const {
+        if (size_ < 2) {
+            return false;
+        }
+        uint16_t expected;
+        switch (frame_[1]) {
+            case FC_READ_HOLDING:
+            case FC_READ_INPUT:
+            case FC_WRITE_SINGLE:
+                expected = kFixedLengthRequest;
+                break;
+            case FC_WRITE_MULTIPLE:
+                if (size_ < kWriteMultipleHeader) {
+                    return false;
+                }
+                expected = static_cast<uint16_t>(kWriteMultipleHeader + frame_[6] + 2U);
+                break;
+            default:
+                // Unknown length, the t3.5 silence ends the frame
+                return false;
+        }
+        return size_ == expected && crc16(frame_, size_ - 2U) == (frame_[size_ - 2] | (frame_[size_ - 1] << 8));
+    }
+
+    void RtuSlave::finishFrame(uint32_t now_us) {
+        size_t length;
+        if (overrun_) {
+            ++stats_.overruns;
+            // Appending the CRC of a frame to it leaves a CRC of 0
+            length = overrun_crc_ == 0 ? rejectOversized(frame_) : 0;
+        } else {
+            length = handleRequest(frame_, size_);
+        }
+        if (length == 0) {
+            reset();
+            return;
+        }
+        size_ = static_cast<uint8_t>(length);
+        tx_offset_ = 0;
+        state_ = STATE_TRANSMITTING;
+        HAL::ModbusPort::setTransmit(true);
+        transmit(now_us);
+    }
+
+    void RtuSlave::transmit(uint32_t now_us) {
+        const int room = HAL::ModbusPort::availableForWrite();
+        size_t count = size_ - tx_offset_;
+        if (room >= 0 && count > static_cast<size_t>(room)) {
+            count = static_cast<size_t>(room);
+        }
+        tx_offset_ = static_cast<uint8_t>(tx_offset_ + HAL::ModbusPort::write(frame_ + tx_offset_, count));
+        if (tx_offset_ == size_) {
+            last_event_us_ = now_us;
+            state_ = STATE_DRAINING;
+        }
+    }
+
+    size_t RtuSlave::handleRequest(uint8_t* frame, size_t size) {
+        if (size < 4 || crc16(frame, size - 2) != (frame[size - 2] | (frame[size - 1] << 8))) {
+            ++stats_.crc_errors;
+            return 0;
+        }
+        const uint8_t address = frame[0];
+        if (address != map_.unitAddress() && address != kBroadcastAddress) {
+            return 0;
+        }
+        ++stats_.requests;
+
+        Exception exception = EXCEPTION_NONE;
+        size_t length = 0;
+        const uint8_t function = frame[1];
+        switch (function) {
+            case FC_READ_HOLDING:
+            case FC_READ_INPUT: {
+                const uint16_t count = getU16(frame + 4);
+                if (size != kFixedLengthRequest || count == 0 || count > kMaxReadRegisters) {
+                    exception = EXCEPTION_ILLEGAL_VALUE;
+                    break;
+                }
+                const auto type = function == FC_READ_HOLDING ? REGISTER_HOLDING : REGISTER_INPUT;
+                exception = map_.read(type, getU16(frame + 2), count, frame + 3);
+                frame[2] = static_cast<uint8_t>(count * 2U);
+                length = 3U + count * 2U;
+                break;
+            }
+            case FC_WRITE_SINGLE:
+                if (size != kFixedLengthRequest) {
+                    exception = EXCEPTION_ILLEGAL_VALUE;
+                    break;
+                }
+                exception = map_.write(getU16(frame + 2), 1, frame + 4);
+                length = 6;     // Echo of the request
+                break;
+            case FC_WRITE_MULTIPLE: {
+                const uint16_t count = size > kWriteMultipleHeader ? getU16(frame + 4) : 0;
+                if (count == 0 || count > kMaxWriteRegisters || frame[6] != count * 2U ||
+                    size != kWriteMultipleHeader + frame[6] + 2U) {
+                    exception = EXCEPTION_ILLEGAL_VALUE;
+                    break;
+                }
+                exception = map_.write(getU16(frame + 2), count, frame + kWriteMultipleHeader);
+                length = 6;     // Address, function, start, count
+                break;
+            }
+            default:
+                exception = EXCEPTION_ILLEGAL_FUNCTION;
+                break;
+        }
+
+        if (address == kBroadcastAddress) {
+            return 0;
+        }
+        return reply(frame, length, exception);
+    }
+
+    size_t RtuSlave::rejectOversized(uint8_t* frame) {
+        // Only the start of the request is in the buffer, its CRC was good
+        const uint8_t address = frame[0];
+        if (address != map_.unitAddress() && address != kBroadcastAddress) {
+            return 0;
+        }
+        ++stats_.requests;
+        if (address == kBroadcastAddress) {
+            return 0;
+        }
+        switch (frame[1]) {
+            case FC_READ_HOLDING:
+            case FC_READ_INPUT:
+            case FC_WRITE_SINGLE:
+            case FC_WRITE_MULTIPLE:
+                return reply(frame, 0, EXCEPTION_ILLEGAL_VALUE);
+            default:
+                return reply(frame, 0, EXCEPTION_ILLEGAL_FUNCTION);
+        }
+    }
+
+    size_t RtuSlave::reply(uint8_t* frame, size_t length, Exception exception) {
+        if (exception != EXCEPTION_NONE) {
+            ++stats_.exceptions;
+            frame[1] = static_cast<uint8_t>(frame[1] | FC_EXCEPTION);
+            frame[2] = exception;
+            length = 3;
+        }
+        const uint16_t crc = crc16(frame, length);
+        frame[length] = static_cast<uint8_t>(crc);
+        frame[length + 1] = static_cast<uint8_t>(crc >> 8);
+        return length + 2;
+    }
+} // namespace Modbus
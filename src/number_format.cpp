@@ -0,0 +1,125 @@
+#include "number_format.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+    constexpr size_t kMaxDigits = 10;   // uint32_t
+} // namespace
+
+namespace NumberFormat
+{
+    size_t formatFixed(char* buffer, size_t buffer_size, int32_t value, const Spec& spec) {
+        if (buffer == nullptr || buffer_size == 0) {
+            return 0;
+        }
+
+        // Collect digits least significant first, at least decimals + 1 of them
+        const bool negative = value < 0;
+        uint32_t magnitude = negative ? 0U - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+        char digits[kMaxDigits];
+        uint8_t num_digits = 0;
+        do {
+            digits[num_digits++] = static_cast<char>('0' + magnitude % 10U);
+            magnitude /= 10U;
+        } while (magnitude != 0U && num_digits < kMaxDigits);
+        const uint8_t decimals = spec.decimals < kMaxDigits ? spec.decimals : kMaxDigits - 1;
+        while (num_digits <= decimals) {
+            digits[num_digits++] = '0';
+        }
+
+        const char sign = negative ? '-' : (spec.force_sign ? '+' : '\0');
+        const size_t length = num_digits + (decimals > 0 ? 1U : 0U) + (sign ? 1U : 0U);
+        const size_t padding = spec.width > length ? spec.width - length : 0U;
+        if (length + padding + 1U > buffer_size) {
+            buffer[0] = '\0';
+            return 0;
+        }
+
+        char* out = buffer;
+        if (spec.pad == '0') {
+            // Zero padding goes between the sign and the digits
+            if (sign) {
+                *out++ = sign;
+            }
+            for (size_t i = 0; i < padding; ++i) {
+                *out++ = '0';
+            }
+        } else {
+            for (size_t i = 0; i < padding; ++i) {
+                *out++ = spec.pad;
+            }
+            if (sign) {
+                *out++ = sign;
+            }
+        }
+        while (num_digits > 0) {
+            if (num_digits == decimals) {
+                *out++ = '.';
+            }
+            *out++ = digits[--num_digits];
+        }
+        *out = '\0';
+        return static_cast<size_t>(out - buffer);
+    }
+
+    size_t formatFloat(char* buffer, size_t buffer_size, float value, const Spec& spec) {
+        float scaled = value;
+        for (uint8_t i = 0; i < spec.decimals; ++i) {
+            scaled *= 10.0f;
+        }
+        const char* special = isnan(value) ? "nan" : (fabsf(scaled) >= 2147483520.0f ? "ovf" : nullptr);
+        if (special != nullptr) {
+            if (buffer == nullptr || buffer_size < 4) {
+                return 0;
+            }
+            memcpy(buffer, special, 4);
+            return 3;
+        }
+        return formatFixed(buffer, buffer_size, lroundf(scaled), spec);
+    }
+
+    size_t formatInteger(char* buffer, size_t buffer_size, int32_t value, const Spec& spec) {
+        Spec integer_spec = spec;
+        integer_spec.decimals = 0;
+        return formatFixed(buffer, buffer_size, value, integer_spec);
+    }
+
+    bool parseFixed(const char* text, uint8_t decimals, int32_t& value) {
+        if (text == nullptr) {
+            return false;
+        }
+        const bool negative = *text == '-';
+        if (*text == '-' || *text == '+') {
+            ++text;
+        }
+        int32_t result = 0;
+        uint8_t num_digits = 0;
+        uint8_t fraction_digits = 0;
+        bool in_fraction = false;
+        for (; *text != '\0'; ++text) {
+            if (*text == '.' && !in_fraction) {
+                in_fraction = true;
+                continue;
+            }
+            if (*text < '0' || *text > '9' || ++num_digits > 9) {
+                return false;
+            }
+            if (in_fraction && ++fraction_digits > decimals) {
+                return false;
+            }
+            result = result * 10 + (*text - '0');
+        }
+        if (num_digits == 0) {
+            return false;
+        }
+        for (; fraction_digits < decimals; ++fraction_digits) {
+            if (++num_digits > 9) {
+                return false;
+            }
+            result *= 10;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+} // namespace NumberFormat
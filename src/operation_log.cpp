@@ -0,0 +1,249 @@
+#include "operation_log.h"
+
+#include "persistence_manager.h"
+#include "log.h"
+#include "stage_marker.h"
+
+struct OperationLog::CounterRecord {
+    uint16_t sequence;
+    uint16_t boots;
+    uint32_t relay_cycles;
+    uint32_t fan_on_seconds;
+    uint32_t counter_writes;
+    uint32_t event_writes;
+    uint32_t crc;
+};
+
+namespace {
+    constexpr uint16_t kCounterSize = 24;
+    constexpr uint16_t kCounterStart = OperationLog::kRegionStart;
+    constexpr uint16_t kEventSize = 8;
+    constexpr uint16_t kEventStart = kCounterStart + OperationLog::kCounterSlots * kCounterSize;
+    constexpr uint16_t kEmptySequence = 0xFFFF;
+
+    static_assert(sizeof(PersistenceData) + sizeof(uint32_t) <= OperationLog::kRegionStart,
+                  "Settings overlap the operation log");
+    static_assert(kEventStart + OperationLog::kEventSlots * kEventSize <= EEPROM_SIZE,
+                  "Operation log does not fit in the EEPROM");
+
+    /// a is newer than b, tolerating 16-bit wrap-around
+    bool isNewer(uint16_t a, uint16_t b) {
+        return static_cast<int16_t>(a - b) > 0;
+    }
+
+    uint16_t nextSequence(uint16_t sequence) {
+        ++sequence;
+        return sequence == kEmptySequence ? 0 : sequence;
+    }
+
+    uint16_t eventAddress(uint8_t slot) {
+        return kEventStart + slot * kEventSize;
+    }
+
+    int8_t toHalfDegrees(int16_t tenths) {
+        if (tenths == -32767 - 1) {
+            return -128;
+        }
+        const int16_t halves = static_cast<int16_t>((tenths >= 0 ? tenths + 2 : tenths - 2) / 5);
+        return static_cast<int8_t>(halves > 127 ? 127 : (halves < -127 ? -127 : halves));
+    }
+} // namespace
+
+static_assert(sizeof(OperationLog::Event) == kEventSize, "Event entry size changed");
+
+void OperationLog::begin(uint32_t now_ms) {
+    loadCounters();
+    loadEvents();
+    ++counters_.boots;
+    started_ = false;
+    pending_count_ = 0;
+    last_event_flush_ms_ = now_ms;
+    // Persist the boot right away, a crash loop must still show up
+    flushCounters(now_ms);
+    LOG_INFO("Operation log: boot %d, %l relay cycles, %l s fan runtime, %d events",
+             static_cast<int>(counters_.boots), static_cast<long>(counters_.relay_cycles),
+             static_cast<long>(counters_.fan_on_seconds), static_cast<int>(stored_events_));
+}
+
+void OperationLog::loadCounters() {
+    CounterRecord newest{};
+    bool found = false;
+    for (uint8_t slot = 0; slot < kCounterSlots; ++slot) {
+        CounterRecord record;
+        EEPROM.get(kCounterStart + slot * kCounterSize, record);
+        CRC32 crc;
+        crc.add(reinterpret_cast<const uint8_t*>(&record), sizeof(record) - sizeof(record.crc));
+        if (crc.calc() != record.crc) {
+            continue;
+        }
+        if (!found || isNewer(record.sequence, newest.sequence)) {
+            newest = record;
+            next_counter_slot_ = static_cast<uint8_t>((slot + 1) % kCounterSlots);
+            found = true;
+        }
+    }
+
+    counters_ = Counters{};
+    if (!found) {
+        LOG_WARNING("Operation log: no valid counters, starting from zero");
+        counter_sequence_ = 0;
+        next_counter_slot_ = 0;
+        return;
+    }
+    counter_sequence_ = newest.sequence;
+    counters_.boots = newest.boots;
+    counters_.relay_cycles = newest.relay_cycles;
+    counters_.fan_on_seconds = newest.fan_on_seconds;
+    counters_.counter_writes = newest.counter_writes;
+    counters_.event_writes = newest.event_writes;
+}
+
+void OperationLog::loadEvents() {
+    stored_events_ = 0;
+    next_event_slot_ = 0;
+    event_sequence_ = 0;
+    bool found = false;
+    for (uint8_t slot = 0; slot < kEventSlots; ++slot) {
+        Event entry;
+        EEPROM.get(eventAddress(slot), entry);
+        if (entry.sequence == kEmptySequence) {
+            continue;
+        }
+        ++stored_events_;
+        if (!found || isNewer(entry.sequence, event_sequence_)) {
+            event_sequence_ = entry.sequence;
+            next_event_slot_ = static_cast<uint8_t>((slot + 1) % kEventSlots);
+            found = true;
+        }
+    }
+    if (found) {
+        event_sequence_ = nextSequence(event_sequence_);
+    }
+}
+
+void OperationLog::update(uint32_t now_ms, bool fan_on, int16_t external_tenths) {
+    if (!started_) {
+        // First call only establishes the fan state and the time base
+        started_ = true;
+        fan_on_ = fan_on;
+        last_update_ms_ = now_ms;
+        last_counter_flush_ms_ = now_ms;
+        return;
+    }
+
+    if (fan_on_) {
+        const uint32_t run_ms = fan_on_ms_ + (now_ms - last_update_ms_);
+        counters_.fan_on_seconds += run_ms / 1000UL;
+        fan_on_ms_ = static_cast<uint16_t>(run_ms % 1000UL);
+        counters_dirty_ |= run_ms >= 1000UL;
+    }
+    last_update_ms_ = now_ms;
+
+    if (fan_on != fan_on_) {
+        fan_on_ = fan_on;
+        if (fan_on) {
+            ++counters_.relay_cycles;
+            counters_dirty_ = true;
+        }
+        if (pending_count_ == kPendingEvents && now_ms - last_event_flush_ms_ >= kEventFlushMs) {
+            flushEvents(now_ms);
+        }
+        if (pending_count_ < kPendingEvents) {
+            Event& entry = pending_[pending_count_++];
+            entry.sequence = event_sequence_;
+            entry.boot = counters_.boots;
+            const uint32_t minutes = now_ms / 60000UL;
+            entry.uptime_minutes = static_cast<uint16_t>(minutes > 0xFFFEUL ? 0xFFFEUL : minutes);
+            entry.external_half_degrees = toHalfDegrees(external_tenths);
+            entry.flags = fan_on ? Event::FLAG_FAN_ON : 0;
+            event_sequence_ = nextSequence(event_sequence_);
+        } else {
+            // Switching faster than the log may wear the EEPROM
+            ++counters_.dropped_events;
+        }
+    }
+
+    if (pending_count_ > 0 && now_ms - last_event_flush_ms_ >= kEventFlushMs) {
+        flushEvents(now_ms);
+    }
+    if (counters_dirty_ && now_ms - last_counter_flush_ms_ >= kCounterFlushMs) {
+        flushCounters(now_ms);
+    }
+}
+
+void OperationLog::flush(uint32_t now_ms) {
+    if (pending_count_ > 0) {
+        flushEvents(now_ms);
+    }
+    if (counters_dirty_) {
+        flushCounters(now_ms);
+    }
+}
+
+void OperationLog::flushCounters(uint32_t now_ms) {
+    ++counters_.counter_writes;
+    counter_sequence_ = nextSequence(counter_sequence_);
+
+    CounterRecord record;
+    static_assert(sizeof(record) == kCounterSize, "Counter record size changed");
+    record.sequence = counter_sequence_;
+    record.boots = counters_.boots;
+    record.relay_cycles = counters_.relay_cycles;
+    record.fan_on_seconds = counters_.fan_on_seconds;
+    record.counter_writes = counters_.counter_writes;
+    record.event_writes = counters_.event_writes;
+    CRC32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(&record), sizeof(record) - sizeof(record.crc));
+    record.crc = crc.calc();
+    HAL::StageMarker::commit(LoopStage::COMMIT_COUNTERS);
+    EEPROM.put(kCounterStart + next_counter_slot_ * kCounterSize, record);
+    HAL::StageMarker::commit(LoopStage::COMMIT_NONE);
+
+    next_counter_slot_ = static_cast<uint8_t>((next_counter_slot_ + 1) % kCounterSlots);
+    counters_dirty_ = false;
+    last_counter_flush_ms_ = now_ms;
+}
+
+void OperationLog::flushEvents(uint32_t now_ms) {
+    HAL::StageMarker::commit(LoopStage::COMMIT_EVENTS);
+    for (uint8_t i = 0; i < pending_count_; ++i) {
+        EEPROM.put(eventAddress(next_event_slot_), pending_[i]);
+        next_event_slot_ = static_cast<uint8_t>((next_event_slot_ + 1) % kEventSlots);
+        if (stored_events_ < kEventSlots) {
+            ++stored_events_;
+        }
+    }
+    HAL::StageMarker::commit(LoopStage::COMMIT_NONE);
+    counters_.event_writes += pending_count_;
+    counters_dirty_ = true;
+    pending_count_ = 0;
+    last_event_flush_ms_ = now_ms;
+}
+
+bool OperationLog::event(uint8_t age, Event& event) const {
+    if (age < pending_count_) {
+        event = pending_[pending_count_ - 1 - age];
+        return true;
+    }
+    age = static_cast<uint8_t>(age - pending_count_);
+    if (age >= stored_events_) {
+        return false;
+    }
+    const uint8_t slot = static_cast<uint8_t>((next_event_slot_ + kEventSlots - 1 - age) % kEventSlots);
+    EEPROM.get(eventAddress(slot), event);
+    return true;
+}
+
+uint16_t OperationLog::relayWearPermille() const {
+    const uint32_t permille = counters_.relay_cycles / (kRelayRatedCycles / 1000UL);
+    return static_cast<uint16_t>(permille > 0xFFFFUL ? 0xFFFFUL : permille);
+}
+
+uint16_t OperationLog::eepromWearPermille() const {
+    // Every flush rewrites one counter slot; the worst cell decides
+    const uint32_t slot_writes = counters_.counter_writes / kCounterSlots;
+    const uint32_t event_writes = counters_.event_writes / kEventSlots;
+    const uint32_t writes = slot_writes > event_writes ? slot_writes : event_writes;
+    const uint32_t permille = writes / (kEepromEndurance / 1000UL);
+    return static_cast<uint16_t>(permille > 0xFFFFUL ? 0xFFFFUL : permille);
+}
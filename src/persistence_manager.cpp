@@ -1,5 +1,6 @@
 #include "persistence_manager.h"
 #include "log.h"
+#include "stage_marker.h"
 #include <string.h>
 
 PersistenceManager::PersistenceManager() {
@@ -14,6 +15,14 @@ PersistenceManager::PersistenceManager() {
     LOG_INFO("PersistenceManager initialized");
 }
 
+namespace {
+    uint32_t crcOf(const void* data, size_t size) {
+        CRC32 crc;
+        crc.add(static_cast<const uint8_t*>(data), static_cast<uint16_t>(size));
+        return crc.calc();
+    }
+} // namespace
+
 bool PersistenceManager::checkIsDataPresent() {
     EEPROM.get(0, data_); // Read the first byte to check if data is present
     if (data_.has_data) {
@@ -22,7 +31,10 @@ bool PersistenceManager::checkIsDataPresent() {
         LOG_INFO("No data found in EEPROM, loading defaults");
         return false; // No data present, return false
     }
-    if (!checkCRC()) { // Check if the data integrity is valid
+    if (data_.has_data == PERSISTENCE_LAYOUT_V1) {
+        return migrateFromV1();
+    }
+    if (data_.has_data != PERSISTENCE_LAYOUT_VERSION || !checkCRC()) { // Check if the data integrity is valid
         LOG_WARNING("CRC check failed, loading defaults");
         data_.has_data = false; // Reset the flag if CRC check fails
         return false; // Data is present but corrupted
@@ -32,17 +44,45 @@ bool PersistenceManager::checkIsDataPresent() {
     return true; // Data is present and valid
 }
 
+// Keeps the settings of a layout 1 record, the fields added since start at their defaults
+bool PersistenceManager::migrateFromV1() {
+    PersistenceDataV1 old;
+    uint32_t stored_crc = 0;
+    EEPROM.get(0, old);
+    EEPROM.get(sizeof(PersistenceDataV1), stored_crc);
+    if (stored_crc != crcOf(&old, sizeof(old))) {
+        LOG_WARNING("CRC check of the layout %d record failed, loading defaults", PERSISTENCE_LAYOUT_V1);
+        data_.has_data = false;
+        return false;
+    }
+    loadDefaults();
+    data_.minimal_external_temperature = old.minimal_external_temperature;
+    data_.maximal_external_temperature = old.maximal_external_temperature;
+    data_.temperature_difference_hysteresis = old.temperature_difference_hysteresis;
+    data_.switch_time_hysteresis = old.switch_time_hysteresis;
+    saveData();
+    LOG_INFO("Settings migrated from layout %d to %d", PERSISTENCE_LAYOUT_V1, PERSISTENCE_LAYOUT_VERSION);
+    return true;
+}
+
 void PersistenceManager::loadDefaults() {
-    data_.has_data = true; // Set the flag to indicate that data is present
+    data_.has_data = PERSISTENCE_LAYOUT_VERSION; // Set the flag to indicate that data is present
     data_.minimal_external_temperature = DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE;
     data_.maximal_external_temperature = DEFAULT_MAXIMAL_EXTERNAL_TEMPERATURE;
     data_.temperature_difference_hysteresis = DEFAULT_TEMPERATURE_DIFFERENCE_HYSTERESIS;
     data_.switch_time_hysteresis = DEFAULT_SWITCH_TIME_HYSTERESIS;
+    data_.modbus_address = DEFAULT_MODBUS_ADDRESS;
 }
 
 void PersistenceManager::saveData() {
+    if (in_transaction_) {
+        save_pending_ = true;
+        return;
+    }
+    HAL::StageMarker::commit(LoopStage::COMMIT_SETTINGS);
     EEPROM.put(0, data_); // Save data to EEPROM
     updateCRC(); // Update the CRC after saving data
+    HAL::StageMarker::commit(LoopStage::COMMIT_NONE);
     LOG_INFO("Data saved to EEPROM");
 }
 
@@ -50,12 +90,13 @@ void PersistenceManager::loadData() {
     EEPROM.get(0, data_); // Load data from EEPROM
     LOG_INFO("Data loaded from EEPROM - has_data: %d, minimal_external_temperature: %F, "
               "maximal_external_temperature: %F, temperature_difference_hysteresis: %F, "
-              "switch_time_hysteresis: %d",
+              "switch_time_hysteresis: %d, modbus_address: %d",
               data_.has_data,
               data_.minimal_external_temperature,
               data_.maximal_external_temperature,
               data_.temperature_difference_hysteresis,
-              static_cast<int>(data_.switch_time_hysteresis));
+              static_cast<int>(data_.switch_time_hysteresis),
+              data_.modbus_address);
 }
 
 float PersistenceManager::getMinimalExternalTemperature() const {
@@ -94,26 +135,44 @@ void PersistenceManager::setSwitchTimeHysteresis(size_t value) {
     saveData(); // Save updated data to EEPROM
 }
 
+uint8_t PersistenceManager::getModbusAddress() const {
+    return data_.modbus_address;
+}
+
+void PersistenceManager::setModbusAddress(uint8_t value) {
+    data_.modbus_address = value;
+    saveData(); // Save updated data to EEPROM
+}
+
 void PersistenceManager::resetToDefaults() {
     loadDefaults();
     saveData();
 }
 
+void PersistenceManager::beginTransaction() {
+    in_transaction_ = true;
+    save_pending_ = false;
+}
+
+void PersistenceManager::commitTransaction() {
+    in_transaction_ = false;
+    if (save_pending_) {
+        save_pending_ = false;
+        saveData();
+    }
+}
+
 bool PersistenceManager::checkCRC() const {
     uint32_t stored_crc = 0;
     EEPROM.get(sizeof(PersistenceData), stored_crc); // Read the stored CRC from EEPROM
-    CRC32 crc;
-    crc.add(reinterpret_cast<const uint8_t*>(&data_), sizeof(data_));
-    const auto calculated_crc = crc.calc(); // Calculate the CRC
+    const auto calculated_crc = crcOf(&data_, sizeof(data_)); // Calculate the CRC
     LOG_INFO("Stored CRC: %u, Calculated CRC: %u", (unsigned long)stored_crc,
                                                    (unsigned long)calculated_crc);
     return stored_crc == calculated_crc; // Compare stored and calculated CRC
 }
 
 void PersistenceManager::updateCRC() {
-    CRC32 crc;
-    crc.add(reinterpret_cast<const uint8_t*>(&data_), sizeof(data_));
-    const auto calculated_crc = crc.calc(); // Calculate the CRC
+    const auto calculated_crc = crcOf(&data_, sizeof(data_)); // Calculate the CRC
     EEPROM.put(sizeof(PersistenceData), calculated_crc); // Save the calculated CRC to EEPROM
     LOG_INFO("CRC updated and saved to EEPROM: %u", (unsigned long)calculated_crc);
 }
@@ -0,0 +1,638 @@
+#include "serial_shell.h"
+#include "log.h"
+#include "number_format.h"
+#include "settings_registry.h"
+#include "persistence_manager_instance.h"
+#include "telemetry.h"
+#include "user_interface.h"
+#include "system_hal.h"
+#include "temperature_history.h"
+#include "temperature_trends.h"
+#include "operation_log.h"
+#include "modbus_rtu.h"
+#include "boot_profile.h"
+#include "memory_hal.h"
+
+#include <string.h>
+
+namespace {
+    constexpr uint8_t kRxMask = SerialShell::kRxSize - 1;
+    static_assert((SerialShell::kRxSize & kRxMask) == 0, "RX ring size must be a power of two");
+
+    bool printError(SerialShell& shell, const __FlashStringHelper* message) {
+        shell.out().print(F("error: "));
+        shell.out().println(message);
+        return false;
+    }
+
+    /// Fixed-point temperature, -32768 (no reading) prints "--"
+    void printTemperature(SerialShell& shell, int16_t value, uint8_t decimals) {
+        if (value == Telemetry::kNoReading) {
+            shell.out().print(F("--"));
+        } else {
+            shell.printFixed(value, decimals);
+        }
+    }
+
+    /// Print one Number setting as "key = value"
+    void printSetting(SerialShell& shell, size_t index) {
+        Settings::Descriptor descriptor;
+        Settings::load(index, descriptor);
+        shell.out().print(reinterpret_cast<const __FlashStringHelper*>(descriptor.key));
+        shell.out().print(F(" = "));
+        shell.printFixed(Settings::readPersisted(descriptor), descriptor.decimals);
+        shell.out().println();
+    }
+
+    bool findSetting(SerialShell& shell, const char* key, size_t& index, Settings::Descriptor& descriptor) {
+        const int8_t found = Settings::indexOf(key);
+        if (found < 0) {
+            printError(shell, F("unknown setting"));
+            return false;
+        }
+        index = static_cast<size_t>(found);
+        Settings::load(index, descriptor);
+        if (descriptor.type != Settings::Type::Number) {
+            printError(shell, F("not a value setting"));
+            return false;
+        }
+        return true;
+    }
+
+    bool cmdHelp(SerialShell& shell, uint8_t step);
+
+    bool cmdGet(SerialShell& shell, uint8_t step) {
+        if (shell.argc() > 1) {
+            size_t index;
+            Settings::Descriptor descriptor;
+            if (findSetting(shell, shell.arg(1), index, descriptor)) {
+                printSetting(shell, index);
+            }
+            return false;
+        }
+        // No key: list every value setting, one per step
+        if (step >= Settings::count()) {
+            return false;
+        }
+        Settings::Descriptor descriptor;
+        Settings::load(step, descriptor);
+        if (descriptor.type == Settings::Type::Number) {
+            printSetting(shell, step);
+        }
+        return step + 1U < Settings::count();
+    }
+
+    bool cmdSet(SerialShell& shell, uint8_t) {
+        if (shell.argc() != 3) {
+            return printError(shell, F("usage: set <key> <value>"));
+        }
+        size_t index;
+        Settings::Descriptor descriptor;
+        if (!findSetting(shell, shell.arg(1), index, descriptor)) {
+            return false;
+        }
+        int32_t value;
+        if (!NumberFormat::parseFixed(shell.arg(2), descriptor.decimals, value)) {
+            return printError(shell, F("bad value"));
+        }
+        if (value < descriptor.min || value > descriptor.max) {
+            return printError(shell, F("out of range"));
+        }
+        // Skip the EEPROM write when nothing changes
+        if (Settings::readPersisted(descriptor) != value) {
+            Settings::writePersisted(descriptor, static_cast<int16_t>(value));
+            LOG_INFO("Setting %S set from serial shell", Settings::name(index));
+        }
+        printSetting(shell, index);
+        return false;
+    }
+
+    bool cmdLog(SerialShell& shell, uint8_t) {
+        if (shell.argc() < 2 || strcmp(shell.arg(1), "level") != 0) {
+            return printError(shell, F("usage: log level [0-6]"));
+        }
+        if (shell.argc() > 2) {
+            int32_t level;
+            if (!NumberFormat::parseFixed(shell.arg(2), 0, level) || level < 0 ||
+                !changeLogLevel(static_cast<size_t>(level))) {
+                return printError(shell, F("level must be 0-6"));
+            }
+        }
+        shell.out().print(F("log level "));
+        shell.printFixed(Log.getLevel(), 0);
+        shell.out().println();
+        return false;
+    }
+
+    bool cmdStats(SerialShell& shell, uint8_t step) {
+        const SerialShell::Context& context = shell.context();
+        Print& out = shell.out();
+        switch (step) {
+            case 0: {
+                out.print(F("uptime ms "));
+                shell.printFixed(static_cast<int32_t>(millis()), 0);
+                if (context.snapshot != nullptr) {
+                    out.print(F(", loop ms "));
+                    shell.printFixed(context.snapshot->read().loop_ms, 0);
+                }
+                out.println();
+                return true;
+            }
+            case 1:
+                if (context.ui != nullptr) {
+                    out.print(F("frames rendered "));
+                    shell.printFixed(static_cast<int32_t>(context.ui->frameStats().rendered), 0);
+                    out.print(F(", skipped "));
+                    shell.printFixed(static_cast<int32_t>(context.ui->frameStats().skipped), 0);
+                    out.println();
+                }
+                return true;
+            case 2:
+                if (context.lcd != nullptr) {
+                    const auto lcd_stats = context.lcd->stats();
+                    out.print(F("lcd B/s "));
+                    shell.printFixed(static_cast<int32_t>(context.lcd->bytesPerSecond()), 0);
+                    out.print(F(", last frame us "));
+                    shell.printFixed(static_cast<int32_t>(lcd_stats.last_frame_micros), 0);
+                    out.print(F(", queue full "));
+                    shell.printFixed(lcd_stats.queue_full_waits, 0);
+                    out.println();
+                }
+                return true;
+            case 3:
+                if (context.telemetry != nullptr) {
+                    out.print(F("telemetry stream ms "));
+                    shell.printFixed(context.telemetry->streamPeriod(), 0);
+                    out.print(F(", dropped frames "));
+                    shell.printFixed(context.telemetry->droppedFrames(), 0);
+                    out.println();
+                }
+                return true;
+            default:
+                if (context.modbus != nullptr) {
+                    const Modbus::RtuSlave::Stats& modbus_stats = context.modbus->stats();
+                    out.print(F("modbus requests "));
+                    shell.printFixed(modbus_stats.requests, 0);
+                    out.print(F(", exceptions "));
+                    shell.printFixed(modbus_stats.exceptions, 0);
+                    out.print(F(", crc errors "));
+                    shell.printFixed(modbus_stats.crc_errors, 0);
+                    out.print(F(", overruns "));
+                    shell.printFixed(modbus_stats.overruns, 0);
+                    out.println();
+                }
+                return false;
+        }
+    }
+
+    bool cmdSensors(SerialShell& shell, uint8_t) {
+        if (shell.context().snapshot == nullptr) {
+            return false;
+        }
+        const Telemetry::Sample sample = shell.context().snapshot->read();
+        shell.out().print(F("external "));
+        printTemperature(shell, sample.external_centi, 2);
+        shell.out().print(F(" C, internal "));
+        printTemperature(shell, sample.internal_centi, 2);
+        shell.out().print(F(" C, fan "));
+        shell.out().println(sample.fan_on ? F("on") : F("off"));
+        return false;
+    }
+
+    bool cmdHistory(SerialShell& shell, uint8_t) {
+        constexpr uint8_t kSamplesPerStep = 3;     // ~20 B each, stays within the TX buffer
+        const TemperatureHistory* history = shell.context().history;
+        if (history == nullptr) {
+            return false;
+        }
+        struct State {
+            TemperatureHistory::Reader reader;
+            uint16_t remaining;
+            bool started;   // The step counter wraps after 255 steps, a long dump takes more
+        };
+        State& state = shell.state<State>();
+        if (!state.started) {
+            int32_t count = history->size();
+            if (shell.argc() > 1 && (!NumberFormat::parseFixed(shell.arg(1), 0, count) || count < 0)) {
+                return printError(shell, F("usage: history [samples]"));
+            }
+            if (count > history->size()) {
+                count = history->size();
+            }
+            state = State{TemperatureHistory::Reader(*history), static_cast<uint16_t>(count), true};
+            state.reader.skip(history->size() - state.remaining);
+            shell.out().print(F("minute ext int fan, "));
+            shell.printFixed(history->usedBytes(), 0);
+            shell.out().println(F(" B used"));
+            return state.remaining > 0;
+        }
+        TemperatureHistory::Sample sample;
+        for (uint8_t i = 0; i < kSamplesPerStep && state.remaining > 0 && state.reader.next(sample); ++i) {
+            // Minutes before the newest sample
+            shell.printFixed(-static_cast<int32_t>(--state.remaining), 0);
+            shell.out().print(' ');
+            printTemperature(shell, sample.external_tenths, 1);
+            shell.out().print(' ');
+            printTemperature(shell, sample.internal_tenths, 1);
+            shell.out().println(sample.fan_on ? F(" 1") : F(" 0"));
+        }
+        if (state.remaining > 0 && state.reader.stale()) {
+            // append() dropped a block the dump had not reached yet
+            return printError(shell, F("history moved on, dump cut short"));
+        }
+        return state.remaining > 0;
+    }
+
+    void printHalfDegrees(SerialShell& shell, int8_t half_degrees) {
+        if (half_degrees == TemperatureTrends::kNoReading) {
+            shell.out().print(F("--"));
+        } else {
+            shell.printFixed(half_degrees * 5, 1);
+        }
+    }
+
+    void printRange(SerialShell& shell, const TemperatureTrends::Range& range) {
+        printHalfDegrees(shell, range.min);
+        shell.out().print('/');
+        printHalfDegrees(shell, range.mean);
+        shell.out().print('/');
+        printHalfDegrees(shell, range.max);
+    }
+
+    /// Summary line step of "trends": coldest and warmest over the week, fan time over a day
+    bool printTrendSummary(SerialShell& shell, const TemperatureTrends& trends, uint8_t step) {
+        constexpr auto kLevel = TemperatureTrends::LEVEL_SIX_HOURS;
+        constexpr uint8_t kDayBuckets = 4;
+        int8_t half_degrees;
+        uint8_t age;
+        switch (step) {
+            case 0:
+                shell.out().print(F("week coldest "));
+                if (trends.coldest(kLevel, TemperatureTrends::kSixHourDepth, half_degrees, age)) {
+                    printHalfDegrees(shell, half_degrees);
+                    shell.out().print(F(" C, "));
+                    shell.printFixed(static_cast<int32_t>(age) * 6, 0);
+                    shell.out().println(F(" h ago"));
+                } else {
+                    shell.out().println(F("--"));
+                }
+                return true;
+            case 1:
+                shell.out().print(F("week warmest "));
+                if (trends.warmest(kLevel, TemperatureTrends::kSixHourDepth, half_degrees, age)) {
+                    printHalfDegrees(shell, half_degrees);
+                    shell.out().print(F(" C, "));
+                    shell.printFixed(static_cast<int32_t>(age) * 6, 0);
+                    shell.out().println(F(" h ago"));
+                } else {
+                    shell.out().println(F("--"));
+                }
+                return true;
+            default:
+                shell.out().print(F("fan last 24 h "));
+                shell.printFixed(trends.fanMinutes(kLevel, kDayBuckets), 0);
+                shell.out().println(F(" min"));
+                return false;
+        }
+    }
+
+    bool cmdTrends(SerialShell& shell, uint8_t step) {
+        const TemperatureTrends* trends = shell.context().trends;
+        if (trends == nullptr) {
+            return false;
+        }
+        if (shell.argc() < 2) {
+            return printTrendSummary(shell, *trends, step);
+        }
+        TemperatureTrends::Level level;
+        if (strcmp(shell.arg(1), "1m") == 0) {
+            level = TemperatureTrends::LEVEL_MINUTE;
+        } else if (strcmp(shell.arg(1), "15m") == 0) {
+            level = TemperatureTrends::LEVEL_QUARTER;
+        } else if (strcmp(shell.arg(1), "6h") == 0) {
+            level = TemperatureTrends::LEVEL_SIX_HOURS;
+        } else {
+            return printError(shell, F("usage: trends [1m|15m|6h]"));
+        }
+        if (step == 0) {
+            shell.out().println(F("age ext min/mean/max, int min/mean/max, fan %"));
+            return trends->count(level) > 0;
+        }
+        // One bucket per step, newest first
+        const uint8_t age = step - 1;
+        TemperatureTrends::Bucket bucket;
+        if (!trends->bucket(level, age, bucket)) {
+            return false;
+        }
+        shell.out().print('-');
+        shell.printFixed(static_cast<int32_t>(age + 1U) * TemperatureTrends::bucketMinutes(level), 0);
+        shell.out().print(F(" min "));
+        printRange(shell, bucket.external);
+        shell.out().print(F(", "));
+        printRange(shell, bucket.internal);
+        shell.out().print(F(", "));
+        shell.printFixed(bucket.fan_percent, 0);
+        shell.out().println();
+        return age + 1U < trends->count(level);
+    }
+
+    void printPermille(SerialShell& shell, uint16_t permille) {
+        shell.out().print(F(" ("));
+        shell.printFixed(permille, 1);
+        shell.out().println(F("% of rated life)"));
+    }
+
+    /// Counter line step of "maint"
+    bool printCounters(SerialShell& shell, const OperationLog& log, uint8_t step) {
+        const OperationLog::Counters& counters = log.counters();
+        Print& out = shell.out();
+        switch (step) {
+            case 0:
+                out.print(F("boots "));
+                shell.printFixed(counters.boots, 0);
+                out.print(F(", fan runtime h "));
+                shell.printFixed(static_cast<int32_t>(counters.fan_on_seconds / 360UL), 1);
+                out.println();
+                return true;
+            case 1:
+                out.print(F("relay cycles "));
+                shell.printFixed(static_cast<int32_t>(counters.relay_cycles), 0);
+                printPermille(shell, log.relayWearPermille());
+                return true;
+            default:
+                out.print(F("eeprom writes "));
+                shell.printFixed(static_cast<int32_t>(counters.counter_writes), 0);
+                out.print('/');
+                shell.printFixed(static_cast<int32_t>(counters.event_writes), 0);
+                out.print(F(", dropped events "));
+                shell.printFixed(counters.dropped_events, 0);
+                printPermille(shell, log.eepromWearPermille());
+                return false;
+        }
+    }
+
+    bool cmdMaint(SerialShell& shell, uint8_t step) {
+        const OperationLog* log = shell.context().operation_log;
+        if (log == nullptr) {
+            return false;
+        }
+        if (shell.argc() < 2) {
+            return printCounters(shell, *log, step);
+        }
+        if (strcmp(shell.arg(1), "events") != 0) {
+            return printError(shell, F("usage: maint [events]"));
+        }
+        if (step == 0) {
+            shell.out().println(F("seq boot minute ext fan"));
+            return log->eventCount() > 0;
+        }
+        // One event per step, newest first
+        const uint8_t age = step - 1;
+        OperationLog::Event event;
+        if (!log->event(age, event)) {
+            return false;
+        }
+        shell.printFixed(event.sequence, 0);
+        shell.out().print(' ');
+        shell.printFixed(event.boot, 0);
+        shell.out().print(' ');
+        shell.printFixed(event.uptime_minutes, 0);
+        shell.out().print(' ');
+        printHalfDegrees(shell, event.external_half_degrees);
+        shell.out().println(event.fanOn() ? F(" on") : F(" off"));
+        return age + 1U < log->eventCount();
+    }
+
+    bool cmdBoot(SerialShell& shell, uint8_t step) {
+        const BootProfile* boot = shell.context().boot;
+        if (boot == nullptr) {
+            return false;
+        }
+        // One step per line, then the total against the budget
+        if (step < BootProfile::STEP_COUNT) {
+            const auto boot_step = static_cast<BootProfile::Step>(step);
+            shell.out().print(BootProfile::name(boot_step));
+            shell.out().print(F(" us "));
+            if (boot->marked(boot_step)) {
+                shell.printFixed(static_cast<int32_t>(boot->stepMicros(boot_step)), 0);
+                shell.out().println();
+            } else {
+                shell.out().println(F("--"));
+            }
+            return true;
+        }
+        shell.out().print(F("fan control after ms "));
+        shell.printFixed(static_cast<int32_t>(boot->endMicros(BootProfile::STEP_FIRST_DECISION) / 1000UL), 0);
+        shell.out().print(F(", budget ms "));
+        shell.printFixed(static_cast<int32_t>(BootProfile::kBudgetMicros / 1000UL), 0);
+        shell.out().println(boot->withinBudget() ? F(", ok") : F(", exceeded"));
+        return false;
+    }
+
+    bool cmdMem(SerialShell& shell, uint8_t step) {
+        // One reading for all lines, the scan runs once
+        MemoryUsage& usage = shell.state<MemoryUsage>();
+        if (step == 0) {
+            usage = HAL::Memory::usage();
+        }
+        Print& out = shell.out();
+        switch (step) {
+            case 0:
+                out.print(F("ram B "));
+                shell.printFixed(usage.total, 0);
+                out.print(F(", data "));
+                shell.printFixed(usage.data, 0);
+                out.print(F(", bss "));
+                shell.printFixed(usage.bss, 0);
+                out.print(F(", heap "));
+                shell.printFixed(usage.heap, 0);
+                out.println();
+                return true;
+            default:
+                out.print(F("free B "));
+                shell.printFixed(usage.free, 0);
+                out.print(F(", stack peak "));
+                shell.printFixed(usage.stack_peak, 0);
+                out.print(F(", never used "));
+                shell.printFixed(usage.unused, 0);
+                out.println();
+                return false;
+        }
+    }
+
+    bool cmdReset(SerialShell& shell, uint8_t) {
+        if (shell.argc() > 1) {
+            if (strcmp(shell.arg(1), "settings") != 0) {
+                return printError(shell, F("usage: reset [settings]"));
+            }
+            resetSettings();
+            shell.out().println(F("settings restored to defaults"));
+            return false;
+        }
+        if (shell.context().operation_log != nullptr) {
+            shell.context().operation_log->flush(millis());
+        }
+        shell.out().println(F("rebooting"));
+        shell.out().flush();
+        HAL::System::reboot();
+        return false;
+    }
+
+    const char kHelpName[] PROGMEM = "help";
+    const char kHelpUsage[] PROGMEM = "help                 list commands";
+    const char kGetName[] PROGMEM = "get";
+    const char kGetUsage[] PROGMEM = "get [key]            show settings";
+    const char kSetName[] PROGMEM = "set";
+    const char kSetUsage[] PROGMEM = "set <key> <value>    change a setting";
+    const char kLogName[] PROGMEM = "log";
+    const char kLogUsage[] PROGMEM = "log level [0-6]      show or change log level";
+    const char kStatsName[] PROGMEM = "stats";
+    const char kStatsUsage[] PROGMEM = "stats                loop, display and link counters";
+    const char kSensorsName[] PROGMEM = "sensors";
+    const char kSensorsUsage[] PROGMEM = "sensors              temperatures and fan state";
+    const char kHistoryName[] PROGMEM = "history";
+    const char kHistoryUsage[] PROGMEM = "history [samples]    per-minute temperature history";
+    const char kTrendsName[] PROGMEM = "trends";
+    const char kTrendsUsage[] PROGMEM = "trends [1m|15m|6h]   week summary or min/mean/max buckets";
+    const char kMaintName[] PROGMEM = "maint";
+    const char kMaintUsage[] PROGMEM = "maint [events]       wear counters or fan switching log";
+    const char kBootName[] PROGMEM = "boot";
+    const char kBootUsage[] PROGMEM = "boot                 boot step timing";
+    const char kMemName[] PROGMEM = "mem";
+    const char kMemUsage[] PROGMEM = "mem                  RAM use and stack high water";
+    const char kResetName[] PROGMEM = "reset";
+    const char kResetUsage[] PROGMEM = "reset [settings]     reboot or restore default settings";
+
+    constexpr SerialShell::Command kCommands[] PROGMEM = {
+        {kHelpName, kHelpUsage, cmdHelp},
+        {kGetName, kGetUsage, cmdGet},
+        {kSetName, kSetUsage, cmdSet},
+        {kLogName, kLogUsage, cmdLog},
+        {kStatsName, kStatsUsage, cmdStats},
+        {kSensorsName, kSensorsUsage, cmdSensors},
+        {kHistoryName, kHistoryUsage, cmdHistory},
+        {kTrendsName, kTrendsUsage, cmdTrends},
+        {kMaintName, kMaintUsage, cmdMaint},
+        {kBootName, kBootUsage, cmdBoot},
+        {kMemName, kMemUsage, cmdMem},
+        {kResetName, kResetUsage, cmdReset},
+    };
+
+    constexpr uint8_t kCommandCount = sizeof(kCommands) / sizeof(kCommands[0]);
+
+    bool cmdHelp(SerialShell& shell, uint8_t step) {
+        SerialShell::Command command;
+        memcpy_P(&command, &kCommands[step], sizeof(command));
+        shell.out().println(reinterpret_cast<const __FlashStringHelper*>(command.usage));
+        return step + 1U < kCommandCount;
+    }
+} // namespace
+
+void SerialShell::feed(uint8_t byte) {
+    // Telemetry frames are 0x00, data, 0x00; back-to-back frames share "0x00 0x00"
+    if (byte == 0) {
+        if (!in_frame_) {
+            in_frame_ = true;
+        } else if (frame_has_data_) {
+            in_frame_ = false;
+        }
+        frame_has_data_ = false;
+        return;
+    }
+    if (in_frame_) {
+        frame_has_data_ = true;
+        return;
+    }
+    const uint8_t next = (rx_head_ + 1) & kRxMask;
+    if (next == rx_tail_) {
+        rx_overflow_ = true;
+        return;
+    }
+    rx_[rx_head_] = byte;
+    rx_head_ = next;
+}
+
+void SerialShell::service() {
+    if (handler_ != nullptr) {
+        if (!handler_(*this, step_++)) {
+            handler_ = nullptr;
+        }
+        return;
+    }
+    collectLine();
+}
+
+void SerialShell::printFixed(int32_t value, uint8_t decimals) {
+    char buffer[13];
+    NumberFormat::Spec spec;
+    spec.decimals = decimals;
+    NumberFormat::formatFixed(buffer, sizeof(buffer), value, spec);
+    out_.print(buffer);
+}
+
+void SerialShell::collectLine() {
+    if (rx_overflow_) {
+        // Bytes were lost, the line being assembled is incomplete
+        rx_overflow_ = false;
+        line_invalid_ = true;
+    }
+    while (rx_tail_ != rx_head_) {
+        const char c = static_cast<char>(rx_[rx_tail_]);
+        rx_tail_ = (rx_tail_ + 1) & kRxMask;
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            if (line_invalid_) {
+                printError(*this, F("line dropped"));
+            } else {
+                line_[line_size_] = '\0';
+                execute();
+            }
+            line_size_ = 0;
+            line_invalid_ = false;
+            return;     // At most one command per call
+        }
+        if (c < ' ' || c > '~' || line_size_ + 1U >= kLineSize) {
+            line_invalid_ = true;
+            continue;
+        }
+        line_[line_size_++] = c;
+    }
+}
+
+void SerialShell::execute() {
+    if (tokenize() == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < kCommandCount; ++i) {
+        Command command;
+        memcpy_P(&command, &kCommands[i], sizeof(command));
+        if (strcmp_P(argv_[0], command.name) == 0) {
+            handler_ = command.handler;
+            step_ = 0;
+            memset(state_, 0, sizeof(state_));
+            service();      // First step right away
+            return;
+        }
+    }
+    printError(*this, F("unknown command, try help"));
+}
+
+uint8_t SerialShell::tokenize() {
+    argc_ = 0;
+    char* cursor = line_;
+    while (*cursor != '\0' && argc_ < kMaxArgs) {
+        while (*cursor == ' ') {
+            *cursor++ = '\0';
+        }
+        if (*cursor == '\0') {
+            break;
+        }
+        argv_[argc_++] = cursor;
+        while (*cursor != '\0' && *cursor != ' ') {
+            ++cursor;
+        }
+    }
+    return argc_;
+}
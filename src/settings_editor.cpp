@@ -0,0 +1,72 @@
+#include "settings_editor.h"
+#include "log.h"
+#include "persistence_manager_instance.h" // For resetSettings()
+
+#include "number_format.h"
+
+namespace {
+    const char kResetValueText[] PROGMEM = "Usuniecie ustawień";
+} // namespace
+
+void SettingsEditor::select(size_t index) {
+    Settings::Descriptor descriptor;
+    Settings::load(index, descriptor);
+    index_ = static_cast<uint8_t>(index);
+    value_ = descriptor.type == Settings::Type::Number ? Settings::readPersisted(descriptor) : 0;
+}
+
+void SettingsEditor::increase() {
+    Settings::Descriptor descriptor;
+    Settings::load(index_, descriptor);
+    value_ = Settings::clamp(descriptor, static_cast<int32_t>(value_) + descriptor.step);
+}
+
+void SettingsEditor::decrease() {
+    Settings::Descriptor descriptor;
+    Settings::load(index_, descriptor);
+    value_ = Settings::clamp(descriptor, static_cast<int32_t>(value_) - descriptor.step);
+}
+
+bool SettingsEditor::save() {
+    Settings::Descriptor descriptor;
+    Settings::load(index_, descriptor);
+    switch (descriptor.type) {
+        case Settings::Type::Number:
+            Settings::writePersisted(descriptor, value_);
+            return true;
+        case Settings::Type::ResetAction:
+            resetSettings();
+            return true;
+    }
+    return false;
+}
+
+void SettingsEditor::discard() {
+    select(index_);
+}
+
+const __FlashStringHelper* SettingsEditor::name() const {
+    return Settings::name(index_);
+}
+
+const __FlashStringHelper* SettingsEditor::screenText() const {
+    return Settings::screenText(index_);
+}
+
+void SettingsEditor::getValueAsString(char* buffer, size_t buffer_size) const {
+    if (buffer_size == 0) {
+        return;
+    }
+    Settings::Descriptor descriptor;
+    Settings::load(index_, descriptor);
+    if (descriptor.type == Settings::Type::ResetAction) {
+        strncpy_P(buffer, kResetValueText, buffer_size);
+        buffer[buffer_size - 1] = '\0';
+        return;
+    }
+    NumberFormat::Spec spec;
+    spec.decimals = descriptor.decimals;
+    if (NumberFormat::formatFixed(buffer, buffer_size, value_, spec) == 0) {
+        LOG_WARNING("Value buffer of %d bytes too small", static_cast<int>(buffer_size));
+    }
+}
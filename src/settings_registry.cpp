@@ -0,0 +1,185 @@
+#include "settings_registry.h"
+#include "config_image.h"
+#include "log.h"
+#include "persistence_manager_instance.h" // For accessing persistence manager functions
+
+#include <math.h>
+
+namespace {
+    // Constants for settings, in descriptor units (tenths for temperatures)
+    constexpr int16_t TEMPERATURE_STEP = 5; // Minimum/maximum external temperature step [0.1 C]
+    constexpr int16_t TIME_DIFFERENCE_HYSTERESIS_STEP = 1; // Time difference hysteresis step [s]
+    constexpr int16_t TEMPERATURE_DIFFERENCE_HYSTERESIS_STEP = 5; // Temperature difference hysteresis step [0.1 C]
+
+    const char kMinimalExternalTemperatureKey[] PROGMEM = "min_ext";
+    const char kMaximalExternalTemperatureKey[] PROGMEM = "max_ext";
+    const char kTemperatureDifferenceHysteresisKey[] PROGMEM = "temp_diff";
+    const char kSwitchTimeHysteresisKey[] PROGMEM = "switch_time";
+    const char kModbusAddressKey[] PROGMEM = "modbus_addr";
+    const char kResetSettingsKey[] PROGMEM = "reset";
+
+    const char kMinimalExternalTemperatureName[] PROGMEM = "Minimal External Temp";
+    const char kMinimalExternalTemperatureText[] PROGMEM = "Min temp zewn";
+    const char kMaximalExternalTemperatureName[] PROGMEM = "Maximal External Temp";
+    const char kMaximalExternalTemperatureText[] PROGMEM = "Max temp zewn";
+    const char kTemperatureDifferenceHysteresisName[] PROGMEM = "Temperature Difference Hyst";
+    const char kTemperatureDifferenceHysteresisText[] PROGMEM = "Temp różnica";
+    const char kSwitchTimeHysteresisName[] PROGMEM = "Switch Time Hysteresis";
+    const char kSwitchTimeHysteresisText[] PROGMEM = "Czas różnica";
+    const char kModbusAddressName[] PROGMEM = "Modbus Address";
+    const char kModbusAddressText[] PROGMEM = "Adres Modbus";
+    const char kResetSettingsName[] PROGMEM = "Reset Settings";
+    const char kResetSettingsText[] PROGMEM = "Resetuj ustw";
+
+    constexpr Settings::Descriptor kSettings[] PROGMEM = {
+        {kMinimalExternalTemperatureKey, kMinimalExternalTemperatureName, kMinimalExternalTemperatureText,
+         Settings::Type::Number, PersistenceField::MinimalExternalTemperature,
+         1, TEMPERATURE_STEP, -100, 250},
+        {kMaximalExternalTemperatureKey, kMaximalExternalTemperatureName, kMaximalExternalTemperatureText,
+         Settings::Type::Number, PersistenceField::MaximalExternalTemperature,
+         1, TEMPERATURE_STEP, 0, 350},
+        {kTemperatureDifferenceHysteresisKey, kTemperatureDifferenceHysteresisName, kTemperatureDifferenceHysteresisText,
+         Settings::Type::Number, PersistenceField::TemperatureDifferenceHysteresis,
+         1, TEMPERATURE_DIFFERENCE_HYSTERESIS_STEP, 0, 100},
+        {kSwitchTimeHysteresisKey, kSwitchTimeHysteresisName, kSwitchTimeHysteresisText,
+         Settings::Type::Number, PersistenceField::SwitchTimeHysteresis,
+         0, TIME_DIFFERENCE_HYSTERESIS_STEP, 0, 3600},
+        {kModbusAddressKey, kModbusAddressName, kModbusAddressText,
+         Settings::Type::Number, PersistenceField::ModbusAddress,
+         0, 1, 1, 247},
+        {kResetSettingsKey, kResetSettingsName, kResetSettingsText,
+         Settings::Type::ResetAction, PersistenceField::None,
+         0, 0, 0, 0},
+    };
+
+    constexpr size_t kSettingsCount = sizeof(kSettings) / sizeof(kSettings[0]);
+
+    // Number settings, one configuration image entry each
+    constexpr size_t countNumberSettings() {
+        size_t count = 0;
+        for (const Settings::Descriptor& descriptor : kSettings) {
+            count += descriptor.type == Settings::Type::Number ? 1 : 0;
+        }
+        return count;
+    }
+    static_assert(countNumberSettings() <= ConfigImage::kMaxEntries,
+                  "ConfigImage::kMaxEntries must hold every Number setting");
+
+    float scaleOf(const Settings::Descriptor& descriptor) {
+        float scale = 1.0f;
+        for (uint8_t i = 0; i < descriptor.decimals; ++i) {
+            scale *= 10.0f;
+        }
+        return scale;
+    }
+} // namespace
+
+namespace Settings
+{
+    size_t count() {
+        return kSettingsCount;
+    }
+
+    void load(size_t index, Descriptor& descriptor) {
+        if (index >= kSettingsCount) {
+            LOG_ERROR("Setting index %d out of range", static_cast<int>(index));
+            index = kSettingsCount - 1;
+        }
+        memcpy_P(&descriptor, &kSettings[index], sizeof(descriptor));
+    }
+
+    bool find(PersistenceField field, Descriptor& descriptor) {
+        if (field == PersistenceField::None) {
+            return false;
+        }
+        for (size_t i = 0; i < kSettingsCount; ++i) {
+            load(i, descriptor);
+            if (descriptor.type == Type::Number && descriptor.field == field) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int8_t indexOf(const char* key) {
+        Descriptor descriptor;
+        for (size_t i = 0; i < kSettingsCount; ++i) {
+            load(i, descriptor);
+            if (strcmp_P(key, descriptor.key) == 0) {
+                return static_cast<int8_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    const __FlashStringHelper* key(size_t index) {
+        Descriptor descriptor;
+        load(index, descriptor);
+        return reinterpret_cast<const __FlashStringHelper*>(descriptor.key);
+    }
+
+    const __FlashStringHelper* name(size_t index) {
+        Descriptor descriptor;
+        load(index, descriptor);
+        return reinterpret_cast<const __FlashStringHelper*>(descriptor.name);
+    }
+
+    const __FlashStringHelper* screenText(size_t index) {
+        Descriptor descriptor;
+        load(index, descriptor);
+        return reinterpret_cast<const __FlashStringHelper*>(descriptor.screen_text);
+    }
+
+    int16_t readPersisted(const Descriptor& descriptor) {
+        const float scale = scaleOf(descriptor);
+        switch (descriptor.field) {
+            case PersistenceField::MinimalExternalTemperature:
+                return clamp(descriptor, lroundf(getMinimalExternalTemperature() * scale));
+            case PersistenceField::MaximalExternalTemperature:
+                return clamp(descriptor, lroundf(getMaximalExternalTemperature() * scale));
+            case PersistenceField::TemperatureDifferenceHysteresis:
+                return clamp(descriptor, lroundf(getTemperatureDifferenceHysteresis() * scale));
+            case PersistenceField::SwitchTimeHysteresis:
+                return clamp(descriptor, static_cast<int32_t>(getSwitchTimeHysteresis()));
+            case PersistenceField::ModbusAddress:
+                return clamp(descriptor, getModbusAddress());
+            case PersistenceField::None:
+                break;
+        }
+        return 0;
+    }
+
+    void writePersisted(const Descriptor& descriptor, int16_t value) {
+        const float scaled = static_cast<float>(clamp(descriptor, value)) / scaleOf(descriptor);
+        switch (descriptor.field) {
+            case PersistenceField::MinimalExternalTemperature:
+                setMinimalExternalTemperature(scaled);
+                break;
+            case PersistenceField::MaximalExternalTemperature:
+                setMaximalExternalTemperature(scaled);
+                break;
+            case PersistenceField::TemperatureDifferenceHysteresis:
+                setTemperatureDifferenceHysteresis(scaled);
+                break;
+            case PersistenceField::SwitchTimeHysteresis:
+                setSwitchTimeHysteresis(static_cast<size_t>(clamp(descriptor, value)));
+                break;
+            case PersistenceField::ModbusAddress:
+                setModbusAddress(static_cast<uint8_t>(clamp(descriptor, value)));
+                break;
+            case PersistenceField::None:
+                LOG_WARNING("Setting has no persistence field");
+                break;
+        }
+    }
+
+    int16_t clamp(const Descriptor& descriptor, int32_t value) {
+        if (value < descriptor.min) {
+            return descriptor.min;
+        }
+        if (value > descriptor.max) {
+            return descriptor.max;
+        }
+        return static_cast<int16_t>(value);
+    }
+} // namespace Settings
@@ -0,0 +1,207 @@
+#include "telemetry.h"
+#include "settings_registry.h"
+
+#include <CRC16.h>
+#include <math.h>
+#include <string.h>
+
+namespace {
+    void putU16(uint8_t* out, uint16_t value) {
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void putU32(uint8_t* out, uint32_t value) {
+        putU16(out, static_cast<uint16_t>(value));
+        putU16(out + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    uint16_t getU16(const uint8_t* in) {
+        return static_cast<uint16_t>(in[0] | (in[1] << 8));
+    }
+
+    constexpr size_t kSampleSize = 11;
+} // namespace
+
+namespace Telemetry
+{
+    int16_t Sample::toCenti(float celsius) {
+        if (isnan(celsius) || celsius >= 327.67f || celsius <= -327.67f) {
+            return kNoReading;
+        }
+        return static_cast<int16_t>(lroundf(celsius * 100.0f));
+    }
+
+    void SnapshotBuffer::publish(const Sample& sample) {
+        const uint8_t back = front_ ^ 1U;
+        slots_[back] = sample;
+        asm volatile("" ::: "memory");
+        front_ = back;
+        sequence_ = sequence_ + 1U;
+    }
+
+    Sample SnapshotBuffer::read() const {
+        Sample copy;
+        uint16_t sequence;
+        do {
+            sequence = sequence_;
+            asm volatile("" ::: "memory");
+            copy = slots_[front_];
+            asm volatile("" ::: "memory");
+        } while (sequence != sequence_);
+        return copy;
+    }
+
+    uint16_t crc16(const uint8_t* data, size_t size) {
+        CRC16 crc(0x1021, 0xFFFF, 0x0000, false, false);
+        crc.add(data, static_cast<uint16_t>(size));
+        return crc.calc();
+    }
+
+    void Link::feed(uint8_t byte) {
+        if (byte != 0) {
+            if (rx_size_ < sizeof(rx_)) {
+                rx_[rx_size_++] = byte;
+            } else {
+                rx_overflow_ = true;
+            }
+            return;
+        }
+        // Delimiter: empty frames are the leading delimiters, skip them
+        if (rx_size_ > 0) {
+            if (rx_overflow_) {
+                ++dropped_frames_;
+            } else {
+                const size_t size = Cobs::decode(rx_, rx_size_, rx_, sizeof(rx_));
+                handleFrame(rx_, size);
+            }
+        }
+        rx_size_ = 0;
+        rx_overflow_ = false;
+    }
+
+    void Link::handleFrame(const uint8_t* payload, size_t size) {
+        if (size < 4 || crc16(payload, size - 2) != getU16(payload + size - 2)) {
+            ++dropped_frames_;
+            return;
+        }
+        // payload[1] is the host's sequence number, responses use their own
+        handleRequest(payload[0], payload + 2, size - 4);
+    }
+
+    void Link::handleRequest(uint8_t type, const uint8_t* body, size_t size) {
+        switch (type) {
+            case MSG_READ_FIELD:
+                if (size != 1) {
+                    sendNack(type, ERROR_BAD_LENGTH);
+                    return;
+                }
+                sendFieldValue(type, body[0]);
+                return;
+            case MSG_WRITE_FIELD: {
+                if (size != 3) {
+                    sendNack(type, ERROR_BAD_LENGTH);
+                    return;
+                }
+                Settings::Descriptor descriptor;
+                if (!Settings::find(static_cast<PersistenceField>(body[0]), descriptor)) {
+                    sendNack(type, ERROR_UNKNOWN_FIELD);
+                    return;
+                }
+                const int16_t value = static_cast<int16_t>(getU16(body + 1));
+                // Skip the EEPROM write when nothing changes
+                if (Settings::readPersisted(descriptor) != Settings::clamp(descriptor, value)) {
+                    Settings::writePersisted(descriptor, value);
+                }
+                sendFieldValue(type, body[0]);
+                return;
+            }
+            case MSG_SET_STREAM: {
+                if (size != 2) {
+                    sendNack(type, ERROR_BAD_LENGTH);
+                    return;
+                }
+                stream_period_ms_ = getU16(body);
+                uint8_t ack[2];
+                putU16(ack, stream_period_ms_);
+                send(type | MSG_RESPONSE, ack, sizeof(ack));
+                return;
+            }
+            case MSG_READ_CONFIG:
+                if (size != 0) {
+                    sendNack(type, ERROR_BAD_LENGTH);
+                    return;
+                }
+                sendConfig(type);
+                return;
+            case MSG_WRITE_CONFIG: {
+                const ConfigImage::Result result = ConfigImage::importImage(body, size);
+                if (result != ConfigImage::RESULT_OK) {
+                    sendNack(type, static_cast<Error>(ERROR_IMAGE_SIZE - ConfigImage::RESULT_BAD_SIZE + result));
+                    return;
+                }
+                sendConfig(type);
+                return;
+            }
+            default:
+                sendNack(type, ERROR_UNKNOWN_TYPE);
+                return;
+        }
+    }
+
+    void Link::sendFieldValue(uint8_t type, uint8_t field) {
+        Settings::Descriptor descriptor;
+        if (!Settings::find(static_cast<PersistenceField>(field), descriptor)) {
+            sendNack(type, ERROR_UNKNOWN_FIELD);
+            return;
+        }
+        uint8_t body[4];
+        body[0] = field;
+        putU16(body + 1, static_cast<uint16_t>(Settings::readPersisted(descriptor)));
+        body[3] = descriptor.decimals;
+        send(type | MSG_RESPONSE, body, sizeof(body));
+    }
+
+    void Link::sendConfig(uint8_t type) {
+        uint8_t image[ConfigImage::kMaxSize];
+        const size_t size = ConfigImage::exportImage(image, sizeof(image));
+        send(type | MSG_RESPONSE, image, size);
+    }
+
+    void Link::sendNack(uint8_t type, Error error) {
+        const uint8_t body[2] = {type, error};
+        send(MSG_NACK, body, sizeof(body));
+    }
+
+    void Link::service(uint32_t now_ms) {
+        if (stream_period_ms_ == 0 || now_ms - last_stream_ms_ < stream_period_ms_) {
+            return;
+        }
+        last_stream_ms_ = now_ms;
+        const Sample sample = snapshot_.read();
+        uint8_t body[kSampleSize];
+        putU32(body, sample.uptime_ms);
+        putU16(body + 4, static_cast<uint16_t>(sample.external_centi));
+        putU16(body + 6, static_cast<uint16_t>(sample.internal_centi));
+        body[8] = sample.fan_on ? 1 : 0;
+        putU16(body + 9, sample.loop_ms);
+        send(MSG_SAMPLE, body, sizeof(body));
+    }
+
+    void Link::send(uint8_t type, const uint8_t* body, size_t size) {
+        if (size > kMaxBody) {
+            return;
+        }
+        uint8_t payload[kMaxPayload];
+        payload[0] = type;
+        payload[1] = tx_sequence_++;
+        memcpy(payload + 2, body, size);
+        putU16(payload + 2 + size, crc16(payload, 2 + size));
+
+        uint8_t frame[kMaxFrame];
+        frame[0] = 0;
+        const size_t encoded = Cobs::encode(payload, size + 4, frame + 1, sizeof(frame) - 2);
+        frame[encoded + 1] = 0;
+        out_.write(frame, encoded + 2);
+    }
+} // namespace Telemetry
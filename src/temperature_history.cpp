@@ -0,0 +1,251 @@
+#include "temperature_history.h"
+
+namespace {
+    constexpr int16_t kMaxTenths = 2047;
+    constexpr uint16_t kNoReadingCode = 0x800;    // -2048 as 12-bit two's complement
+    constexpr int16_t kDeadBand = 2;               // Tenths absorbed without a code
+    // Coded changes start past the dead band: 2 bits of magnitude, then 5
+    constexpr int16_t kSmallDelta = kDeadBand + 4;
+    constexpr int16_t kMediumDelta = kSmallDelta + 32;
+
+    uint16_t encode12(int16_t tenths) {
+        if (tenths == TemperatureHistory::kNoReading) {
+            return kNoReadingCode;
+        }
+        if (tenths > kMaxTenths) {
+            tenths = kMaxTenths;
+        } else if (tenths < -kMaxTenths) {
+            tenths = -kMaxTenths;
+        }
+        return static_cast<uint16_t>(tenths) & 0x0FFFU;
+    }
+
+    int16_t decode12(uint16_t code) {
+        if (code == kNoReadingCode) {
+            return TemperatureHistory::kNoReading;
+        }
+        // Sign-extend bit 11
+        return static_cast<int16_t>((code & 0x800U) ? (code | 0xF000U) : code);
+    }
+
+    bool isValid(int16_t tenths) {
+        return tenths != TemperatureHistory::kNoReading;
+    }
+} // namespace
+
+void TemperatureHistory::clear() {
+    oldest_ = newest_ = blocks_ = 0;
+    size_ = 0;
+    appended_ = 0;
+    ++generation_;
+    last_ = Sample{};
+}
+
+void TemperatureHistory::append(const Sample& input) {
+    Sample sample = input;
+    // Values outside the 12-bit range are stored clamped, the decoder must agree
+    sample.external_tenths = decode12(encode12(sample.external_tenths));
+    sample.internal_tenths = decode12(encode12(sample.internal_tenths));
+    ++appended_;
+    if (blocks_ == 0) {
+        startBlock(sample);
+        return;
+    }
+    sample.external_tenths = applyDeadBand(last_.external_tenths, sample.external_tenths);
+    sample.internal_tenths = applyDeadBand(last_.internal_tenths, sample.internal_tenths);
+
+    const int16_t external_delta = sample.external_tenths - last_.external_tenths;
+    const int16_t internal_delta = sample.internal_tenths - last_.internal_tenths;
+    const bool unchanged = external_delta == 0 && internal_delta == 0 && sample.fan_on == last_.fan_on;
+    const uint16_t bits = unchanged ? 1U :
+        1U + channelBits(external_delta, !isValid(sample.external_tenths) || !isValid(last_.external_tenths)) +
+             channelBits(internal_delta, !isValid(sample.internal_tenths) || !isValid(last_.internal_tenths)) + 1U;
+    if (bits_[newest_] + bits > kBlockBits || samples_[newest_] == 0xFF) {
+        startBlock(sample);
+        return;
+    }
+    if (unchanged) {
+        writeBits(0, 1);
+    } else {
+        writeBits(1, 1);
+        writeChannel(last_.external_tenths, sample.external_tenths);
+        writeChannel(last_.internal_tenths, sample.internal_tenths);
+        writeBits(sample.fan_on != last_.fan_on ? 1 : 0, 1);
+    }
+    ++samples_[newest_];
+    ++size_;
+    last_ = sample;
+}
+
+uint16_t TemperatureHistory::usedBytes() const {
+    uint16_t bytes = 0;
+    for (uint8_t i = 0, block = oldest_; i < blocks_; ++i, block = (block + 1) % kBlockCount) {
+        bytes += (bits_[block] + 7U) / 8U;
+    }
+    return bytes;
+}
+
+void TemperatureHistory::startBlock(const Sample& sample) {
+    if (blocks_ == kBlockCount) {
+        // Full: the oldest block makes room
+        size_ -= samples_[oldest_];
+        oldest_ = (oldest_ + 1) % kBlockCount;
+        --blocks_;
+        ++generation_;
+    }
+    newest_ = blocks_ == 0 ? oldest_ : (newest_ + 1) % kBlockCount;
+    ++blocks_;
+    bits_[newest_] = 0;
+    samples_[newest_] = 1;
+    writeBits(encode12(sample.external_tenths), 12);
+    writeBits(encode12(sample.internal_tenths), 12);
+    writeBits(sample.fan_on ? 1 : 0, 1);
+    writeBits(0, kKeyFrameBits - 25);
+    ++size_;
+    last_ = sample;
+}
+
+void TemperatureHistory::writeBits(uint16_t value, uint8_t count) {
+    uint8_t* block = data_[newest_];
+    uint16_t bit = bits_[newest_];
+    while (count-- > 0) {
+        const uint8_t mask = static_cast<uint8_t>(0x80U >> (bit & 7U));
+        if ((value >> count) & 1U) {
+            block[bit >> 3] |= mask;
+        } else {
+            block[bit >> 3] &= static_cast<uint8_t>(~mask);
+        }
+        ++bit;
+    }
+    bits_[newest_] = bit;
+}
+
+uint8_t TemperatureHistory::channelBits(int16_t delta, bool absolute) {
+    const int16_t magnitude = delta < 0 ? -delta : delta;
+    if (absolute || magnitude > kMediumDelta) {
+        return delta == 0 ? 1 : 15;
+    }
+    if (magnitude == 0) {
+        return 1;
+    }
+    return magnitude <= kSmallDelta ? 5 : 9;
+}
+
+void TemperatureHistory::writeChannel(int16_t previous, int16_t value) {
+    const int16_t delta = value - previous;
+    const int16_t magnitude = delta < 0 ? -delta : delta;
+    if (delta == 0) {
+        writeBits(0, 1);
+    } else if (!isValid(previous) || !isValid(value) || magnitude > kMediumDelta) {
+        writeBits(0b111, 3);
+        writeBits(encode12(value), 12);
+    } else if (magnitude <= kSmallDelta) {
+        writeBits(0b10, 2);
+        writeBits(delta < 0 ? 1 : 0, 1);
+        writeBits(static_cast<uint16_t>(magnitude - kDeadBand - 1), 2);
+    } else {
+        writeBits(0b110, 3);
+        writeBits(delta < 0 ? 1 : 0, 1);
+        writeBits(static_cast<uint16_t>(magnitude - kSmallDelta - 1), 5);
+    }
+}
+
+int16_t TemperatureHistory::applyDeadBand(int16_t previous, int16_t value) const {
+    if (isValid(previous) && isValid(value) && value - previous <= kDeadBand && previous - value <= kDeadBand) {
+        return previous;
+    }
+    return value;
+}
+
+TemperatureHistory::Reader::Reader(const TemperatureHistory& history)
+    : history_(&history), block_(history.oldest_), blocks_left_(history.blocks_), generation_(history.generation_) {
+}
+
+bool TemperatureHistory::Reader::stale() const {
+    return generation_ != history_->generation_;
+}
+
+void TemperatureHistory::Reader::skip(uint16_t count) {
+    while (count > 0) {
+        if (samples_left_ == 0) {
+            if (blocks_left_ == 0) {
+                return;
+            }
+            // Whole blocks are skipped by their sample count
+            const uint8_t in_block = history_->samples_[block_];
+            if (count >= in_block) {
+                count -= in_block;
+                block_ = (block_ + 1) % kBlockCount;
+                --blocks_left_;
+                continue;
+            }
+        }
+        Sample ignored;
+        next(ignored);
+        --count;
+    }
+}
+
+bool TemperatureHistory::Reader::next(Sample& sample) {
+    if (stale()) {
+        return false;
+    }
+    if (samples_left_ == 0) {
+        if (blocks_left_ == 0) {
+            return false;
+        }
+        enterBlock();
+    }
+    if (at_key_frame_) {
+        current_.external_tenths = decode12(readBits(12));
+        current_.internal_tenths = decode12(readBits(12));
+        current_.fan_on = readBits(1) != 0;
+        bit_ = kKeyFrameBits;
+        at_key_frame_ = false;
+    } else if (readBits(1)) {
+        current_.external_tenths = readChannel(current_.external_tenths);
+        current_.internal_tenths = readChannel(current_.internal_tenths);
+        if (readBits(1)) {
+            current_.fan_on = !current_.fan_on;
+        }
+    }
+    if (--samples_left_ == 0) {
+        block_ = (block_ + 1) % kBlockCount;
+        --blocks_left_;
+    }
+    sample = current_;
+    return true;
+}
+
+void TemperatureHistory::Reader::enterBlock() {
+    samples_left_ = history_->samples_[block_];
+    bit_ = 0;
+    at_key_frame_ = true;
+}
+
+uint16_t TemperatureHistory::Reader::readBits(uint8_t count) {
+    const uint8_t* block = history_->data_[block_];
+    uint16_t value = 0;
+    while (count-- > 0) {
+        value = static_cast<uint16_t>((value << 1) | ((block[bit_ >> 3] >> (7U - (bit_ & 7U))) & 1U));
+        ++bit_;
+    }
+    return value;
+}
+
+int16_t TemperatureHistory::Reader::readChannel(int16_t previous) {
+    if (!readBits(1)) {
+        return previous;
+    }
+    if (!readBits(1)) {
+        const bool negative = readBits(1) != 0;
+        const int16_t magnitude = static_cast<int16_t>(readBits(2) + kDeadBand + 1);
+        return negative ? previous - magnitude : previous + magnitude;
+    }
+    if (!readBits(1)) {
+        const bool negative = readBits(1) != 0;
+        const int16_t magnitude = static_cast<int16_t>(readBits(5) + kSmallDelta + 1);
+        return negative ? previous - magnitude : previous + magnitude;
+    }
+    return decode12(readBits(12));
+}
@@ -13,8 +13,18 @@ Sensor::TemperatureSensor::TemperatureSensor(uint8_t pin):
 
 void Sensor::TemperatureSensor::begin() {
     _sensor.begin();
-    _sensor.setResolution(kMaxTempRes);
-    LOG_DEBUG("Temperature sensor on pin %d set to resolution %d bits", _pin, kMaxTempRes);
+    // The resolution is kept in the sensor's EEPROM, only write it when it differs
+    const uint8_t resolution = _sensor.getResolution();
+    if (resolution != kMaxTempRes) {
+        _sensor.setResolution(kMaxTempRes);
+        LOG_INFO("Temperature sensor on pin %d changed from %d to %d bits", _pin, resolution, kMaxTempRes);
+    } else {
+        LOG_DEBUG("Temperature sensor on pin %d already at %d bits", _pin, kMaxTempRes);
+    }
+    // A 12-bit conversion takes 750 ms, the loop keeps serving the keypad meanwhile
+    _sensor.setWaitForConversion(false);
+    _sensor.requestTemperatures();
+    _requested_at = millis();
 }
 
 bool Sensor::TemperatureSensor::isConnected() noexcept {
@@ -29,31 +39,23 @@ float Sensor::TemperatureSensor::readTemperature() noexcept {
         return NAN; // Return NaN if sensor is not connected
     }
 
-    _sensor.requestTemperatures();
+    const unsigned long elapsed = millis() - _requested_at;
+    const uint16_t conversion_ms = _sensor.millisToWaitForConversion();
+    if (elapsed < conversion_ms) {
+        if (_filter.count() > 0) {
+            return _filter.mean();
+        }
+        delay(conversion_ms - elapsed);    // Nothing to show yet, wait for the first conversion
+    }
     float raw = _sensor.getTempCByIndex(0);
+    _sensor.requestTemperatures();
+    _requested_at = millis();
     LOG_VERBOSE("Raw temperature read from pin %d: %F °C", _pin, raw);
 
     // Load into moving‐average filter
-    loadIntoFilter(raw);
-    float average = _sum / static_cast<float>(_bufCount);
+    _filter.add(raw);
+    float average = _filter.mean();
     LOG_VERBOSE("Filtered (mean) temperature: %F °C", average);
 
     return average;
 }
-
-
-void Sensor::TemperatureSensor::loadIntoFilter(float sample) {
-    // subtract oldest value from sum
-    if (_bufCount == kFilterSize) {
-        _sum -= _buffer[_bufIndex];
-    } else {
-        _bufCount++;
-    }
-
-    // store new sample
-    _buffer[_bufIndex] = sample;
-    _sum += sample;
-
-    // advance index (wrapping around)
-    _bufIndex = ( _bufIndex + 1 ) % kFilterSize;
-}
@@ -0,0 +1,164 @@
+#include "temperature_trends.h"
+
+namespace {
+    constexpr uint32_t kMinuteMs = 60UL * 1000UL;
+
+    int32_t roundedDivide(int32_t value, int32_t divisor) {
+        return (value >= 0 ? value + divisor / 2 : value - divisor / 2) / divisor;
+    }
+} // namespace
+
+int8_t TemperatureTrends::toHalfDegrees(int16_t tenths) {
+    if (tenths == kNoReadingTenths) {
+        return kNoReading;
+    }
+    const int32_t half_degrees = roundedDivide(tenths, 5);
+    if (half_degrees > 127) {
+        return 127;
+    }
+    return static_cast<int8_t>(half_degrees < -127 ? -127 : half_degrees);
+}
+
+void TemperatureTrends::ChannelAccumulator::add(int16_t tenths) {
+    if (tenths == kNoReadingTenths) {
+        return;
+    }
+    if (valid == 0 || tenths < min) {
+        min = tenths;
+    }
+    if (valid == 0 || tenths > max) {
+        max = tenths;
+    }
+    sum += tenths;
+    ++valid;
+}
+
+void TemperatureTrends::ChannelAccumulator::merge(const ChannelAccumulator& other) {
+    if (other.valid == 0) {
+        return;
+    }
+    if (valid == 0 || other.min < min) {
+        min = other.min;
+    }
+    if (valid == 0 || other.max > max) {
+        max = other.max;
+    }
+    sum += other.sum;
+    valid += other.valid;
+}
+
+TemperatureTrends::Range TemperatureTrends::ChannelAccumulator::toRange() const {
+    Range range;
+    if (valid > 0) {
+        range.min = toHalfDegrees(min);
+        range.max = toHalfDegrees(max);
+        range.mean = toHalfDegrees(static_cast<int16_t>(roundedDivide(sum, static_cast<int32_t>(valid))));
+    }
+    return range;
+}
+
+void TemperatureTrends::Accumulator::merge(const Accumulator& other) {
+    external.merge(other.external);
+    internal.merge(other.internal);
+    samples += other.samples;
+    fan_samples += other.fan_samples;
+    ++children;
+}
+
+TemperatureTrends::Bucket TemperatureTrends::Accumulator::toBucket() const {
+    Bucket bucket;
+    bucket.external = external.toRange();
+    bucket.internal = internal.toRange();
+    bucket.fan_percent = samples > 0 ? static_cast<uint8_t>((fan_samples * 100U + samples / 2U) / samples) : 0;
+    return bucket;
+}
+
+void TemperatureTrends::addSample(uint32_t now_ms, int16_t external_tenths, int16_t internal_tenths, bool fan_on) {
+    if (!started_) {
+        started_ = true;
+        minute_start_ms_ = now_ms;
+    }
+    // A late loop closes the minute once, the gap is not filled with empty buckets
+    if (now_ms - minute_start_ms_ >= kMinuteMs) {
+        close(LEVEL_MINUTE);
+        minute_start_ms_ += ((now_ms - minute_start_ms_) / kMinuteMs) * kMinuteMs;
+    }
+    Accumulator& minute = open_[LEVEL_MINUTE];
+    minute.external.add(external_tenths);
+    minute.internal.add(internal_tenths);
+    ++minute.samples;
+    if (fan_on) {
+        ++minute.fan_samples;
+    }
+}
+
+void TemperatureTrends::close(uint8_t level) {
+    if (open_[level].samples > 0) {
+        buckets_[kOffset[level] + heads_[level]] = open_[level].toBucket();
+        heads_[level] = (heads_[level] + 1) % kDepth[level];
+        if (counts_[level] < kDepth[level]) {
+            ++counts_[level];
+        }
+        // Cascade into the coarser level, O(1) per level
+        const uint8_t parent = level + 1;
+        if (parent < LEVEL_COUNT) {
+            open_[parent].merge(open_[level]);
+            if (open_[parent].children >= kChildren[parent]) {
+                close(parent);
+            }
+        }
+    }
+    open_[level] = Accumulator{};
+}
+
+bool TemperatureTrends::bucket(Level level, uint8_t age, Bucket& out) const {
+    if (level >= LEVEL_COUNT || age >= counts_[level]) {
+        return false;
+    }
+    const uint8_t slot = (heads_[level] + kDepth[level] - 1 - age) % kDepth[level];
+    out = buckets_[kOffset[level] + slot];
+    return true;
+}
+
+uint16_t TemperatureTrends::bucketMinutes(Level level) {
+    uint16_t minutes = 1;
+    for (uint8_t i = 1; i <= level && i < LEVEL_COUNT; ++i) {
+        minutes *= kChildren[i];
+    }
+    return minutes;
+}
+
+bool TemperatureTrends::coldest(Level level, uint8_t buckets, int8_t& half_degrees, uint8_t& age) const {
+    bool found = false;
+    Bucket current;
+    for (uint8_t i = 0; i < buckets && bucket(level, i, current); ++i) {
+        if (current.external.min != kNoReading && (!found || current.external.min < half_degrees)) {
+            half_degrees = current.external.min;
+            age = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool TemperatureTrends::warmest(Level level, uint8_t buckets, int8_t& half_degrees, uint8_t& age) const {
+    bool found = false;
+    Bucket current;
+    for (uint8_t i = 0; i < buckets && bucket(level, i, current); ++i) {
+        if (current.external.max != kNoReading && (!found || current.external.max > half_degrees)) {
+            half_degrees = current.external.max;
+            age = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+uint16_t TemperatureTrends::fanMinutes(Level level, uint8_t buckets) const {
+    uint32_t percent_minutes = 0;
+    Bucket current;
+    for (uint8_t i = 0; i < buckets && bucket(level, i, current); ++i) {
+        percent_minutes += static_cast<uint32_t>(current.fan_percent) * bucketMinutes(level);
+    }
+    return static_cast<uint16_t>((percent_minutes + 50U) / 100U);
+}
@@ -0,0 +1,123 @@
+#include "ui_state_machine.h"
+#include "user_interface.h"
+#include "log.h"
+
+UserInterface* UiState::ui_ = nullptr;
+
+template <typename S>
+void UiState::transitTo(uint8_t regions) {
+    ui_->invalidate(regions);
+    transit<S>();
+}
+
+template <typename S, typename Action>
+void UiState::transitTo(uint8_t regions, Action action) {
+    ui_->invalidate(regions);
+    transit<S>(action);
+}
+
+class MainScreenState : public UiState {
+public:
+    using UiState::react;
+    void entry() override;
+    void react(KeySelectEvent const &) override;
+};
+
+class SettingsMenuState : public UiState {
+public:
+    using UiState::react;
+    void entry() override;
+    void react(KeySelectEvent const &) override;
+    void react(KeyUpEvent const &) override;
+    void react(KeyDownEvent const &) override;
+    void react(KeyNextEvent const &) override;
+    void react(KeyPrevEvent const &) override;
+};
+
+class EditSettingState : public UiState {
+public:
+    using UiState::react;
+    void entry() override;
+    void react(KeySelectEvent const &) override;
+    void react(KeyUpEvent const &) override;
+    void react(KeyDownEvent const &) override;
+    void react(KeyPrevEvent const &) override;
+};
+
+// --- MAIN_SCREEN ---
+
+void MainScreenState::entry() {
+    ui_->current_state_ = UserInterface::MAIN_SCREEN;
+}
+
+void MainScreenState::react(KeySelectEvent const &) {
+    transitTo<SettingsMenuState>(UserInterface::REGION_ALL, [] { ui_->current_setting_ = 0; });
+}
+
+// --- SETTINGS_MENU ---
+
+void SettingsMenuState::entry() {
+    ui_->current_state_ = UserInterface::SETTINGS_MENU;
+}
+
+void SettingsMenuState::react(KeySelectEvent const &) {
+    if (ui_->current_setting_ < ui_->total_num_settings_) {
+        transitTo<EditSettingState>(UserInterface::REGION_ALL, [] { ui_->enterEditSetting(); });
+    } else {
+        transitTo<MainScreenState>(UserInterface::REGION_ALL);
+    }
+}
+
+void SettingsMenuState::react(KeyUpEvent const &) {
+    ui_->navigateSettings(-1);
+    ui_->invalidate(UserInterface::REGION_TOP | UserInterface::REGION_BOTTOM);
+}
+
+void SettingsMenuState::react(KeyDownEvent const &) {
+    ui_->navigateSettings(1);
+    ui_->invalidate(UserInterface::REGION_TOP | UserInterface::REGION_BOTTOM);
+}
+
+void SettingsMenuState::react(KeyNextEvent const &) {
+    if (ui_->current_setting_ < ui_->total_num_settings_) {
+        transitTo<EditSettingState>(UserInterface::REGION_ALL, [] { ui_->enterEditSetting(); });
+    }
+}
+
+void SettingsMenuState::react(KeyPrevEvent const &) {
+    transitTo<MainScreenState>(UserInterface::REGION_ALL);
+}
+
+// --- EDIT_SETTING ---
+
+void EditSettingState::entry() {
+    ui_->current_state_ = UserInterface::EDIT_SETTING;
+}
+
+void EditSettingState::react(KeySelectEvent const &) {
+    transitTo<SettingsMenuState>(UserInterface::REGION_ALL, [] { ui_->saveSetting(); });
+}
+
+void EditSettingState::react(KeyUpEvent const &) {
+    // Only the value row changes while editing
+    ui_->adjustSetting(1);
+    ui_->invalidate(UserInterface::REGION_BOTTOM);
+}
+
+void EditSettingState::react(KeyDownEvent const &) {
+    ui_->adjustSetting(-1);
+    ui_->invalidate(UserInterface::REGION_BOTTOM);
+}
+
+void EditSettingState::react(KeyPrevEvent const &) {
+    // Discard changes and move back to settings menu
+    transitTo<SettingsMenuState>(UserInterface::REGION_ALL, [] { ui_->discardSetting(); });
+}
+
+FSM_INITIAL_STATE(UiState, MainScreenState)
+
+void UiState::start(UserInterface* ui) {
+    ui_ = ui;
+    tinyfsm::Fsm<UiState>::start();
+    LOG_DEBUG("UI state machine started");
+}
@@ -1,202 +1,184 @@
 #include "user_interface.h"
 #include <Arduino.h>
-#include <LiquidCrystal.h>
 #include <liquid_crystal_ext.h>
 #include "log.h"
-#include "settings_array.h"
+#include "settings_registry.h"
+#include "number_format.h"
 
 UserInterface::UserInterface(PolishLCD* lcd)
     : lcd_(lcd), current_state_(MAIN_SCREEN), current_setting_(0) {
     if (!lcd_) {
         LOG_FATAL("LCD pointer is null");
     }
-    // Get array of settings
-    settings_array_ = createSettings(total_num_settings_);
+    // Settings are described by the flash-resident registry
+    total_num_settings_ = Settings::count();
     if (total_num_settings_ == 0) {
         LOG_WARNING("No settings available");
     } else {
         LOG_INFO("Loaded %d settings", total_num_settings_);
     }
 
+    lcd_->clear();
+    UiState::start(this);
     LOG_INFO("UserInterface initialized");
 }
 
 void UserInterface::updateDisplay() {
+    // Map view model changes to the regions showing them
+    const uint8_t changed = view_model_.takeDirty();
+    if (current_state_ == MAIN_SCREEN) {
+        if (changed & DisplayViewModel::FIELD_EXTERNAL_TEMP) {
+            dirty_regions_ |= REGION_TOP;
+        }
+        if (changed & DisplayViewModel::FIELD_INTERNAL_TEMP) {
+            dirty_regions_ |= REGION_BOTTOM;
+        }
+        if (changed & DisplayViewModel::FIELD_FAN_STATE) {
+            dirty_regions_ |= REGION_STATUS;
+        }
+    }
+    view_model_.countFrame(dirty_regions_ != REGION_NONE);
+    if (dirty_regions_ == REGION_NONE) {
+        return;
+    }
+    const uint8_t regions = dirty_regions_;
+    dirty_regions_ = REGION_NONE;
+    lcd_->beginFrame();
     switch (current_state_) {
         case MAIN_SCREEN:
-            showMainScreen();
+            showMainScreen(regions);
             break;
         case SETTINGS_MENU:
-            showSettingsMenu();
+            showSettingsMenu(regions);
             break;
         case EDIT_SETTING:
-            showEditSetting();
+            showEditSetting(regions);
             break;
     }
+    lcd_->endFrame();
 }
 
 void UserInterface::handleSelect() {
-    switch (current_state_) {
-        case MAIN_SCREEN:
-            enterSettingsMenu();
-            break;
-        case SETTINGS_MENU:
-            if (current_setting_ < total_num_settings_) {
-                enterEditSetting();
-            } else {
-                exitSettingsMenu();
-            }
-            break;
-        case EDIT_SETTING:
-            saveSetting();
-            exitEditSetting();
-            break;
-    }
-    updateDisplay();
+    UiState::dispatch(KeySelectEvent{});
 }
 
 void UserInterface::handleUp() {
-    switch (current_state_) {
-        case SETTINGS_MENU:
-            navigateSettings(-1);
-            break;
-        case EDIT_SETTING:
-            adjustSetting(1);
-            break;
-        default:
-            LOG_DEBUG("No action for UP in current state");
-            break;
-    }
-    updateDisplay();
+    UiState::dispatch(KeyUpEvent{});
 }
 
 void UserInterface::handleDown() {
-    switch (current_state_) {
-        case SETTINGS_MENU:
-            navigateSettings(1);
-            break;
-        case EDIT_SETTING:
-            adjustSetting(-1);
-            break;
-        default:
-            LOG_DEBUG("No action for DOWN in current state");
-            break;
-    }
-    updateDisplay();
+    UiState::dispatch(KeyDownEvent{});
 }
 
-
 void UserInterface::handleNext() {
-    switch (current_state_) {
-        case MAIN_SCREEN:
-            // No action in main screen
-            break;
-        case SETTINGS_MENU:
-            if (current_setting_ < total_num_settings_) {
-                enterEditSetting();
-            }
-            break;
-        case EDIT_SETTING:
-            // No action in edit setting
-            break;
-    }
-    updateDisplay();
+    UiState::dispatch(KeyNextEvent{});
 }
 
 void UserInterface::handlePrev() {
-    switch (current_state_) {
-        case MAIN_SCREEN:
-            // No action in main screen
-            break;
-        case SETTINGS_MENU:
-            exitSettingsMenu();
-            break;
-        case EDIT_SETTING:
-            // Discard changes and move back to settings menu
-            discardSetting();
-            exitEditSetting();
-            break;
-    }
-    updateDisplay();
+    UiState::dispatch(KeyPrevEvent{});
 }
 
-void UserInterface::showMainScreen() {
-    lcd_->clear();
-    // Display external temperature
-    lcd_->setCursor(0, 0);
-    lcd_->print("Zewn: ");
-    if (!isnan(external_temp_)) {
-        lcd_->print(external_temp_);
-        lcd_->print(" C");
-    } else {
-        lcd_->print("Błąd");
-    }
-    // Display internal temperature
-    lcd_->setCursor(0, 1);
-    lcd_->print("Wewn: ");
-    if (!isnan(internal_temp_)) {
-        lcd_->print(internal_temp_);
-        lcd_->print(" C");
-    } else {
-        lcd_->print("Błąd");
-    }
-    // Display current state
-    lcd_->setCursor(14, 0);
-    if (is_fan_on_) {
-        lcd_->print("Wł");
-    }
+void UserInterface::setFanState(bool state) {
+    view_model_.setFanState(state);
 }
 
-void UserInterface::showSettingsMenu() {
-    lcd_->clear();
-    lcd_->setCursor(0, 0);
-    lcd_->print("Ustawienia:  (");
-    lcd_->print(current_setting_ + 1);
-    lcd_->print(")");
+void UserInterface::setExternalTemperature(float temp) {
+    view_model_.setExternalTemperature(temp);
+}
 
-    lcd_->setCursor(0, 1);
-    if (current_setting_ < total_num_settings_) {
-        lcd_->print("> ");
-        lcd_->print(settings_array_[current_setting_]->getScreenText());
-    } else {
-        lcd_->print("> Wróc do menu");
+void UserInterface::setInternalTemperature(float temp) {
+    view_model_.setInternalTemperature(temp);
+}
+
+void UserInterface::showMainScreen(uint8_t regions) {
+    if (regions & REGION_TOP) {
+        // Display external temperature
+        lcd_->setCursor(0, 0);
+        size_t printed = lcd_->print("Zewn: ");
+        printed += printTemperature(view_model_.externalTemperature());
+        padTo(printed, kStatusColumn);
+    }
+    if (regions & REGION_BOTTOM) {
+        // Display internal temperature
+        lcd_->setCursor(0, 1);
+        size_t printed = lcd_->print("Wewn: ");
+        printed += printTemperature(view_model_.internalTemperature());
+        padTo(printed, kScreenColumns);
+    }
+    if (regions & REGION_STATUS) {
+        // Display current state
+        lcd_->setCursor(kStatusColumn, 0);
+        lcd_->print(view_model_.isFanOn() ? "Wł" : "  ");
     }
 }
 
-void UserInterface::showEditSetting() {
-    lcd_->clear();
-    lcd_->setCursor(0, 0);
-    lcd_->print(settings_array_[current_setting_]->getScreenText());
+void UserInterface::showSettingsMenu(uint8_t regions) {
+    if (regions & (REGION_TOP | REGION_STATUS)) {
+        lcd_->setCursor(0, 0);
+        char index_buffer[4];
+        NumberFormat::formatInteger(index_buffer, sizeof(index_buffer), static_cast<int32_t>(current_setting_ + 1));
+        size_t printed = lcd_->print("Ustawienia:  (");
+        printed += lcd_->print(index_buffer);
+        printed += lcd_->print(")");
+        padTo(printed, kScreenColumns);
+    }
+    if (regions & REGION_BOTTOM) {
+        lcd_->setCursor(0, 1);
+        size_t printed = 0;
+        if (current_setting_ < total_num_settings_) {
+            printed += lcd_->print("> ");
+            printed += lcd_->print(Settings::screenText(current_setting_));
+        } else {
+            printed += lcd_->print("> Wróc do menu");
+        }
+        padTo(printed, kScreenColumns);
+    }
+}
 
-    lcd_->setCursor(0, 1);
-    lcd_->print("Wartość: ");
-    char value_buffer[5];
-    settings_array_[current_setting_]->getValueAsString(value_buffer, sizeof(value_buffer));
-    lcd_->print(value_buffer);
+void UserInterface::showEditSetting(uint8_t regions) {
+    if (regions & (REGION_TOP | REGION_STATUS)) {
+        lcd_->setCursor(0, 0);
+        padTo(lcd_->print(editor_.screenText()), kScreenColumns);
+    }
+    if (regions & REGION_BOTTOM) {
+        lcd_->setCursor(0, 1);
+        size_t printed = lcd_->print("Wartość: ");
+        // Remaining columns of the row plus terminator
+        char value_buffer[kScreenColumns - kValueColumn + 1];
+        editor_.getValueAsString(value_buffer, sizeof(value_buffer));
+        printed += lcd_->print(value_buffer);
+        padTo(printed, kScreenColumns);
 
-    LOG_WARNING("Editing setting: %s", value_buffer);
+        LOG_WARNING("Editing setting: %s", value_buffer);
+    }
 }
 
-void UserInterface::enterSettingsMenu() {
-    current_state_ = SETTINGS_MENU;
-    current_setting_ = 0;
+size_t UserInterface::printTemperature(int16_t tenths) {
+    if (tenths == DisplayViewModel::kNoReading) {
+        return lcd_->print("Błąd");
+    }
+    NumberFormat::Spec spec;
+    spec.decimals = 1;
+    char temperature_buffer[8];
+    NumberFormat::formatFixed(temperature_buffer, sizeof(temperature_buffer), tenths, spec);
+    size_t printed = lcd_->print(temperature_buffer);
+    printed += lcd_->print(" C");
+    return printed;
 }
 
-void UserInterface::exitSettingsMenu() {
-    current_state_ = MAIN_SCREEN;
+void UserInterface::padTo(size_t printed, uint8_t width) {
+    // Overwrite leftovers of the previous content instead of clearing the screen
+    for (; printed < width; ++printed) {
+        lcd_->write(' ');
+    }
 }
 
 void UserInterface::enterEditSetting() {
-    current_state_ = EDIT_SETTING;
     if (current_setting_ < total_num_settings_) {
-        settings_array_[current_setting_]->loadDataFromPersistence();
+        editor_.select(current_setting_);
     }
 }
 
-void UserInterface::exitEditSetting() {
-    current_state_ = SETTINGS_MENU;
-}
-
 void UserInterface::navigateSettings(int direction) {
     if (current_setting_ + direction <= total_num_settings_) {
         current_setting_ += direction;
@@ -209,21 +191,20 @@ void UserInterface::navigateSettings(int direction) {
 void UserInterface::adjustSetting(int delta) {
     if (current_setting_ < total_num_settings_) {
         if (delta > 0) {
-            settings_array_[current_setting_]->increase();
+            editor_.increase();
         } else if (delta < 0) {
-            settings_array_[current_setting_]->decrease();
+            editor_.decrease();
         }
-        LOG_INFO("Adjusted setting: %s by %d", settings_array_[current_setting_]->getName(), delta);
+        LOG_INFO("Adjusted setting: %S by %d", editor_.name(), delta);
     } else {
         LOG_WARNING("No setting to adjust at index %zu", current_setting_);
     }
-    updateDisplay();
 }
 
 void UserInterface::saveSetting() {
     if (current_setting_ < total_num_settings_) {
-        settings_array_[current_setting_]->save();
-        LOG_INFO("Saved setting: %s", settings_array_[current_setting_]->getName());
+        editor_.save();
+        LOG_INFO("Saved setting: %S", editor_.name());
     } else {
         LOG_WARNING("No setting to save at index %zu", current_setting_);
     }
@@ -231,8 +212,8 @@ void UserInterface::saveSetting() {
 
 void UserInterface::discardSetting() {
     if (current_setting_ < total_num_settings_) {
-        settings_array_[current_setting_]->discard();
-        LOG_INFO("Discarded changes for setting: %s", settings_array_[current_setting_]->getName());
+        editor_.discard();
+        LOG_INFO("Discarded changes for setting: %S", editor_.name());
     } else {
         LOG_WARNING("No setting to discard at index %zu", current_setting_);
     }
@@ -0,0 +1,77 @@
+#pragma once
+
+// Helpers shared by the host test programs (pio test -e native). Every
+// program links the firmware sources (test_build_src) on top of the
+// simulator from platform/native.
+
+#include <string>
+
+#include <EEPROM.h>
+#include "liquid_crystal_ext.h"
+#include "sim_io.h"
+#include "ui_state_machine.h"
+#include "user_interface.h"
+
+void setup();                       // src/main.cpp
+void loop();
+UserInterface& getUIInstance();
+
+/// PolishLCD that keeps the bytes it would send to the controller
+class RecordingLcd : public PolishLCD {
+public:
+    using PolishLCD::print;
+
+    size_t write(uint8_t value) override {
+        written_ += static_cast<char>(value);
+        return 1;
+    }
+
+    const std::string& written() const { return written_; }
+    void clearWritten() { written_.clear(); }
+
+private:
+    std::string written_;
+};
+
+/// Glyphs PolishLCD loads into CGRAM slots 0-7, drawn here independently of
+/// the firmware table so Sim::lcdRender() shows the letters it should
+inline void registerPolishGlyphs() {
+    static constexpr struct {
+        uint8_t rows[8];
+        const char* utf8;
+    } kGlyphs[] = {
+        {{0b00000, 0b00000, 0b01110, 0b00001, 0b01111, 0b10001, 0b01110, 0b00001}, "ą"},
+        {{0b00010, 0b00100, 0b01110, 0b10000, 0b10000, 0b10000, 0b01110, 0b00000}, "ć"},
+        {{0b00000, 0b01110, 0b10001, 0b11111, 0b10000, 0b01111, 0b00010, 0b00100}, "ę"},
+        {{0b01100, 0b00100, 0b00100, 0b00110, 0b01100, 0b00100, 0b00100, 0b00000}, "ł"},
+        {{0b00100, 0b00010, 0b00000, 0b10110, 0b11001, 0b10001, 0b10001, 0b00000}, "ń"},
+        {{0b00010, 0b00100, 0b01110, 0b10001, 0b10001, 0b10001, 0b01110, 0b00000}, "ó"},
+        {{0b00010, 0b00100, 0b01111, 0b10000, 0b01110, 0b00001, 0b11110, 0b00000}, "ś"},
+        {{0b00100, 0b00000, 0b11111, 0b00010, 0b00100, 0b01000, 0b11111, 0b00000}, "ż"},
+    };
+    Sim::lcdClearGlyphs();
+    for (const auto& glyph : kGlyphs) {
+        Sim::lcdRegisterGlyph(glyph.rows, glyph.utf8);
+    }
+}
+
+/// Visible 16x2 screen of the emulated controller, rows separated by '\n'
+inline std::string lcdScreen() {
+    char buffer[2 * 16 * 4 + 2];    // Up to four UTF-8 bytes per character
+    Sim::lcdRender(buffer, sizeof(buffer));
+    return buffer;
+}
+
+/// Power-on state with a blank EEPROM
+inline void resetSimulator() {
+    Sim::reset();
+    EEPROM.erase();
+}
+
+/// Power-on and setup() with the UI singleton back on a freshly drawn main screen
+inline void rebootFirmware() {
+    resetSimulator();
+    setup();
+    UiState::start(&getUIInstance());
+    getUIInstance().invalidate(UserInterface::REGION_ALL);
+}
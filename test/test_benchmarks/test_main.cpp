@@ -0,0 +1,292 @@
+// Host microbenchmarks of the firmware hot paths, run with:
+//   pio test -e native -f test_benchmarks -v
+//
+// Every case prints ns/op on the host and an ATmega328P cycle estimate, and
+// flags an estimate over the case budget. The estimate scales host
+// wall-clock time by POTATO_AVR_CYCLES_PER_NS (default kDefaultAvrCyclesPerNs):
+// a coarse factor for this 8-bit, soft-float code, not a cycle count, and it
+// moves with the load of the machine. The budgets fail the run only with
+// POTATO_BENCH_ENFORCE=1, on a quiet, calibrated machine. To calibrate, divide
+// the formatFixed cycles logged by env:uno_bench by the formatFixed ns/op
+// printed here. Exact target cycles come from the simavr bench
+// (tools/simavr_bench); these numbers catch regressions early.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../host_support.h"
+#include "fan_control.h"
+#include "keypad_trace.h"
+#include "moving_average.h"
+#include "number_format.h"
+#include "persistence_manager.h"
+#include "persistence_manager_instance.h"
+#include "project_pin_definition.h"
+#include "settings_editor.h"
+#include "temperature_sensor.h"
+
+namespace {
+    constexpr double kDefaultAvrCyclesPerNs = 150.0;
+    constexpr uint32_t kIterations = 20000;
+    constexpr int kRepeats = 7;     // Best of, filters scheduler noise
+
+    // Sinks in the manner of benchmark::DoNotOptimize/ClobberMemory: the
+    // value must be computed, an object may have been read and changed
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    template <typename T>
+    inline void clobber(T& object) {
+        asm volatile("" : "+m"(object) : : "memory");
+    }
+
+    double avrCyclesPerNs() {
+        const char* factor = getenv("POTATO_AVR_CYCLES_PER_NS");
+        const double value = factor != nullptr ? atof(factor) : 0.0;
+        return value > 0.0 ? value : kDefaultAvrCyclesPerNs;
+    }
+
+    bool enforceBudgets() {
+        const char* enforce = getenv("POTATO_BENCH_ENFORCE");
+        return enforce != nullptr && enforce[0] != '\0' && strcmp(enforce, "0") != 0;
+    }
+
+    /// ns per func(i) call: best of kRepeats runs less the best empty loop, 0 when nothing is left
+    template <typename Func>
+    double nsPerOp(Func func) {
+        using Clock = std::chrono::steady_clock;
+        double best_work = 1e30;
+        double best_empty = 1e30;
+        for (int repeat = 0; repeat < kRepeats; ++repeat) {
+            const auto start = Clock::now();
+            for (uint32_t i = 0; i < kIterations; ++i) {
+                func(i);
+            }
+            const auto middle = Clock::now();
+            for (uint32_t i = 0; i < kIterations; ++i) {
+                doNotOptimize(i);
+            }
+            const auto end = Clock::now();
+            best_work = std::min(best_work, std::chrono::duration<double, std::nano>(middle - start).count());
+            best_empty = std::min(best_empty, std::chrono::duration<double, std::nano>(end - middle).count());
+        }
+        return std::max(best_work - best_empty, 0.0) / kIterations;
+    }
+
+    /// Print and record one result, check the cycle estimate against budget_cycles when enforcing
+    void report(const char* name, double ns_per_op, uint32_t budget_cycles) {
+        const double cycles = ns_per_op * avrCyclesPerNs();
+        printf("[ BENCH    ] %-28s %9.1f ns/op  ~%8.0f AVR cycles est.  (budget %lu)%s\n",
+               name, ns_per_op, cycles, static_cast<unsigned long>(budget_cycles),
+               cycles > budget_cycles ? "  OVER" : "");
+        ::testing::Test::RecordProperty("ns_per_op", static_cast<int>(ns_per_op + 0.5));
+        ::testing::Test::RecordProperty("avr_cycles_estimate", static_cast<int>(cycles + 0.5));
+        EXPECT_GT(ns_per_op, 0.0) << name << " measured nothing, the work was optimised away";
+        if (enforceBudgets()) {
+            EXPECT_LE(cycles, budget_cycles) << name << " is over its AVR cycle budget";
+        }
+    }
+
+    /// PolishLCD without the controller queue, for the cost of the UTF-8 mapping alone
+    class SinkLcd : public PolishLCD {
+    public:
+        using PolishLCD::print;
+        size_t write(uint8_t value) override {
+            checksum_ += value;
+            return 1;
+        }
+        uint8_t checksum() const { return checksum_; }
+
+    private:
+        uint8_t checksum_ = 0;
+    };
+
+    // Volatile inputs keep the compiler from folding the work away
+    volatile float g_external = 10.0f;
+    volatile float g_internal = 12.0f;
+    volatile int32_t g_tenths = -125;
+} // namespace
+
+TEST(Bench, FormatFixed) {
+    NumberFormat::Spec spec;
+    spec.decimals = 1;
+    char buffer[16];
+    report("NumberFormat::formatFixed", nsPerOp([&](uint32_t) {
+        doNotOptimize(NumberFormat::formatFixed(buffer, sizeof(buffer), g_tenths, spec));
+    }), 5000);
+}
+
+// The filter of TemperatureSensor::readTemperature(): add, modulo and a
+// soft-float division, about 1000 cycles on the ATmega328P
+TEST(Bench, LoadIntoFilter) {
+    MovingAverage<Sensor::TemperatureSensor::kFilterSize> filter;
+    report("TemperatureSensor filter", nsPerOp([&](uint32_t i) {
+        clobber(filter);
+        filter.add((i & 1U) ? g_external : g_internal);
+        doNotOptimize(filter.mean());
+    }), 1500);
+}
+
+TEST(Bench, PersistenceLoad) {
+    resetSimulator();
+    {
+        PersistenceManager manager;
+        manager.setMinimalExternalTemperature(3.5f);
+    }
+    // Constructor: EEPROM read, CRC-32 check and load
+    report("PersistenceManager load+CRC", nsPerOp([](uint32_t) {
+        PersistenceManager manager;
+        doNotOptimize(manager);
+    }), 250000);
+}
+
+TEST(Bench, PersistenceSave) {
+    resetSimulator();
+    PersistenceManager manager;
+    // Alternate values so every call writes and updates the CRC. CPU time
+    // only, on target each changed EEPROM byte adds about 3.3 ms
+    report("PersistenceManager save+CRC", nsPerOp([&](uint32_t i) {
+        manager.setSwitchTimeHysteresis((i & 1U) ? 300 : 301);
+    }), 250000);
+}
+
+TEST(Bench, PolishLcdPrint) {
+    SinkLcd lcd;
+    report("PolishLCD::print UTF-8", nsPerOp([&](uint32_t) {
+        doNotOptimize(lcd.print("Wentylator ożył"));
+    }), 20000);
+    doNotOptimize(lcd.checksum());
+}
+
+TEST(Bench, SettingValueText) {
+    resetSimulator();
+    resetSettings();
+    SettingsEditor editor;
+    editor.select(static_cast<size_t>(Settings::indexOf("min_ext")));
+    char buffer[16];
+    report("SettingsEditor value text", nsPerOp([&](uint32_t) {
+        editor.getValueAsString(buffer, sizeof(buffer));
+        doNotOptimize(buffer);
+    }), 6000);
+}
+
+TEST(Bench, FanControlUpdate) {
+    FanControl::Settings settings;
+    settings.min_external = 4.0f;
+    settings.max_external = 20.0f;
+    settings.temperature_difference = 1.0f;
+    settings.switch_time_ms = 0;
+    FanControl::State state;
+    // Settings reloaded and the state stored each call, as in loop()
+    report("FanControl::update", nsPerOp([&](uint32_t i) {
+        clobber(settings);
+        doNotOptimize(FanControl::update(state, settings, i, g_external, g_internal));
+        clobber(state);
+    }), 800);
+}
+
+// Host throughput of the SoA kernel for the replay tools against update()
+// run on the same controllers one by one, per controller and pass. It has
+// no AVR counterpart; the check is that batching pays off at all, which
+// needs the vectorised -O3 build (debug_build_flags of the native env).
+TEST(Bench, FanControlBatch) {
+    constexpr size_t kLanes = 1024;
+    static float min_external[kLanes], max_external[kLanes], difference[kLanes];
+    static uint32_t switch_time_ms[kLanes], last_change_ms[kLanes];
+    static uint8_t fan_on[kLanes];
+    static FanControl::Settings settings[kLanes];
+    static FanControl::State states[kLanes];
+    for (size_t i = 0; i < kLanes; ++i) {
+        settings[i].min_external = min_external[i] = 2.0f + 0.5f * (i % 8);
+        settings[i].max_external = max_external[i] = 16.0f + (i % 8);
+        settings[i].temperature_difference = difference[i] = 0.5f * (i % 4);
+        settings[i].switch_time_ms = switch_time_ms[i] = 0;
+    }
+    const FanControl::Lanes lanes = {min_external, max_external, difference, switch_time_ms,
+                                     fan_on, last_change_ms, kLanes};
+    const double batch_ns = nsPerOp([&](uint32_t i) {
+        FanControl::updateBatch(lanes, i, (i & 1U) ? g_external : 14.0f, g_internal);
+        doNotOptimize(fan_on[i % kLanes]);
+    }) / kLanes;
+    const double scalar_ns = nsPerOp([&](uint32_t i) {
+        const float external = (i & 1U) ? g_external : 14.0f;
+        const float internal = g_internal;
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            FanControl::update(states[lane], settings[lane], i, external, internal);
+        }
+        doNotOptimize(states[i % kLanes]);
+    }) / kLanes;
+    printf("[ BENCH    ] %-28s %9.2f ns/op  %.0f M decisions/s, update() %.2f ns/op (%.1fx)\n",
+           "FanControl::updateBatch lane", batch_ns, 1e3 / batch_ns, scalar_ns, scalar_ns / batch_ns);
+    ::testing::Test::RecordProperty("decisions_per_us", static_cast<int>(1e3 / batch_ns + 0.5));
+    ::testing::Test::RecordProperty("speedup_x10", static_cast<int>(10.0 * scalar_ns / batch_ns + 0.5));
+    EXPECT_LE(batch_ns, scalar_ns) << "the batch path is slower than update() lane by lane";
+}
+
+// Press-to-pixel latency of the keypad through loop(), in virtual time. Up
+// and Down in the settings menu, each press repaints the screen. The loop
+// samples the keypad while it waits out its period and while sensors convert,
+// so even short taps are served and the latency is the figure to watch.
+// POTATO_KEYPAD_TRACE=file replays a recorded "ms,adc" trace instead.
+TEST(Bench, KeypadLatency) {
+    // The synthetic trace serves all 200 presses, p99 1.7 ms. A press should
+    // show well within a frame the eye notices.
+    constexpr double kBudgetMs = 50.0;
+    std::vector<Sim::KeypadSample> samples;
+    const char* path = getenv("POTATO_KEYPAD_TRACE");
+    if (path != nullptr) {
+        ASSERT_TRUE(Sim::loadKeypadTrace(path, samples)) << "cannot read " << path;
+    } else {
+        const uint16_t keys[] = {Sim::KEYPAD_DOWN, Sim::KEYPAD_DOWN, Sim::KEYPAD_UP};
+        samples = Sim::syntheticKeypadTrace(200, keys, 3, 80, 300, 150, 900, 42);
+    }
+    rebootFirmware();
+    resetSettings();
+    loop();
+    getUIInstance().handleSelect();
+    loop();
+
+    Sim::KeypadTrace trace(samples);
+    const Sim::LatencyReport report = Sim::runKeypadTrace(trace, KEYPAD_ANALOG_BUTTON_PIN, loop);
+    ASSERT_GT(report.presses, 0U);
+    const double served_share = report.servedWithin(kBudgetMs);
+    const auto ms = [](double value) { return std::isinf(value) ? -1 : static_cast<int>(value + 0.5); };
+    // Percentiles count dropped presses as misses, printed as "miss"
+    const auto percentile = [](char* text, size_t size, double value) {
+        if (std::isinf(value)) {
+            snprintf(text, size, "miss");
+        } else {
+            snprintf(text, size, "%.1f ms", value);
+        }
+        return text;
+    };
+    char p50[16];
+    char p99[16];
+    percentile(p50, sizeof(p50), report.p50_ms);
+    percentile(p99, sizeof(p99), report.p99_ms);
+    printf("[ BENCH    ] %-28s p50 %s  p99 %s  max %.1f ms  dropped %zu/%zu  served within %.0f ms %.1f%%%s\n",
+           "Keypad press-to-pixel", p50, p99, report.max_ms, report.dropped, report.presses, kBudgetMs,
+           served_share * 100.0, report.dropped > 0 || report.p99_ms > kBudgetMs ? "  OVER" : "");
+    ::testing::Test::RecordProperty("p50_ms", ms(report.p50_ms));
+    ::testing::Test::RecordProperty("p99_ms", ms(report.p99_ms));
+    ::testing::Test::RecordProperty("dropped", static_cast<int>(report.dropped));
+    ::testing::Test::RecordProperty("served_within_budget_permille", static_cast<int>(served_share * 1000.0 + 0.5));
+    // Virtual time, so unlike the host timings above these always gate
+    EXPECT_EQ(report.dropped, 0U) << "presses dropped";
+    EXPECT_LE(report.p99_ms, kBudgetMs) << "p99 press-to-pixel over budget";
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    Sim::setSerialEcho(false);
+    printf("AVR cycle estimate: %.1f cycles per host ns, budgets %s\n", avrCyclesPerNs(),
+           enforceBudgets() ? "enforced" : "reported only (POTATO_BENCH_ENFORCE=1 to enforce)");
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <CRC32.h>
+#include <vector>
+
+#include "../host_support.h"
+#include "config_image.h"
+#include "persistence_manager_instance.h"
+
+namespace {
+    using Image = std::vector<uint8_t>;
+
+    struct Entry {
+        PersistenceField field;
+        uint8_t decimals;
+        int16_t value;
+    };
+
+    Image withCrc(Image image) {
+        CRC32 crc;
+        crc.add(image.data(), static_cast<uint16_t>(image.size()));
+        const uint32_t value = crc.calc();
+        for (uint8_t i = 0; i < ConfigImage::kCrcSize; ++i) {
+            image.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+        return image;
+    }
+
+    /// An image as a host tool would build it, with a correct CRC
+    Image build(const std::vector<Entry>& entries, uint8_t version = ConfigImage::kVersion) {
+        Image image = {ConfigImage::kMagic[0], ConfigImage::kMagic[1], version, static_cast<uint8_t>(entries.size())};
+        for (const Entry& entry : entries) {
+            const auto value = static_cast<uint16_t>(entry.value);
+            image.insert(image.end(), {static_cast<uint8_t>(entry.field), entry.decimals, static_cast<uint8_t>(value),
+                                       static_cast<uint8_t>(value >> 8)});
+        }
+        return withCrc(image);
+    }
+
+    ConfigImage::Result import(const Image& image) {
+        return ConfigImage::importImage(image.data(), image.size());
+    }
+
+    class ConfigImageTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            resetSimulator();
+            resetSettings();
+        }
+
+        /// The import is rejected with result and leaves EEPROM and settings alone
+        void expectRejected(const Image& image, ConfigImage::Result result) {
+            const uint32_t writes = EEPROM.byteWrites();
+            EXPECT_EQ(import(image), result);
+            EXPECT_EQ(EEPROM.byteWrites(), writes);
+            PersistenceManager* persistence = getPersistenceManagerInstance();
+            EXPECT_FLOAT_EQ(persistence->getMinimalExternalTemperature(), DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+            EXPECT_EQ(persistence->getSwitchTimeHysteresis(), DEFAULT_SWITCH_TIME_HYSTERESIS);
+            EXPECT_EQ(persistence->getModbusAddress(), DEFAULT_MODBUS_ADDRESS);
+        }
+    };
+} // namespace
+
+TEST_F(ConfigImageTest, ExportImportRoundTrip) {
+    setModbusAddress(42);
+    setSwitchTimeHysteresis(120);
+    Image image(ConfigImage::kMaxSize);
+    image.resize(ConfigImage::exportImage(image.data(), image.size()));
+    ASSERT_EQ(image.size(), ConfigImage::kHeaderSize + 5 * ConfigImage::kEntrySize + ConfigImage::kCrcSize);
+    EXPECT_EQ(image, build({{PersistenceField::MinimalExternalTemperature, 1, 40},
+                            {PersistenceField::MaximalExternalTemperature, 1, 200},
+                            {PersistenceField::TemperatureDifferenceHysteresis, 1, 10},
+                            {PersistenceField::SwitchTimeHysteresis, 0, 120},
+                            {PersistenceField::ModbusAddress, 0, 42}}));
+
+    resetSettings();
+    EXPECT_EQ(import(image), ConfigImage::RESULT_OK);
+    EXPECT_EQ(getPersistenceManagerInstance()->getModbusAddress(), 42);
+    EXPECT_EQ(getPersistenceManagerInstance()->getSwitchTimeHysteresis(), 120U);
+
+    uint8_t small[ConfigImage::kMaxSize];
+    EXPECT_EQ(ConfigImage::exportImage(small, image.size() - 1), 0U);
+}
+
+TEST_F(ConfigImageTest, PartialImageCommitsOnce) {
+    const uint32_t writes = EEPROM.byteWrites();
+    const Image image = build({{PersistenceField::ModbusAddress, 0, 9},
+                               {PersistenceField::MinimalExternalTemperature, 1, -50}});
+    EXPECT_EQ(import(image), ConfigImage::RESULT_OK);
+    EXPECT_EQ(getPersistenceManagerInstance()->getModbusAddress(), 9);
+    EXPECT_FLOAT_EQ(getPersistenceManagerInstance()->getMinimalExternalTemperature(), -5.0f);
+    EXPECT_EQ(getPersistenceManagerInstance()->getSwitchTimeHysteresis(), DEFAULT_SWITCH_TIME_HYSTERESIS);
+    const uint32_t one_commit = EEPROM.byteWrites() - writes;
+
+    // The same two values one by one take a commit each
+    resetSettings();
+    const uint32_t writes_single = EEPROM.byteWrites();
+    setModbusAddress(9);
+    getPersistenceManagerInstance()->setMinimalExternalTemperature(-5.0f);
+    EXPECT_LT(one_commit, EEPROM.byteWrites() - writes_single);
+}
+
+TEST_F(ConfigImageTest, WrongMagicOrVersion) {
+    Image image = build({{PersistenceField::ModbusAddress, 0, 9}});
+    image[0] = 'X';
+    image.resize(image.size() - ConfigImage::kCrcSize);
+    expectRejected(withCrc(image), ConfigImage::RESULT_BAD_HEADER);
+    expectRejected(build({{PersistenceField::ModbusAddress, 0, 9}}, ConfigImage::kVersion + 1),
+                   ConfigImage::RESULT_BAD_HEADER);
+}
+
+TEST_F(ConfigImageTest, BadSizeOrCrc) {
+    Image image = build({{PersistenceField::ModbusAddress, 0, 9}});
+    image[ConfigImage::kHeaderSize + 2] ^= 0x01;
+    expectRejected(image, ConfigImage::RESULT_BAD_CRC);
+
+    image = build({{PersistenceField::ModbusAddress, 0, 9}});
+    image[3] = 2;   // Count says two entries, there is one
+    expectRejected(image, ConfigImage::RESULT_BAD_SIZE);
+    expectRejected(Image(image.begin(), image.begin() + ConfigImage::kHeaderSize), ConfigImage::RESULT_BAD_SIZE);
+    expectRejected(build(std::vector<Entry>(ConfigImage::kMaxEntries + 1, {PersistenceField::ModbusAddress, 0, 9})),
+                   ConfigImage::RESULT_BAD_SIZE);
+}
+
+TEST_F(ConfigImageTest, DuplicateOrUnknownField) {
+    expectRejected(build({{PersistenceField::ModbusAddress, 0, 9}, {PersistenceField::ModbusAddress, 0, 10}}),
+                   ConfigImage::RESULT_UNKNOWN_FIELD);
+    expectRejected(build({{PersistenceField::ModbusAddress, 0, 9}, {PersistenceField::None, 0, 0}}),
+                   ConfigImage::RESULT_UNKNOWN_FIELD);
+    expectRejected(build({{static_cast<PersistenceField>(0x40), 0, 0}}), ConfigImage::RESULT_UNKNOWN_FIELD);
+}
+
+TEST_F(ConfigImageTest, OutOfRangeValueOrScale) {
+    // Valid entries before the bad one are not applied either
+    expectRejected(build({{PersistenceField::ModbusAddress, 0, 9}, {PersistenceField::SwitchTimeHysteresis, 0, 3601}}),
+                   ConfigImage::RESULT_BAD_VALUE);
+    expectRejected(build({{PersistenceField::ModbusAddress, 0, 0}}), ConfigImage::RESULT_BAD_VALUE);
+    expectRejected(build({{PersistenceField::MinimalExternalTemperature, 1, -101}}), ConfigImage::RESULT_BAD_VALUE);
+    // Tenths of a degree sent as whole degrees
+    expectRejected(build({{PersistenceField::MinimalExternalTemperature, 0, 5}}), ConfigImage::RESULT_BAD_VALUE);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "../host_support.h"
+#include "fan_control.h"
+#include "persistence_manager_instance.h"
+#include "project_pin_definition.h"
+
+void setup();
+void loop();
+extern FanControl::State fan_control;  // src/main.cpp
+
+namespace {
+    FanControl::Settings defaultSettings() {
+        FanControl::Settings settings;
+        settings.min_external = 4.0f;
+        settings.max_external = 20.0f;
+        settings.temperature_difference = 1.0f;
+        settings.switch_time_ms = 300UL * 1000UL;
+        return settings;
+    }
+
+    FanControl::State freshState() {
+        return FanControl::initialState(0, defaultSettings());
+    }
+} // namespace
+
+TEST(FanControlLaw, TurnsOnWhenOutsideIsColderInRange) {
+    FanControl::State state = freshState();
+    EXPECT_TRUE(FanControl::update(state, defaultSettings(), 1000, 10.0f, 12.0f));
+    EXPECT_TRUE(state.fan_on);
+    EXPECT_EQ(state.last_change_ms, 1000UL);
+}
+
+TEST(FanControlLaw, StaysOffInsideHysteresisBand) {
+    FanControl::State state = freshState();
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 1000, 10.0f, 11.0f));
+}
+
+TEST(FanControlLaw, StaysOffOutsideRange) {
+    FanControl::State state = freshState();
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 1000, 4.0f, 12.0f));
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 2000, 20.0f, 30.0f));
+}
+
+TEST(FanControlLaw, TurnsOffWhenOutsideWarmsUp) {
+    FanControl::State state = freshState();
+    state.fan_on = true;
+    EXPECT_TRUE(FanControl::update(state, defaultSettings(), 1000, 12.5f, 12.0f));
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 2000, 13.5f, 12.0f));
+}
+
+TEST(FanControlLaw, TurnsOffAtRangeLimits) {
+    FanControl::State state = freshState();
+    state.fan_on = true;
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 1000, 4.0f, 12.0f));
+    state = freshState();
+    state.fan_on = true;
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 2000, 20.0f, 30.0f));
+}
+
+TEST(FanControlLaw, IgnoresReadingsInsideSwitchTime) {
+    FanControl::State state;
+    state.last_change_ms = 1000;
+    // switch_time is stored in seconds, 300 s after the last change
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 1000 + 299999, 10.0f, 12.0f));
+    EXPECT_EQ(state.last_change_ms, 1000UL);
+    EXPECT_TRUE(FanControl::update(state, defaultSettings(), 1000 + 300000, 10.0f, 12.0f));
+    EXPECT_EQ(state.last_change_ms, 301000UL);
+}
+
+TEST(FanControlLaw, SwitchTimeCountsFromTheLastChange) {
+    FanControl::State state = freshState();
+    EXPECT_TRUE(FanControl::update(state, defaultSettings(), 1000, 10.0f, 12.0f));
+    // Passes that keep the fan running do not restart the switch time
+    for (unsigned long now = 2000; now < 301000; now += 1000) {
+        EXPECT_TRUE(FanControl::update(state, defaultSettings(), now, 10.0f, 12.0f));
+    }
+    EXPECT_EQ(state.last_change_ms, 1000UL);
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 301000, 14.0f, 12.0f));
+}
+
+TEST(FanControlLaw, MissingReadingKeepsState) {
+    FanControl::State state = freshState();
+    EXPECT_FALSE(FanControl::update(state, defaultSettings(), 1000, NAN, 12.0f));
+    state.fan_on = true;
+    EXPECT_TRUE(FanControl::update(state, defaultSettings(), 2000, 10.0f, NAN));
+}
+
+// The SoA batch gives the per-controller result on every lane
+TEST(FanControlLaw, BatchMatchesUpdate) {
+    constexpr size_t kLanes = 37;   // Not a multiple of any vector width
+    float min_external[kLanes], max_external[kLanes], difference[kLanes];
+    float external[kLanes], internal[kLanes];
+    uint32_t switch_time_ms[kLanes], last_change_ms[kLanes];
+    uint8_t fan_on[kLanes];
+    FanControl::State states[kLanes];
+    FanControl::Settings settings[kLanes];
+    for (size_t i = 0; i < kLanes; ++i) {
+        settings[i].min_external = min_external[i] = 2.0f + 0.5f * (i % 5);
+        settings[i].max_external = max_external[i] = 18.0f + (i % 3);
+        settings[i].temperature_difference = difference[i] = 0.5f * (i % 4);
+        settings[i].switch_time_ms = switch_time_ms[i] = 60000U * (i % 3);
+        states[i] = FanControl::initialState(0, settings[i]);
+        fan_on[i] = 0;
+        last_change_ms[i] = static_cast<uint32_t>(states[i].last_change_ms);
+    }
+    const FanControl::Lanes lanes = {min_external, max_external, difference, switch_time_ms,
+                                     fan_on, last_change_ms, kLanes};
+
+    for (uint32_t pass = 0; pass < 2000; ++pass) {
+        const uint32_t now = pass * 960U;
+        for (size_t i = 0; i < kLanes; ++i) {
+            external[i] = 10.0f + 8.0f * sinf(0.013f * pass + 0.1f * i);
+            internal[i] = (pass + i) % 97 == 0 ? NAN : 11.0f + 0.2f * i;
+        }
+        FanControl::updateBatch(lanes, now, external, internal);
+        for (size_t i = 0; i < kLanes; ++i) {
+            ASSERT_EQ(FanControl::update(states[i], settings[i], now, external[i], internal[i]), fan_on[i] != 0)
+                << "lane " << i << " pass " << pass;
+            ASSERT_EQ(static_cast<uint32_t>(states[i].last_change_ms), last_change_ms[i]);
+        }
+    }
+}
+
+// The same law driven by the firmware loop() on the simulator
+TEST(FanControlLoop, FollowsSimulatedSensors) {
+    resetSimulator();
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 8.0f);
+    Sim::setSensorTemperature(INTERNAL_DS18B20_PIN, 12.0f);
+    setup();
+    resetSettings();   // Other tests may have changed the singleton
+
+    // About five passes a second, the fan may change once per 300 s switch time
+    const auto loopUntil = [](bool fan_on) {
+        for (int pass = 0; pass < 3000; ++pass) {
+            loop();
+            if (fan_control.fan_on == fan_on) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    EXPECT_TRUE(loopUntil(true)) << "fan did not start with 8 C outside and 12 C inside";
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 14.0f);
+    EXPECT_TRUE(loopUntil(false)) << "fan did not stop once outside was warmer";
+    // The filtered reading crosses the band on its way down, once the ten
+    // sample filter has settled (a conversion each 750 ms) the fan must stop and stay off
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 2.0f);
+    for (int pass = 0; pass < 80; ++pass) {
+        loop();
+    }
+    for (int pass = 0; pass < 250; ++pass) {
+        loop();
+        ASSERT_FALSE(fan_control.fan_on) << "fan started below the minimal external temperature";
+    }
+}
+
+// The relay pin carries every decision of loop(), not only the display
+TEST(FanControlLoop, RelayFollowsTheDecision) {
+    resetSimulator();
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 8.0f);
+    Sim::setSensorTemperature(INTERNAL_DS18B20_PIN, 12.0f);
+    setup();
+    resetSettings();
+    EXPECT_FALSE(Sim::outputLevel(RELAY_PIN));
+
+    const auto loopUntil = [](bool fan_on) {
+        for (int pass = 0; pass < 3000 && fan_control.fan_on != fan_on; ++pass) {
+            loop();
+            if (Sim::outputLevel(RELAY_PIN) != fan_control.fan_on) {
+                return false;
+            }
+        }
+        return fan_control.fan_on == fan_on;
+    };
+    EXPECT_TRUE(loopUntil(true)) << "relay not switched on with the fan";
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 14.0f);
+    EXPECT_TRUE(loopUntil(false)) << "relay not switched off with the fan";
+}
@@ -0,0 +1,21 @@
+#include <gtest/gtest.h>
+
+#include <Arduino.h>
+
+#include "../host_support.h"
+#include "gpio_manager.h"
+#include "project_pin_definition.h"
+
+// Every pin the firmware drives is an output after initGPIO(), the
+// backlight included, so its writes do not just toggle a pull-up
+TEST(Gpio, InitMakesTheDrivenPinsOutputs) {
+    resetSimulator();
+    ASSERT_TRUE(GPIO::initGPIO());
+    EXPECT_EQ(Sim::pinModeOf(RELAY_PIN), OUTPUT);
+    EXPECT_EQ(Sim::pinModeOf(LCD_BACKLIGHT_PIN), OUTPUT);
+
+    GPIO::setBacklight(true);
+    EXPECT_TRUE(Sim::outputLevel(LCD_BACKLIGHT_PIN));
+    GPIO::setBacklight(false);
+    EXPECT_FALSE(Sim::outputLevel(LCD_BACKLIGHT_PIN));
+}
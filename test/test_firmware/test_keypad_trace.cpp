@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "../host_support.h"
+#include "keypad_trace.h"
+#include "persistence_manager_instance.h"
+#include "project_pin_definition.h"
+
+TEST(KeypadLatency, MatchesPressesToTheFirstBurstAfterThem) {
+    const std::vector<uint64_t> presses = {1000, 20000, 40000};
+    // Burst 5000-5200 serves the first press, nothing follows the second
+    // before the third, the third is served by the burst at 45000
+    const std::vector<uint64_t> bytes = {500, 5000, 5100, 5200, 45000, 45050};
+    const Sim::LatencyReport report = Sim::measureKeypadLatency(presses, bytes);
+    EXPECT_EQ(report.presses, 3U);
+    EXPECT_EQ(report.dropped, 1U);
+    EXPECT_DOUBLE_EQ(report.p50_ms, 5.05);
+    EXPECT_TRUE(std::isinf(report.p99_ms));     // The dropped press is a miss
+    EXPECT_DOUBLE_EQ(report.max_ms, 5.05);
+    EXPECT_DOUBLE_EQ(report.servedWithin(5.0), 1.0 / 3.0);
+    EXPECT_DOUBLE_EQ(report.servedWithin(10.0), 2.0 / 3.0);
+}
+
+TEST(KeypadLatency, TraceHoldsEachReadingUntilTheNext) {
+    Sim::KeypadTrace trace({{0, Sim::KEYPAD_RELEASED}, {100, Sim::KEYPAD_UP}, {250, Sim::KEYPAD_RELEASED}});
+    trace.start(1000000);
+    EXPECT_EQ(trace.valueAt(500000), Sim::KEYPAD_RELEASED);
+    EXPECT_EQ(trace.valueAt(1100000), Sim::KEYPAD_UP);
+    EXPECT_EQ(trace.valueAt(1249999), Sim::KEYPAD_UP);
+    EXPECT_EQ(trace.valueAt(1250000), Sim::KEYPAD_RELEASED);
+    EXPECT_EQ(trace.valueAt(1100000), Sim::KEYPAD_UP);   // Clock went back
+    EXPECT_EQ(trace.pressTimes(), std::vector<uint64_t>({1100000}));
+    EXPECT_EQ(trace.endMicros(), 1250000U);
+}
+
+// Through the keypad pin, HAL::Gpio, GPIO:: and the UI: a press held over a
+// whole loop() pass is never missed and shows within about one pass
+TEST(KeypadLatency, HeldPressesReachTheScreen) {
+    rebootFirmware();
+    resetSettings();
+    loop();
+    const uint16_t keys[] = {Sim::KEYPAD_SELECT, Sim::KEYPAD_DOWN, Sim::KEYPAD_DOWN, Sim::KEYPAD_UP};
+    Sim::KeypadTrace trace(Sim::syntheticKeypadTrace(4, keys, 4, 1500, 1500, 500, 900, 1));
+    const Sim::LatencyReport report = Sim::runKeypadTrace(trace, KEYPAD_ANALOG_BUTTON_PIN, loop);
+
+    EXPECT_EQ(report.presses, 4U);
+    EXPECT_EQ(report.dropped, 0U);
+    EXPECT_GT(report.p50_ms, 0.0);
+    EXPECT_LT(report.max_ms, 1500.0);
+    registerPolishGlyphs();
+    EXPECT_EQ(lcdScreen(), "Ustawienia:  (2)\n"
+                           "> Max temp zewn ");
+}
+
+// Taps shorter than a loop() pass are sampled while the loop waits and
+// latched until the UI takes them
+TEST(KeypadLatency, ShortTapsAreLatched) {
+    rebootFirmware();
+    resetSettings();
+    loop();
+    const uint16_t keys[] = {Sim::KEYPAD_SELECT, Sim::KEYPAD_DOWN, Sim::KEYPAD_DOWN, Sim::KEYPAD_UP};
+    Sim::KeypadTrace trace(Sim::syntheticKeypadTrace(4, keys, 4, 30, 40, 100, 150, 7));
+    const Sim::LatencyReport report = Sim::runKeypadTrace(trace, KEYPAD_ANALOG_BUTTON_PIN, loop);
+
+    EXPECT_EQ(report.presses, 4U);
+    EXPECT_EQ(report.dropped, 0U);
+    EXPECT_LT(report.max_ms, 50.0);
+    registerPolishGlyphs();
+    EXPECT_EQ(lcdScreen(), "Ustawienia:  (2)\n"
+                           "> Max temp zewn ");
+}
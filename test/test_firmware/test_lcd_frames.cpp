@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include <memory>
+
+#include "../host_support.h"
+#include "persistence_manager_instance.h"
+#include "ui_state_machine.h"
+#include "user_interface.h"
+
+namespace {
+    // Bytes on a 4-bit bus, as the driver sends them
+    void sendByte(bool rs, uint8_t value) {
+        Sim::lcdWriteNibble(rs, value >> 4);
+        Sim::lcdWriteNibble(rs, value & 0x0F);
+        Sim::advanceMicros(2000);
+    }
+
+    // Power-on initialization by instruction, then 4-bit, two lines, display on
+    void initController() {
+        Sim::advanceMicros(50000);
+        for (int i = 0; i < 3; ++i) {
+            Sim::lcdWriteNibble(false, 0x03);
+            Sim::advanceMicros(5000);
+        }
+        Sim::lcdWriteNibble(false, 0x02);
+        Sim::advanceMicros(100);
+        sendByte(false, 0x28);
+        sendByte(false, 0x0C);
+        sendByte(false, 0x01);
+        sendByte(false, 0x06);
+    }
+
+    void sendText(const char* text) {
+        while (*text) {
+            sendByte(true, static_cast<uint8_t>(*text++));
+        }
+    }
+} // namespace
+
+// --- Emulated controller ---
+
+TEST(Hd44780Emulator, RendersDdramThroughTheDisplayWindow) {
+    Sim::reset();
+    initController();
+    sendText("Hello");
+    sendByte(false, 0x80 | 0x40);
+    sendText("World");
+    EXPECT_EQ(lcdScreen(), "Hello           \nWorld           ");
+
+    // Display shift left moves the window, DDRAM stays as written
+    sendByte(false, 0x18);
+    EXPECT_EQ(lcdScreen(), "ello            \norld            ");
+    EXPECT_EQ(Sim::lcdStatus().shift, 1);
+    sendByte(false, 0x02);  // Return home undoes the shift
+    EXPECT_EQ(lcdScreen(), "Hello           \nWorld           ");
+}
+
+TEST(Hd44780Emulator, TracksCursorAndDisplayControl) {
+    Sim::reset();
+    initController();
+    EXPECT_TRUE(Sim::lcdStatus().display_on);
+    EXPECT_TRUE(Sim::lcdStatus().four_bit);
+    EXPECT_TRUE(Sim::lcdStatus().two_lines);
+    sendText("ab");
+    EXPECT_EQ(Sim::lcdStatus().address, 2);
+    sendByte(false, 0x10);  // Cursor left
+    EXPECT_EQ(Sim::lcdStatus().address, 1);
+    sendByte(false, 0x0F);  // Cursor and blink on
+    EXPECT_TRUE(Sim::lcdStatus().cursor_on);
+    EXPECT_TRUE(Sim::lcdStatus().blink);
+    sendByte(false, 0x08);  // Display off keeps DDRAM
+    EXPECT_EQ(lcdScreen(), std::string(16, ' ') + "\n" + std::string(16, ' '));
+    sendByte(false, 0x0C);
+    EXPECT_EQ(lcdScreen().substr(0, 2), "ab");
+}
+
+TEST(Hd44780Emulator, DecodesRegisteredCgramGlyphs) {
+    Sim::reset();
+    registerPolishGlyphs();
+    initController();
+    const uint8_t l_stroke[8] = {0b01100, 0b00100, 0b00100, 0b00110, 0b01100, 0b00100, 0b00100, 0b00000};
+    sendByte(false, 0x40 | (2 << 3));
+    for (uint8_t row : l_stroke) {
+        sendByte(true, row);
+    }
+    sendByte(false, 0x80);
+    sendText("B");
+    sendByte(true, 2);
+    sendByte(true, 3);  // Slot 3 is still blank
+    EXPECT_EQ(lcdScreen().substr(0, 6), "B\xC5\x82\xEF\xBF\xBD");
+}
+
+TEST(Hd44780Emulator, CountsBusTrafficAndEarlyWrites) {
+    Sim::reset();
+    initController();
+    Sim::lcdResetStats();
+    sendByte(false, 0x01);
+    sendText("ok");
+    Sim::LcdStats stats = Sim::lcdStats();
+    EXPECT_EQ(stats.commands, 1U);
+    EXPECT_EQ(stats.data_bytes, 2U);
+    EXPECT_EQ(stats.nibbles, 6U);
+    EXPECT_EQ(stats.bus_micros, 1520U + 2 * 41U);
+    EXPECT_EQ(stats.busy_violations, 0U);
+
+    // A byte right after a clear display lands while the controller is busy
+    Sim::lcdWriteNibble(false, 0x0);
+    Sim::lcdWriteNibble(false, 0x1);
+    Sim::lcdWriteNibble(true, 0x4);
+    Sim::lcdWriteNibble(true, 0x1);
+    EXPECT_EQ(Sim::lcdStats().busy_violations, 1U);
+}
+
+// --- Firmware driver and UserInterface frames ---
+
+class LcdFrames : public ::testing::Test {
+protected:
+    void SetUp() override {
+        resetSimulator();
+        resetSettings();
+        registerPolishGlyphs();
+        lcd_.beginPolish(16, 2);
+        lcd_.flush();
+        ui_.reset(new UserInterface(&lcd_));   // Clears the screen
+        ui_->setExternalTemperature(8.04f);
+        ui_->setInternalTemperature(12.5f);
+        ui_->setFanState(true);
+        lcd_.flush();
+    }
+
+    void TearDown() override {
+        EXPECT_EQ(Sim::lcdStats().busy_violations, 0U) << "driver wrote while the controller was busy";
+        ui_.reset();
+        Sim::reset();
+        // loop() in later tests dispatches to the firmware's UI again
+        UiState::start(&getUIInstance());
+    }
+
+    /// Render pending changes, wait for the bus and count only this frame
+    std::string frame() {
+        Sim::lcdResetStats();
+        bus_before_ = lcd_.stats().bus_micros;
+        ui_->updateDisplay();
+        lcd_.flush();
+        return lcdScreen();
+    }
+
+    /// The driver and the emulated controller agree on the bus time
+    uint64_t frameBusMicros() const {
+        EXPECT_EQ(Sim::lcdStats().bus_micros, lcd_.stats().bus_micros - bus_before_);
+        return Sim::lcdStats().bus_micros;
+    }
+
+    PolishLCD lcd_;
+    std::unique_ptr<UserInterface> ui_;
+    uint32_t bus_before_ = 0;
+};
+
+TEST_F(LcdFrames, MainScreen) {
+    EXPECT_EQ(frame(), "Zewn: 8.0 C   Wł\n"
+                       "Wewn: 12.5 C    ");
+    // Full repaint: three cursor moves and 32 characters
+    EXPECT_EQ(Sim::lcdStats().commands, 3U);
+    EXPECT_EQ(Sim::lcdStats().data_bytes, 32U);
+    EXPECT_EQ(frameBusMicros(), 3U * 37U + 32U * 41U);
+}
+
+TEST_F(LcdFrames, ThroughputIsTheTransmitTick) {
+    frame();
+    // One byte per tick at best, whatever the datasheet times allow
+    EXPECT_EQ(lcd_.stats().last_drain_bytes, 35U);
+    EXPECT_LE(lcd_.bytesPerSecond(), 1000000UL / Hd44780::kTickMicros);
+    EXPECT_GT(lcd_.bytesPerSecond(), 900000UL / Hd44780::kTickMicros);
+}
+
+// Every other tick held off until just before the next one, as behind a
+// OneWire slot with interrupts disabled: the pair must not write twice within
+// a byte's execution time (TearDown checks the emulator saw no early write)
+TEST_F(LcdFrames, LateTicksKeepTheExecutionTime) {
+    Sim::lcdResetStats();
+    lcd_.setCursor(0, 1);
+    lcd_.print("0123456789abcdef");
+    while (Sim::isTimerEnabled()) {
+        Sim::holdOffTimerTick(Hd44780::kTickMicros - 5);
+        Sim::advanceMicros(2 * Hd44780::kTickMicros);
+    }
+    EXPECT_EQ(Sim::lcdStats().data_bytes, 16U);
+    EXPECT_EQ(lcdScreen().substr(lcdScreen().find('\n') + 1), "0123456789abcdef");
+}
+
+TEST_F(LcdFrames, MainScreenRepaintsOnlyWhatChanged) {
+    frame();
+    ui_->setInternalTemperature(11.96f);
+    EXPECT_EQ(frame(), "Zewn: 8.0 C   Wł\n"
+                       "Wewn: 12.0 C    ");
+    EXPECT_EQ(Sim::lcdStats().commands, 1U);
+    EXPECT_EQ(Sim::lcdStats().data_bytes, 16U);
+
+    ui_->setFanState(false);
+    EXPECT_EQ(frame(), "Zewn: 8.0 C     \n"
+                       "Wewn: 12.0 C    ");
+    EXPECT_EQ(Sim::lcdStats().commands, 1U);
+    EXPECT_EQ(Sim::lcdStats().data_bytes, 2U);
+
+    // Same readings at display resolution: nothing goes to the controller
+    ui_->setExternalTemperature(8.01f);
+    frame();
+    EXPECT_EQ(Sim::lcdStats().nibbles, 0U);
+}
+
+TEST_F(LcdFrames, MainScreenWithoutReadings) {
+    ui_->setExternalTemperature(NAN);
+    ui_->setInternalTemperature(NAN);
+    EXPECT_EQ(frame(), "Zewn: Błąd    Wł\n"
+                       "Wewn: Błąd      ");
+}
+
+TEST_F(LcdFrames, SettingsMenu) {
+    frame();
+    ui_->handleSelect();
+    EXPECT_EQ(frame(), "Ustawienia:  (1)\n"
+                       "> Min temp zewn ");
+    // Two rows from their first column
+    EXPECT_EQ(frameBusMicros(), 2U * 37U + 32U * 41U);
+
+    ui_->handleDown();
+    EXPECT_EQ(frame(), "Ustawienia:  (2)\n"
+                       "> Max temp zewn ");
+}
+
+TEST_F(LcdFrames, EditSetting) {
+    ui_->handleSelect();
+    frame();
+    ui_->handleSelect();
+    EXPECT_EQ(frame(), "Min temp zewn   \n"
+                       "Wartość: 4.0    ");
+
+    ui_->handleUp();
+    EXPECT_EQ(frame(), "Min temp zewn   \n"
+                       "Wartość: 4.5    ");
+    // Only the value row changes while editing
+    EXPECT_EQ(Sim::lcdStats().commands, 1U);
+    EXPECT_EQ(Sim::lcdStats().data_bytes, 16U);
+
+    ui_->handlePrev();  // Discard
+    EXPECT_EQ(frame(), "Ustawienia:  (1)\n"
+                       "> Min temp zewn ");
+}
@@ -0,0 +1,11 @@
+// Host unit tests of the firmware modules, run with: pio test -e native -f test_firmware
+
+#include <gtest/gtest.h>
+
+#include "sim_io.h"
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    Sim::setSerialEcho(false);  // Firmware logs go to the simulated serial port
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "../host_support.h"
+#include "memory_hal.h"
+#include "serial_shell.h"
+
+namespace {
+    class CapturePrint : public Print {
+    public:
+        size_t write(uint8_t c) override {
+            text += static_cast<char>(c);
+            return 1;
+        }
+
+        std::string text;
+    };
+
+    // Touches every byte of its frame, like a deep call chain of the firmware
+    __attribute__((noinline)) uint8_t useStack(size_t bytes) {
+        volatile uint8_t frame[4096];
+        const size_t used = bytes < sizeof(frame) ? bytes : sizeof(frame);
+        for (size_t i = 0; i < used; ++i) {
+            frame[sizeof(frame) - 1 - i] = static_cast<uint8_t>(i);
+        }
+        return frame[sizeof(frame) - 1];
+    }
+} // namespace
+
+TEST(Memory, HighWaterFollowsTheDeepestCall) {
+    HAL::Memory::paintStack();
+    const MemoryUsage before = HAL::Memory::usage();
+    EXPECT_EQ(before.total, HAL::Memory::kWindowBytes);
+    EXPECT_EQ(before.stack_peak + before.unused, before.total);
+
+    (void) useStack(4096);
+    const MemoryUsage after = HAL::Memory::usage();
+    EXPECT_GE(after.stack_peak, before.stack_peak + 4096U);
+    EXPECT_EQ(after.unused, HAL::Memory::unusedStackBytes());
+    EXPECT_EQ(after.stack_peak + after.unused, after.total);
+
+    // Shallower calls leave the mark alone, a new paint starts over
+    (void) useStack(16);
+    EXPECT_EQ(HAL::Memory::usage().stack_peak, after.stack_peak);
+    HAL::Memory::paintStack();
+    EXPECT_LT(HAL::Memory::usage().stack_peak, after.stack_peak);
+}
+
+TEST(Memory, ShellReportsTheReading) {
+    CapturePrint out;
+    SerialShell::Context context;
+    SerialShell shell(out, context);
+    HAL::Memory::paintStack();
+    for (const char c : std::string("mem\n")) {
+        shell.feed(static_cast<uint8_t>(c));
+    }
+    shell.service();
+    while (shell.isRunning()) {
+        shell.service();
+    }
+    EXPECT_NE(out.text.find("ram B 16384, data 0, bss 0, heap 0\r\n"), std::string::npos) << out.text;
+    EXPECT_NE(out.text.find("free B "), std::string::npos) << out.text;
+    EXPECT_NE(out.text.find(", stack peak "), std::string::npos) << out.text;
+}
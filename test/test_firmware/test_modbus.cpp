@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../host_support.h"
+#include "modbus_register_map.h"
+#include "modbus_rtu.h"
+#include "operation_log.h"
+#include "persistence_manager_instance.h"
+#include "telemetry.h"
+
+namespace {
+    using Frame = std::vector<uint8_t>;
+
+    Frame withCrc(Frame frame) {
+        const uint16_t crc = Modbus::crc16(frame.data(), frame.size());
+        frame.push_back(static_cast<uint8_t>(crc));
+        frame.push_back(static_cast<uint8_t>(crc >> 8));
+        return frame;
+    }
+
+    /// Write multiple request for count registers from start, all set to value
+    Frame writeMultiple(uint8_t address, uint16_t start, uint16_t count, uint16_t value) {
+        Frame frame = {address, Modbus::FC_WRITE_MULTIPLE, static_cast<uint8_t>(start >> 8), static_cast<uint8_t>(start),
+                       static_cast<uint8_t>(count >> 8), static_cast<uint8_t>(count), static_cast<uint8_t>(count * 2U)};
+        for (uint16_t i = 0; i < count; ++i) {
+            frame.push_back(static_cast<uint8_t>(value >> 8));
+            frame.push_back(static_cast<uint8_t>(value));
+        }
+        return withCrc(frame);
+    }
+
+    class ModbusSlave : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            resetSimulator();
+            resetSettings();
+            Telemetry::Sample sample;
+            sample.uptime_ms = 65536000UL;
+            sample.external_centi = 812;
+            sample.internal_centi = Telemetry::kNoReading;
+            sample.fan_on = true;
+            sample.loop_ms = 230;
+            snapshot_.publish(sample);
+            context_.snapshot = &snapshot_;
+            context_.operation_log = &operation_log_;
+        }
+
+        /// Reply to request, checked for a good CRC; empty when there is none
+        Frame handle(const Frame& request) {
+            uint8_t buffer[256] = {};
+            std::copy(request.begin(), request.end(), buffer);
+            const size_t length = slave_.handleRequest(buffer, request.size());
+            if (length == 0) {
+                return {};
+            }
+            EXPECT_GE(length, 5U);
+            const uint16_t crc = Modbus::crc16(buffer, length - 2);
+            EXPECT_EQ(buffer[length - 2], static_cast<uint8_t>(crc));
+            EXPECT_EQ(buffer[length - 1], static_cast<uint8_t>(crc >> 8));
+            return Frame(buffer, buffer + length - 2);
+        }
+
+        Telemetry::SnapshotBuffer snapshot_;
+        OperationLog operation_log_;
+        Modbus::RegisterMap::Context context_;
+        Modbus::RegisterMap map_{context_};
+        Modbus::RtuSlave slave_{map_};
+    };
+} // namespace
+
+TEST_F(ModbusSlave, ReadsHoldingRegisters) {
+    const Frame reply = handle(withCrc({1, Modbus::FC_READ_HOLDING, 0, 0, 0, 5}));
+    const Frame expected = {1, Modbus::FC_READ_HOLDING, 10, 0, 40, 0, 200, 0, 10, 0x01, 0x2C, 0, 1};
+    EXPECT_EQ(reply, expected);
+}
+
+TEST_F(ModbusSlave, ReadsInputRegisters) {
+    const Frame reply = handle(withCrc({1, Modbus::FC_READ_INPUT, 0, 0, 0, 6}));
+    const Frame expected = {1, Modbus::FC_READ_INPUT, 12, 0x03, 0x2C, 0x80, 0x00, 0, 1, 0, 230, 0, 1, 0, 0};
+    EXPECT_EQ(reply, expected);
+}
+
+TEST_F(ModbusSlave, ReadLimits) {
+    // Past the last input register, then more than a reply can carry
+    EXPECT_EQ(handle(withCrc({1, Modbus::FC_READ_INPUT, 0, 10, 0, 2})),
+              (Frame{1, Modbus::FC_READ_INPUT | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_ADDRESS}));
+    EXPECT_EQ(handle(withCrc({1, Modbus::FC_READ_INPUT, 0, 0, 0, Modbus::RtuSlave::kMaxReadRegisters + 1})),
+              (Frame{1, Modbus::FC_READ_INPUT | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_VALUE}));
+}
+
+TEST_F(ModbusSlave, WriteSingleEchoesTheRequest) {
+    const Frame request = withCrc({1, Modbus::FC_WRITE_SINGLE, 0, 3, 0, 120});
+    EXPECT_EQ(handle(request), Frame(request.begin(), request.end() - 2));
+    EXPECT_EQ(getPersistenceManagerInstance()->getSwitchTimeHysteresis(), 120U);
+}
+
+TEST_F(ModbusSlave, OutOfRangeValueIsRejectedWithoutWriting) {
+    const uint32_t writes = EEPROM.byteWrites();
+    EXPECT_EQ(handle(withCrc({1, Modbus::FC_WRITE_SINGLE, 0, 0, 0x01, 0x90})),   // 40.0 C, range ends at 25.0
+              (Frame{1, Modbus::FC_WRITE_SINGLE | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_VALUE}));
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+    EXPECT_FLOAT_EQ(getPersistenceManagerInstance()->getMinimalExternalTemperature(),
+                    DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+    EXPECT_EQ(slave_.stats().exceptions, 1U);
+}
+
+TEST_F(ModbusSlave, WriteMultipleValidatesThenCommitsOnce) {
+    // Second value out of range: nothing is written, not even the first
+    const uint32_t writes = EEPROM.byteWrites();
+    EXPECT_EQ(handle(withCrc({1, Modbus::FC_WRITE_MULTIPLE, 0, 0, 0, 2, 4, 0, 50, 0x0F, 0xA0})),
+              (Frame{1, Modbus::FC_WRITE_MULTIPLE | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_VALUE}));
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+    EXPECT_FLOAT_EQ(getPersistenceManagerInstance()->getMinimalExternalTemperature(),
+                    DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+
+    EXPECT_EQ(handle(withCrc({1, Modbus::FC_WRITE_MULTIPLE, 0, 0, 0, 2, 4, 0, 50, 0, 150})),
+              (Frame{1, Modbus::FC_WRITE_MULTIPLE, 0, 0, 0, 2}));
+    EXPECT_FLOAT_EQ(getPersistenceManagerInstance()->getMinimalExternalTemperature(), 5.0f);
+    EXPECT_FLOAT_EQ(getPersistenceManagerInstance()->getMaximalExternalTemperature(), 15.0f);
+    const uint32_t one_commit = EEPROM.byteWrites() - writes;
+
+    // The same two values one by one take a commit each
+    resetSettings();
+    const uint32_t writes_single = EEPROM.byteWrites();
+    handle(withCrc({1, Modbus::FC_WRITE_SINGLE, 0, 0, 0, 50}));
+    handle(withCrc({1, Modbus::FC_WRITE_SINGLE, 0, 1, 0, 150}));
+    EXPECT_LT(one_commit, EEPROM.byteWrites() - writes_single);
+}
+
+TEST_F(ModbusSlave, WriteMultipleLimits) {
+    // Within the frame limit but past the last holding register
+    EXPECT_EQ(handle(writeMultiple(1, 0, Modbus::RtuSlave::kMaxWriteRegisters, 1)),
+              (Frame{1, Modbus::FC_WRITE_MULTIPLE | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_ADDRESS}));
+    EXPECT_EQ(handle(writeMultiple(1, 0, Modbus::RtuSlave::kMaxWriteRegisters + 1, 1)),
+              (Frame{1, Modbus::FC_WRITE_MULTIPLE | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_VALUE}));
+}
+
+TEST_F(ModbusSlave, OversizedRequestOnTheBusGetsIllegalValue) {
+    while (Sim::uartAvailable() > 0) {
+        Sim::uartRead();
+    }
+    uint8_t drained[64];
+    while (Sim::takeUartOutput(drained, sizeof(drained)) > 0) {
+    }
+    slave_.begin(19200);
+    const uint32_t writes = EEPROM.byteWrites();
+
+    // 28 registers: 65 bytes, one more than the frame buffer
+    const Frame request = writeMultiple(1, 0, 28, 1);
+    ASSERT_GT(request.size(), Modbus::RtuSlave::kFrameSize);
+    Sim::injectUart(request.data(), request.size());
+    slave_.service(0);
+    slave_.service(5000);   // t3.5 ends the frame
+    for (uint32_t now = 5000; now < 20000; now += 500) {
+        slave_.service(now);
+    }
+    uint8_t reply[16];
+    const size_t length = Sim::takeUartOutput(reply, sizeof(reply));
+    ASSERT_EQ(length, 5U);
+    EXPECT_EQ(reply[1], Modbus::FC_WRITE_MULTIPLE | Modbus::FC_EXCEPTION);
+    EXPECT_EQ(reply[2], Modbus::EXCEPTION_ILLEGAL_VALUE);
+    EXPECT_EQ(slave_.stats().overruns, 1U);
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+
+    // A corrupted one is dropped silently
+    Frame corrupted = request;
+    corrupted[20] ^= 0x01;
+    Sim::injectUart(corrupted.data(), corrupted.size());
+    slave_.service(30000);
+    for (uint32_t now = 35000; now < 50000; now += 500) {
+        slave_.service(now);
+    }
+    EXPECT_EQ(Sim::takeUartOutput(reply, sizeof(reply)), 0U);
+    EXPECT_EQ(slave_.stats().overruns, 2U);
+}
+
+TEST_F(ModbusSlave, BadCrcIsIgnored) {
+    Frame request = withCrc({1, Modbus::FC_WRITE_SINGLE, 0, 3, 0, 120});
+    request.back() ^= 0xFF;
+    EXPECT_TRUE(handle(request).empty());
+    EXPECT_EQ(slave_.stats().crc_errors, 1U);
+    EXPECT_EQ(slave_.stats().requests, 0U);
+    EXPECT_EQ(getPersistenceManagerInstance()->getSwitchTimeHysteresis(), DEFAULT_SWITCH_TIME_HYSTERESIS);
+}
+
+TEST_F(ModbusSlave, BroadcastWritesWithoutReply) {
+    EXPECT_TRUE(handle(withCrc({Modbus::kBroadcastAddress, Modbus::FC_WRITE_SINGLE, 0, 3, 0, 120})).empty());
+    EXPECT_EQ(getPersistenceManagerInstance()->getSwitchTimeHysteresis(), 120U);
+    // Errors in a broadcast are not answered either
+    EXPECT_TRUE(handle(withCrc({Modbus::kBroadcastAddress, 0x2B, 0, 0})).empty());
+}
+
+TEST_F(ModbusSlave, OtherUnitsAndUnknownFunctions) {
+    EXPECT_TRUE(handle(withCrc({2, Modbus::FC_READ_HOLDING, 0, 0, 0, 1})).empty());
+    EXPECT_EQ(slave_.stats().requests, 0U);
+    EXPECT_EQ(handle(withCrc({1, 0x2B, 0, 0})),
+              (Frame{1, 0x2B | Modbus::FC_EXCEPTION, Modbus::EXCEPTION_ILLEGAL_FUNCTION}));
+}
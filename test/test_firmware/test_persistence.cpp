@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <CRC32.h>
+
+#include "../host_support.h"
+#include "persistence_manager.h"
+
+namespace {
+    /// A record as the firmware before modbus_address stored it
+    void storeV1(float minimal, size_t switch_time, bool corrupt = false) {
+        PersistenceDataV1 old = {};
+        old.has_data = PERSISTENCE_LAYOUT_V1;
+        old.minimal_external_temperature = minimal;
+        old.maximal_external_temperature = 16.0f;
+        old.temperature_difference_hysteresis = 1.5f;
+        old.switch_time_hysteresis = switch_time;
+        CRC32 crc;
+        crc.add(reinterpret_cast<const uint8_t*>(&old), sizeof(old));
+        EEPROM.put(0, old);
+        EEPROM.put(sizeof(PersistenceDataV1), crc.calc() ^ (corrupt ? 1U : 0U));
+    }
+} // namespace
+
+TEST(Persistence, BlankEepromLoadsDefaults) {
+    resetSimulator();
+    PersistenceManager manager;
+    EXPECT_FLOAT_EQ(manager.getMinimalExternalTemperature(), DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+    EXPECT_FLOAT_EQ(manager.getMaximalExternalTemperature(), DEFAULT_MAXIMAL_EXTERNAL_TEMPERATURE);
+    EXPECT_FLOAT_EQ(manager.getTemperatureDifferenceHysteresis(), DEFAULT_TEMPERATURE_DIFFERENCE_HYSTERESIS);
+    EXPECT_EQ(manager.getSwitchTimeHysteresis(), DEFAULT_SWITCH_TIME_HYSTERESIS);
+    EXPECT_EQ(manager.getModbusAddress(), DEFAULT_MODBUS_ADDRESS);
+}
+
+TEST(Persistence, SavedValuesSurviveReboot) {
+    resetSimulator();
+    {
+        PersistenceManager manager;
+        manager.setMinimalExternalTemperature(2.5f);
+        manager.setSwitchTimeHysteresis(120);
+        manager.setModbusAddress(17);
+    }
+    PersistenceManager reloaded;
+    EXPECT_FLOAT_EQ(reloaded.getMinimalExternalTemperature(), 2.5f);
+    EXPECT_EQ(reloaded.getSwitchTimeHysteresis(), 120U);
+    EXPECT_EQ(reloaded.getModbusAddress(), 17);
+}
+
+TEST(Persistence, CorruptedDataFallsBackToDefaults) {
+    resetSimulator();
+    {
+        PersistenceManager manager;
+        manager.setMaximalExternalTemperature(15.0f);
+    }
+    // Flip one bit of the stored maximum, the CRC no longer matches
+    EEPROM.write(static_cast<int>(offsetof(PersistenceData, maximal_external_temperature)),
+                 EEPROM.read(static_cast<int>(offsetof(PersistenceData, maximal_external_temperature))) ^ 0x01);
+    PersistenceManager reloaded;
+    EXPECT_FLOAT_EQ(reloaded.getMaximalExternalTemperature(), DEFAULT_MAXIMAL_EXTERNAL_TEMPERATURE);
+}
+
+TEST(Persistence, TransactionCommitsOnce) {
+    resetSimulator();
+    PersistenceManager manager;
+    manager.beginTransaction();
+    manager.setMinimalExternalTemperature(3.0f);
+    const uint32_t writes_before_commit = EEPROM.byteWrites();
+    manager.setMaximalExternalTemperature(18.0f);
+    manager.setTemperatureDifferenceHysteresis(2.0f);
+    EXPECT_EQ(EEPROM.byteWrites(), writes_before_commit);
+    manager.commitTransaction();
+    EXPECT_GT(EEPROM.byteWrites(), writes_before_commit);
+
+    PersistenceManager reloaded;
+    EXPECT_FLOAT_EQ(reloaded.getMinimalExternalTemperature(), 3.0f);
+    EXPECT_FLOAT_EQ(reloaded.getMaximalExternalTemperature(), 18.0f);
+    EXPECT_FLOAT_EQ(reloaded.getTemperatureDifferenceHysteresis(), 2.0f);
+}
+
+TEST(Persistence, UnchangedValueWritesNoBytes) {
+    resetSimulator();
+    PersistenceManager manager;
+    manager.setSwitchTimeHysteresis(60);
+    const uint32_t writes = EEPROM.byteWrites();
+    manager.setSwitchTimeHysteresis(60);
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+}
+
+TEST(Persistence, LayoutV1RecordIsMigrated) {
+    resetSimulator();
+    storeV1(2.5f, 90);
+    {
+        PersistenceManager manager;
+        EXPECT_FLOAT_EQ(manager.getMinimalExternalTemperature(), 2.5f);
+        EXPECT_FLOAT_EQ(manager.getMaximalExternalTemperature(), 16.0f);
+        EXPECT_FLOAT_EQ(manager.getTemperatureDifferenceHysteresis(), 1.5f);
+        EXPECT_EQ(manager.getSwitchTimeHysteresis(), 90U);
+        EXPECT_EQ(manager.getModbusAddress(), DEFAULT_MODBUS_ADDRESS);
+    }
+    // Stored in the current layout, the next boot loads it without writing
+    EXPECT_EQ(EEPROM.read(0), PERSISTENCE_LAYOUT_VERSION);
+    const uint32_t writes = EEPROM.byteWrites();
+    PersistenceManager reloaded;
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+    EXPECT_FLOAT_EQ(reloaded.getMinimalExternalTemperature(), 2.5f);
+    EXPECT_EQ(reloaded.getSwitchTimeHysteresis(), 90U);
+}
+
+TEST(Persistence, CorruptedV1RecordLoadsDefaults) {
+    resetSimulator();
+    storeV1(2.5f, 90, true);
+    PersistenceManager manager;
+    EXPECT_FLOAT_EQ(manager.getMinimalExternalTemperature(), DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+    EXPECT_EQ(manager.getSwitchTimeHysteresis(), DEFAULT_SWITCH_TIME_HYSTERESIS);
+}
+
+TEST(Persistence, UnknownLayoutLoadsDefaults) {
+    resetSimulator();
+    {
+        PersistenceManager manager;
+        manager.setMinimalExternalTemperature(2.5f);
+    }
+    // A newer layout with a valid CRC is still not read as this one
+    EEPROM.write(0, PERSISTENCE_LAYOUT_VERSION + 1);
+    PersistenceData data;
+    EEPROM.get(0, data);
+    CRC32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(&data), sizeof(data));
+    EEPROM.put(sizeof(PersistenceData), crc.calc());
+    PersistenceManager reloaded;
+    EXPECT_FLOAT_EQ(reloaded.getMinimalExternalTemperature(), DEFAULT_MINIMAL_EXTERNAL_TEMPERATURE);
+}
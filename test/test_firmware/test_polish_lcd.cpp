@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "../host_support.h"
+
+namespace {
+    // CGRAM slots loaded by PolishLCD::beginPolish()
+    constexpr char kA = 0, kC = 1, kE = 2, kL = 3, kN = 4, kO = 5, kS = 6, kZ = 7;
+} // namespace
+
+TEST(PolishLcd, AsciiPassesThrough) {
+    RecordingLcd lcd;
+    EXPECT_EQ(lcd.print("Temp 12.5"), 9U);
+    EXPECT_EQ(lcd.written(), "Temp 12.5");
+}
+
+TEST(PolishLcd, MapsEveryPolishLetterToItsSlot) {
+    RecordingLcd lcd;
+    EXPECT_EQ(lcd.print("ąćęłńóśż"), 8U);
+    EXPECT_EQ(lcd.written(), std::string({kA, kC, kE, kL, kN, kO, kS, kZ}));
+}
+
+TEST(PolishLcd, FlashStringMapsLikeRam) {
+    RecordingLcd lcd;
+    EXPECT_EQ(lcd.print(F("Wartość")), 7U);
+    EXPECT_EQ(lcd.written(), std::string("Warto") + kS + kC);
+}
+
+TEST(PolishLcd, UnknownSequenceBecomesQuestionMark) {
+    RecordingLcd lcd;
+    // ź (C5 BA) and Ó (C3 93) have no glyph
+    EXPECT_EQ(lcd.print("źÓa"), 3U);
+    EXPECT_EQ(lcd.written(), "??a");
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "../host_support.h"
+#include "persistence_manager_instance.h"
+#include "settings_editor.h"
+
+namespace {
+    size_t indexOf(const char* key) {
+        const int8_t index = Settings::indexOf(key);
+        EXPECT_GE(index, 0) << key;
+        return static_cast<size_t>(index);
+    }
+
+    std::string valueText(const SettingsEditor& editor, size_t buffer_size = 16) {
+        char buffer[16];
+        editor.getValueAsString(buffer, buffer_size);
+        return buffer;
+    }
+} // namespace
+
+class SettingsFormat : public ::testing::Test {
+protected:
+    void SetUp() override {
+        resetSimulator();
+        resetSettings();
+    }
+};
+
+TEST_F(SettingsFormat, TemperatureHasOneDecimal) {
+    SettingsEditor editor;
+    editor.select(indexOf("min_ext"));
+    EXPECT_EQ(editor.value(), 40);
+    EXPECT_EQ(valueText(editor), "4.0");
+    editor.decrease();
+    EXPECT_EQ(valueText(editor), "3.5");
+}
+
+TEST_F(SettingsFormat, NegativeTemperatureKeepsLeadingZero) {
+    setMinimalExternalTemperature(-0.5f);
+    SettingsEditor editor;
+    editor.select(indexOf("min_ext"));
+    EXPECT_EQ(valueText(editor), "-0.5");
+}
+
+TEST_F(SettingsFormat, SwitchTimeIsWholeSeconds) {
+    SettingsEditor editor;
+    editor.select(indexOf("switch_time"));
+    EXPECT_EQ(valueText(editor), "300");
+}
+
+TEST_F(SettingsFormat, ValueClampedToDescriptorRange) {
+    SettingsEditor editor;
+    editor.select(indexOf("modbus_addr"));
+    editor.decrease();
+    EXPECT_EQ(valueText(editor), "1");
+}
+
+TEST_F(SettingsFormat, ResetActionShowsText) {
+    SettingsEditor editor;
+    editor.select(indexOf("reset"));
+    EXPECT_EQ(valueText(editor), "Usuniecie ustaw");   // Cut to the 15 characters that fit
+}
+
+TEST_F(SettingsFormat, TooSmallBufferGivesEmptyText) {
+    setMaximalExternalTemperature(20.0f);
+    SettingsEditor editor;
+    editor.select(indexOf("max_ext"));
+    EXPECT_EQ(valueText(editor, 4), "");
+    EXPECT_EQ(valueText(editor, 5), "20.0");
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../host_support.h"
+#include "cobs.h"
+#include "persistence_manager_instance.h"
+#include "telemetry.h"
+
+namespace {
+    using Bytes = std::vector<uint8_t>;
+
+    Bytes encode(const Bytes& data) {
+        Bytes out(Cobs::maxEncodedSize(data.size()));
+        out.resize(Cobs::encode(data.data(), data.size(), out.data(), out.size()));
+        return out;
+    }
+
+    Bytes decode(const Bytes& data) {
+        Bytes out(data.size());
+        out.resize(Cobs::decode(data.data(), data.size(), out.data(), out.size()));
+        return out;
+    }
+
+    class CapturePrint : public Print {
+    public:
+        size_t write(uint8_t c) override {
+            bytes.push_back(c);
+            return 1;
+        }
+
+        Bytes bytes;
+    };
+
+    /// A decoded frame: type, sequence and body, CRC checked and stripped
+    struct Message {
+        uint8_t type;
+        Bytes body;
+    };
+
+    class TelemetryLink : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            resetSimulator();
+            resetSettings();
+        }
+
+        /// Frame a request as the host does and feed it to the link
+        void request(uint8_t type, const Bytes& body, uint8_t sequence = 7) {
+            Bytes payload = {type, sequence};
+            payload.insert(payload.end(), body.begin(), body.end());
+            const uint16_t crc = Telemetry::crc16(payload.data(), payload.size());
+            payload.push_back(static_cast<uint8_t>(crc));
+            payload.push_back(static_cast<uint8_t>(crc >> 8));
+            Bytes frame = {0};
+            const Bytes encoded = encode(payload);
+            frame.insert(frame.end(), encoded.begin(), encoded.end());
+            frame.push_back(0);
+            feed(frame);
+        }
+
+        void feed(const Bytes& bytes) {
+            for (uint8_t byte : bytes) {
+                link_.feed(byte);
+            }
+        }
+
+        /// Frames sent since the last call, each with a good CRC
+        std::vector<Message> replies() {
+            std::vector<Message> messages;
+            Bytes frame;
+            for (uint8_t byte : out_.bytes) {
+                if (byte != 0) {
+                    frame.push_back(byte);
+                    continue;
+                }
+                if (!frame.empty()) {
+                    const Bytes payload = decode(frame);
+                    EXPECT_GE(payload.size(), 4U);
+                    if (payload.size() >= 4) {
+                        const uint16_t crc = Telemetry::crc16(payload.data(), payload.size() - 2);
+                        EXPECT_EQ(payload[payload.size() - 2], static_cast<uint8_t>(crc));
+                        EXPECT_EQ(payload[payload.size() - 1], static_cast<uint8_t>(crc >> 8));
+                        messages.push_back(Message{payload[0], Bytes(payload.begin() + 2, payload.end() - 2)});
+                    }
+                }
+                frame.clear();
+            }
+            EXPECT_TRUE(frame.empty()) << "unterminated frame";
+            out_.bytes.clear();
+            return messages;
+        }
+
+        CapturePrint out_;
+        Telemetry::SnapshotBuffer snapshot_;
+        Telemetry::Link link_{out_, snapshot_};
+    };
+
+    constexpr uint8_t kModbusAddressField = static_cast<uint8_t>(PersistenceField::ModbusAddress);
+} // namespace
+
+TEST(Cobs, KnownEncodings) {
+    EXPECT_EQ(encode({}), (Bytes{0x01}));
+    EXPECT_EQ(encode({0x00}), (Bytes{0x01, 0x01}));
+    EXPECT_EQ(encode({0x00, 0x00}), (Bytes{0x01, 0x01, 0x01}));
+    EXPECT_EQ(encode({0x11, 0x22, 0x00, 0x33}), (Bytes{0x03, 0x11, 0x22, 0x02, 0x33}));
+    EXPECT_EQ(encode({0x11, 0x00, 0x00, 0x00}), (Bytes{0x02, 0x11, 0x01, 0x01, 0x01}));
+
+    // A full block of 254 non-zero bytes takes a 0xFF code and no zero
+    Bytes full(254);
+    for (size_t i = 0; i < full.size(); ++i) {
+        full[i] = static_cast<uint8_t>(i + 1);
+    }
+    const Bytes encoded = encode(full);
+    ASSERT_EQ(encoded.size(), Cobs::maxEncodedSize(full.size()));
+    EXPECT_EQ(encoded.front(), 0xFF);
+    EXPECT_EQ(encoded.back(), 0x01);
+}
+
+TEST(Cobs, RoundTripsAnyPayload) {
+    for (size_t size : {1U, 2U, 253U, 254U, 255U, 508U, 600U}) {
+        for (uint8_t zero_every : {0, 1, 3, 200}) {
+            Bytes data(size);
+            for (size_t i = 0; i < size; ++i) {
+                data[i] = zero_every != 0 && i % zero_every == 0 ? 0 : static_cast<uint8_t>(i * 37U + 1U) | 1U;
+            }
+            const Bytes encoded = encode(data);
+            ASSERT_FALSE(encoded.empty());
+            EXPECT_LE(encoded.size(), Cobs::maxEncodedSize(size));
+            for (uint8_t byte : encoded) {
+                ASSERT_NE(byte, 0) << "size " << size;
+            }
+            EXPECT_EQ(decode(encoded), data) << "size " << size << ", zero every " << int(zero_every);
+        }
+    }
+}
+
+TEST(Cobs, RejectsMalformedFramesAndSmallBuffers) {
+    EXPECT_TRUE(decode({0x03, 0x11}).empty());              // Truncated block
+    EXPECT_TRUE(decode({0x02, 0x11, 0x00, 0x22}).empty());  // Stray delimiter
+    const Bytes data = {0x11, 0x22, 0x00, 0x33};
+    uint8_t out[8];
+    EXPECT_EQ(Cobs::encode(data.data(), data.size(), out, Cobs::maxEncodedSize(data.size()) - 1), 0U);
+    const Bytes encoded = encode(data);
+    EXPECT_EQ(Cobs::decode(encoded.data(), encoded.size(), out, data.size() - 1), 0U);
+    EXPECT_EQ(Cobs::decode(encoded.data(), encoded.size(), out, data.size()), data.size());
+}
+
+TEST(TelemetryCrc, MatchesCcittFalse) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(Telemetry::crc16(check, sizeof(check)), 0x29B1);
+}
+
+TEST_F(TelemetryLink, WriteAndReadFieldRoundTrip) {
+    request(Telemetry::MSG_WRITE_FIELD, {kModbusAddressField, 17, 0});
+    request(Telemetry::MSG_READ_FIELD, {kModbusAddressField});
+    const std::vector<Message> messages = replies();
+    ASSERT_EQ(messages.size(), 2U);
+    EXPECT_EQ(messages[0].type, Telemetry::MSG_WRITE_FIELD | Telemetry::MSG_RESPONSE);
+    EXPECT_EQ(messages[0].body, (Bytes{kModbusAddressField, 17, 0, 0}));
+    EXPECT_EQ(messages[1].type, Telemetry::MSG_READ_FIELD | Telemetry::MSG_RESPONSE);
+    EXPECT_EQ(messages[1].body, (Bytes{kModbusAddressField, 17, 0, 0}));
+    EXPECT_EQ(getPersistenceManagerInstance()->getModbusAddress(), 17);
+    EXPECT_EQ(link_.droppedFrames(), 0U);
+
+    // Out of range values are clamped, unchanged ones are not written again
+    request(Telemetry::MSG_WRITE_FIELD, {kModbusAddressField, 0xF4, 0x01});    // 500
+    EXPECT_EQ(replies()[0].body, (Bytes{kModbusAddressField, 247, 0, 0}));
+    const uint32_t writes = EEPROM.byteWrites();
+    request(Telemetry::MSG_WRITE_FIELD, {kModbusAddressField, 247, 0});
+    EXPECT_EQ(replies().size(), 1U);
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+}
+
+TEST_F(TelemetryLink, BadCrcAndTruncatedFramesAreDropped) {
+    const uint32_t writes = EEPROM.byteWrites();
+    // A good frame with one body byte flipped after the CRC was computed
+    Bytes payload = {Telemetry::MSG_WRITE_FIELD, 1, kModbusAddressField, 17, 0};
+    const uint16_t crc = Telemetry::crc16(payload.data(), payload.size());
+    payload.push_back(static_cast<uint8_t>(crc));
+    payload.push_back(static_cast<uint8_t>(crc >> 8));
+    payload[3] ^= 0x01;
+    Bytes frame = encode(payload);
+    frame.push_back(0);
+    feed(frame);
+    EXPECT_EQ(link_.droppedFrames(), 1U);
+
+    // Shorter than type, sequence and CRC; and a broken COBS block
+    feed({0x04, 0x01, 0x02, 0x03, 0x00});
+    feed({0x09, 0x01, 0x02, 0x00});
+    EXPECT_EQ(link_.droppedFrames(), 3U);
+    EXPECT_TRUE(replies().empty());
+    EXPECT_EQ(EEPROM.byteWrites(), writes);
+    EXPECT_EQ(getPersistenceManagerInstance()->getModbusAddress(), DEFAULT_MODBUS_ADDRESS);
+}
+
+TEST_F(TelemetryLink, LogTextBeforeAFrameIsDropped) {
+    const char text[] = "I: boot 3\r\n";
+    feed(Bytes(text, text + sizeof(text) - 1));
+    request(Telemetry::MSG_READ_FIELD, {kModbusAddressField});
+    EXPECT_EQ(link_.droppedFrames(), 1U);
+    EXPECT_EQ(replies().size(), 1U);
+}
+
+TEST_F(TelemetryLink, OversizedFrameIsDroppedAndTheLinkRecovers) {
+    // A WRITE_CONFIG body one byte over the largest image does not fit
+    request(Telemetry::MSG_WRITE_CONFIG, Bytes(Telemetry::kMaxBody + 1, 0x5A));
+    EXPECT_EQ(link_.droppedFrames(), 1U);
+    EXPECT_TRUE(replies().empty());
+
+    request(Telemetry::MSG_READ_FIELD, {kModbusAddressField});
+    const std::vector<Message> messages = replies();
+    ASSERT_EQ(messages.size(), 1U);
+    EXPECT_EQ(messages[0].body, (Bytes{kModbusAddressField, DEFAULT_MODBUS_ADDRESS, 0, 0}));
+}
+
+TEST_F(TelemetryLink, BadRequestsGetANack) {
+    request(0x42, {});
+    request(Telemetry::MSG_READ_FIELD, {});
+    request(Telemetry::MSG_READ_FIELD, {static_cast<uint8_t>(PersistenceField::None)});
+    request(Telemetry::MSG_WRITE_CONFIG, {'P', 'C', 1, 0});
+    const std::vector<Message> messages = replies();
+    ASSERT_EQ(messages.size(), 4U);
+    for (const Message& message : messages) {
+        EXPECT_EQ(message.type, Telemetry::MSG_NACK);
+    }
+    EXPECT_EQ(messages[0].body, (Bytes{0x42, Telemetry::ERROR_UNKNOWN_TYPE}));
+    EXPECT_EQ(messages[1].body, (Bytes{Telemetry::MSG_READ_FIELD, Telemetry::ERROR_BAD_LENGTH}));
+    EXPECT_EQ(messages[2].body, (Bytes{Telemetry::MSG_READ_FIELD, Telemetry::ERROR_UNKNOWN_FIELD}));
+    EXPECT_EQ(messages[3].body, (Bytes{Telemetry::MSG_WRITE_CONFIG, Telemetry::ERROR_IMAGE_SIZE}));
+    EXPECT_EQ(link_.droppedFrames(), 0U);
+}
+
+TEST_F(TelemetryLink, StreamsSamplesAtThePeriod) {
+    Telemetry::Sample sample;
+    sample.uptime_ms = 0x01020304;
+    sample.external_centi = Telemetry::Sample::toCenti(-5.25f);
+    sample.fan_on = true;
+    sample.loop_ms = 230;
+    snapshot_.publish(sample);
+
+    link_.service(1000);
+    EXPECT_TRUE(replies().empty());     // Off until the host asks
+    request(Telemetry::MSG_SET_STREAM, {0xE8, 0x03});
+    std::vector<Message> messages = replies();
+    ASSERT_EQ(messages.size(), 1U);
+    EXPECT_EQ(messages[0].type, Telemetry::MSG_SET_STREAM | Telemetry::MSG_RESPONSE);
+    EXPECT_EQ(messages[0].body, (Bytes{0xE8, 0x03}));
+
+    link_.service(2000);
+    link_.service(2500);
+    link_.service(3000);
+    messages = replies();
+    ASSERT_EQ(messages.size(), 2U);
+    EXPECT_EQ(messages[0].type, Telemetry::MSG_SAMPLE);
+    EXPECT_EQ(messages[0].body, (Bytes{0x04, 0x03, 0x02, 0x01, 0xF3, 0xFD, 0x00, 0x80, 1, 230, 0}));
+}
@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "serial_shell.h"
+#include "temperature_history.h"
+
+namespace {
+    using Sample = TemperatureHistory::Sample;
+    constexpr int16_t kNoReading = TemperatureHistory::kNoReading;
+
+    Sample sample(int16_t external, int16_t internal, bool fan = false) {
+        Sample value;
+        value.external_tenths = external;
+        value.internal_tenths = internal;
+        value.fan_on = fan;
+        return value;
+    }
+
+    class CapturePrint : public Print {
+    public:
+        size_t write(uint8_t c) override {
+            text += static_cast<char>(c);
+            return 1;
+        }
+
+        std::string text;
+    };
+
+    size_t countLines(const std::string& text) {
+        size_t lines = 0;
+        for (size_t at = text.find('\n'); at != std::string::npos; at = text.find('\n', at + 1)) {
+            ++lines;
+        }
+        return lines;
+    }
+
+    std::vector<Sample> decodeAll(const TemperatureHistory& history) {
+        std::vector<Sample> samples;
+        TemperatureHistory::Reader reader(history);
+        Sample value;
+        while (reader.next(value)) {
+            samples.push_back(value);
+        }
+        return samples;
+    }
+
+    /// Stored value within the 0.2 C dead band of the input, no reading kept exactly
+    void expectClose(int16_t decoded, int16_t input) {
+        if (input == kNoReading) {
+            EXPECT_EQ(decoded, kNoReading);
+        } else {
+            EXPECT_NE(decoded, kNoReading);
+            EXPECT_LE(abs(decoded - input), 2) << "input " << input;
+        }
+    }
+
+    /// Day/night swing outside, a slow one inside, Gaussian noise on both
+    std::vector<Sample> noisyDay(uint32_t minutes, double sigma, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> noise(0.0, sigma);
+        std::vector<Sample> samples;
+        for (uint32_t minute = 0; minute < minutes; ++minute) {
+            const double external = 8.0 + 6.0 * sin(2.0 * M_PI * minute / 1440.0) + noise(rng);
+            const double internal = 10.0 + 1.5 * sin(2.0 * M_PI * (minute - 180.0) / 1440.0) + noise(rng);
+            samples.push_back(sample(static_cast<int16_t>(lround(external * 10.0)),
+                                     static_cast<int16_t>(lround(internal * 10.0)), (minute / 90) % 4 == 0));
+        }
+        return samples;
+    }
+} // namespace
+
+TEST(TemperatureHistory, EveryCodeRoundTrips) {
+    TemperatureHistory history;
+    history.clear();
+    // Key frame, unchanged, small, medium and escape deltas in both directions, fan toggles
+    const std::vector<Sample> inputs = {
+        sample(100, 120), sample(100, 120), sample(103, 114, true), sample(97, 120, true),
+        sample(117, 100), sample(79, 138, false), sample(500, -300), sample(-300, 500, true),
+        sample(-300, 500, true),
+    };
+    for (const Sample& input : inputs) {
+        history.append(input);
+    }
+    const std::vector<Sample> decoded = decodeAll(history);
+    ASSERT_EQ(decoded.size(), inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        EXPECT_EQ(decoded[i].external_tenths, inputs[i].external_tenths) << "sample " << i;
+        EXPECT_EQ(decoded[i].internal_tenths, inputs[i].internal_tenths) << "sample " << i;
+        EXPECT_EQ(decoded[i].fan_on, inputs[i].fan_on) << "sample " << i;
+    }
+}
+
+TEST(TemperatureHistory, DeadBandAbsorbsNoise) {
+    TemperatureHistory history;
+    history.clear();
+    history.append(sample(100, 100));
+    const uint16_t key_frame_bytes = history.usedBytes();
+    for (int i = 0; i < 64; ++i) {
+        history.append(sample(static_cast<int16_t>(i % 2 ? 102 : 98), static_cast<int16_t>(i % 3 ? 101 : 99)));
+    }
+    // One bit per sample on top of the key frame
+    EXPECT_EQ(history.usedBytes(), key_frame_bytes + 8U);
+    for (const Sample& decoded : decodeAll(history)) {
+        EXPECT_EQ(decoded.external_tenths, 100);
+        EXPECT_EQ(decoded.internal_tenths, 100);
+    }
+}
+
+TEST(TemperatureHistory, InvalidReadingsUseTheEscape) {
+    TemperatureHistory history;
+    history.clear();
+    const std::vector<Sample> inputs = {
+        sample(kNoReading, 50), sample(kNoReading, 51), sample(12, kNoReading),
+        sample(13, kNoReading), sample(kNoReading, kNoReading), sample(-40, 60),
+    };
+    for (const Sample& input : inputs) {
+        history.append(input);
+    }
+    const std::vector<Sample> decoded = decodeAll(history);
+    ASSERT_EQ(decoded.size(), inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        expectClose(decoded[i].external_tenths, inputs[i].external_tenths);
+        expectClose(decoded[i].internal_tenths, inputs[i].internal_tenths);
+    }
+    EXPECT_EQ(decoded[2].external_tenths, 12);   // First reading after a loss is exact
+    EXPECT_EQ(decoded[5].external_tenths, -40);
+}
+
+TEST(TemperatureHistory, LargeJumpsAndClamping) {
+    TemperatureHistory history;
+    history.clear();
+    history.append(sample(0, 0));
+    history.append(sample(38, -38));        // Largest medium delta
+    history.append(sample(77, -77));        // One past it: escape
+    history.append(sample(3000, -3000));    // Beyond 12 bits: clamped
+    history.append(sample(-2047, 2047));
+    const std::vector<Sample> decoded = decodeAll(history);
+    ASSERT_EQ(decoded.size(), 5U);
+    EXPECT_EQ(decoded[1].external_tenths, 38);
+    EXPECT_EQ(decoded[1].internal_tenths, -38);
+    EXPECT_EQ(decoded[2].external_tenths, 77);
+    EXPECT_EQ(decoded[2].internal_tenths, -77);
+    EXPECT_EQ(decoded[3].external_tenths, 2047);
+    EXPECT_EQ(decoded[3].internal_tenths, -2047);
+    EXPECT_EQ(decoded[4].external_tenths, -2047);
+    EXPECT_EQ(decoded[4].internal_tenths, 2047);
+}
+
+TEST(TemperatureHistory, FullBufferDropsTheOldestBlock) {
+    TemperatureHistory history;
+    history.clear();
+    // Every sample escapes: 32 bits each, a block holds the key frame and 7 more
+    std::vector<Sample> inputs;
+    for (int i = 0; i < 200; ++i) {
+        inputs.push_back(sample(static_cast<int16_t>(i % 2 ? 500 : -500), static_cast<int16_t>(i % 2 ? -500 : 500)));
+    }
+    uint16_t previous_size = 0;
+    bool dropped = false;
+    for (const Sample& input : inputs) {
+        history.append(input);
+        if (history.size() < previous_size) {
+            dropped = true;
+            EXPECT_EQ(previous_size + 1U - history.size(), 8U) << "a whole block goes at once";
+        }
+        previous_size = history.size();
+    }
+    EXPECT_TRUE(dropped);
+    EXPECT_EQ(history.appended(), inputs.size());
+    EXPECT_LE(history.usedBytes(), TemperatureHistory::kBlockCount * TemperatureHistory::kBlockSize);
+
+    // What is left is the newest samples, in order
+    const std::vector<Sample> decoded = decodeAll(history);
+    ASSERT_EQ(decoded.size(), history.size());
+    const size_t first = inputs.size() - decoded.size();
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        EXPECT_EQ(decoded[i].external_tenths, inputs[first + i].external_tenths) << "sample " << i;
+        EXPECT_EQ(decoded[i].internal_tenths, inputs[first + i].internal_tenths) << "sample " << i;
+    }
+
+    // Skipping lands on the same sample as decoding
+    TemperatureHistory::Reader reader(history);
+    reader.skip(20);
+    Sample value;
+    ASSERT_TRUE(reader.next(value));
+    EXPECT_EQ(value.external_tenths, decoded[20].external_tenths);
+}
+
+TEST(TemperatureHistory, NoisyDayFits) {
+    // Noise the sensors' moving average leaves on a DS18B20
+    const std::vector<Sample> inputs = noisyDay(48U * 60U, 0.05, 7);
+    TemperatureHistory history;
+    history.clear();
+    for (const Sample& input : inputs) {
+        history.append(input);
+    }
+    EXPECT_GE(history.size(), 24U * 60U);
+    const std::vector<Sample> decoded = decodeAll(history);
+    ASSERT_EQ(decoded.size(), history.size());
+    const size_t first = inputs.size() - decoded.size();
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        expectClose(decoded[i].external_tenths, inputs[first + i].external_tenths);
+        expectClose(decoded[i].internal_tenths, inputs[first + i].internal_tenths);
+        EXPECT_EQ(decoded[i].fan_on, inputs[first + i].fan_on);
+    }
+}
+
+TEST(TemperatureHistory, ReaderStopsWhenABlockIsDropped) {
+    TemperatureHistory history;
+    history.clear();
+    for (int i = 0; i < 4000; ++i) {
+        history.append(sample(static_cast<int16_t>(i * 3 % 400), 200));
+    }
+    TemperatureHistory::Reader reader(history);
+    Sample value;
+    ASSERT_TRUE(reader.next(value));
+    EXPECT_FALSE(reader.stale());
+    // The block being read is dropped and its slot reused for new samples
+    const uint32_t dropped = history.appended() - history.size();
+    while (history.appended() - history.size() == dropped) {
+        history.append(sample(100, 200));
+    }
+    EXPECT_TRUE(reader.stale());
+    EXPECT_FALSE(reader.next(value));
+}
+
+// More samples than the shell's 8-bit step counter can count steps for
+TEST(TemperatureHistory, ShellDumpsALongHistory) {
+    TemperatureHistory history;
+    history.clear();
+    for (int i = 0; i < 1440; ++i) {
+        history.append(sample(215, 190));
+    }
+    ASSERT_EQ(history.size(), 1440U);
+    CapturePrint out;
+    SerialShell::Context context;
+    context.history = &history;
+    SerialShell shell(out, context);
+    for (const char c : std::string("history\n")) {
+        shell.feed(static_cast<uint8_t>(c));
+    }
+    shell.service();
+    size_t steps = 0;
+    while (shell.isRunning() && steps < 2000) {
+        shell.service();
+        ++steps;
+    }
+    EXPECT_FALSE(shell.isRunning());
+    EXPECT_GT(steps, 255U);
+    EXPECT_EQ(countLines(out.text), 1441U);
+    EXPECT_NE(out.text.find("\n-1439 21.5 19.0 0\r\n"), std::string::npos);
+    EXPECT_NE(out.text.find("\n0 21.5 19.0 0\r\n"), std::string::npos);
+}
+
+TEST(TemperatureHistory, ShellDumpStopsWhenTheHistoryMovesOn) {
+    TemperatureHistory history;
+    history.clear();
+    for (int i = 0; i < 4000; ++i) {
+        history.append(sample(static_cast<int16_t>(i * 3 % 400), 200));
+    }
+    CapturePrint out;
+    SerialShell::Context context;
+    context.history = &history;
+    SerialShell shell(out, context);
+    for (const char c : std::string("history\n")) {
+        shell.feed(static_cast<uint8_t>(c));
+    }
+    for (int i = 0; i < 5; ++i) {
+        shell.service();
+    }
+    const uint32_t dropped = history.appended() - history.size();
+    while (history.appended() - history.size() == dropped) {
+        history.append(sample(100, 200));
+    }
+    size_t steps = 0;
+    while (shell.isRunning() && steps < 2000) {
+        shell.service();
+        ++steps;
+    }
+    EXPECT_FALSE(shell.isRunning());
+    EXPECT_NE(out.text.find("error: history moved on"), std::string::npos);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "../host_support.h"
+#include "project_pin_definition.h"
+#include "temperature_sensor.h"
+
+using Sensor::TemperatureSensor;
+
+namespace {
+    constexpr unsigned long kConversionMs = 750;    // 12 bits
+
+    /// One conversion of celsius on the simulated bus, read into the filter
+    float convert(TemperatureSensor& sensor, uint8_t pin, float celsius) {
+        Sim::setSensorTemperature(pin, celsius);
+        delay(kConversionMs);
+        return sensor.readTemperature();
+    }
+
+    class TemperatureFilter : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            resetSimulator();
+            sensor_.begin();
+        }
+
+        TemperatureSensor sensor_{EXTERNAL_DS18B20_PIN};
+    };
+} // namespace
+
+TEST_F(TemperatureFilter, AveragesPartialWindow) {
+    EXPECT_FLOAT_EQ(convert(sensor_, EXTERNAL_DS18B20_PIN, 10.0f), 10.0f);
+    EXPECT_FLOAT_EQ(convert(sensor_, EXTERNAL_DS18B20_PIN, 20.0f), 15.0f);
+}
+
+TEST_F(TemperatureFilter, DropsOldestSampleWhenFull) {
+    for (size_t i = 0; i < TemperatureSensor::kFilterSize; ++i) {
+        convert(sensor_, EXTERNAL_DS18B20_PIN, 0.0f);
+    }
+    // Ten samples of 10 C push all the zeros out again
+    for (int i = 1; i <= 10; ++i) {
+        EXPECT_FLOAT_EQ(convert(sensor_, EXTERNAL_DS18B20_PIN, 10.0f), static_cast<float>(i));
+    }
+}
+
+TEST_F(TemperatureFilter, ReadQuantizedToTwelveBits) {
+    ASSERT_EQ(Sim::sensorResolution(EXTERNAL_DS18B20_PIN), 12);
+    EXPECT_FLOAT_EQ(convert(sensor_, EXTERNAL_DS18B20_PIN, 7.05f), 7.0625f);
+}
+
+// Only the first reading waits; later ones keep the mean until the next
+// conversion is done and never stall the loop
+TEST_F(TemperatureFilter, ReadsDoNotWaitForTheBus) {
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 4.0f);
+    EXPECT_FLOAT_EQ(sensor_.readTemperature(), 4.0f);
+
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 8.0f);
+    const unsigned long start = millis();
+    EXPECT_FLOAT_EQ(sensor_.readTemperature(), 4.0f);
+    EXPECT_EQ(millis(), start);
+    delay(kConversionMs - 1);
+    EXPECT_FLOAT_EQ(sensor_.readTemperature(), 4.0f);
+    delay(1);
+    EXPECT_FLOAT_EQ(sensor_.readTemperature(), 6.0f);
+}
+
+TEST(TemperatureSensor, DisconnectedSensorReadsNan) {
+    resetSimulator();
+    Sim::setSensorConnected(INTERNAL_DS18B20_PIN, false);
+    TemperatureSensor sensor(INTERNAL_DS18B20_PIN);
+    sensor.begin();
+    EXPECT_FALSE(sensor.isConnected());
+    EXPECT_TRUE(isnan(sensor.readTemperature()));
+}
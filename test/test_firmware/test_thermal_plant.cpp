@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "../host_support.h"
+#include "fan_control.h"
+#include "persistence_manager_instance.h"
+#include "project_pin_definition.h"
+#include "sim_plant.h"
+
+void setup();
+void loop();
+extern FanControl::State fan_control;  // src/main.cpp
+
+namespace {
+    Sim::PlantParameters quietRoom() {
+        Sim::PlantParameters parameters;
+        parameters.respiration_w_per_t = 0.0f;
+        return parameters;
+    }
+} // namespace
+
+TEST(ThermalPlant, SettlesToTheOutsideWithoutRespiration) {
+    Sim::ThermalPlant plant(quietRoom(), 12.0f);
+    for (int day = 0; day < 120; ++day) {
+        plant.advance(86400.0, 5.0f, false);
+        ASSERT_GE(plant.pileTemperature(), 5.0f) << "cooled below the outside on day " << day;
+        ASSERT_GE(plant.airTemperature(), 5.0f);
+    }
+    EXPECT_NEAR(plant.pileTemperature(), 5.0f, 0.5f);
+    EXPECT_NEAR(plant.elapsedSeconds(), 120.0 * 86400.0, 1.0);
+}
+
+TEST(ThermalPlant, FanCoolsThePileFaster) {
+    Sim::ThermalPlant still(quietRoom(), 12.0f);
+    Sim::ThermalPlant ventilated(quietRoom(), 12.0f);
+    still.advance(86400.0, 5.0f, false);
+    ventilated.advance(86400.0, 5.0f, true);
+    EXPECT_LT(ventilated.pileTemperature(), still.pileTemperature() - 1.0f);
+}
+
+TEST(ThermalPlant, RespirationWarmsAClosedRoom) {
+    Sim::PlantParameters parameters;
+    parameters.wall_ua = 0.0f;
+    Sim::ThermalPlant plant(parameters, 6.0f);
+    plant.advance(7 * 86400.0, 6.0f, false);
+    EXPECT_GT(plant.pileTemperature(), 6.5f);
+    EXPECT_LT(plant.maxStableStep(), 1000.0f);
+    EXPECT_GT(plant.maxStableStep(), 10.0f * parameters.step_s);
+}
+
+// loop() closed around the model: the fan the firmware switches cools the
+// room its internal sensor reads
+TEST(ThermalPlantLoop, FirmwareFanCoolsTheRoom) {
+    resetSimulator();
+    Sim::PlantParameters parameters = quietRoom();
+    parameters.pile_mass_kg = 2000.0f;     // A small pile, so minutes of virtual time show the effect
+    parameters.room_heat_capacity = 2.0e5f;
+    Sim::ThermalPlant plant(parameters, 14.0f);
+    Sim::PlantSensor room(plant, EXTERNAL_DS18B20_PIN, RELAY_PIN);
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 6.0f);
+    Sim::attachSensorModel(INTERNAL_DS18B20_PIN, &room);
+    setup();
+    resetSettings();
+
+    bool started = false;
+    for (int pass = 0; pass < 15000 && !(started && !fan_control.fan_on); ++pass) {
+        loop();
+        started = started || fan_control.fan_on;
+    }
+    Sim::attachSensorModel(INTERNAL_DS18B20_PIN, nullptr);
+
+    EXPECT_TRUE(started) << "fan never started with 6 C outside and 14 C inside";
+    EXPECT_LT(plant.pileTemperature(), 10.0f);
+    EXPECT_GT(plant.pileTemperature(), 6.0f);
+    EXPECT_EQ(Sim::outputLevel(RELAY_PIN), fan_control.fan_on);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <string>
+
+#include "../host_support.h"
+#include "persistence_manager_instance.h"
+#include "project_pin_definition.h"
+#include "sim_timeline.h"
+
+namespace {
+    std::string exportJson() {
+        FILE* file = tmpfile();
+        EXPECT_NE(file, nullptr);
+        EXPECT_TRUE(Sim::timelineWriteJson(file));
+        std::string json;
+        rewind(file);
+        for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+            json += static_cast<char>(c);
+        }
+        fclose(file);
+        return json;
+    }
+
+    size_t count(const std::string& text, const std::string& pattern) {
+        size_t found = 0;
+        for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1)) {
+            ++found;
+        }
+        return found;
+    }
+} // namespace
+
+TEST(Timeline, RecordsNothingWhileStopped) {
+    ASSERT_TRUE(Sim::timelineStart(16));
+    Sim::timelineStop();
+    Sim::timelineBegin(Sim::TRACK_LOOP, "a");
+    Sim::timelineInstant(Sim::TRACK_INPUT, "b");
+    EXPECT_EQ(Sim::timelineSize(), 0U);
+    EXPECT_FALSE(Sim::timelineStart(0));
+    EXPECT_FALSE(Sim::timelineEnabled());
+}
+
+TEST(Timeline, KeepsTheNewestEventsAndBalancesSlices) {
+    Sim::reset();
+    ASSERT_TRUE(Sim::timelineStart(4));
+    Sim::timelineBegin(Sim::TRACK_SENSORS, "first");
+    Sim::advanceMicros(10);
+    Sim::timelineEnd(Sim::TRACK_SENSORS, "first");
+    Sim::timelineEnd(Sim::TRACK_SENSORS, "unmatched");     // Nothing open, ignored
+    Sim::timelineBegin(Sim::TRACK_SENSORS, "second");
+    Sim::advanceMicros(10);
+    Sim::timelineEnd(Sim::TRACK_SENSORS, "second");
+    Sim::timelineBegin(Sim::TRACK_SENSORS, "open");
+    Sim::timelineStop();
+    EXPECT_EQ(Sim::timelineSize(), 4U);
+    EXPECT_EQ(Sim::timelineOverwritten(), 1U);
+
+    // The end of "first" lost its begin, "open" is closed at the export
+    const std::string json = exportJson();
+    EXPECT_EQ(json.find("\"first\""), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), 2U);
+    EXPECT_EQ(count(json, "\"ph\":\"E\""), 2U);
+    EXPECT_NE(json.find("{\"name\":\"second\",\"ph\":\"B\",\"ts\":10,\"pid\":1,\"tid\":1"), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+// A firmware session on the timeline: conversions, decisions, a key press
+// that saves a setting, the LCD frames and the relay
+TEST(Timeline, ShowsTheFirmwareSources) {
+    ASSERT_TRUE(Sim::timelineStart(1U << 14));
+    rebootFirmware();
+    resetSettings();
+    Sim::setSensorTemperature(EXTERNAL_DS18B20_PIN, 5.0f);
+    Sim::setSensorTemperature(INTERNAL_DS18B20_PIN, 15.0f);
+    // Enough passes to flush the sensor filters of earlier tests, ten conversions each
+    for (int pass = 0; pass < 80; ++pass) {
+        loop();
+    }
+    // Select, Select (edit the first setting), Up, Select (save)
+    const int keys[] = {639, 639, 99, 639};
+    for (int key : keys) {
+        Sim::setAnalog(KEYPAD_ANALOG_BUTTON_PIN, key);
+        loop();
+        Sim::setAnalog(KEYPAD_ANALOG_BUTTON_PIN, Sim::kFloatingAnalog);
+        loop();
+    }
+    Sim::timelineStop();
+    const std::string json = exportJson();
+
+    EXPECT_EQ(Sim::timelineOverwritten(), 0U);
+    EXPECT_NE(json.find("\"name\":\"reset\",\"ph\":\"i\""), std::string::npos);
+    EXPECT_GE(count(json, "\"name\":\"DS18B20 conversion\",\"ph\":\"X\""), 32U);
+    EXPECT_EQ(count(json, "\"name\":\"fan control\",\"ph\":\"B\""), 88U);
+    EXPECT_EQ(count(json, "\"name\":\"analog 14\",\"ph\":\"i\""), 8U);
+    EXPECT_GE(count(json, "\"name\":\"LCD frame\",\"ph\":\"X\""), 5U);
+    EXPECT_EQ(count(json, "\"name\":\"settings commit\",\"ph\":\"B\""), 2U);   // resetSettings() and the save
+    EXPECT_NE(json.find("\"name\":\"pin " + std::to_string(RELAY_PIN) + "\",\"ph\":\"i\""), std::string::npos);
+    EXPECT_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+}
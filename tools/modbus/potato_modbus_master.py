@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Minimal Modbus RTU master for PotatoFanController units.
+
+Stand-in for a PLC or SCADA poller, stdlib only. Works against a real
+RS-485 adapter or the host simulator's pty:
+
+    POTATO_SIM_MODBUS_PTY=/tmp/potato-modbus POTATO_SIM_REALTIME=1 .pio/build/native/program &
+    potato_modbus_master.py /tmp/potato-modbus --unit 1 --status
+    potato_modbus_master.py /tmp/potato-modbus --unit 1 --write 0 45
+    potato_modbus_master.py /tmp/potato-modbus --units 1-32 --poll 10
+
+Register map: include/modbus_register_map.h.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import time
+
+FC_READ_HOLDING = 0x03
+FC_READ_INPUT = 0x04
+FC_WRITE_SINGLE = 0x06
+FC_WRITE_MULTIPLE = 0x10
+
+EXCEPTIONS = {1: "illegal function", 2: "illegal data address", 3: "illegal data value", 4: "device failure"}
+
+HOLDING = ["min_ext (0.1 C)", "max_ext (0.1 C)", "temp_diff (0.1 C)", "switch_time (s)", "modbus_addr"]
+NO_READING = 0x8000
+
+
+class ModbusError(Exception):
+    pass
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/MODBUS."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def frame(unit: int, pdu: bytes) -> bytes:
+    body = bytes([unit]) + pdu
+    return body + struct.pack("<H", crc16(body))
+
+
+def open_port(path: str, baud: int) -> int:
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = attrs[1] = attrs[3] = 0
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        attrs[4] = attrs[5] = getattr(termios, f"B{baud}")
+        attrs[6][termios.VMIN] = 0
+        attrs[6][termios.VTIME] = 0
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    os.set_blocking(fd, False)
+    return fd
+
+
+class Master:
+    def __init__(self, fd: int, timeout: float):
+        self.fd = fd
+        self.timeout = timeout
+
+    def transact(self, unit: int, pdu: bytes, reply_size) -> bytes:
+        """Send a request and return the reply PDU; reply_size(first_bytes) gives the full length."""
+        if os.isatty(self.fd):
+            termios.tcflush(self.fd, termios.TCIFLUSH)   # Drop late replies of timed out requests
+        os.write(self.fd, frame(unit, pdu))
+        reply = bytearray()
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            try:
+                reply += os.read(self.fd, 256)
+            except BlockingIOError:
+                time.sleep(0.0005)
+                continue
+            if len(reply) >= 5 and reply[1] & 0x80:
+                expected = 5
+            elif len(reply) >= 3:
+                expected = reply_size(reply)
+            else:
+                continue
+            if len(reply) >= expected:
+                reply = reply[:expected]
+                break
+        else:
+            raise ModbusError(f"unit {unit}: timeout")
+        if crc16(reply[:-2]) != struct.unpack("<H", reply[-2:])[0]:
+            raise ModbusError(f"unit {unit}: bad CRC")
+        if reply[0] != unit:
+            raise ModbusError(f"unit {unit}: reply from unit {reply[0]}")
+        if reply[1] & 0x80:
+            raise ModbusError(f"unit {unit}: {EXCEPTIONS.get(reply[2], reply[2])}")
+        return bytes(reply[1:-2])
+
+    def read(self, unit: int, function: int, start: int, count: int):
+        pdu = self.transact(unit, struct.pack(">BHH", function, start, count), lambda r: 5 + r[2])
+        return list(struct.unpack(f">{count}H", pdu[2:]))
+
+    def write_single(self, unit: int, address: int, value: int):
+        self.transact(unit, struct.pack(">BHh", FC_WRITE_SINGLE, address, value), lambda r: 8)
+
+    def write_multiple(self, unit: int, start: int, values):
+        pdu = struct.pack(">BHHB", FC_WRITE_MULTIPLE, start, len(values), 2 * len(values))
+        pdu += struct.pack(f">{len(values)}h", *values)
+        self.transact(unit, pdu, lambda r: 8)
+
+
+def signed(value: int) -> int:
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def celsius(value: int) -> str:
+    return "--" if value == NO_READING else f"{signed(value) / 100:.2f}"
+
+
+def print_status(master: Master, unit: int):
+    inputs = master.read(unit, FC_READ_INPUT, 0, 11)
+    holding = master.read(unit, FC_READ_HOLDING, 0, len(HOLDING))
+    print(f"unit {unit}: ext {celsius(inputs[0])} C, int {celsius(inputs[1])} C, "
+          f"fan {'on' if inputs[2] else 'off'}, loop {inputs[3]} ms, uptime {inputs[4] << 16 | inputs[5]} s")
+    print(f"  boots {inputs[6]}, relay cycles {inputs[7] << 16 | inputs[8]}, "
+          f"fan runtime {inputs[9] << 16 | inputs[10]} s")
+    for name, value in zip(HOLDING, holding):
+        print(f"  {name} = {signed(value)}")
+
+
+def parse_units(text: str):
+    units = []
+    for part in text.split(","):
+        first, _, last = part.partition("-")
+        units += range(int(first), int(last or first) + 1)
+    return units
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("--baud", type=int, default=19200)
+    parser.add_argument("--timeout", type=float, default=0.1, help="reply timeout per request, s")
+    parser.add_argument("--unit", type=int, default=1)
+    parser.add_argument("--units", type=parse_units, help="unit list for --poll, e.g. 1-8,12")
+    parser.add_argument("--status", action="store_true", help="read all input and holding registers")
+    parser.add_argument("--write", type=int, nargs="+", metavar=("ADDRESS", "VALUE"),
+                        help="write holding registers from ADDRESS (one value: function 06, more: 16)")
+    parser.add_argument("--poll", type=float, metavar="SECONDS",
+                        help="poll the temperatures of all --units for SECONDS and report the rate")
+    args = parser.parse_args()
+
+    master = Master(open_port(args.port, args.baud), args.timeout)
+    try:
+        if args.write:
+            if len(args.write) < 2:
+                parser.error("--write needs an address and at least one value")
+            if len(args.write) == 2:
+                master.write_single(args.unit, args.write[0], args.write[1])
+            else:
+                master.write_multiple(args.unit, args.write[0], args.write[1:])
+        if args.status or not (args.write or args.poll):
+            print_status(master, args.unit)
+        if args.poll:
+            units = args.units or [args.unit]
+            polls = failures = 0
+            deadline = time.monotonic() + args.poll
+            while time.monotonic() < deadline:
+                for unit in units:
+                    try:
+                        master.read(unit, FC_READ_INPUT, 0, 3)
+                        polls += 1
+                    except ModbusError:
+                        failures += 1
+            print(f"{polls} polls, {failures} failed, {polls / args.poll:.1f} polls/s")
+    except ModbusError as error:
+        print(error, file=sys.stderr)
+        return 1
+    finally:
+        os.close(master.fd)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
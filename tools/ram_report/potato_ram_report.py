@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Static RAM of a firmware image, per module and per symbol.
+
+Reads the .data/.bss/.noinit sizes with avr-size and the RAM symbols with
+avr-nm, groups symbols by their first name component (namespace, class,
+function of a function-local static, or the global itself) and prints the
+totals against the RAM of the MCU. The object files are no help here: the
+image is linked with LTO, so only the ELF tells what ended up in RAM.
+
+    potato_ram_report.py .pio/build/uno/firmware.elf
+    potato_ram_report.py firmware.elf --top 20 --json ram.json
+    potato_ram_report.py firmware.elf --baseline main.json --max-static 1536
+
+The stack and heap share what is left; the "mem" shell command reports how
+much of it the stack has used so far.
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+
+RAM_SECTIONS = (".data", ".bss", ".noinit")
+RAM_TYPES = set("bBdDvV")
+LTO_SUFFIX = re.compile(r"\.lto_priv\.\d+$|\.\d+$")
+# Compiler generated objects belong to the class or variable they are for
+GENERATED = re.compile(r"^(vtable for |typeinfo for |typeinfo name for |guard variable for )")
+ANONYMOUS = "(anonymous namespace)::"
+
+
+def section_sizes(size_tool, elf):
+    """{section: bytes} of the RAM sections, from "size -A"."""
+    output = subprocess.run([size_tool, "-A", elf], check=True, capture_output=True, text=True).stdout
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in RAM_SECTIONS:
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def ram_symbols(nm_tool, elf):
+    """[(name, bytes)] of every sized symbol in a RAM section, demangled."""
+    output = subprocess.run([nm_tool, "-S", "-C", "--size-sort", "-t", "d", elf],
+                            check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(maxsplit=3)
+        if len(fields) == 4 and fields[2] in RAM_TYPES:
+            symbols.append((LTO_SUFFIX.sub("", fields[3]), int(fields[1])))
+    return symbols
+
+
+def module_of(name):
+    """First component of a qualified name, ignoring "::" inside () and <>."""
+    name = GENERATED.sub("", name)
+    while name.startswith(ANONYMOUS):
+        name = name[len(ANONYMOUS):]
+    depth = 0
+    for index, char in enumerate(name):
+        if char in "(<":
+            depth += 1
+        elif char in ")>":
+            depth -= 1
+        elif depth == 0 and name.startswith("::", index):
+            return name[:index]
+    return name
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf")
+    parser.add_argument("--nm", default="avr-nm")
+    parser.add_argument("--size", default="avr-size")
+    parser.add_argument("--ram", type=int, default=2048, help="RAM of the MCU, bytes")
+    parser.add_argument("--top", type=int, default=10, help="largest symbols to list")
+    parser.add_argument("--json", help="write the module totals for a later --baseline")
+    parser.add_argument("--baseline", help="module totals of the reference firmware")
+    parser.add_argument("--max-static", type=int, help="fail when .data + .bss + .noinit exceed this")
+    args = parser.parse_args()
+
+    sections = section_sizes(args.size, args.elf)
+    symbols = ram_symbols(args.nm, args.elf)
+    static = sum(sections.values())
+    modules = {}
+    for name, size in symbols:
+        module = module_of(name)
+        modules[module] = modules.get(module, 0) + size
+    # Padding and symbols without a size, e.g. from assembly
+    unattributed = static - sum(modules.values())
+    if unattributed > 0:
+        modules["(unattributed)"] = unattributed
+
+    print(f"RAM {args.ram} B: " + ", ".join(f"{name} {size}" for name, size in sections.items())
+          + f", left for heap and stack {args.ram - static}")
+    print(f"\n{'module':40} {'bytes':>6} {'share':>7}")
+    for module, size in sorted(modules.items(), key=lambda item: (-item[1], item[0])):
+        print(f"{module[:40]:40} {size:>6} {100.0 * size / args.ram:>6.1f}%")
+    if args.top > 0:
+        print(f"\n{'symbol':60} {'bytes':>6}")
+        for name, size in sorted(symbols, key=lambda item: -item[1])[:args.top]:
+            print(f"{name[:60]:60} {size:>6}")
+
+    if args.json:
+        with open(args.json, "w") as target:
+            json.dump({"static": static, "sections": sections, "modules": modules}, target, indent=2)
+
+    if args.baseline:
+        with open(args.baseline) as source:
+            reference = json.load(source)
+        before_modules = reference.get("modules", {})
+        print(f"\n{'module':40} {'baseline':>8} {'bytes':>6} {'change':>7}")
+        for module in sorted(set(modules) | set(before_modules)):
+            before, after = before_modules.get(module, 0), modules.get(module, 0)
+            if before != after:
+                print(f"{module[:40]:40} {before:>8} {after:>6} {after - before:>+7}")
+        print(f"{'static total':40} {reference.get('static', 0):>8} {static:>6} "
+              f"{static - reference.get('static', 0):>+7}")
+
+    if args.max_static is not None and static > args.max_static:
+        print(f"{args.elf}: {static} B of statics, over the {args.max_static} B limit", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
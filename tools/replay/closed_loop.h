@@ -0,0 +1,97 @@
+#pragma once
+
+// Closed-loop replay: only the external readings come from the trace, the
+// internal sensor reads a Sim::ThermalPlant (platform/native/include) that
+// the replayed fan cools. Build with -Iplatform/native/include.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "thermal_plant.h"
+
+namespace Replay
+{
+    /// Reading of a 12-bit DS18B20, like the simulator's getTempCByIndex()
+    inline float quantizeReading(float celsius) {
+        constexpr float kStep = 0.0625f;
+        return kStep * floorf(celsius / kStep + 0.5f);
+    }
+
+    /**
+     * Replay [begin, end) with plant as the room. The plant advances one loop
+     * period per pass with the fan state of the previous pass; while the
+     * external reading is missing it keeps the last known outside
+     * temperature. The band and cooling metrics use the plant reading.
+     */
+    template <typename DayHook>
+    Metrics runClosedLoop(const Record* begin, const Record* end, const Config& config, Sim::ThermalPlant& plant,
+                          int64_t start_time, DayHook&& day) {
+        const double pass_s = config.loop_ms * 1e-3;
+        float outside = NAN;
+        return runWith(begin, end, config, start_time, [&](const Cursor& cursor, bool fan_on) {
+            if (!isnan(cursor.external())) {
+                outside = cursor.external();
+            }
+            if (!isnan(outside)) {
+                plant.advance(pass_s, outside, fan_on);
+            }
+            return quantizeReading(plant.sensorTemperature());
+        }, day);
+    }
+
+    inline Metrics runClosedLoop(const Record* begin, const Record* end, const Config& config,
+                                 Sim::ThermalPlant& plant, int64_t start_time = 0) {
+        return runClosedLoop(begin, end, config, plant, start_time, [](int64_t, const Metrics&) {});
+    }
+
+    /// Plant options shared by the command line tools
+    struct PlantOptions {
+        bool enabled = false;
+        float initial_c = 12.0f;
+        Sim::PlantParameters parameters;
+    };
+
+    constexpr char kPlantUsage[] =
+        "       [--plant] [--initial C] [--pile-t TONNES] [--airflow M3_S] [--respiration W_PER_T]\n"
+        "       [--wall-ua W_K] [--sensor pile|air] [--plant-step S]\n";
+
+    /// Parameters the model cannot run with, nullptr when they are fine
+    inline const char* plantOptionsError(const PlantOptions& options) {
+        const Sim::PlantParameters& parameters = options.parameters;
+        if (parameters.step_s <= 0.0f) {
+            return "--plant-step must be positive";
+        }
+        if (parameters.pile_mass_kg <= 0.0f) {
+            return "--pile-t must be positive";
+        }
+        return nullptr;
+    }
+
+    /// Take argv[i] (and its value) when it is a plant option, false otherwise
+    inline bool parsePlantOption(int& i, int argc, char** argv, PlantOptions& options) {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--plant")) {
+            options.enabled = true;
+        } else if (!strcmp(argv[i], "--initial") && has_value) {
+            options.initial_c = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--pile-t") && has_value) {
+            options.parameters.pile_mass_kg = static_cast<float>(atof(argv[++i]) * 1000.0);
+        } else if (!strcmp(argv[i], "--airflow") && has_value) {
+            options.parameters.fan_airflow_m3_s = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--respiration") && has_value) {
+            options.parameters.respiration_w_per_t = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--wall-ua") && has_value) {
+            options.parameters.wall_ua = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--sensor") && has_value) {
+            options.parameters.sensor_in_pile = strcmp(argv[++i], "air") != 0;
+        } else if (!strcmp(argv[i], "--plant-step") && has_value) {
+            options.parameters.step_s = static_cast<float>(atof(argv[++i]));
+        } else {
+            return false;
+        }
+        options.enabled = true;
+        return true;
+    }
+} // namespace Replay
@@ -0,0 +1,172 @@
+// Replays a recorded temperature trace through the firmware fan decision.
+//
+// The trace (tools/replay/trace.h) is memory-mapped and stepped on a virtual
+// clock at the loop() period; the totals tell how a set of fan settings
+// would have behaved over the recorded season. A CSV trace can be converted
+// to the binary format once with --write-binary, later runs then map it
+// without parsing.
+//
+// With --plant the loop is closed (closed_loop.h): the internal readings
+// come from a thermal model of the room that the replayed fan cools, and
+// the internal column of the trace is ignored.
+//
+// Build, from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude -Iplatform/native/include -o potato_replay tools/replay/potato_replay.cpp
+// Run:
+//   ./potato_replay storage_2024.csv --write-binary storage_2024.trc
+//   ./potato_replay storage_2024.trc --min-ext 3 --diff 1.5 --daily days.csv
+//   ./potato_replay storage_2024.trc --plant --pile-t 150 --initial 14
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "closed_loop.h"
+#include "replay.h"
+
+namespace {
+    void usage(const char* program) {
+        fprintf(stderr,
+                "usage: %s trace.(csv|trc) [--min-ext C] [--max-ext C] [--diff C] [--switch-time S]\n"
+                "       [--loop-ms MS] [--max-gap S] [--band LOW:HIGH] [--daily file.csv]\n"
+                "       [--write-binary file.trc] [--json]\n%s", program, Replay::kPlantUsage);
+    }
+
+    void printText(const Replay::Metrics& metrics, const Replay::Config& config, size_t samples, double seconds) {
+        printf("trace:            %zu samples, %.1f days\n", samples, metrics.hours / 24.0);
+        printf("decisions:        %llu (%.1f M/s, %.1f M samples/s)\n",
+               static_cast<unsigned long long>(metrics.passes),
+               seconds > 0.0 ? metrics.passes / seconds / 1e6 : 0.0,
+               seconds > 0.0 ? samples / seconds / 1e6 : 0.0);
+        printf("fan switches:     %u on, %u off\n", metrics.switches_on, metrics.switches_off);
+        printf("fan hours:        %.1f (%.1f %%)\n", metrics.fan_hours,
+               metrics.hours > 0.0 ? 100.0 * metrics.fan_hours / metrics.hours : 0.0);
+        printf("cooling:          %.1f C h\n", metrics.cooling_degree_hours);
+        printf("outside %.1f..%.1f C: %.1f h (%.1f h below, %.1f h above)\n",
+               config.band_low, config.band_high, metrics.outsideBandHours(),
+               metrics.below_band_hours, metrics.above_band_hours);
+        printf("no internal data: %.1f h\n", metrics.missing_hours);
+        if (metrics.internal_min <= metrics.internal_max) {
+            printf("internal range:   %.2f .. %.2f C\n", metrics.internal_min, metrics.internal_max);
+        }
+    }
+
+    void printJson(const Replay::Metrics& metrics, size_t samples, double seconds) {
+        printf("{\"samples\": %zu, \"decisions\": %llu, \"hours\": %.3f, \"switches_on\": %u, "
+               "\"switches_off\": %u, \"fan_hours\": %.3f, \"cooling_degree_hours\": %.3f, \"below_band_hours\": %.3f, "
+               "\"above_band_hours\": %.3f, \"missing_hours\": %.3f, \"run_seconds\": %.6f}\n",
+               samples, static_cast<unsigned long long>(metrics.passes), metrics.hours,
+               metrics.switches_on, metrics.switches_off, metrics.fan_hours, metrics.cooling_degree_hours,
+               metrics.below_band_hours, metrics.above_band_hours, metrics.missing_hours, seconds);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char* trace_path = argv[1];
+    const char* daily_path = nullptr;
+    const char* binary_path = nullptr;
+    bool json = false;
+    Replay::Config config;
+    Replay::PlantOptions plant_options;
+    for (int i = 2; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (Replay::parsePlantOption(i, argc, argv, plant_options)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--min-ext") && has_value) {
+            config.settings.min_external = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-ext") && has_value) {
+            config.settings.max_external = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--diff") && has_value) {
+            config.settings.temperature_difference = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--switch-time") && has_value) {
+            config.settings.switch_time_ms = static_cast<unsigned long>(atol(argv[++i])) * 1000UL;
+        } else if (!strcmp(argv[i], "--loop-ms") && has_value) {
+            config.loop_ms = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-gap") && has_value) {
+            config.max_gap_s = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--band") && has_value) {
+            if (sscanf(argv[++i], "%f:%f", &config.band_low, &config.band_high) != 2) {
+                fprintf(stderr, "bad --band, expected LOW:HIGH\n");
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--daily") && has_value) {
+            daily_path = argv[++i];
+        } else if (!strcmp(argv[i], "--write-binary") && has_value) {
+            binary_path = argv[++i];
+        } else if (!strcmp(argv[i], "--json")) {
+            json = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (config.loop_ms == 0) {
+        fprintf(stderr, "--loop-ms must be positive\n");
+        return 2;
+    }
+
+    if (plant_options.enabled && Replay::plantOptionsError(plant_options) != nullptr) {
+        fprintf(stderr, "%s\n", Replay::plantOptionsError(plant_options));
+        return 2;
+    }
+
+    Replay::Trace trace;
+    if (!trace.open(trace_path)) {
+        fprintf(stderr, "%s\n", trace.error().c_str());
+        return 1;
+    }
+    if (binary_path != nullptr) {
+        if (!Replay::Trace::writeBinary(binary_path, trace.begin(), trace.size(), trace.startTime())) {
+            fprintf(stderr, "%s: cannot write trace\n", binary_path);
+            return 1;
+        }
+        fprintf(stderr, "wrote %zu samples to %s\n", trace.size(), binary_path);
+    }
+
+    FILE* daily = nullptr;
+    if (daily_path != nullptr) {
+        daily = fopen(daily_path, "w");
+        if (daily == nullptr) {
+            fprintf(stderr, "%s: cannot write\n", daily_path);
+            return 1;
+        }
+        fprintf(daily, "day,switches_on,fan_hours,cooling_degree_hours,below_band_hours,above_band_hours,missing_hours,internal_min,internal_max\n");
+    }
+
+    const auto write_day = [daily](int64_t day, const Replay::Metrics& today) {
+        if (daily != nullptr) {
+            fprintf(daily, "%lld,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f\n", static_cast<long long>(day),
+                    today.switches_on, today.fan_hours, today.cooling_degree_hours, today.below_band_hours,
+                    today.above_band_hours, today.missing_hours, today.internal_min, today.internal_max);
+        }
+    };
+    Sim::ThermalPlant plant(plant_options.parameters, plant_options.initial_c);
+    if (plant_options.enabled && plant_options.parameters.step_s > 0.5f * plant.maxStableStep()) {
+        fprintf(stderr, "--plant-step %.1f s is close to the stability limit of %.1f s\n",
+                plant_options.parameters.step_s, plant.maxStableStep());
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const Replay::Metrics metrics = plant_options.enabled
+        ? Replay::runClosedLoop(trace.begin(), trace.end(), config, plant, trace.startTime(), write_day)
+        : Replay::run(trace.begin(), trace.end(), config, trace.startTime(), write_day);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (daily != nullptr) {
+        fclose(daily);
+    }
+
+    if (json) {
+        printJson(metrics, trace.size(), seconds);
+    } else {
+        printText(metrics, config, trace.size(), seconds);
+        if (plant_options.enabled) {
+            printf("plant at the end: pile %.2f C, air %.2f C\n", plant.pileTemperature(), plant.airTemperature());
+        }
+    }
+    return 0;
+}
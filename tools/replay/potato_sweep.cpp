@@ -0,0 +1,304 @@
+// Sweeps the fan settings over a trace and prints the Pareto front of relay
+// switches against cooling.
+//
+// Every candidate (min_ext, max_ext, temp_diff, switch_time) replays the
+// whole trace with its own controller state. Blocks of candidates run in
+// lockstep through FanControl::updateBatch() (Replay::runBatch), the blocks
+// on a work-stealing pool, one worker per hardware thread unless --threads
+// says otherwise. The speedup from more workers has not been measured on a
+// multi-core machine; on a single CPU 1, 2 and 4 threads take about the same
+// time. --scalar replays each candidate on its own with Replay::run()
+// instead, as a cross-check. With
+// --plant every candidate runs closed loop against its own copy of the room
+// model (closed_loop.h), one candidate per task.
+//
+// A candidate is on the front when no other one both switches the relay
+// less often and cools more; cooling is the sum of internal - external over
+// the hours the fan runs (Metrics::cooling_degree_hours).
+//
+// Build, from the repository root:
+//   g++ -std=c++17 -O3 -march=native -pthread -Iinclude -Iplatform/native/include -o potato_sweep
+//       tools/replay/potato_sweep.cpp
+// Run:
+//   ./potato_sweep storage_2024.trc --min-ext 0:6:0.5 --diff 0.5:3:0.5 > front.csv
+//   ./potato_sweep --synthetic 180 --random 2000 --all candidates.csv
+//   ./potato_sweep storage_2024.trc --plant --pile-t 150 --initial 14 --band 4:7
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "closed_loop.h"
+#include "replay.h"
+#include "work_stealing_pool.h"
+
+namespace {
+    constexpr size_t kCandidatesPerBlock = 256;
+
+    /// start:stop:step, stop included; step 0 pins the value to start
+    struct Range {
+        double start;
+        double stop;
+        double step;
+
+        size_t count() const {
+            return step > 0.0 && stop >= start ? static_cast<size_t>((stop - start) / step + 1e-9) + 1 : 1;
+        }
+        double at(size_t index) const { return start + step * static_cast<double>(index); }
+    };
+
+    struct Candidate {
+        FanControl::Settings settings;
+        Replay::Metrics metrics;
+    };
+
+    bool parseRange(const char* text, Range& range) {
+        range.step = 0.0;
+        const int fields = sscanf(text, "%lf:%lf:%lf", &range.start, &range.stop, &range.step);
+        if (fields == 1) {
+            range.stop = range.start;
+        }
+        return fields == 1 || (fields == 3 && range.step >= 0.0 && range.stop >= range.start);
+    }
+
+    FanControl::Settings settingsOf(double min_external, double max_external, double difference, double switch_time) {
+        FanControl::Settings settings;
+        settings.min_external = static_cast<float>(min_external);
+        settings.max_external = static_cast<float>(max_external);
+        settings.temperature_difference = static_cast<float>(difference);
+        settings.switch_time_ms = static_cast<unsigned long>(switch_time * 1000.0);
+        return settings;
+    }
+
+    /// Fewest switches first; a candidate stays only when it cools more than every one before it
+    std::vector<const Candidate*> paretoFront(const std::vector<Candidate>& candidates) {
+        std::vector<const Candidate*> sorted;
+        for (const Candidate& candidate : candidates) {
+            sorted.push_back(&candidate);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Candidate* a, const Candidate* b) {
+            if (a->metrics.switches_on != b->metrics.switches_on) {
+                return a->metrics.switches_on < b->metrics.switches_on;
+            }
+            return a->metrics.cooling_degree_hours > b->metrics.cooling_degree_hours;
+        });
+        std::vector<const Candidate*> front;
+        for (const Candidate* candidate : sorted) {
+            if (front.empty() || candidate->metrics.cooling_degree_hours > front.back()->metrics.cooling_degree_hours) {
+                front.push_back(candidate);
+            }
+        }
+        return front;
+    }
+
+    void printRow(FILE* out, const Candidate& candidate) {
+        const Replay::Metrics& metrics = candidate.metrics;
+        fprintf(out, "%u,%.2f,%.2f,%.2f,%.1f,%.1f,%.1f,%lu\n", metrics.switches_on, metrics.cooling_degree_hours,
+                metrics.fan_hours, metrics.outsideBandHours(), candidate.settings.min_external,
+                candidate.settings.max_external, candidate.settings.temperature_difference,
+                candidate.settings.switch_time_ms / 1000UL);
+    }
+
+    const char kHeader[] = "switches_on,cooling_degree_hours,fan_hours,outside_band_hours,min_ext,max_ext,temp_diff,switch_time\n";
+
+    void usage(const char* program) {
+        fprintf(stderr,
+                "usage: %s (trace.(csv|trc) | --synthetic DAYS) [--min-ext A:B:STEP] [--max-ext A:B:STEP]\n"
+                "       [--diff A:B:STEP] [--switch-time A:B:STEP] [--random N] [--seed S] [--threads N]\n"
+                "       [--loop-ms MS] [--max-gap S] [--band LOW:HIGH] [--all file.csv] [--scalar]\n"
+                "%s"
+                "a range is start:stop:step with stop included, or a single value\n", program, Replay::kPlantUsage);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char* trace_path = nullptr;
+    const char* all_path = nullptr;
+    uint32_t synthetic_days = 0;
+    size_t random_count = 0;
+    uint32_t seed = 1;
+    unsigned threads = 0;
+    bool scalar = false;
+    Replay::Config config;
+    Replay::PlantOptions plant_options;
+    // Defaults cover what the keypad offers (settings_registry.cpp), on a coarser grid
+    Range min_external = {0.0, 8.0, 1.0};
+    Range max_external = {12.0, 24.0, 2.0};
+    Range difference = {0.5, 3.0, 0.5};
+    Range switch_time = {0.0, 1800.0, 300.0};
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        bool range_ok = true;
+        if (Replay::parsePlantOption(i, argc, argv, plant_options)) {
+            continue;
+        }
+        if (!strcmp(argv[i], "--synthetic") && has_value) {
+            synthetic_days = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--min-ext") && has_value) {
+            range_ok = parseRange(argv[++i], min_external);
+        } else if (!strcmp(argv[i], "--max-ext") && has_value) {
+            range_ok = parseRange(argv[++i], max_external);
+        } else if (!strcmp(argv[i], "--diff") && has_value) {
+            range_ok = parseRange(argv[++i], difference);
+        } else if (!strcmp(argv[i], "--switch-time") && has_value) {
+            range_ok = parseRange(argv[++i], switch_time);
+        } else if (!strcmp(argv[i], "--random") && has_value) {
+            random_count = static_cast<size_t>(atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--seed") && has_value) {
+            seed = static_cast<uint32_t>(atol(argv[++i]));
+        } else if (!strcmp(argv[i], "--threads") && has_value) {
+            threads = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--loop-ms") && has_value) {
+            config.loop_ms = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-gap") && has_value) {
+            config.max_gap_s = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--band") && has_value) {
+            range_ok = sscanf(argv[++i], "%f:%f", &config.band_low, &config.band_high) == 2;
+        } else if (!strcmp(argv[i], "--scalar")) {
+            scalar = true;
+        } else if (!strcmp(argv[i], "--all") && has_value) {
+            all_path = argv[++i];
+        } else if (argv[i][0] != '-' && trace_path == nullptr) {
+            trace_path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        if (!range_ok) {
+            fprintf(stderr, "bad value for %s: %s\n", argv[i - 1], argv[i]);
+            return 2;
+        }
+    }
+    if ((trace_path == nullptr) == (synthetic_days == 0) || config.loop_ms == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (plant_options.enabled && Replay::plantOptionsError(plant_options) != nullptr) {
+        fprintf(stderr, "%s\n", Replay::plantOptionsError(plant_options));
+        return 2;
+    }
+
+    Replay::Trace trace;
+    std::vector<Replay::Record> synthetic;
+    const Replay::Record* begin = nullptr;
+    const Replay::Record* end = nullptr;
+    int64_t start_time = 0;
+    if (trace_path != nullptr) {
+        if (!trace.open(trace_path)) {
+            fprintf(stderr, "%s\n", trace.error().c_str());
+            return 1;
+        }
+        begin = trace.begin();
+        end = trace.end();
+        start_time = trace.startTime();
+    } else {
+        synthetic = Replay::syntheticTrace(synthetic_days, seed);
+        begin = synthetic.data();
+        end = synthetic.data() + synthetic.size();
+    }
+
+    std::vector<Candidate> candidates;
+    if (random_count > 0) {
+        // Uniform over the same grid, for spaces too large to walk
+        std::mt19937 generator(seed);
+        while (candidates.size() < random_count) {
+            auto pick = [&generator](const Range& range) {
+                return range.at(std::uniform_int_distribution<size_t>(0, range.count() - 1)(generator));
+            };
+            Candidate candidate;
+            candidate.settings = settingsOf(pick(min_external), pick(max_external), pick(difference), pick(switch_time));
+            if (candidate.settings.min_external < candidate.settings.max_external) {
+                candidates.push_back(candidate);
+            }
+        }
+    } else {
+        for (size_t a = 0; a < min_external.count(); ++a) {
+            for (size_t b = 0; b < max_external.count(); ++b) {
+                for (size_t c = 0; c < difference.count(); ++c) {
+                    for (size_t d = 0; d < switch_time.count(); ++d) {
+                        Candidate candidate;
+                        candidate.settings = settingsOf(min_external.at(a), max_external.at(b),
+                                                        difference.at(c), switch_time.at(d));
+                        if (candidate.settings.min_external < candidate.settings.max_external) {
+                            candidates.push_back(candidate);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if (candidates.empty()) {
+        fprintf(stderr, "no candidate with min_ext below max_ext\n");
+        return 2;
+    }
+
+    Replay::WorkStealingPool pool(threads);
+    const auto started = std::chrono::steady_clock::now();
+    if (plant_options.enabled) {
+        pool.run(candidates.size(), [&](size_t index, unsigned) {
+            Replay::Config candidate_config = config;
+            candidate_config.settings = candidates[index].settings;
+            Sim::ThermalPlant plant(plant_options.parameters, plant_options.initial_c);
+            candidates[index].metrics = Replay::runClosedLoop(begin, end, candidate_config, plant, start_time);
+        });
+    } else if (scalar) {
+        pool.run(candidates.size(), [&](size_t index, unsigned) {
+            Replay::Config candidate_config = config;
+            candidate_config.settings = candidates[index].settings;
+            candidates[index].metrics = Replay::run(begin, end, candidate_config, start_time);
+        });
+    } else {
+        const size_t blocks = (candidates.size() + kCandidatesPerBlock - 1) / kCandidatesPerBlock;
+        pool.run(blocks, [&](size_t block, unsigned) {
+            const size_t first = block * kCandidatesPerBlock;
+            const size_t count = std::min(kCandidatesPerBlock, candidates.size() - first);
+            std::vector<FanControl::Settings> settings(count);
+            std::vector<Replay::Metrics> metrics(count);
+            for (size_t i = 0; i < count; ++i) {
+                settings[i] = candidates[first + i].settings;
+            }
+            Replay::runBatch(begin, end, config, settings.data(), count, metrics.data());
+            for (size_t i = 0; i < count; ++i) {
+                candidates[first + i].metrics = metrics[i];
+            }
+        });
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    uint64_t decisions = 0;
+    for (const Candidate& candidate : candidates) {
+        decisions += candidate.metrics.passes;
+    }
+    fprintf(stderr, "%zu candidates x %zu samples on %u threads: %.2f s, %.1f M decisions/s\n",
+            candidates.size(), static_cast<size_t>(end - begin), pool.threads(), seconds,
+            seconds > 0.0 ? decisions / seconds / 1e6 : 0.0);
+
+    if (all_path != nullptr) {
+        FILE* all = fopen(all_path, "w");
+        if (all == nullptr) {
+            fprintf(stderr, "%s: cannot write\n", all_path);
+            return 1;
+        }
+        fputs(kHeader, all);
+        for (const Candidate& candidate : candidates) {
+            printRow(all, candidate);
+        }
+        fclose(all);
+    }
+
+    fputs(kHeader, stdout);
+    for (const Candidate* candidate : paretoFront(candidates)) {
+        printRow(stdout, *candidate);
+    }
+    return 0;
+}
@@ -0,0 +1,297 @@
+#pragma once
+
+// Replay engine: runs the firmware's fan decision over a recorded trace on a
+// virtual clock. Each pass mirrors one loop() of src/main.cpp: read one
+// sensor (external and internal alternate) through the same moving-average
+// filter as TemperatureSensor, then FanControl::update() from
+// include/fan_control.h with the settings as PersistenceManager stores them.
+
+#include <stdint.h>
+#include <math.h>
+
+#include <vector>
+
+#include "fan_control.h"
+#include "moving_average.h"
+#include "trace.h"
+
+namespace Replay
+{
+    constexpr size_t kFilterSize = 10;  // Sensor::TemperatureSensor::kFilterSize
+
+    struct Config {
+        // PersistenceManager defaults (include/persistence_manager.h)
+        FanControl::Settings settings = {4.0f, 20.0f, 1.0f, 5UL * 60UL * 1000UL};
+        uint32_t loop_ms = 960;     // 12-bit conversion, delay(200) and the loop work
+        uint32_t max_gap_s = 600;   // A reading older than this counts as missing
+        float band_low = 4.0f;      // Target band of the internal temperature, C
+        float band_high = 8.0f;
+    };
+
+    struct Metrics {
+        uint64_t passes = 0;
+        uint32_t switches_on = 0;   // Off -> on, i.e. relay cycles
+        uint32_t switches_off = 0;
+        double hours = 0.0;
+        double fan_hours = 0.0;
+        double cooling_degree_hours = 0.0;  // Sum of internal - external while the fan runs, C h
+        double below_band_hours = 0.0;
+        double above_band_hours = 0.0;
+        double missing_hours = 0.0; // No internal reading, not counted in or out of band
+        float internal_min = INFINITY;
+        float internal_max = -INFINITY;
+
+        double outsideBandHours() const { return below_band_hours + above_band_hours; }
+
+        void merge(const Metrics& other) {
+            passes += other.passes;
+            switches_on += other.switches_on;
+            switches_off += other.switches_off;
+            hours += other.hours;
+            fan_hours += other.fan_hours;
+            cooling_degree_hours += other.cooling_degree_hours;
+            below_band_hours += other.below_band_hours;
+            above_band_hours += other.above_band_hours;
+            missing_hours += other.missing_hours;
+            internal_min = fminf(internal_min, other.internal_min);
+            internal_max = fmaxf(internal_max, other.internal_max);
+        }
+    };
+
+    /// The sensor half of loop(): one sensor read per pass, each through its filter
+    class Sensors {
+    public:
+        /// One pass with the raw readings (NAN = disconnected)
+        void pass(float external_reading, float internal_reading) {
+            if (read_external_) {
+                external_temp_ = isnan(external_reading) ? NAN : filter(external_filter_, external_reading);
+            } else {
+                internal_temp_ = isnan(internal_reading) ? NAN : filter(internal_filter_, internal_reading);
+            }
+            read_external_ = !read_external_;
+        }
+
+        float external() const { return external_temp_; }
+        float internal() const { return internal_temp_; }
+
+    private:
+        static float filter(MovingAverage<kFilterSize>& average, float reading) {
+            average.add(reading);
+            return average.mean();
+        }
+
+        MovingAverage<kFilterSize> external_filter_;
+        MovingAverage<kFilterSize> internal_filter_;
+        float external_temp_ = NAN;
+        float internal_temp_ = NAN;
+        bool read_external_ = true;
+    };
+
+    /// The sensor and fan state one loop() carries between passes
+    class Controller {
+    public:
+        explicit Controller(const FanControl::Settings& settings)
+            : settings_(settings), state_(FanControl::initialState(0, settings)) {}
+
+        /// One loop() pass at now_ms with the raw sensor readings (NAN = disconnected)
+        bool pass(unsigned long now_ms, float external_reading, float internal_reading) {
+            sensors_.pass(external_reading, internal_reading);
+            return FanControl::update(state_, settings_, now_ms, sensors_.external(), sensors_.internal());
+        }
+
+        bool fanOn() const { return state_.fan_on; }
+
+    private:
+        FanControl::Settings settings_;
+        FanControl::State state_;
+        Sensors sensors_;
+    };
+
+    /// Walks a trace pass by pass: the newest sample at or before each pass (zero-order hold)
+    class Cursor {
+    public:
+        Cursor(const Record* begin, const Record* end, const Config& config)
+            : sample_(begin), end_(end), loop_ms_(config.loop_ms),
+              max_gap_ms_(static_cast<uint64_t>(config.max_gap_s) * 1000U),
+              trace_ms_(static_cast<uint64_t>(begin->seconds) * 1000U),
+              first_ms_(trace_ms_), last_ms_(static_cast<uint64_t>((end - 1)->seconds) * 1000U) {}
+
+        /// Move to the next pass; false past the last sample
+        bool next() {
+            if (started_) {
+                trace_ms_ += loop_ms_;
+            }
+            started_ = true;
+            if (trace_ms_ > last_ms_) {
+                return false;
+            }
+            while (sample_ + 1 < end_ && static_cast<uint64_t>(sample_[1].seconds) * 1000U <= trace_ms_) {
+                ++sample_;
+            }
+            const bool fresh = trace_ms_ - static_cast<uint64_t>(sample_->seconds) * 1000U <= max_gap_ms_;
+            external_ = fresh ? toCelsius(sample_->external_centi) : NAN;
+            internal_ = fresh ? toCelsius(sample_->internal_centi) : NAN;
+            return true;
+        }
+
+        uint64_t traceMs() const { return trace_ms_; }
+        /// Virtual millis() of the pass, zero at the first sample
+        uint64_t nowMs() const { return trace_ms_ - first_ms_; }
+        float external() const { return external_; }
+        float internal() const { return internal_; }
+
+    private:
+        const Record* sample_;
+        const Record* end_;
+        uint32_t loop_ms_;
+        uint64_t max_gap_ms_;
+        uint64_t trace_ms_;
+        uint64_t first_ms_;
+        uint64_t last_ms_;
+        float external_ = NAN;
+        float internal_ = NAN;
+        bool started_ = false;
+    };
+
+    /// Add one pass of the trace readings to metrics, the parts that do not depend on the fan
+    inline void countPass(Metrics& metrics, const Config& config, double pass_hours, float internal) {
+        ++metrics.passes;
+        metrics.hours += pass_hours;
+        if (isnan(internal)) {
+            metrics.missing_hours += pass_hours;
+            return;
+        }
+        if (internal < config.band_low) {
+            metrics.below_band_hours += pass_hours;
+        } else if (internal > config.band_high) {
+            metrics.above_band_hours += pass_hours;
+        }
+        metrics.internal_min = fminf(metrics.internal_min, internal);
+        metrics.internal_max = fmaxf(metrics.internal_max, internal);
+    }
+
+    /**
+     * Replay [begin, end) and return the totals. internal(cursor, fan_on)
+     * gives the internal reading of each pass, fan_on being the state the
+     * previous pass left. day(index, metrics) is called with the totals of
+     * every finished day (unix days when the trace has a start time,
+     * otherwise days since its start).
+     */
+    template <typename Internal, typename DayHook>
+    Metrics runWith(const Record* begin, const Record* end, const Config& config, int64_t start_time,
+                    Internal&& internal_of, DayHook&& day) {
+        Metrics total;
+        if (begin == end) {
+            return total;
+        }
+        Controller controller(config.settings);
+        Cursor cursor(begin, end, config);
+        Metrics today;
+        const double pass_hours = config.loop_ms / 3600000.0;
+        const int64_t day_offset_s = start_time > 0 ? start_time : 0;
+        int64_t current_day = (day_offset_s + begin->seconds) / 86400;
+
+        while (cursor.next()) {
+            const int64_t pass_day = (day_offset_s + static_cast<int64_t>(cursor.traceMs() / 1000U)) / 86400;
+            if (pass_day != current_day) {
+                day(current_day, static_cast<const Metrics&>(today));
+                total.merge(today);
+                today = Metrics();
+                current_day = pass_day;
+            }
+
+            const float external = cursor.external();
+            const float internal = internal_of(static_cast<const Cursor&>(cursor), controller.fanOn());
+            const bool was_on = controller.fanOn();
+            const bool on = controller.pass(static_cast<unsigned long>(cursor.nowMs()), external, internal);
+            countPass(today, config, pass_hours, internal);
+            if (on != was_on) {
+                ++(on ? today.switches_on : today.switches_off);
+            }
+            if (on) {
+                today.fan_hours += pass_hours;
+                if (!isnan(external) && !isnan(internal)) {
+                    today.cooling_degree_hours += (internal - external) * pass_hours;
+                }
+            }
+        }
+        day(current_day, static_cast<const Metrics&>(today));
+        total.merge(today);
+        return total;
+    }
+
+    /// Open loop: the internal readings come from the trace
+    template <typename DayHook>
+    Metrics run(const Record* begin, const Record* end, const Config& config, int64_t start_time, DayHook&& day) {
+        return runWith(begin, end, config, start_time, [](const Cursor& cursor, bool) { return cursor.internal(); },
+                       day);
+    }
+
+    inline Metrics run(const Record* begin, const Record* end, const Config& config, int64_t start_time = 0) {
+        return run(begin, end, config, start_time, [](int64_t, const Metrics&) {});
+    }
+
+    /**
+     * Replay [begin, end) for count settings at once and store one Metrics
+     * each in metrics. The sensors are shared, as the settings do not change
+     * what loop() reads, and the fan decisions of all settings run through
+     * FanControl::updateBatch(). The batch keeps 32-bit times like the
+     * target, so a fan left alone for over 49 days may wait up to one
+     * switch time longer than in run(), as it would on the board.
+     */
+    inline void runBatch(const Record* begin, const Record* end, const Config& config,
+                         const FanControl::Settings* settings, size_t count, Metrics* metrics) {
+        if (begin == end || count == 0) {
+            for (size_t i = 0; i < count; ++i) {
+                metrics[i] = Metrics();
+            }
+            return;
+        }
+        std::vector<float> min_external(count), max_external(count), difference(count);
+        std::vector<uint32_t> switch_time_ms(count), last_change_ms(count);
+        std::vector<uint8_t> fan_on(count, 0), was_on(count, 0);
+        std::vector<uint32_t> switches_on(count, 0), switches_off(count, 0), on_passes(count, 0);
+        std::vector<double> cooling(count, 0.0);
+        for (size_t i = 0; i < count; ++i) {
+            min_external[i] = settings[i].min_external;
+            max_external[i] = settings[i].max_external;
+            difference[i] = settings[i].temperature_difference;
+            switch_time_ms[i] = static_cast<uint32_t>(settings[i].switch_time_ms);
+            last_change_ms[i] = static_cast<uint32_t>(FanControl::initialState(0, settings[i]).last_change_ms);
+        }
+        const FanControl::Lanes lanes = {min_external.data(), max_external.data(), difference.data(),
+                                         switch_time_ms.data(), fan_on.data(), last_change_ms.data(), count};
+
+        Sensors sensors;
+        Cursor cursor(begin, end, config);
+        Metrics shared;
+        const double pass_hours = config.loop_ms / 3600000.0;
+        while (cursor.next()) {
+            const float external = cursor.external();
+            const float internal = cursor.internal();
+            sensors.pass(external, internal);
+            FanControl::updateBatch(lanes, static_cast<uint32_t>(cursor.nowMs()), sensors.external(), sensors.internal());
+            countPass(shared, config, pass_hours, internal);
+
+            // Per lane counters, branch-free like the kernel
+            const double delta = !isnan(external) && !isnan(internal) ? internal - external : 0.0;
+            for (size_t i = 0; i < count; ++i) {
+                const uint32_t on = fan_on[i];
+                const uint32_t before = was_on[i];
+                switches_on[i] += on & ~before;
+                switches_off[i] += before & ~on;
+                on_passes[i] += on;
+                cooling[i] += on != 0 ? delta : 0.0;
+                was_on[i] = static_cast<uint8_t>(on);
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            metrics[i] = shared;
+            metrics[i].switches_on = switches_on[i];
+            metrics[i].switches_off = switches_off[i];
+            metrics[i].fan_hours = on_passes[i] * pass_hours;
+            metrics[i].cooling_degree_hours = cooling[i] * pass_hours;
+        }
+    }
+} // namespace Replay
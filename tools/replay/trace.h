@@ -0,0 +1,247 @@
+#pragma once
+
+// Temperature traces for the host replay tools, read through mmap.
+//
+// Binary trace (.trc), little-endian:
+//   header  "PTRC", u16 version (1), u16 record size (8), i64 start time (unix s, 0 = unknown)
+//   record  u32 seconds since start, i16 external, i16 internal (0.01 C, -32768 = no reading)
+// The readings use the telemetry Sample encoding (include/telemetry.h).
+//
+// CSV trace: one "seconds,external_c,internal_c" line per sample, seconds
+// relative or unix time, an empty or "nan" field is a missing reading. A
+// first line that does not start with a digit is taken as a header.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace Replay
+{
+    constexpr int16_t kNoReading = -32767 - 1;
+
+    struct Record {
+        uint32_t seconds;
+        int16_t external_centi;
+        int16_t internal_centi;
+    };
+    static_assert(sizeof(Record) == 8, "Record is the on-disk layout");
+
+    struct TraceHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t record_size;
+        int64_t start_time;
+    };
+    static_assert(sizeof(TraceHeader) == 16, "TraceHeader is the on-disk layout");
+
+    inline float toCelsius(int16_t centi) {
+        return centi == kNoReading ? NAN : static_cast<float>(centi) * 0.01f;
+    }
+
+    inline int16_t toCenti(double celsius) {
+        if (isnan(celsius) || celsius < -327.0 || celsius > 327.0) {
+            return kNoReading;
+        }
+        return static_cast<int16_t>(lround(celsius * 100.0));
+    }
+
+    /**
+     * A trace file mapped read-only. Binary records are used in place, a CSV
+     * file is parsed once into records. Samples must be in time order.
+     */
+    class Trace {
+    public:
+        Trace() = default;
+        Trace(const Trace&) = delete;
+        Trace& operator=(const Trace&) = delete;
+
+        ~Trace() {
+            if (map_ != nullptr) {
+                munmap(map_, map_size_);
+            }
+        }
+
+        /// Map path; false with error() set on failure
+        bool open(const char* path) {
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return fail(std::string(path) + ": " + strerror(errno));
+            }
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size == 0) {
+                close(fd);
+                return fail(std::string(path) + ": empty or unreadable");
+            }
+            map_size_ = static_cast<size_t>(info.st_size);
+            map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (map_ == MAP_FAILED) {
+                map_ = nullptr;
+                return fail(std::string(path) + ": mmap failed");
+            }
+            madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+            const auto* bytes = static_cast<const char*>(map_);
+            if (map_size_ >= sizeof(TraceHeader) && memcmp(bytes, "PTRC", 4) == 0) {
+                return openBinary(path, bytes);
+            }
+            return parseCsv(path, bytes);
+        }
+
+        const Record* begin() const { return records_; }
+        const Record* end() const { return records_ + count_; }
+        size_t size() const { return count_; }
+        int64_t startTime() const { return start_time_; }
+        const std::string& error() const { return error_; }
+
+        /// Write records as a binary trace
+        static bool writeBinary(const char* path, const Record* records, size_t count, int64_t start_time) {
+            FILE* out = fopen(path, "wb");
+            if (out == nullptr) {
+                return false;
+            }
+            TraceHeader header;
+            memcpy(header.magic, "PTRC", 4);
+            header.version = 1;
+            header.record_size = sizeof(Record);
+            header.start_time = start_time;
+            bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                      fwrite(records, sizeof(Record), count, out) == count;
+            ok = fclose(out) == 0 && ok;
+            return ok;
+        }
+
+    private:
+        bool fail(const std::string& message) {
+            error_ = message;
+            return false;
+        }
+
+        bool openBinary(const char* path, const char* bytes) {
+            TraceHeader header;
+            memcpy(&header, bytes, sizeof(header));
+            if (header.version != 1 || header.record_size != sizeof(Record) ||
+                (map_size_ - sizeof(header)) % sizeof(Record) != 0) {
+                return fail(std::string(path) + ": unsupported trace version or size");
+            }
+            start_time_ = header.start_time;
+            records_ = reinterpret_cast<const Record*>(bytes + sizeof(header));
+            count_ = (map_size_ - sizeof(header)) / sizeof(Record);
+            return checkOrder(path);
+        }
+
+        // strtod() needs a terminated string, fields are copied to a small buffer
+        static const char* field(const char* cursor, const char* end, double& value, bool& present) {
+            char text[32];
+            size_t length = 0;
+            while (cursor < end && *cursor != ',' && *cursor != '\n' && *cursor != '\r') {
+                if (length + 1 < sizeof(text) && *cursor != ' ') {
+                    text[length++] = *cursor;
+                }
+                ++cursor;
+            }
+            text[length] = '\0';
+            char* parsed_end = nullptr;
+            value = strtod(text, &parsed_end);
+            present = length > 0 && parsed_end == text + length && !isnan(value);
+            return cursor;
+        }
+
+        bool parseCsv(const char* path, const char* bytes) {
+            const char* cursor = bytes;
+            const char* end = bytes + map_size_;
+            size_t line = 0;
+            double first_seconds = 0.0;
+            while (cursor < end) {
+                ++line;
+                const char* line_end = static_cast<const char*>(memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+                if (line_end == nullptr) {
+                    line_end = end;
+                }
+                const bool header = line == 1 && !(*cursor >= '0' && *cursor <= '9');
+                if (!header && line_end > cursor && *cursor != '\r') {
+                    double seconds = 0.0, external = 0.0, internal = 0.0;
+                    bool has_time = false, has_external = false, has_internal = false;
+                    const char* next = field(cursor, line_end, seconds, has_time);
+                    if (next < line_end && *next == ',') {
+                        next = field(next + 1, line_end, external, has_external);
+                    }
+                    if (next < line_end && *next == ',') {
+                        next = field(next + 1, line_end, internal, has_internal);
+                    }
+                    if (!has_time) {
+                        return fail(std::string(path) + ":" + std::to_string(line) + ": no time");
+                    }
+                    if (csv_.empty()) {
+                        first_seconds = seconds;
+                        start_time_ = seconds >= 1e9 ? static_cast<int64_t>(seconds) : 0;
+                    }
+                    // Times relative to the first sample, unix times keep the start in the header
+                    Record record;
+                    record.seconds = static_cast<uint32_t>(seconds - (start_time_ != 0 ? first_seconds : 0.0));
+                    record.external_centi = has_external ? toCenti(external) : kNoReading;
+                    record.internal_centi = has_internal ? toCenti(internal) : kNoReading;
+                    csv_.push_back(record);
+                }
+                cursor = line_end + 1;
+            }
+            records_ = csv_.data();
+            count_ = csv_.size();
+            return checkOrder(path);
+        }
+
+        bool checkOrder(const char* path) {
+            for (size_t i = 1; i < count_; ++i) {
+                if (records_[i].seconds < records_[i - 1].seconds) {
+                    return fail(std::string(path) + ": sample " + std::to_string(i) + " goes back in time");
+                }
+            }
+            return true;
+        }
+
+        void* map_ = nullptr;
+        size_t map_size_ = 0;
+        const Record* records_ = nullptr;
+        size_t count_ = 0;
+        int64_t start_time_ = 0;
+        std::vector<Record> csv_;
+        std::string error_;
+    };
+
+    /**
+     * A synthetic season for runs without a recording, one sample a minute
+     * from mid-September: yearly and daily swings of the external temperature
+     * with some noise, and a storage room that follows it slowly, kept a few
+     * degrees warmer by respiration. The same seed gives the same trace.
+     */
+    inline std::vector<Record> syntheticTrace(uint32_t days, uint32_t seed = 1) {
+        std::vector<Record> records;
+        records.reserve(static_cast<size_t>(days) * 1440U);
+        uint32_t state = seed != 0 ? seed : 1;
+        double internal = 12.0;
+        for (uint32_t minute = 0; minute < days * 1440U; ++minute) {
+            state = state * 1664525U + 1013904223U;
+            const double noise = (static_cast<double>(state >> 8) / 16777216.0 - 0.5) * 0.6;
+            const double day = minute / 1440.0;
+            const double external = 4.0 + 10.0 * cos(2.0 * M_PI * day / 365.0) +
+                                    4.0 * sin(2.0 * M_PI * (day - 0.375)) + noise;
+            internal += (external + 3.0 - internal) * 0.0005;
+            Record record;
+            record.seconds = minute * 60U;
+            record.external_centi = toCenti(external);
+            record.internal_centi = toCenti(internal);
+            records.push_back(record);
+        }
+        return records;
+    }
+} // namespace Replay
@@ -0,0 +1,100 @@
+#pragma once
+
+// Fixed-size work-stealing pool for the host replay tools. run() hands every
+// worker a contiguous block of task indices; a worker takes from the back of
+// its own block and, once it is empty, steals from the front of another
+// worker's block. Tasks that cost more than others (long traces, slow
+// settings) are then picked up by whoever is idle.
+
+#include <stddef.h>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Replay
+{
+    class WorkStealingPool {
+    public:
+        /// threads = 0 uses every hardware thread
+        explicit WorkStealingPool(unsigned threads = 0)
+            : threads_(threads != 0 ? threads : defaultThreads()) {}
+
+        unsigned threads() const { return threads_; }
+
+        /**
+         * Call task(index, worker) for every index in [0, count) and return
+         * once all calls have finished. worker is in [0, threads()), so
+         * callers can keep per-worker state without locking.
+         */
+        template <typename Task>
+        void run(size_t count, Task&& task) {
+            std::vector<std::unique_ptr<Queue>> queues;
+            for (unsigned worker = 0; worker < threads_; ++worker) {
+                queues.emplace_back(new Queue());
+                const size_t first = count * worker / threads_;
+                const size_t last = count * (worker + 1) / threads_;
+                for (size_t index = first; index < last; ++index) {
+                    queues.back()->tasks.push_back(index);
+                }
+            }
+
+            std::vector<std::thread> workers;
+            for (unsigned worker = 1; worker < threads_; ++worker) {
+                workers.emplace_back([&, worker] { work(queues, worker, task); });
+            }
+            work(queues, 0, task);
+            for (auto& thread : workers) {
+                thread.join();
+            }
+        }
+
+    private:
+        struct Queue {
+            std::mutex lock;
+            std::deque<size_t> tasks;
+        };
+
+        static unsigned defaultThreads() {
+            const unsigned hardware = std::thread::hardware_concurrency();
+            return hardware != 0 ? hardware : 1;
+        }
+
+        template <typename Task>
+        void work(std::vector<std::unique_ptr<Queue>>& queues, unsigned worker, Task& task) {
+            size_t index = 0;
+            while (popOwn(*queues[worker], index) || steal(queues, worker, index)) {
+                task(index, worker);
+            }
+        }
+
+        static bool popOwn(Queue& queue, size_t& index) {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.tasks.empty()) {
+                return false;
+            }
+            index = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        // No task is ever added after run() starts, so one empty pass over
+        // the other queues means the work is done
+        bool steal(std::vector<std::unique_ptr<Queue>>& queues, unsigned worker, size_t& index) {
+            for (unsigned offset = 1; offset < threads_; ++offset) {
+                Queue& victim = *queues[(worker + offset) % threads_];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                if (!victim.tasks.empty()) {
+                    index = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        unsigned threads_;
+    };
+} // namespace Replay
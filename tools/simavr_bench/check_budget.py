@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Check a potato_simavr_bench report against cycle budgets.
+
+Two checks, at least one of them:
+  baseline  the report of the previous firmware: any mean or max that grew
+            by more than --tolerance percent fails, so a change that costs
+            cycles is seen while it is small
+  budgets   absolute limits from a JSON file (setup_cycles, then loop, stages
+            and commits with a "max" or "mean" per entry). No budgets are
+            kept in the tree until they are set from measured simavr reports.
+
+    check_budget.py cycles.json --baseline main.json --tolerance 2
+    check_budget.py cycles.json --budgets budgets.json
+"""
+
+import argparse
+import json
+import sys
+
+GROUPS = ("loop", "stages", "commits")
+
+
+def metrics(report):
+    """Flatten a report into {"stages.fan_control.max": cycles, ...}."""
+    values = {"setup_cycles": report["setup_cycles"]}
+    for group in GROUPS:
+        for name, stats in report.get(group, {}).items():
+            if stats.get("count", 0) == 0:
+                continue    # Not reached in this run, e.g. no settings commit
+            for key in ("mean", "max"):
+                values[f"{group}.{name}.{key}"] = stats[key]
+    return values
+
+
+def budget_limits(budgets):
+    limits = {}
+    if "setup_cycles" in budgets:
+        limits["setup_cycles"] = budgets["setup_cycles"]
+    for group in GROUPS:
+        for name, keys in budgets.get(group, {}).items():
+            for key, limit in keys.items():
+                limits[f"{group}.{name}.{key}"] = limit
+    return limits
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("report")
+    parser.add_argument("--budgets", help="budget file")
+    parser.add_argument("--baseline", help="report of the reference firmware")
+    parser.add_argument("--tolerance", type=float, default=1.0, help="allowed growth over the baseline, percent")
+    args = parser.parse_args()
+    if not args.budgets and not args.baseline:
+        parser.error("nothing to check, give --baseline and/or --budgets")
+
+    with open(args.report) as source:
+        report = json.load(source)
+    if not report.get("complete", False):
+        print(f"{args.report}: run did not complete {report.get('loops', 0)} loops", file=sys.stderr)
+        return 1
+    current = metrics(report)
+    failures = 0
+
+    if args.budgets:
+        with open(args.budgets) as source:
+            limits = budget_limits(json.load(source))
+        print(f"{'metric':32} {'cycles':>12} {'budget':>12}")
+        for name, limit in limits.items():
+            if name not in current:
+                print(f"{name:32} {'-':>12} {limit:>12}  not reached")
+                continue
+            over = current[name] > limit
+            failures += over
+            print(f"{name:32} {current[name]:>12} {limit:>12}{'  OVER' if over else ''}")
+
+    if args.baseline:
+        with open(args.baseline) as source:
+            reference = metrics(json.load(source))
+        print(f"\n{'metric':32} {'baseline':>12} {'cycles':>12} {'change':>8}")
+        for name in sorted(set(current) & set(reference)):
+            before, after = reference[name], current[name]
+            change = (after - before) * 100.0 / before if before else 0.0
+            grown = change > args.tolerance
+            failures += grown
+            print(f"{name:32} {before:>12} {after:>12} {change:>+7.1f}%{'  GROWN' if grown else ''}")
+
+    print(f"\n{failures} check(s) failed" if failures else "\nall checks passed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,703 @@
+// Cycle-accurate benchmark of the Uno firmware under simavr.
+//
+// Loads the env:uno_simavr ELF into a simulated ATmega328P at 16 MHz with
+// stand-ins for the board: two DS18B20 responders on the OneWire pins, the
+// analog keypad on ADC0, a sink for the HD44780 bus and the UART. The
+// firmware writes its loop stage to GPIOR0 and the EEPROM commit in progress
+// to GPIOR1 (include/loop_stages.h); every write is timestamped with the
+// simulated cycle counter, so the report holds exact cycles per stage, per
+// loop and per commit.
+//
+// Build (simavr and libelf development files), from the repository root:
+//   g++ -std=c++17 -O2 -Iinclude $(pkg-config --cflags simavr) -o potato_simavr_bench
+//       tools/simavr_bench/potato_simavr_bench.cpp $(pkg-config --libs simavr) -lelf
+// Run:
+//   pio run -e uno_simavr
+//   ./potato_simavr_bench .pio/build/uno_simavr/firmware.elf --loops 20 --report cycles.json
+//       --keys 3000:select,3600:select,4200:up,4800:select
+//   tools/simavr_bench/check_budget.py cycles.json --baseline main.json
+// where main.json is the report of the firmware before the change.
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/avr_adc.h>
+#include <simavr/avr_eeprom.h>
+#include <simavr/avr_ioport.h>
+#include <simavr/avr_uart.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "loop_stages.h"
+
+namespace {
+    constexpr uint32_t kCpuHz = 16000000UL;
+    constexpr avr_io_addr_t kGpior0 = 0x3E;     // Data space addresses, ATmega328P
+    constexpr avr_io_addr_t kGpior1 = 0x4A;
+    constexpr uint8_t kExternalSensorBit = 2;   // PD2, EXTERNAL_DS18B20_PIN
+    constexpr uint8_t kInternalSensorBit = 3;   // PD3, INTERNAL_DS18B20_PIN
+    constexpr uint8_t kLcdEnableBit = 1;        // PB1, LCD_EN_PIN
+    constexpr uint32_t kVccMillivolts = 5000;
+
+    const char* const kStageNames[] = {
+        "none", "setup", "links", "sensors", "fan_control", "telemetry",
+        "records", "ui_input", "ui_render", "delay",
+    };
+    static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) == LoopStage::STAGE_COUNT,
+                  "Stage names out of date with loop_stages.h");
+
+    const char* const kCommitNames[] = {"none", "settings", "counters", "events"};
+    static_assert(sizeof(kCommitNames) / sizeof(kCommitNames[0]) == LoopStage::COMMIT_COUNT,
+                  "Commit names out of date with loop_stages.h");
+
+    // Keypad shield ADC levels of the 10-bit thresholds in gpio_hal_interface.h
+    struct Key {
+        const char* name;
+        uint32_t millivolts;
+    };
+    const Key kKeys[] = {
+        {"next", 0}, {"up", 489}, {"down", 1222}, {"prev", 2077}, {"select", 3055},
+    };
+
+    uint64_t cyclesToMicros(avr_cycle_count_t cycles) {
+        return cycles / (kCpuHz / 1000000UL);
+    }
+
+    struct Stats {
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t min = UINT64_MAX;
+        uint64_t max = 0;
+
+        void add(uint64_t cycles) {
+            ++count;
+            total += cycles;
+            min = cycles < min ? cycles : min;
+            max = cycles > max ? cycles : max;
+        }
+
+        void print(FILE* out, const char* name, bool last) const {
+            fprintf(out, "    \"%s\": {\"count\": %llu, \"total\": %llu, \"min\": %llu, \"mean\": %llu, \"max\": %llu}%s\n",
+                    name, static_cast<unsigned long long>(count), static_cast<unsigned long long>(total),
+                    static_cast<unsigned long long>(count ? min : 0),
+                    static_cast<unsigned long long>(count ? total / count : 0),
+                    static_cast<unsigned long long>(max), last ? "" : ",");
+        }
+    };
+
+    /**
+     * DS18B20 on its own OneWire bus, externally powered. Follows the master
+     * through the pin's DDR and PORT bits: a low pulse of 480 us is a reset,
+     * shorter ones are write slots (1 below 30 us) or the start of a read slot,
+     * for which the sensor holds the line low 30 us to send a 0.
+     */
+    class Ds18b20 {
+    public:
+        Ds18b20(avr_t* avr, char port, uint8_t bit, uint8_t serial, float celsius, uint8_t resolution)
+            : avr_(avr), bit_(bit), celsius_(celsius), resolution_(resolution) {
+            rom_[0] = 0x28;     // DS18B20 family code
+            rom_[1] = serial;
+            rom_[7] = crc8(rom_, 7);
+            pin_irq_ = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), bit);
+            avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), IOPORT_IRQ_DIRECTION_ALL),
+                                    onDirection, this);
+            avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(port), IOPORT_IRQ_REG_PORT),
+                                    onPort, this);
+            avr_raise_irq(pin_irq_, 1);     // 4.7k pull-up
+        }
+
+        uint32_t resets() const { return resets_; }
+        uint32_t conversions() const { return conversions_; }
+
+    private:
+        enum State : uint8_t {
+            IDLE,               // Ignores slots until the next reset
+            ROM_COMMAND,
+            MATCH_ROM,
+            READ_ROM,
+            SEARCH_ROM,
+            FUNCTION_COMMAND,
+            SEND,               // Bytes in tx_
+            WRITE_SCRATCHPAD,
+            CONVERTING,         // Read slots return 0 until the conversion ends
+        };
+
+        static uint8_t crc8(const uint8_t* data, uint8_t size) {
+            uint8_t crc = 0;
+            for (uint8_t i = 0; i < size; ++i) {
+                uint8_t byte = data[i];
+                for (uint8_t bit = 0; bit < 8; ++bit) {
+                    const uint8_t mix = (crc ^ byte) & 0x01;
+                    crc >>= 1;
+                    if (mix) {
+                        crc ^= 0x8C;
+                    }
+                    byte >>= 1;
+                }
+            }
+            return crc;
+        }
+
+        static void onDirection(avr_irq_t*, uint32_t value, void* param) {
+            auto* self = static_cast<Ds18b20*>(param);
+            self->ddr_ = (value >> self->bit_) & 1U;
+            self->updateMaster();
+        }
+
+        static void onPort(avr_irq_t*, uint32_t value, void* param) {
+            auto* self = static_cast<Ds18b20*>(param);
+            self->port_ = (value >> self->bit_) & 1U;
+            self->updateMaster();
+        }
+
+        static avr_cycle_count_t onPresenceStart(avr_t*, avr_cycle_count_t, void* param) {
+            static_cast<Ds18b20*>(param)->pull(true);
+            return 0;
+        }
+
+        static avr_cycle_count_t onRelease(avr_t*, avr_cycle_count_t, void* param) {
+            static_cast<Ds18b20*>(param)->pull(false);
+            return 0;
+        }
+
+        void pull(bool low) {
+            avr_raise_irq(pin_irq_, low ? 0 : 1);
+        }
+
+        void updateMaster() {
+            const bool low = ddr_ && !port_;
+            if (low == master_low_) {
+                return;
+            }
+            master_low_ = low;
+            if (low) {
+                // The slot direction is fixed by the state at its falling edge
+                fall_cycle_ = avr_->cycle;
+                read_slot_ = sending();
+                if (read_slot_ && !nextTxBit()) {
+                    // Hold the line for a 0 until the master has sampled it
+                    pull(true);
+                    avr_cycle_timer_register_usec(avr_, 30, onRelease, this);
+                }
+                return;
+            }
+            const uint64_t low_us = cyclesToMicros(avr_->cycle - fall_cycle_);
+            if (low_us >= 400) {
+                reset();
+            } else if (!read_slot_) {
+                receiveBit(low_us < 30);
+            }
+        }
+
+        void reset() {
+            ++resets_;
+            state_ = ROM_COMMAND;
+            expect(8);
+            avr_cycle_timer_register_usec(avr_, 20, onPresenceStart, this);
+            avr_cycle_timer_register_usec(avr_, 140, onRelease, this);
+        }
+
+        bool sending() const {
+            return state_ == READ_ROM || state_ == SEND || state_ == CONVERTING ||
+                   (state_ == SEARCH_ROM && search_step_ < 2);
+        }
+
+        void expect(uint8_t bits) {
+            rx_bits_ = 0;
+            rx_expected_ = bits;
+            memset(rx_, 0, sizeof(rx_));
+        }
+
+        void send(const uint8_t* data, uint8_t size, State state) {
+            memcpy(tx_, data, size);
+            tx_bits_ = static_cast<uint16_t>(size * 8U);
+            tx_index_ = 0;
+            state_ = state;
+        }
+
+        bool romBit(uint8_t index) const {
+            return (rom_[index / 8] >> (index % 8)) & 1U;
+        }
+
+        // Bit for the read slot that starts now; 1 leaves the line released
+        bool nextTxBit() {
+            switch (state_) {
+                case CONVERTING:
+                    return avr_->cycle >= conversion_done_;
+                case SEARCH_ROM: {
+                    const bool bit = romBit(search_index_);
+                    return search_step_++ == 0 ? bit : !bit;
+                }
+                default:
+                    break;
+            }
+            if (tx_index_ >= tx_bits_) {
+                state_ = IDLE;
+                return true;
+            }
+            const bool bit = (tx_[tx_index_ / 8] >> (tx_index_ % 8)) & 1U;
+            ++tx_index_;
+            return bit;
+        }
+
+        void receiveBit(bool bit) {
+            if (state_ == SEARCH_ROM) {
+                // Master's direction bit: stay in the search only on our path
+                search_step_ = 0;
+                if (bit != romBit(search_index_) || ++search_index_ == 64) {
+                    state_ = IDLE;
+                }
+                return;
+            }
+            if (state_ == IDLE || rx_bits_ >= rx_expected_) {
+                return;
+            }
+            if (bit) {
+                rx_[rx_bits_ / 8] |= static_cast<uint8_t>(1U << (rx_bits_ % 8));
+            }
+            if (++rx_bits_ == rx_expected_) {
+                received();
+            }
+        }
+
+        void received() {
+            switch (state_) {
+                case ROM_COMMAND:
+                    romCommand(rx_[0]);
+                    break;
+                case MATCH_ROM:
+                    state_ = memcmp(rx_, rom_, sizeof(rom_)) == 0 ? FUNCTION_COMMAND : IDLE;
+                    expect(8);
+                    break;
+                case FUNCTION_COMMAND:
+                    functionCommand(rx_[0]);
+                    break;
+                case WRITE_SCRATCHPAD:
+                    alarm_high_ = rx_[0];
+                    alarm_low_ = rx_[1];
+                    resolution_ = static_cast<uint8_t>(9 + ((rx_[2] >> 5) & 0x03));
+                    state_ = IDLE;
+                    break;
+                default:
+                    state_ = IDLE;
+                    break;
+            }
+        }
+
+        void romCommand(uint8_t command) {
+            switch (command) {
+                case 0x33:  // Read ROM
+                    send(rom_, sizeof(rom_), READ_ROM);
+                    break;
+                case 0x55:  // Match ROM
+                    state_ = MATCH_ROM;
+                    expect(64);
+                    break;
+                case 0xCC:  // Skip ROM
+                    state_ = FUNCTION_COMMAND;
+                    expect(8);
+                    break;
+                case 0xF0:  // Search ROM
+                    state_ = SEARCH_ROM;
+                    search_index_ = 0;
+                    search_step_ = 0;
+                    break;
+                default:
+                    state_ = IDLE;
+                    break;
+            }
+        }
+
+        void functionCommand(uint8_t command) {
+            switch (command) {
+                case 0x44: {  // Convert T, 93.75 ms at 9 bits doubling up to 750 ms
+                    ++conversions_;
+                    const uint32_t micros = 93750UL << (resolution_ - 9);
+                    conversion_done_ = avr_->cycle + static_cast<avr_cycle_count_t>(micros) * (kCpuHz / 1000000UL);
+                    state_ = CONVERTING;
+                    break;
+                }
+                case 0xBE: {  // Read scratchpad
+                    const int16_t raw = static_cast<int16_t>(lroundf(celsius_ * 16.0f)) &
+                                        static_cast<int16_t>(0xFFFF << (12 - resolution_));
+                    uint8_t scratchpad[9] = {
+                        static_cast<uint8_t>(raw & 0xFF), static_cast<uint8_t>((raw >> 8) & 0xFF),
+                        alarm_high_, alarm_low_, static_cast<uint8_t>(((resolution_ - 9) << 5) | 0x1F),
+                        0xFF, 0x0C, 0x10, 0};
+                    scratchpad[8] = crc8(scratchpad, 8);
+                    send(scratchpad, sizeof(scratchpad), SEND);
+                    break;
+                }
+                case 0x4E:  // Write scratchpad: TH, TL, configuration
+                    state_ = WRITE_SCRATCHPAD;
+                    expect(24);
+                    break;
+                case 0xB4: {  // Read power supply, 1 = external supply
+                    const uint8_t powered = 0xFF;
+                    send(&powered, 1, SEND);
+                    break;
+                }
+                default:      // Copy scratchpad, recall E2: done at once
+                    state_ = IDLE;
+                    break;
+            }
+        }
+
+        avr_t* avr_;
+        avr_irq_t* pin_irq_ = nullptr;
+        uint8_t bit_;
+        float celsius_;
+        uint8_t resolution_;
+        uint8_t alarm_high_ = 0x4B;
+        uint8_t alarm_low_ = 0x46;
+        uint8_t rom_[8] = {};
+
+        bool ddr_ = false;
+        bool port_ = false;
+        bool master_low_ = false;
+        bool read_slot_ = false;
+        avr_cycle_count_t fall_cycle_ = 0;
+        avr_cycle_count_t conversion_done_ = 0;
+
+        State state_ = IDLE;
+        uint8_t rx_[8] = {};
+        uint8_t rx_bits_ = 0;
+        uint8_t rx_expected_ = 0;
+        uint8_t tx_[9] = {};
+        uint16_t tx_bits_ = 0;
+        uint16_t tx_index_ = 0;
+        uint8_t search_index_ = 0;
+        uint8_t search_step_ = 0;
+
+        uint32_t resets_ = 0;
+        uint32_t conversions_ = 0;
+    };
+
+    struct KeyPress {
+        uint32_t at_ms;
+        uint32_t hold_ms;
+        uint32_t millivolts;
+    };
+
+    /// Markers, keypad script and bus sinks of one run
+    struct Bench {
+        avr_t* avr = nullptr;
+        uint32_t loops_wanted = 10;
+        bool done = false;
+
+        uint8_t stage = LoopStage::STAGE_NONE;
+        avr_cycle_count_t stage_start = 0;
+        avr_cycle_count_t loop_start = 0;
+        avr_cycle_count_t loop_delay = 0;     // Cycles of STAGE_DELAY in the current loop
+        avr_cycle_count_t setup_end = 0;
+        uint32_t loops = 0;
+        Stats stages[LoopStage::STAGE_COUNT];
+        Stats loop_total;
+        Stats loop_work;                      // Loop without the pacing delay()
+
+        uint8_t commit = LoopStage::COMMIT_NONE;
+        avr_cycle_count_t commit_start = 0;
+        Stats commits[LoopStage::COMMIT_COUNT];
+
+        avr_irq_t* adc = nullptr;
+        std::vector<KeyPress> keys;
+        size_t next_key = 0;
+
+        uint64_t uart_bytes = 0;
+        FILE* uart_log = nullptr;
+        uint64_t lcd_strobes = 0;
+        bool lcd_enable = false;
+
+        void onStage(uint8_t next) {
+            const avr_cycle_count_t now = avr->cycle;
+            if (stage < LoopStage::STAGE_COUNT) {
+                stages[stage].add(now - stage_start);
+                if (stage == LoopStage::STAGE_DELAY) {
+                    loop_delay += now - stage_start;
+                }
+            }
+            if (next == LoopStage::STAGE_LINKS) {
+                if (loops == 0) {
+                    setup_end = now;
+                } else {
+                    loop_total.add(now - loop_start);
+                    loop_work.add(now - loop_start - loop_delay);
+                }
+                if (loops++ == loops_wanted) {
+                    done = true;
+                }
+                loop_start = now;
+                loop_delay = 0;
+            }
+            stage = next;
+            stage_start = now;
+        }
+
+        void onCommit(uint8_t next) {
+            if (commit != LoopStage::COMMIT_NONE && commit < LoopStage::COMMIT_COUNT) {
+                commits[commit].add(avr->cycle - commit_start);
+            }
+            commit = next;
+            commit_start = avr->cycle;
+        }
+
+        void scheduleKey() {
+            if (next_key < keys.size()) {
+                const uint64_t now_ms = cyclesToMicros(avr->cycle) / 1000U;
+                const uint32_t at_ms = keys[next_key].at_ms;
+                avr_cycle_timer_register_usec(avr, static_cast<uint32_t>((at_ms > now_ms ? at_ms - now_ms : 0) * 1000U),
+                                              onKeyDown, this);
+            }
+        }
+
+        static avr_cycle_count_t onKeyDown(avr_t* avr, avr_cycle_count_t, void* param) {
+            auto* self = static_cast<Bench*>(param);
+            const KeyPress& key = self->keys[self->next_key];
+            avr_raise_irq(self->adc, key.millivolts);
+            avr_cycle_timer_register_usec(avr, key.hold_ms * 1000U, onKeyUp, self);
+            return 0;
+        }
+
+        static avr_cycle_count_t onKeyUp(avr_t*, avr_cycle_count_t, void* param) {
+            auto* self = static_cast<Bench*>(param);
+            avr_raise_irq(self->adc, kVccMillivolts);
+            ++self->next_key;
+            self->scheduleKey();
+            return 0;
+        }
+    };
+
+    void onGpior0(avr_t* avr, avr_io_addr_t addr, uint8_t value, void* param) {
+        avr->data[addr] = value;
+        static_cast<Bench*>(param)->onStage(value);
+    }
+
+    void onGpior1(avr_t* avr, avr_io_addr_t addr, uint8_t value, void* param) {
+        avr->data[addr] = value;
+        static_cast<Bench*>(param)->onCommit(value);
+    }
+
+    void onUartByte(avr_irq_t*, uint32_t value, void* param) {
+        auto* bench = static_cast<Bench*>(param);
+        ++bench->uart_bytes;
+        if (bench->uart_log != nullptr) {
+            fputc(static_cast<int>(value & 0xFF), bench->uart_log);
+        }
+    }
+
+    void onLcdEnable(avr_irq_t*, uint32_t value, void* param) {
+        auto* bench = static_cast<Bench*>(param);
+        // The controller latches a nibble on the falling edge of E
+        if (bench->lcd_enable && value == 0) {
+            ++bench->lcd_strobes;
+        }
+        bench->lcd_enable = value != 0;
+    }
+
+    bool parseKeys(const char* text, std::vector<KeyPress>& keys) {
+        // at_ms:key[:hold_ms],...
+        while (text != nullptr && *text != '\0') {
+            char name[16] = {};
+            unsigned at_ms = 0;
+            unsigned hold_ms = 150;
+            int used = 0;
+            if (sscanf(text, "%u:%15[a-z]%n", &at_ms, name, &used) < 2) {
+                return false;
+            }
+            text += used;
+            if (*text == ':') {
+                if (sscanf(text, ":%u%n", &hold_ms, &used) < 1) {
+                    return false;
+                }
+                text += used;
+            }
+            const Key* key = nullptr;
+            for (const Key& candidate : kKeys) {
+                if (strcmp(candidate.name, name) == 0) {
+                    key = &candidate;
+                }
+            }
+            if (key == nullptr || (!keys.empty() && at_ms < keys.back().at_ms + keys.back().hold_ms)) {
+                return false;
+            }
+            keys.push_back({at_ms, hold_ms, key->millivolts});
+            if (*text == ',') {
+                ++text;
+            }
+        }
+        return true;
+    }
+
+    void usage(const char* program) {
+        fprintf(stderr,
+                "usage: %s firmware.elf [--loops N] [--max-seconds S] [--ext C] [--int C]\n"
+                "       [--sensor-bits 9..12] [--keys at_ms:key[:hold_ms],...] [--eeprom file]\n"
+                "       [--report file.json] [--uart-log file]\n"
+                "keys: next up down prev select\n", program);
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    Bench bench;
+    const char* firmware_path = argv[1];
+    const char* report_path = nullptr;
+    const char* eeprom_path = nullptr;
+    const char* uart_path = nullptr;
+    float external_celsius = 8.0f;
+    float internal_celsius = 12.0f;
+    unsigned sensor_bits = 12;
+    double max_seconds = 120.0;
+    for (int i = 2; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (!strcmp(argv[i], "--loops") && has_value) {
+            bench.loops_wanted = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--max-seconds") && has_value) {
+            max_seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--ext") && has_value) {
+            external_celsius = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--int") && has_value) {
+            internal_celsius = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--sensor-bits") && has_value) {
+            sensor_bits = static_cast<unsigned>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--keys") && has_value) {
+            if (!parseKeys(argv[++i], bench.keys)) {
+                fprintf(stderr, "bad --keys script: %s\n", argv[i]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--eeprom") && has_value) {
+            eeprom_path = argv[++i];
+        } else if (!strcmp(argv[i], "--report") && has_value) {
+            report_path = argv[++i];
+        } else if (!strcmp(argv[i], "--uart-log") && has_value) {
+            uart_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (sensor_bits < 9 || sensor_bits > 12) {
+        fprintf(stderr, "--sensor-bits must be 9..12\n");
+        return 2;
+    }
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(firmware_path, &firmware) != 0) {
+        fprintf(stderr, "%s: cannot read firmware\n", firmware_path);
+        return 1;
+    }
+    avr_t* avr = avr_make_mcu_by_name("atmega328p");
+    if (avr == nullptr) {
+        fprintf(stderr, "simavr has no atmega328p core\n");
+        return 1;
+    }
+    avr_init(avr);
+    avr_load_firmware(avr, &firmware);
+    avr->frequency = kCpuHz;
+    avr->vcc = avr->avcc = avr->aref = kVccMillivolts;
+    bench.avr = avr;
+
+    if (eeprom_path != nullptr) {
+        // Start from a saved EEPROM image, e.g. to skip the first-boot defaults
+        static uint8_t image[1024];
+        FILE* file = fopen(eeprom_path, "rb");
+        const size_t size = file != nullptr ? fread(image, 1, sizeof(image), file) : 0;
+        if (file != nullptr) {
+            fclose(file);
+        }
+        if (size == 0) {
+            fprintf(stderr, "%s: cannot read EEPROM image\n", eeprom_path);
+            return 1;
+        }
+        avr_eeprom_desc_t eeprom;
+        eeprom.ee = image;
+        eeprom.offset = 0;
+        eeprom.size = static_cast<uint16_t>(size);
+        avr_ioctl(avr, AVR_IOCTL_EEPROM_SET, &eeprom);
+    }
+
+    // Markers
+    avr_register_io_write(avr, kGpior0, onGpior0, &bench);
+    avr_register_io_write(avr, kGpior1, onGpior1, &bench);
+
+    // Board
+    Ds18b20 external(avr, 'D', kExternalSensorBit, 1, external_celsius, static_cast<uint8_t>(sensor_bits));
+    Ds18b20 internal(avr, 'D', kInternalSensorBit, 2, internal_celsius, static_cast<uint8_t>(sensor_bits));
+    bench.adc = avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, ADC_IRQ_ADC0);
+    avr_raise_irq(bench.adc, kVccMillivolts);   // No key pressed
+    bench.scheduleKey();
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('B'), kLcdEnableBit), onLcdEnable, &bench);
+
+    // UART output is counted (and optionally saved) instead of printed
+    uint32_t uart_flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &uart_flags);
+    uart_flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &uart_flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), onUartByte, &bench);
+    if (uart_path != nullptr) {
+        bench.uart_log = fopen(uart_path, "wb");
+    }
+
+    const avr_cycle_count_t max_cycles = static_cast<avr_cycle_count_t>(max_seconds * kCpuHz);
+    int state = cpu_Running;
+    while (!bench.done && avr->cycle < max_cycles) {
+        state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) {
+            break;
+        }
+    }
+    bench.onCommit(LoopStage::COMMIT_NONE);     // Close a commit cut off by the end of the run
+    if (bench.uart_log != nullptr) {
+        fclose(bench.uart_log);
+    }
+
+    const bool complete = bench.done;
+    FILE* out = report_path != nullptr ? fopen(report_path, "w") : stdout;
+    if (out == nullptr) {
+        fprintf(stderr, "%s: cannot write report\n", report_path);
+        return 1;
+    }
+    fprintf(out, "{\n  \"firmware\": \"%s\",\n  \"f_cpu\": %lu,\n  \"complete\": %s,\n", firmware_path,
+            static_cast<unsigned long>(kCpuHz), complete ? "true" : "false");
+    fprintf(out, "  \"loops\": %lu,\n  \"cycles\": %llu,\n  \"setup_cycles\": %llu,\n",
+            static_cast<unsigned long>(bench.loop_total.count), static_cast<unsigned long long>(avr->cycle),
+            static_cast<unsigned long long>(bench.setup_end));
+    fprintf(out, "  \"loop\": {\n");
+    bench.loop_total.print(out, "total", false);
+    bench.loop_work.print(out, "work", true);
+    fprintf(out, "  },\n  \"stages\": {\n");
+    for (uint8_t i = LoopStage::STAGE_LINKS; i < LoopStage::STAGE_COUNT; ++i) {
+        bench.stages[i].print(out, kStageNames[i], i + 1 == LoopStage::STAGE_COUNT);
+    }
+    fprintf(out, "  },\n  \"commits\": {\n");
+    for (uint8_t i = LoopStage::COMMIT_NONE + 1; i < LoopStage::COMMIT_COUNT; ++i) {
+        bench.commits[i].print(out, kCommitNames[i], i + 1 == LoopStage::COMMIT_COUNT);
+    }
+    fprintf(out, "  },\n  \"io\": {\"uart_bytes\": %llu, \"lcd_nibbles\": %llu, \"sensor_resets\": %lu, "
+                 "\"conversions\": %lu, \"keys_pressed\": %lu}\n}\n",
+            static_cast<unsigned long long>(bench.uart_bytes), static_cast<unsigned long long>(bench.lcd_strobes),
+            static_cast<unsigned long>(external.resets() + internal.resets()),
+            static_cast<unsigned long>(external.conversions() + internal.conversions()),
+            static_cast<unsigned long>(bench.next_key));
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (!complete) {
+        fprintf(stderr, "stopped after %llu cycles with %lu of %lu loops (cpu state %d)\n",
+                static_cast<unsigned long long>(avr->cycle), static_cast<unsigned long>(bench.loop_total.count),
+                static_cast<unsigned long>(bench.loops_wanted), state);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Bulk configuration images for PotatoFanController units.
+
+An image holds every persisted setting (include/config_image.h):
+    magic "PC", version u8, count u8,
+    count x (field u8, decimals u8, value i16), CRC-32 LE
+and is moved with the READ_CONFIG / WRITE_CONFIG telemetry messages. A
+unit validates the whole image and persists it in one EEPROM commit, then
+answers with its settings read back, which this tool compares with the
+image it sent.
+
+Command line:
+    potato_provision.py make -o room.img min_ext=4.5 max_ext=20 temp_diff=1 switch_time=300
+    potato_provision.py export /dev/ttyACM0 -o room.img
+    potato_provision.py show room.img
+    potato_provision.py push room.img /dev/ttyACM0 /dev/ttyACM1 /dev/ttyUSB0
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from potato_telemetry import (  # noqa: E402
+    ERRORS, Config, FrameDecoder, Nack, open_port, read_config_request, write_config_request)
+
+MAGIC = b"PC"
+VERSION = 1
+MAX_ENTRIES = 6
+
+# PersistenceField -> (shell key, decimals), mirrors src/settings_registry.cpp
+SETTINGS = {
+    0: ("min_ext", 1),
+    1: ("max_ext", 1),
+    2: ("temp_diff", 1),
+    3: ("switch_time", 0),
+    4: ("modbus_addr", 0),
+}
+ADDRESS_FIELD = 4   # Unique per unit on a bus, left out of exported images
+KEYS = {key: (field, decimals) for field, (key, decimals) in SETTINGS.items()}
+
+
+def build_image(entries) -> bytes:
+    """entries: iterable of (field, decimals, raw value)."""
+    entries = list(entries)
+    if len(entries) > MAX_ENTRIES:
+        raise ValueError(f"at most {MAX_ENTRIES} settings per image")
+    body = MAGIC + bytes([VERSION, len(entries)])
+    for field, decimals, raw in entries:
+        body += struct.pack("<BBh", field, decimals, raw)
+    return body + struct.pack("<I", zlib.crc32(body))
+
+
+def parse_image(image: bytes):
+    """Return [(field, decimals, raw)], raise ValueError on a malformed image."""
+    if len(image) < 8 or len(image) != 8 + 4 * image[3]:
+        raise ValueError("bad image size")
+    if zlib.crc32(image[:-4]) != struct.unpack("<I", image[-4:])[0]:
+        raise ValueError("bad image CRC")
+    if image[:2] != MAGIC or image[2] != VERSION:
+        raise ValueError("bad image header or version")
+    return [struct.unpack_from("<BBh", image, 4 + 4 * i) for i in range(image[3])]
+
+
+def describe(image: bytes) -> str:
+    lines = []
+    for field, decimals, raw in parse_image(image):
+        key = SETTINGS.get(field, (f"field_{field}", decimals))[0]
+        lines.append(f"{key} = {raw / 10 ** decimals:g}")
+    return "\n".join(lines)
+
+
+def exchange(path: str, request: bytes, baud: int, timeout: float):
+    """Send one request and return the first Config or Nack answer (None on timeout)."""
+    fd = open_port(path, baud)
+    try:
+        os.write(fd, request)
+        decoder = FrameDecoder()
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            data = os.read(fd, 256)
+            for message in decoder.feed(data):
+                if isinstance(message, (Config, Nack)):
+                    return message
+        return None
+    finally:
+        os.close(fd)
+
+
+def push(path: str, image: bytes, baud: int, timeout: float, retries: int):
+    """Write image to one unit; returns (ok, message, seconds)."""
+    start = time.monotonic()
+    reason = "no answer"
+    for attempt in range(retries):
+        answer = exchange(path, write_config_request(image, attempt), baud, timeout)
+        if isinstance(answer, Nack):
+            # The unit checked the image itself, retrying cannot help
+            return False, f"rejected: {ERRORS.get(answer.error, answer.error)}", time.monotonic() - start
+        if isinstance(answer, Config):
+            # The read back has every setting, the image may hold only some
+            if set(parse_image(image)) <= set(parse_image(answer.image)):
+                return True, "ok", time.monotonic() - start
+            reason = "read back differs"
+    return False, reason, time.monotonic() - start
+
+
+def parse_assignment(text: str):
+    key, _, value = text.partition("=")
+    if key not in KEYS or not value:
+        raise argparse.ArgumentTypeError(f"expected one of {', '.join(KEYS)} as key=value, got {text!r}")
+    field, decimals = KEYS[key]
+    return field, decimals, round(float(value) * 10 ** decimals)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=2.0, help="seconds to wait for each answer")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    make = commands.add_parser("make", help="build an image from key=value settings")
+    make.add_argument("settings", nargs="+", type=parse_assignment, metavar="KEY=VALUE")
+    make.add_argument("-o", "--output", required=True)
+
+    export = commands.add_parser("export", help="read the image of a configured unit")
+    export.add_argument("port")
+    export.add_argument("-o", "--output", required=True)
+    export.add_argument("--keep-address", action="store_true", help="keep the unit's Modbus address in the image")
+
+    show = commands.add_parser("show", help="print the settings in an image")
+    show.add_argument("image")
+
+    push_cmd = commands.add_parser("push", help="write an image to one or more units in parallel")
+    push_cmd.add_argument("image")
+    push_cmd.add_argument("ports", nargs="+")
+    push_cmd.add_argument("--retries", type=int, default=3)
+
+    args = parser.parse_args()
+
+    if args.command == "make":
+        image = build_image(args.settings)
+        with open(args.output, "wb") as out:
+            out.write(image)
+        print(describe(image))
+        return 0
+
+    if args.command == "export":
+        answer = exchange(args.port, read_config_request(), args.baud, args.timeout)
+        if not isinstance(answer, Config):
+            print(f"{args.port}: no configuration received", file=sys.stderr)
+            return 1
+        image = answer.image
+        if not args.keep_address:
+            image = build_image(entry for entry in parse_image(image) if entry[0] != ADDRESS_FIELD)
+        with open(args.output, "wb") as out:
+            out.write(image)
+        print(describe(image))
+        return 0
+
+    with open(args.image, "rb") as source:
+        image = source.read()
+    try:
+        text = describe(image)
+    except ValueError as error:
+        print(f"{args.image}: {error}", file=sys.stderr)
+        return 1
+    if args.command == "show":
+        print(text)
+        return 0
+
+    start = time.monotonic()
+    with ThreadPoolExecutor(max_workers=len(args.ports)) as pool:
+        results = list(pool.map(lambda port: push(port, image, args.baud, args.timeout, args.retries), args.ports))
+    failed = 0
+    for port, (ok, message, seconds) in zip(args.ports, results):
+        print(f"{port}: {message} ({seconds:.2f} s)")
+        failed += not ok
+    print(f"{len(args.ports) - failed}/{len(args.ports)} units provisioned in {time.monotonic() - start:.2f} s")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
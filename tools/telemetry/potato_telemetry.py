@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""Host side of the PotatoFanController binary telemetry protocol.
+
+Decoder library and command line client for the framed protocol described
+in include/telemetry.h: 0x00, COBS(type, sequence, body, CRC-16 LE), 0x00
+interleaved with the firmware's plain log text on the same serial port.
+
+Library use:
+    decoder = FrameDecoder()
+    for message in decoder.feed(data):
+        ...
+
+Command line:
+    potato_telemetry.py /dev/ttyACM0 --stream 1000
+    potato_telemetry.py /dev/ttyACM0 --read 0
+    potato_telemetry.py /dev/ttyACM0 --write 0 45
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import time
+from dataclasses import dataclass
+
+MSG_SAMPLE = 0x01
+MSG_READ_FIELD = 0x02
+MSG_WRITE_FIELD = 0x03
+MSG_SET_STREAM = 0x04
+MSG_READ_CONFIG = 0x05
+MSG_WRITE_CONFIG = 0x06
+MSG_RESPONSE = 0x80
+MSG_NACK = 0xFF
+
+NO_READING = -32768
+
+# PersistenceField values (include/persistence_manager.h)
+FIELDS = {
+    0: "minimal_external_temperature",
+    1: "maximal_external_temperature",
+    2: "temperature_difference_hysteresis",
+    3: "switch_time_hysteresis",
+    4: "modbus_address",
+}
+
+ERRORS = {
+    1: "unknown type",
+    2: "bad length",
+    3: "unknown field",
+    4: "bad image size",
+    5: "bad image CRC",
+    6: "bad image header or version",
+    7: "unknown or repeated field in image",
+    8: "image value out of range",
+}
+
+
+def crc16(data: bytes) -> int:
+    """CRC-16/CCITT-FALSE."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data: bytes) -> bytes:
+    out = bytearray([0])
+    code_index = 0
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+            continue
+        out.append(byte)
+        code += 1
+        if code == 0xFF:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    index = 0
+    while index < len(data):
+        code = data[index]
+        index += 1
+        if code == 0 or index + code - 1 > len(data):
+            raise ValueError("malformed COBS frame")
+        out += data[index:index + code - 1]
+        index += code - 1
+        if code != 0xFF and index < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+@dataclass
+class Sample:
+    sequence: int
+    uptime_ms: int
+    external: float | None   # C, None when the sensor has no reading
+    internal: float | None
+    fan_on: bool
+    loop_ms: int
+
+
+@dataclass
+class FieldValue:
+    sequence: int
+    field: int
+    raw: int
+    decimals: int
+
+    @property
+    def value(self) -> float:
+        return self.raw / (10 ** self.decimals)
+
+    @property
+    def name(self) -> str:
+        return FIELDS.get(self.field, f"field_{self.field}")
+
+
+@dataclass
+class Ack:
+    sequence: int
+    period_ms: int
+
+
+@dataclass
+class Config:
+    sequence: int
+    image: bytes    # ConfigImage blob, see tools/telemetry/potato_provision.py
+
+
+@dataclass
+class Nack:
+    sequence: int
+    request: int
+    error: int
+
+
+def _celsius(centi: int):
+    return None if centi == NO_READING else centi / 100.0
+
+
+def parse_payload(payload: bytes):
+    """Decode a CRC-checked payload into a message object (None if unknown)."""
+    msg_type, sequence, body = payload[0], payload[1], payload[2:-2]
+    if msg_type == MSG_SAMPLE and len(body) == 11:
+        uptime, ext, intern, fan, loop_ms = struct.unpack("<IhhBH", body)
+        return Sample(sequence, uptime, _celsius(ext), _celsius(intern), bool(fan), loop_ms)
+    if msg_type in (MSG_READ_FIELD | MSG_RESPONSE, MSG_WRITE_FIELD | MSG_RESPONSE) and len(body) == 4:
+        field, raw, decimals = struct.unpack("<BhB", body)
+        return FieldValue(sequence, field, raw, decimals)
+    if msg_type == MSG_SET_STREAM | MSG_RESPONSE and len(body) == 2:
+        return Ack(sequence, struct.unpack("<H", body)[0])
+    if msg_type in (MSG_READ_CONFIG | MSG_RESPONSE, MSG_WRITE_CONFIG | MSG_RESPONSE):
+        return Config(sequence, bytes(body))
+    if msg_type == MSG_NACK and len(body) == 2:
+        return Nack(sequence, body[0], body[1])
+    return None
+
+
+class FrameDecoder:
+    """Splits a byte stream into frames; log text and corrupt frames are counted and dropped."""
+
+    MAX_FRAME = 64
+
+    def __init__(self):
+        self._buffer = bytearray()
+        self.text = bytearray()    # Log text seen between frames
+        self.dropped = 0
+
+    def feed(self, data: bytes):
+        messages = []
+        for byte in data:
+            if byte != 0:
+                self._buffer.append(byte)
+                continue
+            if self._buffer:
+                message = self._decode(bytes(self._buffer))
+                if message is not None:
+                    messages.append(message)
+            self._buffer.clear()
+        if len(self._buffer) > self.MAX_FRAME:
+            # Long run without a delimiter is log text
+            self.text += self._buffer
+            self._buffer.clear()
+        return messages
+
+    def _decode(self, frame: bytes):
+        try:
+            payload = cobs_decode(frame)
+        except ValueError:
+            payload = b""
+        if len(payload) < 4 or crc16(payload[:-2]) != struct.unpack("<H", payload[-2:])[0]:
+            # Log text printed before the frame's leading delimiter lands here
+            self.text += frame
+            self.dropped += 1
+            return None
+        return parse_payload(payload)
+
+
+def encode_frame(msg_type: int, sequence: int, body: bytes = b"") -> bytes:
+    payload = bytes([msg_type, sequence & 0xFF]) + body
+    payload += struct.pack("<H", crc16(payload))
+    return b"\x00" + cobs_encode(payload) + b"\x00"
+
+
+def read_field_request(field: int, sequence: int = 0) -> bytes:
+    return encode_frame(MSG_READ_FIELD, sequence, bytes([field]))
+
+
+def write_field_request(field: int, raw: int, sequence: int = 0) -> bytes:
+    return encode_frame(MSG_WRITE_FIELD, sequence, struct.pack("<Bh", field, raw))
+
+
+def set_stream_request(period_ms: int, sequence: int = 0) -> bytes:
+    return encode_frame(MSG_SET_STREAM, sequence, struct.pack("<H", period_ms))
+
+
+def read_config_request(sequence: int = 0) -> bytes:
+    return encode_frame(MSG_READ_CONFIG, sequence)
+
+
+def write_config_request(image: bytes, sequence: int = 0) -> bytes:
+    return encode_frame(MSG_WRITE_CONFIG, sequence, image)
+
+
+def open_port(path: str, baud: int) -> int:
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        attrs = termios.tcgetattr(fd)
+        attrs[0] = attrs[1] = attrs[3] = 0                    # raw iflag, oflag, lflag
+        attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL
+        speed = getattr(termios, f"B{baud}")
+        attrs[4] = attrs[5] = speed
+        attrs[6][termios.VMIN] = 0
+        attrs[6][termios.VTIME] = 1                           # 100 ms read timeout
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def format_message(message) -> str:
+    if isinstance(message, Sample):
+        ext = "--" if message.external is None else f"{message.external:.2f}"
+        intern = "--" if message.internal is None else f"{message.internal:.2f}"
+        return (f"sample #{message.sequence} t={message.uptime_ms} ms ext={ext} C "
+                f"int={intern} C fan={'on' if message.fan_on else 'off'} loop={message.loop_ms} ms")
+    if isinstance(message, FieldValue):
+        return f"{message.name} = {message.value:g} (raw {message.raw})"
+    if isinstance(message, Ack):
+        return f"stream period {message.period_ms} ms"
+    if isinstance(message, Config):
+        return f"config image {message.image.hex()}"
+    if isinstance(message, Nack):
+        return f"request 0x{message.request:02X} rejected: {ERRORS.get(message.error, message.error)}"
+    return repr(message)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial device or pty")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--stream", type=int, metavar="MS", help="stream samples every MS ms (0 stops)")
+    parser.add_argument("--read", type=int, metavar="FIELD", help="read a persisted field")
+    parser.add_argument("--write", type=int, nargs=2, metavar=("FIELD", "RAW"),
+                        help="write a persisted field in fixed-point units")
+    parser.add_argument("--duration", type=float, default=None, help="seconds to listen (default: 2, forever with --stream)")
+    parser.add_argument("--show-text", action="store_true", help="also print the log text")
+    args = parser.parse_args()
+
+    fd = open_port(args.port, args.baud)
+    requests = []
+    if args.read is not None:
+        requests.append(read_field_request(args.read, len(requests)))
+    if args.write:
+        requests.append(write_field_request(*args.write, len(requests)))
+    if args.stream is not None:
+        requests.append(set_stream_request(args.stream, len(requests)))
+    for request in requests:
+        os.write(fd, request)
+
+    duration = args.duration
+    if duration is None:
+        duration = float("inf") if args.stream else 2.0
+    decoder = FrameDecoder()
+    deadline = time.monotonic() + duration
+    try:
+        while time.monotonic() < deadline:
+            data = os.read(fd, 256)
+            if not data:
+                continue
+            for message in decoder.feed(data):
+                print(format_message(message), flush=True)
+            if args.show_text and decoder.text:
+                sys.stdout.write(decoder.text.decode(errors="replace"))
+            decoder.text.clear()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.close(fd)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())